@@ -0,0 +1,72 @@
+#pragma once
+// 主机端微基准框架：固定迭代次数，多轮取最小值，输出 ns/op
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+namespace bench
+{
+    // 阻止编译器把被测结果优化掉
+    template <typename T>
+    inline void doNotOptimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // 让编译器认为指针指向的内存对外可见
+    inline void escape(void *p)
+    {
+        asm volatile("" : : "g"(p) : "memory");
+    }
+
+    inline void clobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    // 运行 rounds 轮，每轮 iterations 次，返回最快一轮的 ns/op
+    template <typename Fn>
+    double measure(uint32_t iterations, uint32_t rounds, Fn &&fn)
+    {
+        double best = 1e30;
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                fn(i);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+            if (ns < best)
+                best = ns;
+        }
+        return best;
+    }
+
+    inline void report(const char *name, double nsPerOp, const char *unit)
+    {
+        printf("[BENCH] %-40s %10.2f ns/%s\n", name, nsPerOp, unit);
+    }
+
+    // 各基准套件入口：返回 false 表示套件中有检查失败 (FAIL)
+    bool runBikeDataBench();
+    bool runEncoderBench();
+    bool runLatencyBench();
+    bool runKeiserBench();
+    bool runGatewayBench();
+    bool runHandoffBench();
+    bool runCoalesceBench();
+    bool runFtmsBench();
+    bool runCpBench();
+    bool runLogBench();
+    bool runStatusBench();
+    bool runLedBench();
+    bool runLoopbackBench();
+    bool runFilterBench();
+    bool runScenarioBench();
+    bool runPowerBench();
+    bool runLinkBench();
+    bool runBatteryBench();
+    bool runPulseBench();
+}
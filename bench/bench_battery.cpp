@@ -0,0 +1,157 @@
+#include "Bench.h"
+#include "BatteryGauge.h"
+#include "BatteryService.h"
+#include "LoopbackGatt.h"
+#include "Prng.h"
+
+namespace bench
+{
+    // 电池电量：曲线插值与截尾平均的边界、恒定电压加噪声时不反复跳变、
+    // 3 小时放电中上报次数与方向反转（对比每周期单次读数直接换算），以及每帧的处理开销。
+
+    static const size_t FRAME = 64;
+
+    // 一帧引脚电压：电池电压的一半，加均匀噪声与少量射频突发尖峰
+    static void makeFrame(Prng &prng, uint32_t batteryMv, uint16_t noiseMv, uint16_t *frame)
+    {
+        for (size_t i = 0; i < FRAME; i++)
+        {
+            float mv = batteryMv * 0.5f + prng.nextSigned() * noiseMv;
+            if (prng.nextFloat() < 0.05f)
+                mv += 150.0f;
+            frame[i] = (uint16_t)(mv + 0.5f);
+        }
+    }
+
+    static bool checkCurve()
+    {
+        bool ok = true;
+        BatteryGauge gauge;
+        const BatteryGauge::Config &config = gauge.getConfig();
+        ok &= gauge.toCentiPercent(3000) == 0 && gauge.toCentiPercent(4300) == 10000;
+        ok &= gauge.toCentiPercent(3840) == 5000 && gauge.toCentiPercent(3815) == 4500;
+        uint16_t last = 0;
+        for (uint16_t mv = config.curve[0].millivolts; mv <= config.curve[config.curvePoints - 1].millivolts; mv++)
+        {
+            uint16_t c = gauge.toCentiPercent(mv);
+            ok &= c >= last;
+            last = c;
+        }
+
+        // 截尾平均：四分之一以内的尖峰不影响结果
+        uint16_t samples[16];
+        for (size_t i = 0; i < 16; i++)
+            samples[i] = 1900;
+        samples[3] = 3000;
+        samples[7] = 3100;
+        samples[11] = 0;
+        ok &= BatteryGauge::trimmedMean(samples, 16) == 1900;
+
+        // 引脚悬空（读数接近 0 或满量程）的帧丢弃，不产生电量
+        uint16_t floating[FRAME] = {};
+        ok &= !gauge.addFrame(floating, FRAME) && !gauge.hasLevel() && gauge.getInvalidCount() == 1;
+
+        printf("[BENCH] %-40s %s\n", "电池曲线与截尾平均检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 电压在 54.6% 附近加噪声：首帧上报后最多再下降一次，不来回跳变
+    static bool checkBoundary()
+    {
+        bool ok = true;
+        BatteryGauge gauge;
+        Prng prng(7);
+        uint16_t frame[FRAME];
+        uint32_t naiveChanges = 0;
+        uint8_t naiveLevel = 0xFF;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            makeFrame(prng, 3863, 25, frame);
+            gauge.addFrame(frame, FRAME);
+            uint8_t naive = (uint8_t)((gauge.toCentiPercent(frame[0] * 2) + 50) / 100);
+            naiveChanges += naive != naiveLevel;
+            naiveLevel = naive;
+        }
+        ok &= gauge.getChangeCount() <= 2;
+        printf("[BENCH] %-40s 上报 %u 次 (单次读数 %u 次) %s\n", "电量边界噪声检查", (unsigned)gauge.getChangeCount(),
+               (unsigned)naiveChanges, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 3 小时从 4150 mV 放电到 3550 mV，每 10 秒一帧；骑行时负载使电压下沉 15 mV（每 5 分钟切换）
+    static bool checkDischarge()
+    {
+        bool ok = true;
+        host::LoopbackServer server;
+        BatteryService service(&server);
+        host::LoopbackServer::ClientConfig clientConfig;
+        server.connect(clientConfig);
+        BatteryGauge gauge;
+        Prng prng(11);
+        uint16_t frame[FRAME];
+
+        const uint32_t frames = 3 * 3600 / 10;
+        uint32_t naiveChanges = 0;
+        uint8_t naiveLevel = 0xFF;
+        uint32_t reversals = 0;
+        int direction = 0;
+        uint32_t maxErrorCenti = 0;
+        uint64_t notifies = server.getCallCount(host::LoopbackServer::CALL_NOTIFY);
+        for (uint32_t i = 0; i < frames; i++)
+        {
+            uint32_t restMv = 4150 - 600 * i / frames;
+            uint32_t loadMv = ((i / 30) & 1) ? 15 : 0;
+            makeFrame(prng, restMv - loadMv, 25, frame);
+            uint8_t previous = gauge.getLevel();
+            if (gauge.addFrame(frame, FRAME))
+            {
+                service.updateLevel(gauge.getLevel());
+                if (i > 0)
+                {
+                    int d = gauge.getLevel() > previous ? 1 : -1;
+                    reversals += direction != 0 && d != direction;
+                    direction = d;
+                }
+            }
+
+            // 与真实开路电压对应电量的偏差（含负载下沉）
+            int32_t error = (int32_t)gauge.getLevel() * 100 - gauge.toCentiPercent(restMv);
+            uint32_t e = (uint32_t)(error < 0 ? -error : error);
+            if (i > 10 && e > maxErrorCenti)
+                maxErrorCenti = e;
+
+            uint8_t naive = (uint8_t)((gauge.toCentiPercent(frame[0] * 2) + 50) / 100);
+            naiveChanges += naive != naiveLevel;
+            naiveLevel = naive;
+        }
+        notifies = server.getCallCount(host::LoopbackServer::CALL_NOTIFY) - notifies;
+
+        uint32_t ideal = (gauge.toCentiPercent(4150) - gauge.toCentiPercent(3550) + 50) / 100;
+        ok &= notifies == gauge.getChangeCount();
+        ok &= gauge.getChangeCount() <= ideal + 2 && reversals == 0;
+        printf("[BENCH] %-40s 上报 %u 次 (理想 %u, 单次读数 %u), 反转 %u, 最大偏差 %.1f%% %s\n", "3 小时放电电量上报",
+               (unsigned)gauge.getChangeCount(), (unsigned)ideal, (unsigned)naiveChanges, (unsigned)reversals,
+               maxErrorCenti / 100.0, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runBatteryBench()
+    {
+        bool ok = true;
+        ok &= checkCurve();
+        ok &= checkBoundary();
+        ok &= checkDischarge();
+
+        const uint32_t ITERATIONS = 100000;
+        const uint32_t ROUNDS = 5;
+        Prng prng(3);
+        uint16_t frames[16][FRAME];
+        for (auto &frame : frames)
+            makeFrame(prng, 3900, 25, frame);
+        BatteryGauge gauge;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            { doNotOptimize(gauge.addFrame(frames[i & 15], FRAME)); });
+        report("BatteryGauge::addFrame (64 点)", ns, "frame");
+        return ok;
+    }
+}
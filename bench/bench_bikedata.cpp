@@ -0,0 +1,30 @@
+#include "Bench.h"
+#include "BikeData.h"
+
+namespace bench
+{
+    bool runBikeDataBench()
+    {
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        BikeData bikeData;
+
+        // 每次推进 100ms，保证速度/踏频/功率三条更新路径都会执行
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t)
+                            {
+            host::advanceMicros(100000);
+            bikeData.update();
+            doNotOptimize(bikeData.getData()); });
+        report("BikeData::update (10Hz 全量更新)", ns, "update");
+
+        // 两次调用间隔不足 100ms 时走强制更新分支（与固件 50ms 轮询一致）
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t)
+                     {
+            host::advanceMicros(50000);
+            bikeData.update();
+            doNotOptimize(bikeData.getData()); });
+        report("BikeData::update (50ms 轮询)", ns, "update");
+        return true;
+    }
+}
@@ -0,0 +1,153 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "HostGatt.h"
+#include "MeasurementEncoder.h"
+#include "NotifyCoalescer.h"
+#include "ride_profile.h"
+#include <string.h>
+
+namespace bench
+{
+    // 通知合并：ride_profile.h 中的 1 小时骑行。
+    // 旧版每次采样都对两个特征值 setValue + notify；
+    // 合并后只在负载变化时发送，停车期间按 1s 保活。
+    // 骑行按 50 ms 采样，慢于合并窗口，合并路径由 checkBursts 单独检查。
+
+    static void simulateRide(bool coalesce, uint32_t &cscNotifies, uint32_t &cpNotifies,
+                             host::GattServer &server)
+    {
+        CSCService csc(&server);
+        CPService cp(&server, 0); // 仅瞬时功率，与旧版负载一致
+        csc.getCoalescer().setKeepAlive(1000000);
+        cp.getCoalescer().setKeepAlive(1000000);
+
+        BikeData bikeData;
+        bikeData.setSource(BikeData::SOURCE_KEISER);
+
+        uint64_t now = 1000000;
+        for (uint32_t t = 0; t < RIDE_TICKS; t++)
+        {
+            now += RIDE_TICK_US;
+            host::setMicros(now);
+            if (t % RIDE_ADVERT_EVERY == 0)
+                bikeData.ingestKeiser(rideSample(t));
+            bikeData.update(now);
+            const BikeData::Data &d = bikeData.getData();
+
+            if (coalesce)
+            {
+                csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+                cp.updateMeasurement(CPService::toFields(d));
+            }
+            else
+            {
+                // 旧版：无论负载是否变化都 setValue + notify
+                auto cscData = encoder::CscWheelCrank::encode(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+                csc.getMeasurementChar()->setValue(cscData.data(), cscData.size());
+                csc.getMeasurementChar()->notify();
+                encoder::CpFields fields = {};
+                fields.power = d.power;
+                auto cpData = encoder::CpPower::encode(fields);
+                cp.getMeasurementChar()->setValue(cpData.data(), cpData.size());
+                cp.getMeasurementChar()->notify();
+            }
+        }
+
+        cscNotifies = host::native(csc.getMeasurementChar())->getNotifyCount();
+        cpNotifies = host::native(cp.getMeasurementChar())->getNotifyCount();
+        if (coalesce)
+        {
+            printf("[BENCH] %-40s CSC sent=%u suppressed=%u merged=%u keepalive=%u\n", "合并器计数",
+                   (unsigned)csc.getCoalescer().getSentCount(), (unsigned)csc.getCoalescer().getSuppressedCount(),
+                   (unsigned)csc.getCoalescer().getMergedCount(), (unsigned)csc.getCoalescer().getKeepAliveCount());
+            printf("[BENCH] %-40s CP  sent=%u suppressed=%u merged=%u keepalive=%u\n", "",
+                   (unsigned)cp.getCoalescer().getSentCount(), (unsigned)cp.getCoalescer().getSuppressedCount(),
+                   (unsigned)cp.getCoalescer().getMergedCount(), (unsigned)cp.getCoalescer().getKeepAliveCount());
+        }
+    }
+
+    // 一个合并窗口内连续提交多个变化的负载：每个窗口只发一次且为最后一个负载；
+    // 之后负载不再变化：全部计入抑制，只按保活间隔重发
+    static bool checkBursts()
+    {
+        bool ok = true;
+        host::GattServer server;
+        CSCService csc(&server);
+        NotifyCoalescer &coalescer = csc.getCoalescer();
+        coalescer.setWindow(30000);
+        coalescer.setKeepAlive(1000000);
+        host::GattCharacteristic *measurement = host::native(csc.getMeasurementChar());
+
+        const uint32_t WINDOWS = 100;
+        const uint32_t BURST = 5;
+        uint64_t now = 1000000;
+        uint32_t wheel = 0;
+        host::setMicros(now);
+        ok &= csc.updateMeasurement(wheel, 0, 0, 0); // 第一包立即发出
+
+        uint32_t badWindows = 0;
+        for (uint32_t w = 0; w < WINDOWS; w++)
+        {
+            // 窗口内每 5 ms 一个新负载，都还在窗口内，只能合并
+            uint32_t before = measurement->getNotifyCount();
+            for (uint32_t i = 0; i < BURST; i++)
+            {
+                host::setMicros(now + (i + 1) * 5000);
+                wheel++;
+                csc.updateMeasurement(wheel, (uint16_t)wheel, 0, 0);
+            }
+            // 窗口到期时发出
+            now += 30000;
+            bool sent = csc.flush(now);
+            bool again = csc.flush(now);
+            auto last = encoder::CscWheelCrank::encode(wheel, (uint16_t)wheel, 0, 0);
+            bool carriesLast = measurement->getLength() == last.size() &&
+                               memcmp(measurement->getData(), last.data(), last.size()) == 0;
+            if (!sent || again || measurement->getNotifyCount() - before != 1 || !carriesLast)
+                badWindows++;
+        }
+        ok &= badWindows == 0;
+        ok &= coalescer.getMergedCount() == WINDOWS * (BURST - 1);
+
+        // 负载不变：每 50 ms 提交一次共 3 s，全部被抑制，每 1 s 一次保活
+        uint32_t sentBefore = coalescer.getSentCount();
+        for (uint32_t i = 1; i <= 60; i++)
+        {
+            host::setMicros(now + i * 50000);
+            csc.updateMeasurement(wheel, (uint16_t)wheel, 0, 0);
+        }
+        ok &= coalescer.getSuppressedCount() == 60 && coalescer.getKeepAliveCount() == 3;
+        ok &= coalescer.getSentCount() - sentBefore == 3;
+
+        printf("[BENCH] %-40s %u 个窗口, sent=%u merged=%u suppressed=%u keepalive=%u %s\n", "合并窗口检查",
+               (unsigned)WINDOWS, (unsigned)coalescer.getSentCount(), (unsigned)coalescer.getMergedCount(),
+               (unsigned)coalescer.getSuppressedCount(), (unsigned)coalescer.getKeepAliveCount(), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runCoalesceBench()
+    {
+        bool ok = checkBursts();
+        host::GattServer server;
+        uint32_t legacyCsc, legacyCp, csc, cp;
+        simulateRide(false, legacyCsc, legacyCp, server);
+        simulateRide(true, csc, cp, server);
+
+        printf("[BENCH] %-40s CSC %u -> %u (%.1f%%), CP %u -> %u (%.1f%%)\n", "1 小时骑行通知数 (旧版 -> 合并)",
+               (unsigned)legacyCsc, (unsigned)csc, 100.0 * csc / legacyCsc,
+               (unsigned)legacyCp, (unsigned)cp, 100.0 * cp / legacyCp);
+
+        // 合并判断本身的开销：一半负载重复
+        NotifyCoalescer coalescer;
+        uint8_t payload[11] = {0x03};
+        double ns = measure(1000000, 5, [&](uint32_t i)
+                            {
+            payload[1] = (uint8_t)(i >> 1);
+            coalescer.submit(payload, sizeof(payload));
+            doNotOptimize(coalescer.take((int64_t)i * 25000)); });
+        report("NotifyCoalescer submit+take", ns, "packet");
+        return ok;
+    }
+}
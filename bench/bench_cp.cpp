@@ -0,0 +1,190 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "HostGatt.h"
+#include "MeasurementEncoder.h"
+#include "ride_profile.h"
+#include <string.h>
+
+namespace bench
+{
+    // 完整 CP 测量与 Control Point：协议检查、编码开销，
+    // 以及只订阅 CP（含转数）与同时订阅 CSC + CP 的通知负载对比。
+
+    static bool expectBytes(const char *name, const uint8_t *actual, size_t actualLen,
+                            const uint8_t *expected, size_t expectedLen)
+    {
+        if (actualLen == expectedLen && memcmp(actual, expected, expectedLen) == 0)
+            return true;
+        printf("[BENCH] CP 检查不一致: %s\n", name);
+        return false;
+    }
+
+    static bool checkControlPoint()
+    {
+        bool ok = true;
+        host::GattServer server;
+        CPService cp(&server);
+        host::GattCharacteristic *feature = server.findCharacteristic(CP_FEATURE_UUID);
+        host::GattCharacteristic *measurement = host::native(cp.getMeasurementChar());
+        host::GattCharacteristic *control = host::native(cp.getControlPointChar());
+        cp.onConnect(0);
+
+        // 特性位：车轮 (bit2) + 曲柄 (bit3) + 累计能量 (bit7) + 内容屏蔽 (bit10)
+        static const uint8_t FEATURE[] = {0x8C, 0x04, 0x00, 0x00};
+        ok &= feature && expectBytes("特性值", feature->getData(), feature->getLength(), FEATURE, sizeof(FEATURE));
+
+        encoder::CpFields fields = {};
+        fields.power = 250;
+        fields.wheelRev = 5;
+        fields.wEventTime = 0x0800;
+        fields.crankRev = 3;
+        fields.cEventTime = 0x0400;
+        fields.energy = 12;
+        cp.updateMeasurement(fields);
+        static const uint8_t FULL[] = {0x30, 0x08, 0xFA, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x08,
+                                       0x03, 0x00, 0x00, 0x04, 0x0C, 0x00};
+        ok &= expectBytes("完整测量", measurement->getData(), measurement->getLength(), FULL, sizeof(FULL));
+
+        // 设置累计车轮转数为 10000：之后按 BikeData 的增量继续累加
+        static const uint8_t SET_CUMULATIVE[] = {0x01, 0x10, 0x27, 0x00, 0x00};
+        static const uint8_t SET_CUMULATIVE_OK[] = {0x20, 0x01, 0x01};
+        control->write(0, SET_CUMULATIVE, sizeof(SET_CUMULATIVE));
+        ok &= expectBytes("设置累计值响应", control->getData(), control->getLength(), SET_CUMULATIVE_OK, sizeof(SET_CUMULATIVE_OK));
+        fields.wheelRev = 7;
+        cp.updateMeasurement(fields);
+        uint32_t wheel = measurement->getData()[4] | (measurement->getData()[5] << 8);
+        if (wheel != 10000)
+        {
+            printf("[BENCH] CP 检查不一致: 设置累计值后车轮转数 %u\n", (unsigned)wheel);
+            ok = false;
+        }
+        fields.wheelRev = 9;
+        cp.updateMeasurement(fields);
+        wheel = measurement->getData()[4] | (measurement->getData()[5] << 8);
+        ok &= wheel == 10002;
+
+        // 屏蔽车轮、曲柄与能量：只剩瞬时功率
+        static const uint8_t MASK_ALL[] = {0x0D, 0x0C, 0x01};
+        control->write(0, MASK_ALL, sizeof(MASK_ALL));
+        cp.updateMeasurement(fields);
+        static const uint8_t POWER_ONLY[] = {0x00, 0x00, 0xFA, 0x00};
+        ok &= expectBytes("屏蔽后测量", measurement->getData(), measurement->getLength(), POWER_ONLY, sizeof(POWER_ONLY));
+        ok &= control->getLastIndicateConn() == 0;
+
+        // 屏蔽属于设置它的连接：该连接断开、或有其他中心设备连接时清除；多个连接时拒绝屏蔽
+        const uint16_t ALL_FLAGS = encoder::CP_WHEEL_REV | encoder::CP_CRANK_REV | encoder::CP_ACC_ENERGY;
+        cp.onDisconnect(0);
+        ok &= cp.getMeasurementFlags() == ALL_FLAGS;
+        static const uint8_t MASK_OK[] = {0x20, 0x0D, 0x01};
+        static const uint8_t MASK_FAILED[] = {0x20, 0x0D, 0x04};
+        cp.onConnect(1);
+        control->write(1, MASK_ALL, sizeof(MASK_ALL));
+        ok &= expectBytes("单连接屏蔽", control->getData(), control->getLength(), MASK_OK, sizeof(MASK_OK));
+        ok &= cp.getMeasurementFlags() == 0;
+        cp.onConnect(2);
+        ok &= cp.getMeasurementFlags() == ALL_FLAGS;
+        control->write(2, MASK_ALL, sizeof(MASK_ALL));
+        ok &= expectBytes("多连接屏蔽", control->getData(), control->getLength(), MASK_FAILED, sizeof(MASK_FAILED));
+        ok &= control->getLastIndicateConn() == 2 && cp.getMeasurementFlags() == ALL_FLAGS;
+        cp.onDisconnect(2);
+
+        // 错误路径：不支持的操作码、参数长度错误
+        static const uint8_t SET_CRANK_LENGTH[] = {0x04, 0xAF, 0x00};
+        static const uint8_t NOT_SUPPORTED[] = {0x20, 0x04, 0x02};
+        control->write(1, SET_CRANK_LENGTH, sizeof(SET_CRANK_LENGTH));
+        ok &= expectBytes("不支持的操作码", control->getData(), control->getLength(), NOT_SUPPORTED, sizeof(NOT_SUPPORTED));
+        static const uint8_t SHORT_CUMULATIVE[] = {0x01, 0x10};
+        static const uint8_t INVALID_PARAMETER[] = {0x20, 0x01, 0x03};
+        control->write(1, SHORT_CUMULATIVE, sizeof(SHORT_CUMULATIVE));
+        ok &= expectBytes("参数错误", control->getData(), control->getLength(), INVALID_PARAMETER, sizeof(INVALID_PARAMETER));
+        ok &= control->getIndicateCount() == 6 && control->getLastIndicateConn() == 1;
+
+        // 未声明车轮数据时不接受设置累计值
+        CPService powerOnly(&server, 0);
+        static const uint8_t CUMULATIVE_NOT_SUPPORTED[] = {0x20, 0x01, 0x02};
+        host::GattCharacteristic *powerOnlyControl = host::native(powerOnly.getControlPointChar());
+        powerOnlyControl->write(0, SET_CUMULATIVE, sizeof(SET_CUMULATIVE));
+        ok &= expectBytes("未支持车轮数据", powerOnlyControl->getData(), powerOnlyControl->getLength(),
+                          CUMULATIVE_NOT_SUPPORTED, sizeof(CUMULATIVE_NOT_SUPPORTED));
+
+        printf("[BENCH] %-40s %s\n", "CP 测量与 Control Point 检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static void compareSubscriptions()
+    {
+        host::GattServer server;
+        CSCService csc(&server);
+        CPService cpPower(&server, 0);
+        CPService cpFull(&server);
+        csc.getCoalescer().setKeepAlive(1000000);
+        cpPower.getCoalescer().setKeepAlive(1000000);
+        cpFull.getCoalescer().setKeepAlive(1000000);
+
+        BikeData bikeData;
+        bikeData.setSource(BikeData::SOURCE_KEISER);
+
+        uint64_t now = 1000000;
+        for (uint32_t t = 0; t < RIDE_TICKS; t++)
+        {
+            now += RIDE_TICK_US;
+            host::setMicros(now);
+            if (t % RIDE_ADVERT_EVERY == 0)
+                bikeData.ingestKeiser(rideSample(t));
+            bikeData.update(now);
+            const BikeData::Data &d = bikeData.getData();
+            csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+            cpPower.updateMeasurement(CPService::toFields(d));
+            cpFull.updateMeasurement(CPService::toFields(d));
+        }
+
+        const double seconds = (double)RIDE_TICKS * RIDE_TICK_US / 1e6;
+        uint32_t cscCount = host::native(csc.getMeasurementChar())->getNotifyCount();
+        uint32_t cpCount = host::native(cpPower.getMeasurementChar())->getNotifyCount();
+        uint32_t fullCount = host::native(cpFull.getMeasurementChar())->getNotifyCount();
+        uint64_t pairBytes = (uint64_t)cscCount * (encoder::CscWheelCrank::SIZE + AIR_OVERHEAD) +
+                             (uint64_t)cpCount * (encoder::CpPower::SIZE + AIR_OVERHEAD);
+        uint64_t fullBytes = (uint64_t)fullCount * (encoder::CpPowerFull::SIZE + AIR_OVERHEAD);
+
+        printf("[BENCH] %-40s CSC+CP 2 次 %u B, CP 完整 1 次 %u B\n", "每次采样通知 (全部变化)",
+               (unsigned)(encoder::CscWheelCrank::SIZE + encoder::CpPower::SIZE + 2 * AIR_OVERHEAD),
+               (unsigned)(encoder::CpPowerFull::SIZE + AIR_OVERHEAD));
+        printf("[BENCH] %-40s CSC %u + CP %u 次 -> CP 完整 %u 次 (%.1f%%)\n", "1 小时骑行通知数 (合并后)",
+               (unsigned)cscCount, (unsigned)cpCount, (unsigned)fullCount,
+               100.0 * fullCount / (cscCount + cpCount));
+        printf("[BENCH] %-40s CSC+CP %.1f B/s, CP 完整 %.1f B/s (%.1f%%)\n", "1 小时骑行平均空口字节",
+               pairBytes / seconds, fullBytes / seconds, 100.0 * fullBytes / pairBytes);
+    }
+
+    bool runCpBench()
+    {
+        bool ok = true;
+        ok &= checkControlPoint();
+        compareSubscriptions();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        // 运行期按特性位分派 vs 编译期固定格式
+        host::GattServer server;
+        CPService cp(&server);
+        uint8_t buf[CPService::MAX_MEASUREMENT_SIZE];
+        escape(buf);
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            encoder::CpFields fields = {(int16_t)(i & 0x3FF), i, (uint16_t)i, (uint16_t)(i >> 1), (uint16_t)(i >> 1), (uint16_t)(i >> 12)};
+            doNotOptimize(cp.encode(fields, buf));
+            clobberMemory(); });
+        report("CPService::encode (按特性位分派)", ns, "packet");
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            encoder::CpFields fields = {(int16_t)(i & 0x3FF), i, (uint16_t)i, (uint16_t)(i >> 1), (uint16_t)(i >> 1), (uint16_t)(i >> 12)};
+            doNotOptimize(cp.updateMeasurement(fields));
+            clobberMemory(); });
+        report("CPService::updateMeasurement (完整)", ns, "packet");
+        return ok;
+    }
+}
@@ -0,0 +1,116 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "HostGatt.h"
+#include "MeasurementEncoder.h"
+
+namespace bench
+{
+    // 旧版手工编码（模板编码器引入前的实现），仅作对比基线
+    static size_t legacyCscEncode(uint8_t *data, uint32_t wheelRev, uint16_t wEventTime,
+                                  uint32_t crankRev, uint16_t cEventTime)
+    {
+        const size_t TOTAL_SIZE = 13;
+        size_t offset = 0;
+        data[offset++] = 0x03;
+        data[offset++] = wheelRev & 0xFF;
+        data[offset++] = (wheelRev >> 8) & 0xFF;
+        data[offset++] = (wheelRev >> 16) & 0xFF;
+        data[offset++] = (wheelRev >> 24) & 0xFF;
+        data[offset++] = wEventTime & 0xFF;
+        data[offset++] = (wEventTime >> 8) & 0xFF;
+        data[offset++] = crankRev & 0xFF;
+        data[offset++] = (crankRev >> 8) & 0xFF;
+        data[offset++] = (crankRev >> 16) & 0xFF;
+        data[offset++] = (crankRev >> 24) & 0xFF;
+        data[offset++] = cEventTime & 0xFF;
+        data[offset++] = (cEventTime >> 8) & 0xFF;
+        if (offset != TOTAL_SIZE)
+            return 0;
+        return offset;
+    }
+
+    static size_t legacyCpEncode(uint8_t *data, int16_t power)
+    {
+        size_t dataLen = 0;
+        data[dataLen++] = 0x20;
+        memcpy(&data[dataLen], &power, sizeof(power));
+        dataLen += sizeof(power);
+        data[dataLen++] = 0;
+        if (dataLen > 4)
+            return 0;
+        return dataLen;
+    }
+
+    template <typename Enc>
+    static void benchCsc(const char *name, uint32_t iterations, uint32_t rounds)
+    {
+        double ns = measure(iterations, rounds, [&](uint32_t i)
+                            {
+            auto buf = Enc::encode(i, (uint16_t)i, (uint16_t)(i >> 1), (uint16_t)(i >> 2));
+            doNotOptimize(buf); });
+        report(name, ns, "packet");
+    }
+
+    template <typename Enc>
+    static void benchCp(const char *name, uint32_t iterations, uint32_t rounds)
+    {
+        double ns = measure(iterations, rounds, [&](uint32_t i)
+                            {
+            encoder::CpFields f = {(int16_t)(i & 0x3FF), i, (uint16_t)i,
+                                   (uint16_t)(i >> 1), (uint16_t)(i >> 2), (uint16_t)(i >> 10)};
+            auto buf = Enc::encode(f);
+            doNotOptimize(buf); });
+        report(name, ns, "packet");
+    }
+
+    bool runEncoderBench()
+    {
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        // 纯编码开销：旧版 vs 模板特化
+        uint8_t legacyBuf[16];
+        escape(legacyBuf);
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            doNotOptimize(legacyCscEncode(legacyBuf, i, (uint16_t)i, i >> 1, (uint16_t)(i >> 2)));
+            clobberMemory(); });
+        report("legacy CSC encode (13B)", ns, "packet");
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            doNotOptimize(legacyCpEncode(legacyBuf, (int16_t)(i & 0x3FF)));
+            clobberMemory(); });
+        report("legacy CP encode (4B)", ns, "packet");
+
+        benchCsc<encoder::CscWheel>("CscWheel::encode", ITERATIONS, ROUNDS);
+        benchCsc<encoder::CscCrank>("CscCrank::encode", ITERATIONS, ROUNDS);
+        benchCsc<encoder::CscWheelCrank>("CscWheelCrank::encode", ITERATIONS, ROUNDS);
+        benchCp<encoder::CpPower>("CpPower::encode", ITERATIONS, ROUNDS);
+        benchCp<encoder::CpPowerCrank>("CpPowerCrank::encode", ITERATIONS, ROUNDS);
+        benchCp<encoder::CpPowerFull>("CpPowerFull::encode", ITERATIONS, ROUNDS);
+
+        // 服务层完整路径：编码 + setValue + 合并判断（主机时钟不前进，首包之后均被合并）
+        host::GattServer server;
+        CSCService csc(&server);
+        CPService cp(&server);
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            csc.updateMeasurement(i, (uint16_t)i, (uint16_t)(i >> 1), (uint16_t)(i >> 1));
+            clobberMemory(); });
+        report("CSCService::updateMeasurement", ns, "packet");
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            encoder::CpFields fields = {};
+            fields.power = (int16_t)(i & 0x3FF);
+            fields.crankRev = (uint16_t)(i >> 1);
+            cp.updateMeasurement(fields);
+            clobberMemory(); });
+        report("CPService::updateMeasurement", ns, "packet");
+        return true;
+    }
+}
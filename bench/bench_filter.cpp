@@ -0,0 +1,200 @@
+#include "Bench.h"
+#include "FilterKernels.h"
+#include "SampleFilter.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace bench
+{
+    // 采样滤波：标量与向量中值内核逐位一致、批处理与逐样本处理一致、平滑效果，
+    // 以及各内核的每样本开销。
+
+    static uint32_t nextRandom(uint32_t &state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // 约 200W、±5% 均匀噪声并夹带偶发尖峰的功率序列
+    static std::vector<int16_t> makeSignal(size_t n, uint32_t seed)
+    {
+        std::vector<int16_t> signal(n);
+        uint32_t state = seed;
+        size_t sinceSpike = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            int32_t v = 200 + (int32_t)(nextRandom(state) % 21) - 10;
+            bool spike = nextRandom(state) % 50 == 0 && sinceSpike >= 2;
+            sinceSpike = spike ? 0 : sinceSpike + 1;
+            if (spike)
+                v += 400; // 单点尖峰，相邻尖峰至少间隔 2 个样本
+            signal[i] = (int16_t)v;
+        }
+        return signal;
+    }
+
+    static bool checkMedianKernels()
+    {
+        bool ok = true;
+        uint32_t state = 12345;
+        std::vector<int16_t> window(1000 + dsp::MAX_MEDIAN);
+        std::vector<int16_t> scalar(1000), vector(1000);
+        size_t compared = 0;
+        for (uint32_t round = 0; round < 50; round++)
+        {
+            // 全范围随机值，含 INT16_MIN/INT16_MAX 与大量重复值
+            for (auto &v : window)
+            {
+                uint32_t r = nextRandom(state);
+                v = (round & 1) ? (int16_t)(r & 7) : (int16_t)r;
+            }
+            window[3] = INT16_MIN;
+            window[7] = INT16_MAX;
+            size_t n = 1000 - round * 7; // 覆盖不足 8 个的尾部
+            for (uint8_t size = 1; size <= dsp::MAX_MEDIAN; size += 2)
+            {
+                dsp::medianScalar(window.data(), scalar.data(), n, size);
+                dsp::medianVector(window.data(), vector.data(), n, size);
+                ok &= memcmp(scalar.data(), vector.data(), n * sizeof(int16_t)) == 0;
+                compared += n;
+            }
+        }
+        printf("[BENCH] %-40s %u 个输出, 目标实现 %s %s\n", "中值内核标量/向量交叉校验", (unsigned)compared,
+               dsp::medianIsVector() ? "向量" : "标量", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static bool checkSampleFilter()
+    {
+        bool ok = true;
+        const size_t N = 5000;
+        std::vector<int16_t> signal = makeSignal(N, 777);
+
+        SampleFilter::Config configs[4];
+        configs[0].medianSize = 5;
+        configs[1].smoother = SampleFilter::SMOOTH_EMA;
+        configs[2].medianSize = 3;
+        configs[2].smoother = SampleFilter::SMOOTH_KALMAN;
+        configs[3].medianSize = 9;
+        configs[3].smoother = SampleFilter::SMOOTH_EMA;
+        configs[3].emaAlpha = 0.1f;
+
+        for (const SampleFilter::Config &config : configs)
+        {
+            // 一次处理、逐个处理、不规则分批与经过序列化的状态得到相同输出
+            SampleFilter batch(config), single(config), chunked(config);
+            std::vector<int16_t> a(N), b(N), c(N);
+            batch.process(signal.data(), a.data(), N);
+            for (size_t i = 0; i < N; i++)
+                b[i] = single.push(signal[i]);
+            size_t pos = 0;
+            for (size_t step = 1; pos < N; step = step * 3 % 97 + 1)
+            {
+                size_t count = N - pos < step ? N - pos : step;
+                if (pos > N / 2 && pos - count <= N / 2)
+                {
+                    uint8_t buf[128];
+                    trace::ByteWriter w(buf, sizeof(buf));
+                    chunked.saveState(w);
+                    trace::ByteReader r(buf, w.size());
+                    SampleFilter restored;
+                    restored.loadState(r);
+                    chunked = restored;
+                }
+                chunked.process(signal.data() + pos, c.data() + pos, count);
+                pos += count;
+            }
+            ok &= a == b && a == c;
+        }
+
+        // 中值 3 + Kalman：尖峰被去除，噪声标准差明显下降
+        SampleFilter filter(configs[2]);
+        std::vector<int16_t> out(N);
+        filter.process(signal.data(), out.data(), N);
+        double inVar = 0, outVar = 0;
+        int16_t outMax = 0;
+        for (size_t i = 100; i < N; i++)
+        {
+            inVar += (signal[i] - 200.0) * (signal[i] - 200.0);
+            outVar += (out[i] - 200.0) * (out[i] - 200.0);
+            if (out[i] > outMax)
+                outMax = out[i];
+        }
+        double inStd = sqrt(inVar / (N - 100));
+        double outStd = sqrt(outVar / (N - 100));
+        ok &= outStd < inStd / 4 && outMax < 220;
+
+        // 未启用时原样输出
+        SampleFilter passthrough;
+        ok &= !passthrough.isEnabled() && passthrough.push(-123) == -123;
+
+        printf("[BENCH] %-40s 标准差 %.1f -> %.1f W, 最大 %d W %s\n", "采样滤波批处理与平滑检查",
+               inStd, outStd, outMax, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runFilterBench()
+    {
+        bool ok = true;
+        ok &= checkMedianKernels();
+        ok &= checkSampleFilter();
+
+        const size_t N = 4096;
+        const uint32_t ROUNDS = 20;
+        std::vector<int16_t> signal = makeSignal(N + dsp::MAX_MEDIAN, 99);
+        std::vector<int16_t> out(N);
+        escape(out.data());
+        char name[64];
+
+        // 批处理开销按样本计：每轮处理 N 个样本
+        for (uint8_t size = 3; size <= dsp::MAX_MEDIAN; size += 2)
+        {
+            double ns = measure(1, ROUNDS, [&](uint32_t)
+                                {
+                dsp::medianScalar(signal.data(), out.data(), N, size);
+                clobberMemory(); });
+            snprintf(name, sizeof(name), "中值-%u 标量", (unsigned)size);
+            report(name, ns / N, "sample");
+            ns = measure(1, ROUNDS, [&](uint32_t)
+                         {
+                dsp::medianVector(signal.data(), out.data(), N, size);
+                clobberMemory(); });
+            snprintf(name, sizeof(name), "中值-%u 向量 (8 路)", (unsigned)size);
+            report(name, ns / N, "sample");
+        }
+
+        int32_t emaState = 200 * 256;
+        double ns = measure(1, ROUNDS, [&](uint32_t)
+                            {
+            emaState = dsp::ema(signal.data(), out.data(), N, 8192, emaState);
+            clobberMemory(); });
+        report("EMA (Q8)", ns / N, "sample");
+
+        float x = 200, p = 100;
+        ns = measure(1, ROUNDS, [&](uint32_t)
+                     {
+            dsp::kalman(signal.data(), out.data(), N, 4.0f, 100.0f, &x, &p);
+            clobberMemory(); });
+        report("Kalman (float)", ns / N, "sample");
+
+        // 固件中的用法：每次更新处理一个样本
+        SampleFilter::Config config;
+        config.medianSize = 3;
+        config.smoother = SampleFilter::SMOOTH_KALMAN;
+        SampleFilter filter(config);
+        ns = measure(1000000, 5, [&](uint32_t i)
+                     {
+            doNotOptimize(filter.push(signal[i & (N - 1)]));
+            clobberMemory(); });
+        report("SampleFilter::push (中值-3 + Kalman)", ns, "sample");
+        ns = measure(1, ROUNDS, [&](uint32_t)
+                     {
+            filter.process(signal.data(), out.data(), N);
+            clobberMemory(); });
+        report("SampleFilter::process (中值-3 + Kalman)", ns / N, "sample");
+        return ok;
+    }
+}
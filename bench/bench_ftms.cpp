@@ -0,0 +1,136 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "FTMSService.h"
+#include "HostGatt.h"
+#include "MeasurementEncoder.h"
+#include "ride_profile.h"
+#include <string.h>
+
+namespace bench
+{
+    // FTMS Indoor Bike Data：编码正确性检查、编码开销，
+    // 以及与 CSC + CP 两个特征值相比的空口字节数。
+
+    struct EncodeCase
+    {
+        const char *name;
+        float speed;
+        float cadence;
+        int16_t power;
+        uint8_t expected[8];
+    };
+
+    static bool checkEncoder()
+    {
+        static const EncodeCase CASES[] = {
+            {"零值", 0.0f, 0.0f, 0, {0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+            {"典型骑行", 32.5f, 90.0f, 215, {0x44, 0x00, 0xB2, 0x0C, 0xB4, 0x00, 0xD7, 0x00}},
+            {"四舍五入", 25.004f, 85.3f, 1, {0x44, 0x00, 0xC4, 0x09, 0xAB, 0x00, 0x01, 0x00}},
+            {"负值截断", -3.0f, -1.0f, -5, {0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFB, 0xFF}},
+            {"上限截断", 900.0f, 40000.0f, 2000, {0x44, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xD0, 0x07}},
+        };
+
+        bool ok = true;
+        host::GattServer server;
+        FTMSService ftms(&server);
+        for (const EncodeCase &c : CASES)
+        {
+            ftms.updateMeasurement(c.speed, c.cadence, c.power);
+            gatt::Characteristic *ch = ftms.getMeasurementChar();
+            bool match = ch->getLength() == sizeof(c.expected) &&
+                         memcmp(ch->getData(), c.expected, sizeof(c.expected)) == 0;
+            if (!match)
+            {
+                printf("[BENCH] FTMS 编码不一致: %s\n", c.name);
+                ok = false;
+            }
+        }
+
+        // 特性值：踏频 (bit1) + 功率 (bit14)，无目标设定
+        host::GattCharacteristic *feature = server.findCharacteristic(FTMS_FEATURE_UUID);
+        static const uint8_t EXPECTED_FEATURE[8] = {0x02, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+        if (!feature || feature->getLength() != sizeof(EXPECTED_FEATURE) ||
+            memcmp(feature->getData(), EXPECTED_FEATURE, sizeof(EXPECTED_FEATURE)) != 0)
+        {
+            printf("[BENCH] FTMS 特性值不一致\n");
+            ok = false;
+        }
+
+        printf("[BENCH] %-40s %u 例 %s\n", "FTMS Indoor Bike Data 编码检查",
+               (unsigned)(sizeof(CASES) / sizeof(CASES[0])), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // ride_profile.h 中的 1 小时骑行，三个特征值都经过合并器
+    static void compareAirBytes()
+    {
+        host::GattServer server;
+        CSCService csc(&server);
+        CPService cp(&server, 0); // 仅瞬时功率
+        FTMSService ftms(&server);
+        csc.getCoalescer().setKeepAlive(1000000);
+        cp.getCoalescer().setKeepAlive(1000000);
+        ftms.getCoalescer().setKeepAlive(1000000);
+
+        BikeData bikeData;
+        bikeData.setSource(BikeData::SOURCE_KEISER);
+
+        uint64_t now = 1000000;
+        for (uint32_t t = 0; t < RIDE_TICKS; t++)
+        {
+            now += RIDE_TICK_US;
+            host::setMicros(now);
+            if (t % RIDE_ADVERT_EVERY == 0)
+                bikeData.ingestKeiser(rideSample(t));
+            bikeData.update(now);
+            const BikeData::Data &d = bikeData.getData();
+            csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+            cp.updateMeasurement(CPService::toFields(d));
+            ftms.updateMeasurement(d.speed, d.cadence, d.power);
+        }
+
+        const double seconds = (double)RIDE_TICKS * RIDE_TICK_US / 1e6;
+        uint32_t cscCount = host::native(csc.getMeasurementChar())->getNotifyCount();
+        uint32_t cpCount = host::native(cp.getMeasurementChar())->getNotifyCount();
+        uint32_t ftmsCount = host::native(ftms.getMeasurementChar())->getNotifyCount();
+        uint64_t pairBytes = (uint64_t)cscCount * (encoder::CscWheelCrank::SIZE + AIR_OVERHEAD) +
+                             (uint64_t)cpCount * (encoder::CpPower::SIZE + AIR_OVERHEAD);
+        uint64_t ftmsBytes = (uint64_t)ftmsCount * (encoder::IbdSpeedCadencePower::SIZE + AIR_OVERHEAD);
+
+        printf("[BENCH] %-40s CSC+CP %u B, FTMS %u B\n", "每次采样空口字节 (全部变化)",
+               (unsigned)(encoder::CscWheelCrank::SIZE + encoder::CpPower::SIZE + 2 * AIR_OVERHEAD),
+               (unsigned)(encoder::IbdSpeedCadencePower::SIZE + AIR_OVERHEAD));
+        printf("[BENCH] %-40s CSC %u + CP %u 次, FTMS %u 次\n", "1 小时骑行通知数 (合并后)",
+               (unsigned)cscCount, (unsigned)cpCount, (unsigned)ftmsCount);
+        printf("[BENCH] %-40s CSC+CP %.1f B/s, FTMS %.1f B/s (%.1f%%)\n", "1 小时骑行平均空口字节",
+               pairBytes / seconds, ftmsBytes / seconds, 100.0 * ftmsBytes / pairBytes);
+    }
+
+    bool runFtmsBench()
+    {
+        bool ok = true;
+        ok &= checkEncoder();
+        compareAirBytes();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            encoder::IbdFields fields = FTMSService::toFields((float)(i & 0xFFF) * 0.01f, (float)(i & 0xFF), (int16_t)(i & 0x3FF));
+            doNotOptimize(encoder::IbdSpeedCadencePower::encode(fields));
+            clobberMemory(); });
+        report("IbdSpeedCadencePower::encode (含换算)", ns, "packet");
+
+        host::GattServer server;
+        FTMSService ftms(&server);
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            ftms.updateMeasurement((float)(i & 0xFFF) * 0.01f, (float)(i & 0xFF), (int16_t)(i & 0x3FF));
+            clobberMemory(); });
+        report("FTMSService::updateMeasurement", ns, "packet");
+        return ok;
+    }
+}
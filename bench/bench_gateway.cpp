@@ -0,0 +1,79 @@
+#include "Bench.h"
+#include "BikeTable.h"
+#include "CPService.h"
+#include "MeasurementEncoder.h"
+
+namespace bench
+{
+    // 多车网关负载测试：N 台模拟单车，每个周期各写入一条广播并推进整张表，
+    // 再为发生变化的单车编码 CSC + CP（对应每个会话的发送准备）
+    static void runTableLoad(uint8_t bikes)
+    {
+        const uint32_t TICKS = 200000;
+        const uint32_t ROUNDS = 3;
+        const uint32_t TICK_US = 50000;
+
+        BikeTable table;
+        KeiserSample samples[BikeTable::MAX_BIKES];
+        for (uint8_t i = 0; i < bikes; i++)
+        {
+            samples[i] = {};
+            samples[i].versionMajor = 6;
+            samples[i].versionMinor = 0x30;
+            samples[i].equipmentId = (uint8_t)(i + 1);
+            samples[i].cadence = (uint16_t)(600 + i * 15);
+            samples[i].power = (uint16_t)(120 + i * 5);
+            samples[i].gear = (uint8_t)(8 + i % 12);
+        }
+
+        uint32_t nowUs = 0;
+        uint64_t changedTotal = 0;
+        double ns = measure(TICKS, ROUNDS, [&](uint32_t t)
+                            {
+            nowUs += TICK_US;
+            uint32_t nowMs = nowUs / 1000;
+            for (uint8_t i = 0; i < bikes; i++)
+            {
+                samples[i].power = (uint16_t)(120 + i * 5 + (t & 7));
+                table.ingest(samples[i], nowMs);
+            }
+            uint32_t changed = table.advance(nowUs, nowMs);
+            changedTotal += __builtin_popcount(changed);
+            while (changed)
+            {
+                uint8_t slot = __builtin_ctz(changed);
+                changed &= changed - 1;
+                BikeData::Data d = table.get(slot);
+                auto csc = encoder::CscWheelCrank::encode(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+                auto cp = encoder::CpPowerFull::encode(CPService::toFields(d));
+                doNotOptimize(csc);
+                doNotOptimize(cp);
+            } });
+
+        double perBike = ns / bikes;
+        printf("[BENCH] gateway %2u 台单车  %9.1f ns/tick  %7.1f ns/bike  %6.2f M bike-updates/s\n",
+               (unsigned)bikes, ns, perBike, 1000.0 / perBike);
+        doNotOptimize(changedTotal);
+    }
+
+    bool runGatewayBench()
+    {
+        runTableLoad(1);
+        runTableLoad(8);
+        runTableLoad(16);
+        runTableLoad(32);
+
+        // 满表时的查找开销（最坏情况为末尾槽位）
+        BikeTable table;
+        KeiserSample s = {};
+        for (uint8_t i = 0; i < BikeTable::MAX_BIKES; i++)
+        {
+            s.equipmentId = (uint8_t)(i + 1);
+            table.ingest(s, 1);
+        }
+        double ns = measure(1000000, 5, [&](uint32_t i)
+                            { doNotOptimize(table.find((uint8_t)(i % BikeTable::MAX_BIKES + 1))); });
+        report("BikeTable::find (32 台)", ns, "lookup");
+        return true;
+    }
+}
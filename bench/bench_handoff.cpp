@@ -0,0 +1,149 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "Bench.h"
+#include "BikeData.h"
+#include "SpscRing.h"
+
+namespace bench
+{
+    // 采样 -> 通知的快照交接：
+    // 比较 SPSC 环形队列与加锁拷贝的开销，检查双线程下的顺序与计数，
+    // 并在虚拟时间中模拟射频拥塞时 notify 变慢对队列的影响。
+
+    struct Sample
+    {
+        BikeData::Data data;
+        int64_t eventUs[2];
+        uint32_t tick;
+        uint8_t events;
+    };
+
+    static const uint32_t STRESS_SAMPLES = 2000000;
+    static const int64_t TICK_US = 50000;
+
+    // 双线程正确性：顺序不乱，发送数 = 接收数 + 溢出数
+    static bool runThreaded()
+    {
+        static SpscRing<Sample, 16> ring;
+        ring.reset();
+        std::atomic<bool> done(false);
+        uint32_t received = 0;
+        uint32_t outOfOrder = 0;
+
+        std::thread consumer([&]()
+                             {
+            uint32_t expected = 0;
+            Sample s;
+            for (;;)
+            {
+                bool finished = done.load(std::memory_order_acquire);
+                while (ring.pop(s))
+                {
+                    if (s.tick < expected)
+                        outOfOrder++;
+                    expected = s.tick + 1;
+                    received++;
+                }
+                if (finished)
+                    break;
+                std::this_thread::yield();
+            } });
+
+        Sample s = {};
+        for (uint32_t i = 0; i < STRESS_SAMPLES; i++)
+        {
+            s.tick = i;
+            s.data.wheel_rev = i;
+            if (!ring.push(s))
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+        consumer.join();
+
+        bool ok = outOfOrder == 0 && received + ring.getOverflowCount() == STRESS_SAMPLES;
+        printf("[BENCH] %-40s sent=%u recv=%u overflow=%u order_err=%u %s\n", "SPSC 双线程交接",
+               (unsigned)STRESS_SAMPLES, (unsigned)received, (unsigned)ring.getOverflowCount(),
+               (unsigned)outOfOrder, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 拥塞仿真（虚拟时间）：每 50ms 采样一次，消费者每次发送后按给定时长停顿。
+    // 采样从不等待消费者；队列满时事件并入下一个快照，只有快照被跳过。
+    static void simulateCongestion(int64_t stallUs)
+    {
+        SpscRing<Sample, 16> ring;
+        Sample s = {};
+        Sample out;
+        uint8_t deferred = 0;
+        int64_t consumerFreeUs = 0;
+        uint32_t delivered = 0;
+
+        for (uint32_t i = 0; i < 20000; i++)
+        {
+            int64_t now = (int64_t)i * TICK_US;
+            s.tick = i;
+            s.events = BikeData::EVENT_WHEEL | deferred;
+            if (ring.push(s))
+                deferred = 0;
+            else
+                deferred = s.events;
+
+            // 消费者空闲时取空队列并发送一次
+            if (now >= consumerFreeUs)
+            {
+                bool any = false;
+                while (ring.pop(out))
+                    any = true;
+                if (any)
+                {
+                    delivered++;
+                    consumerFreeUs = now + stallUs;
+                }
+            }
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "拥塞仿真 notify 停顿 %ums", (unsigned)(stallUs / 1000));
+        printf("[BENCH] %-40s notifies=%u overflow=%u high=%u/16\n", name,
+               (unsigned)delivered, (unsigned)ring.getOverflowCount(), (unsigned)ring.getHighWater());
+    }
+
+    bool runHandoffBench()
+    {
+        bool ok = true;
+        Sample s = {};
+        Sample out;
+
+        static SpscRing<Sample, 16> ring;
+        double ns = measure(1000000, 5, [&](uint32_t i)
+                            {
+            s.tick = i;
+            ring.push(s);
+            ring.pop(out);
+            doNotOptimize(out); });
+        report("SpscRing push+pop", ns, "sample");
+
+        std::mutex mutex;
+        Sample shared = {};
+        ns = measure(1000000, 5, [&](uint32_t i)
+                     {
+            s.tick = i;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                shared = s;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                out = shared;
+            }
+            doNotOptimize(out); });
+        report("加锁拷贝 写+读 (对照)", ns, "sample");
+
+        ok &= runThreaded();
+        simulateCongestion(30000);
+        simulateCongestion(500000);
+        simulateCongestion(2000000);
+        return ok;
+    }
+}
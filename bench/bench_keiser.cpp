@@ -0,0 +1,57 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "KeiserParser.h"
+#include "keiser_corpus.h"
+
+namespace bench
+{
+    bool runKeiserBench()
+    {
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        // 先校验样本集的解析结果，避免基准测到的是提前返回的错误路径
+        uint32_t parsed = 0;
+        for (size_t i = 0; i < KEISER_CORPUS_SIZE; i++)
+        {
+            KeiserSample s;
+            if (KeiserParser::parseAdvertisement(KEISER_CORPUS[i].data, KEISER_CORPUS[i].len, s))
+            {
+                parsed++;
+                printf("[BENCH] keiser #%u bike=%u type=%u cad=%u.%u pwr=%u gear=%u\n",
+                       (unsigned)i, s.equipmentId, s.dataType, s.cadence / 10, s.cadence % 10,
+                       s.power, s.gear);
+            }
+        }
+        printf("[BENCH] 样本集 %u 条，解析成功 %u 条\n", (unsigned)KEISER_CORPUS_SIZE, (unsigned)parsed);
+
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            const AdvertRecord &rec = KEISER_CORPUS[i % KEISER_CORPUS_SIZE];
+            KeiserSample s;
+            doNotOptimize(KeiserParser::parseAdvertisement(rec.data, rec.len, s));
+            doNotOptimize(s); });
+        report("KeiserParser::parseAdvertisement (混合)", ns, "advert");
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t)
+                     {
+            KeiserSample s;
+            doNotOptimize(KeiserParser::parseAdvertisement(ADV_KEISER_RT_1, sizeof(ADV_KEISER_RT_1), s));
+            doNotOptimize(s); });
+        report("KeiserParser::parseAdvertisement (Keiser)", ns, "advert");
+
+        // 广播写入 + 一次数据更新（固件中采样定时器的完整路径）
+        BikeData bikeData;
+        bikeData.setSource(BikeData::SOURCE_KEISER);
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            KeiserSample s;
+            const AdvertRecord &rec = KEISER_CORPUS[(i & 1) ? 0 : 2];
+            KeiserParser::parseAdvertisement(rec.data, rec.len, s);
+            host::advanceMicros(50000);
+            bikeData.ingestKeiser(s);
+            doNotOptimize(bikeData.update()); });
+        report("parse + BikeData::ingestKeiser + update", ns, "advert");
+        return true;
+    }
+}
@@ -0,0 +1,165 @@
+#include "Bench.h"
+#include "LatencyStats.h"
+#include "NotifyPolicy.h"
+#include "RevolutionAccumulator.h"
+
+namespace bench
+{
+    // 转数事件到通知延迟的离散事件仿真，延迟从累加器给出的最后一整圈时刻算起：
+    // 旧版 loop() 每 50ms 轮询一次，在轮询时刻发现新的一圈并立即发送；
+    // 调度器只在采样周期的时刻发现新的一圈，再受该通道的最小通知间隔限制，
+    // 被限速时通知任务在到期时刻醒来发送。
+    // 任务切换与合并窗口（不超过一个连接间隔）未建模，板上数值见固件 [LAT] 输出（从采样时刻算起）。
+
+    static const uint32_t EVENTS = 200000;
+
+    // 轮速约 15km/h (周长 2m) 与踏频约 70rpm，每次采样转速在 ±5% 内随机变化
+    struct RideSource
+    {
+        RevolutionAccumulator wheel;
+        RevolutionAccumulator crank;
+        uint32_t rng = 12345;
+
+        float jitter(float rate)
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            return rate * (0.95f + (rng % 1000) * 0.0001f);
+        }
+
+        // 推进到 nowUs，返回本次新增整圈中最早的时刻；没有新的一圈时返回 -1
+        int64_t advance(int64_t nowUs)
+        {
+            int64_t first = -1;
+            if (wheel.advance(jitter(15.0f / 3.6f / 2.0f), (uint32_t)nowUs))
+                first = (int64_t)wheel.lastEventUs();
+            if (crank.advance(jitter(70.0f / 60.0f), (uint32_t)nowUs))
+            {
+                int64_t t = (int64_t)crank.lastEventUs();
+                if (first < 0 || t < first)
+                    first = t;
+            }
+            return first;
+        }
+    };
+
+    struct LatencyResult
+    {
+        LatencyStats stats;
+        double notifyPerSecond;
+    };
+
+    static void simulatePolling(int64_t periodUs, LatencyResult &result)
+    {
+        RideSource src;
+        int64_t now = 0;
+        src.advance(now);
+        while (result.stats.count() < EVENTS)
+        {
+            now += periodUs;
+            int64_t t = src.advance(now);
+            if (t >= 0)
+                result.stats.record((uint32_t)(now - t));
+        }
+        // 旧版每次轮询都发送
+        result.notifyPerSecond = 1e6 / periodUs;
+    }
+
+    // powerEveryTick：通道同时携带每次采样都在变化的功率（模拟数据与 CP/FTMS 通道的情形），
+    // 每个采样都有待发数据，转数只能随限速后的下一次发送送出
+    static void simulateScheduler(int64_t producerUs, uint32_t capUs, bool powerEveryTick, LatencyResult &result)
+    {
+        RideSource src;
+        NotifyPolicy policy;
+        policy.setMinInterval(0, capUs);
+        int64_t revPendingUs = -1; // 最早未送出的一圈
+        uint64_t sent = 0;
+        auto trySend = [&](int64_t now)
+        {
+            int64_t eventUs;
+            if (!policy.take(0, now, &eventUs))
+                return;
+            sent++;
+            if (revPendingUs >= 0)
+            {
+                result.stats.record((uint32_t)(now - revPendingUs));
+                revPendingUs = -1;
+            }
+        };
+
+        int64_t tick = 0;
+        src.advance(tick);
+        int64_t wakeUs = -1;
+        while (result.stats.count() < EVENTS)
+        {
+            tick += producerUs;
+            // 限速到期的唤醒先于本次采样
+            while (wakeUs >= 0 && wakeUs < tick)
+            {
+                trySend(wakeUs);
+                int64_t wait = policy.nextWakeUs(wakeUs);
+                wakeUs = wait >= 0 ? wakeUs + wait : -1;
+            }
+
+            int64_t t = src.advance(tick);
+            if (t >= 0 && revPendingUs < 0)
+                revPendingUs = t;
+            if (t < 0 && !powerEveryTick)
+                continue;
+            policy.markPending(0, tick);
+            trySend(tick);
+            int64_t wait = policy.nextWakeUs(tick);
+            wakeUs = wait >= 0 ? tick + wait : -1;
+        }
+        result.notifyPerSecond = sent * 1e6 / tick;
+    }
+
+    static void printStats(const char *name, const LatencyResult &result)
+    {
+        printf("[BENCH] %-40s p50=%5.1fms p99=%5.1fms max=%5.1fms  %4.1f 次通知/s\n", name,
+               result.stats.percentileUs(50) / 1000.0, result.stats.percentileUs(99) / 1000.0,
+               result.stats.maxUs() / 1000.0, result.notifyPerSecond);
+    }
+
+    bool runLatencyBench()
+    {
+        LatencyResult polling;
+        simulatePolling(50000, polling);
+        printStats("一圈->通知 旧版 50ms 轮询", polling);
+
+        LatencyResult oldDefault;
+        simulateScheduler(50000, 100000, false, oldDefault);
+        printStats("CSC 采样50 限速100 (原默认)", oldDefault);
+
+        LatencyResult sameTick;
+        simulateScheduler(50000, 50000, false, sameTick);
+        printStats("CSC 采样50 限速50", sameTick);
+
+        LatencyResult csc;
+        simulateScheduler(25000, 25000, false, csc);
+        printStats("CSC 采样25 限速25 (默认)", csc);
+
+        LatencyResult cp;
+        simulateScheduler(25000, 50000, true, cp);
+        printStats("CP 功率常变 采样25 限速50 (默认)", cp);
+
+        bool ok = csc.stats.percentileUs(99) < polling.stats.percentileUs(99) &&
+                  csc.stats.maxUs() < polling.stats.maxUs() &&
+                  cp.stats.maxUs() <= polling.stats.maxUs() + 1000 && cp.notifyPerSecond <= polling.notifyPerSecond * 1.01;
+        printf("[BENCH] %-40s %s\n", "默认配置的尾延迟不高于轮询", ok ? "OK" : "FAIL");
+
+        // 调度决策本身的开销
+        NotifyPolicy policy;
+        policy.setMinInterval(0, 25000);
+        double ns = measure(1000000, 5, [&](uint32_t i)
+                            {
+            int64_t now = (int64_t)i * 1000;
+            int64_t eventUs;
+            policy.markPending(0, now);
+            doNotOptimize(policy.take(0, now, &eventUs));
+            doNotOptimize(policy.nextWakeUs(now)); });
+        report("NotifyPolicy mark+take+nextWake", ns, "event");
+        return ok;
+    }
+}
@@ -0,0 +1,117 @@
+#include "Bench.h"
+// 按固件中 StatusLed.cpp 的包含顺序编译 StatusLed.h：Arduino.h 定义的宏（如 PI）在前
+#include <Arduino.h>
+#include "StatusLed.h"
+#include "BreathTable.h"
+#include "LedPattern.h"
+#include <math.h>
+
+namespace bench
+{
+    // 状态灯：编译期呼吸表与运行时 exp/sin 的一致性、各状态的图案，
+    // 以及查表与原先每次调用 exp(sin()) 的开销对比。
+
+    static bool checkBreathTable()
+    {
+        bool ok = true;
+        int maxError = 0;
+        for (size_t i = 0; i < breath::TABLE_SIZE; i++)
+        {
+            double expected = (exp(sin(2 * M_PI * i / breath::TABLE_SIZE)) - 1 / M_E) / (M_E - 1 / M_E);
+            int error = abs((int)breath::TABLE[i] - (int)lround(expected * 255.0));
+            if (error > maxError)
+                maxError = error;
+        }
+        if (maxError > 0)
+        {
+            printf("[BENCH] 呼吸表与 libm 最大偏差 %d LSB\n", maxError);
+            ok = false;
+        }
+
+        // 编译期 sin/exp 本身的精度
+        double worst = 0;
+        for (int i = -100; i <= 100; i++)
+        {
+            double x = i / 100.0;
+            worst = fmax(worst, fabs(breath::exp(x) - exp(x)));
+            worst = fmax(worst, fabs(breath::sin(x * 7) - sin(x * 7)));
+        }
+        if (worst > 1e-9)
+        {
+            printf("[BENCH] 编译期 sin/exp 误差 %.3g\n", worst);
+            ok = false;
+        }
+
+        printf("[BENCH] %-40s %u 项, 最大误差 %.1e %s\n", "编译期呼吸表检查",
+               (unsigned)breath::TABLE_SIZE, worst, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static bool checkPatterns()
+    {
+        bool ok = true;
+        LedPattern pattern;
+        const LedPattern::Config &config = pattern.getConfig();
+        const LedPattern::Color off = {0, 0, 0};
+
+        // 未连接：每秒前 500ms 红色，其余熄灭
+        LedPattern::Color on = pattern.render(LedPattern::STATE_ADVERTISING, 100);
+        ok &= on.r > 0 && on.g == 0 && on.b == 0;
+        ok &= pattern.render(LedPattern::STATE_ADVERTISING, config.blinkOnMs + 1) == off;
+        ok &= pattern.render(LedPattern::STATE_ADVERTISING, config.blinkPeriodMs + 1) == on;
+
+        // 呼吸：1/4 周期最亮（峰值亮度），3/4 周期熄灭
+        LedPattern::Color peak = pattern.render(LedPattern::STATE_STREAMING, config.breathPeriodMs / 4);
+        ok &= peak.r == peak.g && peak.g == peak.b && peak.r == (255 * (config.breathLevel + 1)) >> 8;
+        ok &= pattern.render(LedPattern::STATE_STREAMING, config.breathPeriodMs * 3 / 4) == off;
+        LedPattern::Color amber = pattern.render(LedPattern::STATE_WAITING_DATA, config.breathPeriodMs / 4);
+        ok &= amber.r > amber.g && amber.b == 0;
+
+        // 状态优先级：错误 > 未连接 > 有无数据
+        ok &= LedPattern::stateFor(true, true, true) == LedPattern::STATE_ERROR;
+        ok &= LedPattern::stateFor(false, true, false) == LedPattern::STATE_ADVERTISING;
+        ok &= LedPattern::stateFor(true, false, false) == LedPattern::STATE_WAITING_DATA;
+        ok &= LedPattern::stateFor(true, true, false) == LedPattern::STATE_STREAMING;
+
+        // 20ms 刷新一个呼吸周期内实际需要写 LED 的次数（颜色不变时跳过）
+        uint32_t writes = 0;
+        LedPattern::Color last = off;
+        for (uint32_t t = 0; t < config.breathPeriodMs; t += 20)
+        {
+            LedPattern::Color c = pattern.render(LedPattern::STATE_STREAMING, t);
+            if (c != last)
+                writes++;
+            last = c;
+        }
+
+        printf("[BENCH] %-40s 每周期写 LED %u/%u 次 %s\n", "状态灯图案检查",
+               (unsigned)writes, (unsigned)(config.breathPeriodMs / 20), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runLedBench()
+    {
+        bool ok = true;
+        ok &= checkBreathTable();
+        ok &= checkPatterns();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        LedPattern pattern;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            doNotOptimize(pattern.render(LedPattern::STATE_STREAMING, i * 7));
+            clobberMemory(); });
+        report("LedPattern::render (查表)", ns, "frame");
+
+        // 原 LightLoop 的呼吸曲线
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            float breath = (exp(sin((i * 7) / 3000.0 * M_PI)) - 0.3678) / 2.35;
+            doNotOptimize((uint8_t)(breath * 32));
+            clobberMemory(); });
+        report("exp(sin()) 呼吸曲线 (原实现)", ns, "frame");
+        return ok;
+    }
+}
@@ -0,0 +1,143 @@
+#include "Bench.h"
+#include "LinkPolicy.h"
+
+namespace bench
+{
+    // 链路策略：连接后的 PHY/数据长度请求、按踏频切换连接参数、中心设备拒绝时的重试上限，
+    // 以及 1M/2M PHY 下一次通知与一个连接事件的空口时间（按规范的包格式计算，非实测）。
+
+    // 中心设备：收到请求后按 grant 决定是否接受，接受时取请求的最大间隔
+    static size_t pollAndGrant(LinkPolicy &policy, uint32_t nowMs, bool grant)
+    {
+        LinkPolicy::Request requests[LinkPolicy::MAX_LINKS];
+        size_t count = policy.poll(nowMs, requests, LinkPolicy::MAX_LINKS);
+        for (size_t i = 0; grant && i < count; i++)
+        {
+            const LinkPolicy::ConnParams &p = requests[i].params;
+            policy.onParamsUpdated(requests[i].connHandle, p.maxInterval, p.latency, p.timeout);
+        }
+        return count;
+    }
+
+    static bool checkNegotiation()
+    {
+        bool ok = true;
+        LinkPolicy policy;
+        const LinkPolicy::Config &config = policy.getConfig();
+        const uint32_t t0 = 1000;
+        policy.begin(t0);
+
+        // 连接：立即请求 2M PHY 与数据长度，连接参数等服务发现之后
+        LinkPolicy::Request request;
+        ok &= policy.onConnect(t0, 0, 36, 0, 500, request);
+        ok &= request.actions == (LinkPolicy::ACTION_PHY | LinkPolicy::ACTION_DATA_LEN);
+        ok &= pollAndGrant(policy, t0 + config.paramsDelayMs - 1, true) == 0;
+        ok &= pollAndGrant(policy, t0 + config.paramsDelayMs, true) == 1;
+        ok &= policy.find(0)->interval == 24 && pollAndGrant(policy, t0 + 60000, true) == 0;
+        policy.onPhyUpdated(0, LinkPolicy::PHY_2M, LinkPolicy::PHY_2M);
+        policy.onMtuChanged(0, 247);
+        ok &= policy.find(0)->txPhy == LinkPolicy::PHY_2M && policy.find(0)->mtu == 247;
+
+        // 骑行中保持 ACTIVE；停止踏频 idleAfterMs 后改为长间隔，中心设备接受
+        uint32_t t = t0 + 2000;
+        ok &= !policy.update(t, true);
+        ok &= !policy.update(t + config.idleAfterMs - 1, false);
+        t += config.idleAfterMs;
+        ok &= policy.update(t, false) && policy.getActivity() == LinkPolicy::ACTIVITY_IDLE;
+        ok &= pollAndGrant(policy, t, true) == 1 && policy.find(0)->interval == 160 && policy.find(0)->latency == 4;
+
+        // 第二个中心设备在空闲中连接：回到 ACTIVE，已有连接立即请求短间隔，
+        // 该中心设备拒绝：按 retryMs 重试 maxAttempts 次后不再请求
+        t += 10000;
+        ok &= policy.onConnect(t, 1, 24, 0, 400, request);
+        ok &= policy.getActivity() == LinkPolicy::ACTIVITY_ACTIVE;
+        uint32_t requests = 0;
+        for (uint32_t ms = 0; ms <= 60000; ms += 100)
+            requests += pollAndGrant(policy, t + ms, false);
+        ok &= requests == config.maxAttempts && policy.find(1)->requests == 0;
+        ok &= policy.find(0)->interval == 160;
+
+        // 断开后表中只剩另一个连接；表满时拒绝跟踪
+        policy.onDisconnect(0);
+        ok &= policy.getLinkCount() == 1 && !policy.find(0) && policy.find(1);
+        for (uint16_t conn = 2; conn < 2 + LinkPolicy::MAX_LINKS; conn++)
+            ok &= policy.onConnect(t, conn, 24, 0, 400, request) == (conn < 1 + LinkPolicy::MAX_LINKS);
+        ok &= !policy.onConnect(t, 1, 24, 0, 400, request);
+
+        // idleAfterMs = 0：始终 ACTIVE（网关模式）
+        LinkPolicy::Config always;
+        always.idleAfterMs = 0;
+        LinkPolicy gateway(always);
+        gateway.begin(0);
+        ok &= !gateway.update(10 * 60000, false);
+
+        // 跨越 millis() 的 32 位回绕
+        LinkPolicy wrap;
+        wrap.begin(0xFFFFFE00u);
+        ok &= wrap.onConnect(0xFFFFFE00u, 7, 36, 0, 400, request);
+        ok &= pollAndGrant(wrap, 0xFFFFFE00u + config.paramsDelayMs - 1, true) == 0;
+        ok &= pollAndGrant(wrap, 0xFFFFFE00u + config.paramsDelayMs, true) == 1;
+
+        printf("[BENCH] %-40s %s\n", "链路协商检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 一次通知的空口时间与一个连接事件（中心设备空包 + T_IFS + 通知）的射频时间
+    static void reportAirTime()
+    {
+        const size_t T_IFS = 150;
+        const size_t sizes[3] = {8, 11, 20}; // CP 最小测量、CSC 测量、默认 MTU 下的最大通知
+        for (size_t len : sizes)
+        {
+            uint32_t us1M = LinkPolicy::notifyAirTimeUs(LinkPolicy::PHY_1M, len, 27);
+            uint32_t us2M = LinkPolicy::notifyAirTimeUs(LinkPolicy::PHY_2M, len, 251);
+            uint32_t event1M = LinkPolicy::airTimeUs(LinkPolicy::PHY_1M, 0) + T_IFS + us1M;
+            uint32_t event2M = LinkPolicy::airTimeUs(LinkPolicy::PHY_2M, 0) + T_IFS + us2M;
+            char label[40];
+            snprintf(label, sizeof(label), "通知空口时间 (%u 字节)", (unsigned)len);
+            printf("[BENCH] %-40s 1M %u us, 2M %u us; 连接事件 1M %u us, 2M %u us (%.0f%%)\n", label,
+                   (unsigned)us1M, (unsigned)us2M, (unsigned)event1M, (unsigned)event2M, 100.0 * event2M / event1M);
+        }
+
+        // DLE 只在单个通知超过 27 字节 LL 负载时减少分片；默认 MTU 下通知不超过 20 字节
+        uint32_t frag = LinkPolicy::notifyAirTimeUs(LinkPolicy::PHY_1M, 64, 27);
+        uint32_t dle = LinkPolicy::notifyAirTimeUs(LinkPolicy::PHY_1M, 64, 251);
+        printf("[BENCH] %-40s 不分片 %u us, 27 字节分片 %u us\n", "64 字节通知 1M (需 MTU >= 67)", (unsigned)dle,
+               (unsigned)frag);
+
+        // 空闲时中心设备无数据可收，从机按从机延迟跳过连接事件
+        LinkPolicy policy;
+        for (uint8_t i = 0; i < LinkPolicy::ACTIVITY_COUNT; i++)
+        {
+            const LinkPolicy::ConnParams &p = policy.getParams((LinkPolicy::Activity)i);
+            double eventsPerSecond = 1000.0 / (p.maxInterval * 1.25);
+            char label[40];
+            snprintf(label, sizeof(label), "链路 %s", LinkPolicy::activityName((LinkPolicy::Activity)i));
+            printf("[BENCH] %-40s 间隔 %.2f-%.2f ms, 连接事件 %.1f 次/s, 无数据时唤醒 %.1f 次/s\n", label,
+                   p.minInterval * 1.25, p.maxInterval * 1.25, eventsPerSecond, eventsPerSecond / (1 + p.latency));
+        }
+    }
+
+    bool runLinkBench()
+    {
+        bool ok = true;
+        ok &= checkNegotiation();
+        reportAirTime();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+        LinkPolicy policy;
+        policy.begin(0);
+        LinkPolicy::Request request;
+        for (uint16_t conn = 0; conn < 3; conn++)
+            policy.onConnect(0, conn, 24, 0, 400, request);
+        uint32_t nowMs = 0;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            nowMs += 100;
+            policy.update(nowMs, (i & 0xFFFF) < 0x4000);
+            doNotOptimize(pollAndGrant(policy, nowMs, (i & 1) == 0)); });
+        report("LinkPolicy::update+poll (3 连接)", ns, "poll");
+        return ok;
+    }
+}
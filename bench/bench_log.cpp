@@ -0,0 +1,196 @@
+#include "Bench.h"
+#include "Log.h"
+#include "LogDecoder.h"
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    // 二进制日志：记录 → 帧 → 解码的往返检查、中途接入解码器的恢复，
+    // 以及热路径入队开销与 snprintf 格式化的对比。
+
+    struct Collector
+    {
+        std::vector<std::string> lines;
+        static void onLine(void *ctx, const std::string &line)
+        {
+            static_cast<Collector *>(ctx)->lines.push_back(line);
+        }
+    };
+
+    // 取出队列中的全部记录编码成帧
+    static void drainTo(logging::FrameEncoder &encoder, std::vector<uint8_t> &out)
+    {
+        static uint8_t buf[logging::FrameEncoder::MAX_OUTPUT];
+        logging::Record r;
+        while (logging::ring().pop(r))
+        {
+            size_t n = encoder.encode(r, buf);
+            out.insert(out.end(), buf, buf + n);
+        }
+    }
+
+    // 解码行形如 "[   0.001234] I 正文"，只比较正文
+    static bool bodyEquals(const std::string &line, char level, const char *expected)
+    {
+        size_t pos = line.find("] ");
+        if (pos == std::string::npos || line.size() < pos + 4)
+            return false;
+        return line[pos + 2] == level && line.compare(pos + 4, std::string::npos, expected) == 0;
+    }
+
+    static bool checkRoundTrip()
+    {
+        bool ok = true;
+        logging::FrameEncoder encoder;
+        std::vector<uint8_t> stream;
+        // 丢弃之前各套件中服务类写入的日志
+        drainTo(encoder, stream);
+        stream.clear();
+        encoder.newEpoch();
+        char expected[8][128];
+        size_t cases = 0;
+
+#define LOG_CASE(level, letter, fmt, ...)                                        \
+    do                                                                           \
+    {                                                                            \
+        LOG_AT(level, fmt, ##__VA_ARGS__);                                       \
+        snprintf(expected[cases], sizeof(expected[cases]), fmt, ##__VA_ARGS__); \
+        levels[cases++] = letter;                                                \
+    } while (0)
+
+        char levels[8];
+        LOG_CASE(logfmt::LEVEL_INFO, 'I', "[INIT] 初始化完成");
+        LOG_CASE(logfmt::LEVEL_ERROR, 'E', "[ERROR] BLE设置失败: %s", "bad state");
+        LOG_CASE(logfmt::LEVEL_INFO, 'I', "[LAT] %s n=%u p50=%uus p99=%uus", "CSC", 1234u, 850u, 4100u);
+        LOG_CASE(logfmt::LEVEL_DEBUG, 'D', "[BLE] reason=0x%02X delta=%d", 0x13, -42);
+        LOG_CASE(logfmt::LEVEL_WARN, 'W', "[CP] speed=%.2f ratio=%5.1f%%", 32.25f, 84.9);
+        LOG_CASE(logfmt::LEVEL_INFO, 'I', "[MEM] %s: free=%lu big=%llu", "heap", 123456ul, 9876543210ull);
+#undef LOG_CASE
+        drainTo(encoder, stream);
+
+        // 文本与帧交错：帧之外的字节按行原样输出
+        static const char TEXT[] = "[TRACE] BEGIN blocks=1\n";
+        std::vector<uint8_t> mixed(TEXT, TEXT + strlen(TEXT));
+        mixed.insert(mixed.end(), stream.begin(), stream.end());
+
+        Collector collector;
+        LogDecoder decoder(Collector::onLine, &collector);
+        decoder.feed(mixed.data(), mixed.size());
+        decoder.finish();
+
+        if (collector.lines.size() != cases + 1 || collector.lines[0] != "[TRACE] BEGIN blocks=1")
+        {
+            printf("[BENCH] 日志解码行数不一致: %u\n", (unsigned)collector.lines.size());
+            ok = false;
+        }
+        for (size_t i = 0; ok && i < cases; i++)
+        {
+            if (!bodyEquals(collector.lines[i + 1], levels[i], expected[i]))
+            {
+                printf("[BENCH] 日志解码不一致: %s | %s\n", collector.lines[i + 1].c_str(), expected[i]);
+                ok = false;
+            }
+        }
+
+        // 超出参数区的记录标记截断而不是写出半个参数
+        LOG_AT(logfmt::LEVEL_INFO, "%s %s %s", "aaaaaaaaaaaaaaaaaaaaaaaa", "bbbbbbbbbbbbbbbbbbbbbbbb", "c");
+        std::vector<uint8_t> truncated;
+        drainTo(encoder, truncated);
+        Collector tail;
+        LogDecoder tailDecoder(Collector::onLine, &tail);
+        tailDecoder.feed(truncated.data(), truncated.size());
+        if (tail.lines.size() != 1 || tail.lines[0].find("<参数截断>") == std::string::npos)
+        {
+            printf("[BENCH] 日志截断标记缺失\n");
+            ok = false;
+        }
+
+        // 去帧后只剩文本，追踪导出的解析不受日志帧影响
+        std::vector<uint8_t> text = LogDecoder::stripFrames(mixed.data(), mixed.size());
+        if (std::string(text.begin(), text.end()) != TEXT)
+        {
+            printf("[BENCH] stripFrames 输出不一致\n");
+            ok = false;
+        }
+
+        printf("[BENCH] %-40s %u 例 %s\n", "日志帧往返检查", (unsigned)cases + 2, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 解码器在格式定义帧之后接入：新周期重发定义后恢复
+    static bool checkMidStreamJoin()
+    {
+        logging::FrameEncoder encoder;
+        std::vector<uint8_t> first;
+        std::vector<uint8_t> second;
+        std::vector<uint8_t> third;
+
+        LOG_AT(logfmt::LEVEL_INFO, "[RING] samples=%u", 1u);
+        drainTo(encoder, first);
+        LOG_AT(logfmt::LEVEL_INFO, "[RING] samples=%u", 2u);
+        drainTo(encoder, second);
+        encoder.newEpoch();
+        LOG_AT(logfmt::LEVEL_INFO, "[RING] samples=%u", 3u);
+        drainTo(encoder, third);
+
+        Collector collector;
+        LogDecoder decoder(Collector::onLine, &collector);
+        decoder.feed(second.data(), second.size());
+        decoder.feed(third.data(), third.size());
+
+        bool ok = collector.lines.size() == 2 && decoder.getUnknownFormats() == 1 &&
+                  bodyEquals(collector.lines[1], 'I', "[RING] samples=3");
+        printf("[BENCH] %-40s 首帧 %u B, 后续 %u B %s\n", "中途接入解码 (新周期恢复)",
+               (unsigned)first.size(), (unsigned)second.size(), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runLogBench()
+    {
+        bool ok = true;
+        ok &= checkRoundTrip();
+        ok &= checkMidStreamJoin();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+        logging::Record r;
+
+        // 热路径：入队（格式化推迟到输出任务）与直接格式化的对比
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            LOG_AT(logfmt::LEVEL_VERBOSE, "[CSC] 数据更新成功: flags=0x%02X wheel=%u time=%u crank=%u time=%u",
+                   0x03, i, i & 0xFFFF, i >> 2, (i * 3) & 0xFFFF);
+            logging::ring().pop(r);
+            clobberMemory(); });
+        report("LOG_VERBOSE 入队+出队 (5 个参数)", ns, "log");
+
+        char line[128];
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            int n = snprintf(line, sizeof(line), "[CSC] 数据更新成功: flags=0x%02X wheel=%u time=%u crank=%u time=%u",
+                             0x03, i, i & 0xFFFF, i >> 2, (i * 3) & 0xFFFF);
+            doNotOptimize(n);
+            clobberMemory(); });
+        report("snprintf (同一条日志)", ns, "log");
+
+        logging::FrameEncoder encoder;
+        uint8_t out[logging::FrameEncoder::MAX_OUTPUT];
+        size_t frameBytes = 0;
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            LOG_AT(logfmt::LEVEL_VERBOSE, "[CSC] 数据更新成功: flags=0x%02X wheel=%u time=%u crank=%u time=%u",
+                   0x03, i, i & 0xFFFF, i >> 2, (i * 3) & 0xFFFF);
+            logging::ring().pop(r);
+            frameBytes = encoder.encode(r, out);
+            doNotOptimize(frameBytes);
+            clobberMemory(); });
+        report("FrameEncoder::encode (含入队)", ns, "log");
+
+        int textBytes = snprintf(line, sizeof(line), "[CSC] 数据更新成功: flags=0x%02X wheel=%u time=%u crank=%u time=%u\r\n",
+                                 0x03, 123456u, 40000u, 30864u, 20000u);
+        printf("[BENCH] %-40s 帧 %u B, 文本 %d B\n", "每条日志串口字节", (unsigned)frameBytes, textBytes);
+        return ok;
+    }
+}
@@ -0,0 +1,290 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "BLEConfig.h"
+#include "BatteryService.h"
+#include "BikeSelectService.h"
+#include "CPService.h"
+#include "CSCService.h"
+#include "DeviceInfoService.h"
+#include "FTMSService.h"
+#include "LoopbackGatt.h"
+#include <string.h>
+
+namespace bench
+{
+    // 回环 GATT 后端：调用记录、订阅、发送缓冲满、连接事件丢失等行为检查，
+    // 多个中心设备时负载只编码、拷贝一次并只扇出到订阅的连接，网关启动后单车选择特征值可被发现，
+    // 以及 1..32 个订阅者时一次 notify 与一次完整测量更新的开销。
+
+    static bool checkDelivery()
+    {
+        bool ok = true;
+        host::setMicros(1000000);
+        host::LoopbackServer server;
+        CSCService csc(&server);
+        ok &= csc.getStatus().ok();
+        csc.getCoalescer().setWindow(0);
+        csc.getCoalescer().setKeepAlive(0);
+
+        host::LoopbackServer::ClientConfig config;
+        config.connIntervalUs = 30000;
+        config.packetsPerEvent = 2;
+        config.txQueueSize = 3;
+        uint16_t a = server.connect(config);
+        config.subscribeAll = false;
+        uint16_t b = server.connect(config);
+
+        auto *ch = server.findCharacteristic(CSC_MEASUREMENT_UUID);
+        ok &= ch != nullptr && server.getClientCount() == 2;
+        if (!ch)
+            return false;
+        server.setRecording(true);
+
+        // 5 包进入容量 3 的缓冲：后 2 包被拒绝
+        for (uint16_t i = 1; i <= 5; i++)
+            csc.updateMeasurement(i, i, i, i);
+        ok &= server.getQueueDepth(a) == 3 && server.getStats(a).dropped == 2;
+        ok &= server.getQueueDepth(b) == 0; // 未订阅
+        ok &= server.getCallCount(host::LoopbackServer::CALL_NOTIFY) == 5;
+        ok &= server.getCalls().size() == 10; // setValue + notify 各 5 次
+
+        // 第一个连接事件送达 2 包，第二个送达剩余 1 包；最后一包是第 3 次更新
+        server.advance(1000000);
+        ok &= server.getStats(a).delivered == 2 && server.getQueueDepth(a) == 1;
+        server.advance(1030000);
+        ok &= server.getStats(a).delivered == 3 && server.getQueueDepth(a) == 0;
+        auto expected = encoder::CscWheelCrank::encode(3, 3, 3, 3);
+        const std::vector<uint8_t> &last = server.getLastPayload(a, ch);
+        ok &= last.size() == expected.size() && memcmp(last.data(), expected.data(), last.size()) == 0;
+        ok &= server.getStats(a).maxLatencyUs == 30000;
+        ok &= server.getDeliveredCount(b, ch) == 0;
+
+        // 订阅后第二个连接也收到；指定连接的 notify 只进入该连接
+        server.subscribe(b, CSC_MEASUREMENT_UUID, true);
+        csc.updateMeasurement(9, 9, 9, 9);
+        ok &= server.getQueueDepth(a) == 1 && server.getQueueDepth(b) == 1;
+        ok &= ch->notify(ch->getData(), ch->getLength(), b);
+        ok &= server.getQueueDepth(a) == 1 && server.getQueueDepth(b) == 2;
+        return ok;
+    }
+
+    static bool checkMissedEvents()
+    {
+        bool ok = true;
+        host::setMicros(0);
+        host::LoopbackServer server(7);
+        FTMSService ftms(&server);
+        ftms.getCoalescer().setWindow(0);
+
+        host::LoopbackServer::ClientConfig config;
+        config.connIntervalUs = 10000;
+        config.packetsPerEvent = 2;
+        config.txQueueSize = 1000;
+        config.missPermille = 250;
+        uint16_t conn = server.connect(config);
+
+        // 每个连接间隔一包：丢失的连接事件使缓冲积压，之后的事件补发，总量不变
+        const uint32_t PACKETS = 4000;
+        for (uint32_t i = 0; i < PACKETS; i++)
+        {
+            host::setMicros((int64_t)i * 10000 + 1);
+            ftms.updateMeasurement(20.0f + (i & 1), 80, 150);
+            server.advance((int64_t)i * 10000 + 5000);
+        }
+        server.advance((int64_t)PACKETS * 20000);
+
+        const host::LoopbackServer::ClientStats &s = server.getStats(conn);
+        double missRate = (double)s.missedEvents / s.events;
+        ok &= s.queued == PACKETS && s.delivered == PACKETS && s.dropped == 0;
+        ok &= missRate > 0.22 && missRate < 0.28;
+        ok &= s.maxDepth > 1;
+
+        printf("[BENCH] %-40s 丢失 %.1f%%, 最大缓冲 %u, 最大延迟 %.0f ms %s\n", "回环连接事件丢失检查",
+               missRate * 100, (unsigned)s.maxDepth, s.maxLatencyUs / 1000.0, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 8 个连接中 3 个订阅：一次更新只编码一次、只有一份负载，只进入订阅连接的缓冲；
+    // 断开仍有积压的连接会释放它持有的引用
+    static bool checkFanout()
+    {
+        bool ok = true;
+        host::setMicros(1000000);
+        host::LoopbackServer server;
+        CSCService csc(&server);
+        csc.getCoalescer().setWindow(0);
+        host::LoopbackServer::ClientConfig config;
+        config.subscribeAll = false;
+        uint16_t conns[8];
+        for (uint16_t &conn : conns)
+            conn = server.connect(config);
+        const uint16_t subscribed[3] = {conns[1], conns[4], conns[6]};
+        for (uint16_t conn : subscribed)
+            server.subscribe(conn, CSC_MEASUREMENT_UUID, true);
+        gatt::Characteristic *ch = csc.getMeasurementChar();
+        ok &= ch->getSubscriberCount() == 3;
+
+        uint64_t setValues = server.getCallCount(host::LoopbackServer::CALL_SET_VALUE);
+        uint64_t notifies = server.getCallCount(host::LoopbackServer::CALL_NOTIFY);
+        csc.updateMeasurement(1, 1024, 1, 1024);
+        ok &= server.getCallCount(host::LoopbackServer::CALL_SET_VALUE) == setValues + 1;
+        ok &= server.getCallCount(host::LoopbackServer::CALL_NOTIFY) == notifies + 1;
+        ok &= server.getPayloadsInFlight() == 1;
+        for (uint16_t conn : conns)
+        {
+            bool isSubscribed = conn == subscribed[0] || conn == subscribed[1] || conn == subscribed[2];
+            ok &= server.getQueueDepth(conn) == (isSubscribed ? 1u : 0u);
+        }
+
+        // 指定连接发送要求该连接已订阅
+        ok &= !ch->notify(ch->getData(), ch->getLength(), conns[0]);
+        ok &= ch->notify(ch->getData(), ch->getLength(), conns[4]);
+        ok &= server.getPayloadsInFlight() == 2;
+
+        server.disconnect(conns[4]);
+        ok &= ch->getSubscriberCount() == 2 && !server.isConnected(conns[4]);
+        csc.updateMeasurement(2, 2048, 2, 2048);
+        ok &= server.getQueueDepth(conns[1]) == 2 && server.getQueueDepth(conns[6]) == 2;
+        server.advance(1100000);
+        ok &= server.getPayloadsInFlight() == 0;
+        ok &= server.getDeliveredCount(conns[1], server.findCharacteristic(CSC_MEASUREMENT_UUID)) == 2;
+        ok &= server.getDeliveredCount(conns[4], server.findCharacteristic(CSC_MEASUREMENT_UUID)) == 0;
+
+        printf("[BENCH] %-40s %s\n", "多中心设备扇出检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static void onSelectWrite(void *ctx, uint16_t connHandle, const uint8_t *data, size_t len)
+    {
+        if (len >= 1)
+            *static_cast<uint8_t *>(ctx) = data[0];
+    }
+
+    // 网关模式按 setupBLE() 的顺序启动：全部服务（含单车选择）创建后才开始广播，
+    // 网关随后只接管写入；首个连接的中心设备即可发现并写入单车选择特征值。
+    // 对照：广播后才创建的服务在 GATT 重置前不可发现
+    static bool checkGatewayBoot()
+    {
+        bool ok = true;
+        host::setMicros(1000000);
+        host::LoopbackServer server;
+        BatteryService battery(&server);
+        CSCService csc(&server);
+        CPService cp(&server);
+        FTMSService ftms(&server);
+        DeviceInfoService deviceInfo(&server);
+        BikeSelectService select(&server);
+        ok &= battery.getStatus().ok() && csc.getStatus().ok() && cp.getStatus().ok() && ftms.getStatus().ok() &&
+              deviceInfo.getStatus().ok() && select.getStatus().ok();
+        server.startAdvertising();
+
+        uint8_t selected = 0;
+        select.setWriteHandler(onSelectWrite, &selected);
+        uint16_t conn = server.connect(host::LoopbackServer::ClientConfig());
+        host::LoopbackCharacteristic *ch = server.discover(GATEWAY_BIKE_SELECT_UUID);
+        ok &= ch != nullptr && server.discover(CSC_MEASUREMENT_UUID) != nullptr;
+        if (ch)
+        {
+            const uint8_t bike = 7;
+            ch->write(conn, &bike, 1);
+            ok &= selected == 7 && ch->getLength() == 1;
+        }
+
+        host::LoopbackServer late;
+        CSCService lateCsc(&late);
+        late.startAdvertising();
+        BikeSelectService lateSelect(&late);
+        ok &= late.discover(GATEWAY_BIKE_SELECT_UUID) == nullptr && late.findCharacteristic(GATEWAY_BIKE_SELECT_UUID);
+
+        printf("[BENCH] %-40s 注册特征值 %u %s\n", "网关启动后单车选择可发现",
+               (unsigned)server.getRegisteredCount(), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 订阅者数量下的开销：connections 个连接中前 subscribers 个订阅 CSC 测量
+    struct FanoutCost
+    {
+        double notifyNs;
+        double updateNs;
+    };
+
+    static FanoutCost measureFanout(uint32_t connections, uint32_t subscribers)
+    {
+        const uint32_t ITERATIONS = 200000;
+        const uint32_t ROUNDS = 5;
+        host::setMicros(0);
+        host::LoopbackServer server;
+        CSCService csc(&server);
+        csc.getCoalescer().setWindow(0);
+        host::LoopbackServer::ClientConfig config;
+        config.packetsPerEvent = 32;
+        config.txQueueSize = 64;
+        config.subscribeAll = false;
+        for (uint32_t i = 0; i < connections; i++)
+        {
+            uint16_t conn = server.connect(config);
+            if (i < subscribers)
+                server.subscribe(conn, CSC_MEASUREMENT_UUID, true);
+        }
+        gatt::Characteristic *ch = csc.getMeasurementChar();
+
+        // 每 32 次通知推进一个连接事件，缓冲不会满
+        FanoutCost cost;
+        int64_t nowUs = 0;
+        cost.notifyNs = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                                {
+            doNotOptimize(ch->notify());
+            if ((i & 31) == 31)
+            {
+                nowUs += 30000;
+                host::setMicros(nowUs);
+                server.advance(nowUs);
+            } });
+
+        // 完整路径：编码、写入特征值、合并与扇出（每次数值都变化）
+        uint32_t rev = 0;
+        cost.updateNs = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                                {
+            rev++;
+            doNotOptimize(csc.updateMeasurement(rev, (uint16_t)(rev * 1024), (uint16_t)rev, (uint16_t)(rev * 1024)));
+            if ((i & 31) == 31)
+            {
+                nowUs += 30000;
+                host::setMicros(nowUs);
+                server.advance(nowUs);
+            } });
+        return cost;
+    }
+
+    bool runLoopbackBench()
+    {
+        bool ok = checkDelivery();
+        printf("[BENCH] %-40s %s\n", "回环 GATT 送达与缓冲检查", ok ? "OK" : "FAIL");
+        ok &= checkMissedEvents();
+        ok &= checkFanout();
+        ok &= checkGatewayBoot();
+
+        char name[64];
+        FanoutCost one = {0, 0};
+        FanoutCost cost = {0, 0};
+        for (uint32_t clients = 1; clients <= 32; clients *= 2)
+        {
+            cost = measureFanout(clients, clients);
+            if (clients == 1)
+                one = cost;
+            snprintf(name, sizeof(name), "回环 notify (%u 订阅者)", (unsigned)clients);
+            report(name, cost.notifyNs, "notify");
+            snprintf(name, sizeof(name), "CSC 测量更新 (%u 订阅者)", (unsigned)clients);
+            report(name, cost.updateNs, "update");
+        }
+        printf("[BENCH] %-40s notify %.1fx, 测量更新 %.1fx (订阅者 32x)\n", "32/1 订阅者开销比",
+               cost.notifyNs / one.notifyNs, cost.updateNs / one.updateNs);
+
+        // 已连接但未订阅的中心设备不增加开销
+        FanoutCost sparse = measureFanout(32, 4);
+        FanoutCost dense = measureFanout(4, 4);
+        report("回环 notify (32 连接, 4 订阅者)", sparse.notifyNs, "notify");
+        report("回环 notify (4 连接, 4 订阅者)", dense.notifyNs, "notify");
+        return ok;
+    }
+}
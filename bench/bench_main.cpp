@@ -0,0 +1,29 @@
+#include "Bench.h"
+
+int main()
+{
+    printf("[BENCH] 主机端基准测试开始\n");
+    bool ok = true;
+    ok &= bench::runStatusBench();
+    ok &= bench::runBikeDataBench();
+    ok &= bench::runFilterBench();
+    ok &= bench::runScenarioBench();
+    ok &= bench::runEncoderBench();
+    ok &= bench::runLatencyBench();
+    ok &= bench::runHandoffBench();
+    ok &= bench::runCoalesceBench();
+    ok &= bench::runCpBench();
+    ok &= bench::runFtmsBench();
+    ok &= bench::runKeiserBench();
+    ok &= bench::runGatewayBench();
+    ok &= bench::runLoopbackBench();
+    ok &= bench::runLogBench();
+    ok &= bench::runLedBench();
+    ok &= bench::runPowerBench();
+    ok &= bench::runLinkBench();
+    ok &= bench::runBatteryBench();
+    ok &= bench::runPulseBench();
+    // 任一检查失败时以非零状态退出，供 CI 判定
+    printf("[BENCH] 完成 %s\n", ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
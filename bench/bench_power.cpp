@@ -0,0 +1,178 @@
+#include "Bench.h"
+#include "BikeData.h"
+#include "PowerPolicy.h"
+#include "Scenario.h"
+
+namespace bench
+{
+    // 电源策略：状态切换规则、连接与踏频恢复的唤醒延迟（按各状态的采样周期步进的脚本骑行），
+    // 以及各状态下周期性唤醒次数与扫描占空比。电流需要在硬件上测量，这里只统计决定电流的量。
+
+    static bool checkTransitions()
+    {
+        bool ok = true;
+        PowerPolicy policy;
+        const uint32_t idleAfter = policy.getConfig().idleAfterMs;
+        policy.begin(1000);
+        ok &= policy.getState() == PowerPolicy::STATE_ADVERTISING;
+        // 连接与广播时不降频：延迟基准与板上 [LAT] 数值都是在 240 MHz 下得到的
+        for (PowerPolicy::State s : {PowerPolicy::STATE_CONNECTED, PowerPolicy::STATE_ADVERTISING})
+            ok &= policy.getProfile(s).cpuMinMHz == 240 && policy.getProfile(s).cpuMaxMHz == 240;
+
+        // 无连接、无踏频：恰好在 idleAfterMs 时进入空闲
+        ok &= !policy.update(1000 + idleAfter - 1, false, false);
+        ok &= policy.update(1000 + idleAfter, false, false) && policy.getState() == PowerPolicy::STATE_IDLE;
+        ok &= policy.getProfile().lightSleep && policy.getProfile().cpuMinMHz < policy.getProfile().cpuMaxMHz;
+
+        // 空闲中连接：同一次 update 回到全速
+        uint32_t t = 1000 + idleAfter + 5000;
+        ok &= policy.update(t, true, false) && policy.getState() == PowerPolicy::STATE_CONNECTED;
+        ok &= !policy.getProfile().lightSleep && policy.getProfile().cpuMinMHz == policy.getProfile().cpuMaxMHz;
+        ok &= !policy.update(t + idleAfter * 3, true, false);
+
+        // 断开后重新计时快速广播；骑行中不进入空闲
+        t += idleAfter * 3;
+        ok &= policy.update(t, false, false) && policy.getState() == PowerPolicy::STATE_ADVERTISING;
+        ok &= !policy.update(t + idleAfter * 2, false, true);
+        t += idleAfter * 2;
+        ok &= !policy.update(t + idleAfter - 1, false, false);
+        ok &= policy.update(t + idleAfter, false, false) && policy.getState() == PowerPolicy::STATE_IDLE;
+
+        // 空闲中踏频恢复：立即快速广播
+        t += idleAfter + 60000;
+        ok &= policy.update(t, false, true) && policy.getState() == PowerPolicy::STATE_ADVERTISING;
+
+        ok &= policy.getTransitionCount() == 5;
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < PowerPolicy::STATE_COUNT; i++)
+            total += policy.getTimeInState((PowerPolicy::State)i, t);
+        ok &= total == t - 1000;
+
+        // 跨越 millis() 的 32 位回绕
+        policy.begin(0xFFFFF000u);
+        ok &= !policy.update(0xFFFFF000u + idleAfter - 1, false, false);
+        ok &= policy.update(0xFFFFF000u + idleAfter, false, false);
+
+        printf("[BENCH] %-40s %s\n", "电源状态切换检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 脚本骑行：停车（其间中心设备连接）、骑行、断开、长时间停车、再骑行。
+    // 采样按当前状态的采样周期步进，与固件中采样任务在各状态下的节奏一致；连接回调在其本身的时刻处理。
+    static bool checkRide()
+    {
+        bool ok = true;
+        Scenario scenario;
+        ok &= scenario.parse("stop 2m\n"
+                             "ramp 30s 28kmh 85rpm 180w\n"
+                             "hold 20m\n"
+                             "coast 20s\n"
+                             "stop 10m\n"
+                             "ramp 10s 25kmh 80rpm 150w\n"
+                             "hold 5m\n");
+        BikeData bikeData;
+        bikeData.setScenario(&scenario);
+        PowerPolicy policy;
+        const uint64_t startUs = 1000000;
+        const uint64_t edgeUs[2] = {
+            startUs + 61300000ULL,               // 空闲中连接（不与采样时刻对齐）
+            startUs + 20 * 60000000ULL + 700000, // 骑行结束前断开
+        };
+        policy.begin((uint32_t)(startUs / 1000));
+
+        uint64_t nowUs = startUs;
+        const uint64_t endUs = startUs + scenario.getDurationUs();
+        size_t nextEdge = 0;
+        bool connected = false;
+        bool lastRiding = false;
+        uint64_t resumeUs = 0;
+        uint32_t worstRideWakeMs = 0;
+        uint32_t connectMisses = 0;
+        uint32_t ridingWakes = 0;
+        uint64_t samples = 0;
+        while (nowUs < endUs)
+        {
+            if (nextEdge < 2 && edgeUs[nextEdge] <= nowUs)
+            {
+                connected = nextEdge == 0;
+                policy.update((uint32_t)(edgeUs[nextEdge] / 1000), connected, lastRiding);
+                if (connected != (policy.getState() == PowerPolicy::STATE_CONNECTED))
+                    connectMisses++;
+                nextEdge++;
+                continue;
+            }
+
+            bikeData.update(nowUs);
+            bool riding = bikeData.getData().cadence > 0;
+            if (riding && !lastRiding && policy.getState() == PowerPolicy::STATE_IDLE)
+                resumeUs = nowUs;
+            lastRiding = riding;
+            const uint32_t period = policy.getProfile().samplePeriodMs;
+            policy.update((uint32_t)(nowUs / 1000), connected, riding);
+            if (resumeUs && policy.getState() != PowerPolicy::STATE_IDLE)
+            {
+                // 最坏情况下踏频在前一次采样之后立即恢复
+                uint32_t ms = (uint32_t)((nowUs - resumeUs) / 1000) + period;
+                if (ms > worstRideWakeMs)
+                    worstRideWakeMs = ms;
+                ridingWakes++;
+                resumeUs = 0;
+            }
+            samples++;
+            nowUs += (uint64_t)policy.getProfile().samplePeriodMs * 1000;
+        }
+
+        uint32_t endMs = (uint32_t)(nowUs / 1000);
+        uint32_t idleMs = policy.getTimeInState(PowerPolicy::STATE_IDLE, endMs);
+        uint32_t connectedMs = policy.getTimeInState(PowerPolicy::STATE_CONNECTED, endMs);
+        // 空闲两段：开始停车到连接、断开并停止踏频 30 秒后到再次骑行；第二段由踏频唤醒
+        ok &= ridingWakes == 1 && connectMisses == 0;
+        ok &= connectedMs == (uint32_t)((edgeUs[1] - edgeUs[0]) / 1000);
+        ok &= idleMs > 10 * 60000 && idleMs < 11 * 60000;
+        ok &= worstRideWakeMs <= policy.getProfile(PowerPolicy::STATE_IDLE).samplePeriodMs;
+
+        printf("[BENCH] %-40s 空闲 %.1f min, 连接 %.1f min, 采样 %llu 次 (全速 %llu), 踏频唤醒 <= %u ms %s\n",
+               "脚本骑行电源状态检查", idleMs / 60000.0, connectedMs / 60000.0, (unsigned long long)samples,
+               (unsigned long long)(scenario.getDurationUs() / 1000 /
+                                    policy.getProfile(PowerPolicy::STATE_CONNECTED).samplePeriodMs),
+               (unsigned)worstRideWakeMs, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 各状态的周期唤醒：采样、主循环、电源任务与状态灯，加上每个广播事件
+    static void reportProfiles()
+    {
+        PowerPolicy policy;
+        for (uint8_t i = 0; i < PowerPolicy::STATE_COUNT; i++)
+        {
+            const PowerPolicy::Profile &p = policy.getProfile((PowerPolicy::State)i);
+            double advHz = i == PowerPolicy::STATE_CONNECTED ? 0.0 : 1000.0 / (p.advMinUnits * 0.625);
+            double wakeups = 1000.0 / p.samplePeriodMs + 2 * 1000.0 / p.pollPeriodMs + 1000.0 / p.ledPeriodMs + advHz;
+            char label[40];
+            snprintf(label, sizeof(label), "电源状态 %s", PowerPolicy::stateName((PowerPolicy::State)i));
+            printf("[BENCH] %-40s CPU %u-%u MHz, 浅睡眠 %s, 唤醒 %.1f 次/s, 广播 %.1f ms, 扫描占空比 %.0f%%\n",
+                   label, (unsigned)p.cpuMinMHz, (unsigned)p.cpuMaxMHz,
+                   p.lightSleep ? "开" : "关", wakeups, p.advMinUnits * 0.625, 100.0 * p.scanWindowMs / p.scanIntervalMs);
+        }
+    }
+
+    bool runPowerBench()
+    {
+        bool ok = true;
+        ok &= checkTransitions();
+        ok &= checkRide();
+        reportProfiles();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+        PowerPolicy policy;
+        policy.begin(0);
+        uint32_t nowMs = 0;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            nowMs += 50;
+            doNotOptimize(policy.update(nowMs, (i & 0xFFFF) < 0x4000, (i & 0x3FFF) < 0x100)); });
+        report("PowerPolicy::update", ns, "update");
+        return ok;
+    }
+}
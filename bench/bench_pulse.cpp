@@ -0,0 +1,275 @@
+#include "Bench.h"
+#include <math.h>
+#include "BikeData.h"
+#include "PulseInput.h"
+#include "Prng.h"
+#include "Scenario.h"
+
+namespace bench
+{
+    // 有线传感器：合成的脉冲序列经 PulseSource（去抖 + 无锁队列）进入 BikeData，与固件中断走同一条路径。
+    // 检查闭合与释放两处的触点弹跳被滤除、转数与事件时间与脉冲时刻一致（含 32 位微秒与 16 位事件时间回绕），
+    // 并对比中心设备按 CSC 事件时间算出的踏频：中断时间戳 vs 在 50 ms 采样中轮询得到的时间。
+
+    static const uint64_t TICK_US = 50000;
+
+    // 中心设备按 CSC 规范由相邻两次测量算出的踏频 (rpm)
+    struct CentralCadence
+    {
+        bool started = false;
+        uint16_t rev = 0;
+        uint16_t time = 0;
+
+        bool update(uint16_t crankRev, uint16_t eventTime, float &rpm)
+        {
+            bool valid = started && crankRev != rev && eventTime != time;
+            if (valid)
+                rpm = (uint16_t)(crankRev - rev) * 1024.0f * 60.0f / (uint16_t)(eventTime - time);
+            started = true;
+            rev = crankRev;
+            time = eventTime;
+            return valid;
+        }
+    };
+
+    // 一次完整的脉冲：磁铁到来时闭合，holdUs 后磁铁离开时释放，没有弹跳
+    static uint32_t capturePulse(PulseSource &pulses, PulseSource::Channel channel, uint64_t us, uint32_t holdUs)
+    {
+        uint32_t accepted = pulses.capture(channel, (uint32_t)us, true);
+        accepted += pulses.capture(channel, (uint32_t)(us + holdUs), false);
+        return accepted;
+    }
+
+    // 闭合与释放各带 4 个弹跳边沿（电平交替，间隔 0.1-0.5 ms，整段在 2 ms 内），返回被接受的边沿数
+    static uint32_t captureWithBounce(PulseSource &pulses, PulseSource::Channel channel, uint64_t us, uint32_t holdUs,
+                                      Prng &prng)
+    {
+        uint32_t accepted = 0;
+        for (int edge = 0; edge < 2; edge++)
+        {
+            bool closed = edge == 0;
+            uint64_t at = edge == 0 ? us : us + holdUs;
+            for (int i = 0; i < 5; i++)
+            {
+                accepted += pulses.capture(channel, (uint32_t)at, (i % 2 == 0) == closed);
+                at += 100 + prng.next() % 400;
+            }
+        }
+        return accepted;
+    }
+
+    // 曲柄以 rpm 骑行 1 分钟，每 50 ms 取一次队列。低踏频下释放远在锁定时间之后，
+    // 释放弹跳中的闭合边沿不能被计为额外的一圈
+    static bool checkDebounce(const char *name, uint32_t rpm, uint32_t holdUs)
+    {
+        bool ok = true;
+        PulseSource pulses;
+        Prng prng(5);
+        uint32_t accepted = 0;
+        uint32_t popped = 0;
+        uint32_t time;
+        uint64_t t = 1000000;
+        uint64_t nextPoll = t;
+        for (uint32_t i = 0; i < rpm; i++)
+        {
+            uint64_t at = t + i * 60000000ULL / rpm;
+            for (; nextPoll < at; nextPoll += TICK_US)
+                while (pulses.pop(PulseSource::CHANNEL_CRANK, time))
+                    popped++;
+            accepted += captureWithBounce(pulses, PulseSource::CHANNEL_CRANK, at, holdUs, prng);
+        }
+        while (pulses.pop(PulseSource::CHANNEL_CRANK, time))
+            popped++;
+        ok &= accepted == rpm && popped == rpm && pulses.getBounceCount(PulseSource::CHANNEL_CRANK) == rpm * 8;
+        ok &= pulses.getOverflowCount(PulseSource::CHANNEL_CRANK) == 0;
+        printf("[BENCH] %-40s 实际 %u 圈, 接受 %u, 弹跳 %u %s\n", name, (unsigned)rpm, (unsigned)accepted,
+               (unsigned)pulses.getBounceCount(PulseSource::CHANNEL_CRANK), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static bool checkQueueAndWrap()
+    {
+        bool ok = true;
+        PulseSource pulses;
+
+        // 消费端停滞时队列满，多余脉冲计入溢出而不覆盖已有时间戳
+        for (uint32_t i = 0; i < PulseSource::RING_SIZE + 8; i++)
+            capturePulse(pulses, PulseSource::CHANNEL_CRANK, 1000000ULL + i * 200000ULL, 30000);
+        ok &= pulses.getOverflowCount(PulseSource::CHANNEL_CRANK) == 8;
+
+        // 跨越 32 位微秒回绕：锁定时间内的闭合被拒绝，之后的闭合被接受，静默时间内的边沿计为弹跳
+        PulseDebouncer debouncer(30000, 5000);
+        ok &= debouncer.accept(0xFFFFE000u, true) && !debouncer.accept(0xFFFFF800u, false);
+        ok &= !debouncer.accept(0x00001000u, true) && !debouncer.accept(0x00002800u, false);
+        ok &= debouncer.accept(0x00008000u, true) && !debouncer.accept(0x00008100u, false);
+        ok &= debouncer.getRejectedCount() == 2;
+        ok &= PulseTracker::extend(0x100000010ULL, 0xFFFFFFF0u) == 0xFFFFFFF0ULL;
+        ok &= PulseTracker::extend(0x100000010ULL, 0x00000020u) == 0x100000020ULL;
+
+        printf("[BENCH] %-40s 队列溢出 %u %s\n", "脉冲队列与回绕检查",
+               (unsigned)pulses.getOverflowCount(PulseSource::CHANNEL_CRANK), ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 恒定 87.3 rpm 骑行 2 分钟：中断时间戳（加 0-20 us 中断延迟）与 50 ms 轮询两种事件时间
+    static bool checkCadenceAccuracy()
+    {
+        bool ok = true;
+        const float rpm = 87.3f;
+        const double periodUs = 60e6 / rpm;
+        const uint64_t startUs = 0xFFFFFFFFULL - 30000000ULL; // 30 秒后 32 位微秒回绕
+        PulseSource pulses;
+        BikeData bikeData;
+        bikeData.setPulseSource(&pulses);
+        Prng prng(9);
+
+        CentralCadence isr;
+        CentralCadence polled;
+        uint16_t polledRev = 0;
+        uint16_t polledTime = 0;
+        float worstIsr = 0;
+        float worstPolled = 0;
+        uint32_t measurements = 0;
+        uint32_t eventMismatch = 0;
+        double nextPulse = startUs + periodUs / 2;
+        for (uint64_t now = startUs; now < startUs + 120000000ULL; now += TICK_US)
+        {
+            uint64_t lastPulse = 0;
+            while (nextPulse <= now)
+            {
+                lastPulse = (uint64_t)nextPulse;
+                capturePulse(pulses, PulseSource::CHANNEL_CRANK, lastPulse + prng.next() % 20, 30000);
+                nextPulse += periodUs;
+            }
+            uint8_t events = bikeData.update(now);
+            const BikeData::Data d = bikeData.getData();
+            float value;
+            if ((events & BikeData::EVENT_CRANK) && isr.update(d.crank_rev, d.c_event_time, value))
+            {
+                measurements++;
+                worstIsr = fmaxf(worstIsr, fabsf(value - rpm));
+                uint16_t expected = (uint16_t)((lastPulse * 1024 / 1000000) & 0xFFFF);
+                eventMismatch += (uint16_t)(d.c_event_time - expected) > 1;
+            }
+
+            // 轮询：在采样时刻发现新的一圈，事件时间只能取采样时刻
+            if (events & BikeData::EVENT_CRANK)
+            {
+                polledRev = d.crank_rev;
+                polledTime = (uint16_t)((now * 1024 / 1000000) & 0xFFFF);
+                if (polled.update(polledRev, polledTime, value))
+                    worstPolled = fmaxf(worstPolled, fabsf(value - rpm));
+            }
+        }
+        const BikeData::Data d = bikeData.getData();
+        ok &= measurements > 150 && eventMismatch == 0;
+        ok &= worstIsr < 0.2f;
+        ok &= fabsf(d.cadence - rpm) < 0.5f;
+        printf("[BENCH] %-40s 最大误差 中断 %.2f rpm, 50 ms 轮询 %.2f rpm, 上报 %.1f rpm %s\n", "踏频精度 (87.3 rpm)",
+               worstIsr, worstPolled, d.cadence, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 按脚本场景的速度与踏频积分生成脉冲（1 ms 步长内线性插值出精确时刻），
+    // 检查转数与最后一圈事件时间，以及最后一圈之后踏频多久归零
+    static bool checkScenario()
+    {
+        bool ok = true;
+        Scenario scenario;
+        ok &= scenario.parse("ramp 20s 30kmh 90rpm\n"
+                             "ramp 10s 45kmh 120rpm\n"
+                             "coast 10s\n"
+                             "ramp 5s 10kmh 40rpm\n"
+                             "stop 10s\n");
+        PulseSource pulses;
+        BikeData bikeData;
+        bikeData.setPulseSource(&pulses);
+        const uint64_t startUs = 1000000;
+        scenario.begin(startUs);
+
+        double wheelPhase = 0;
+        double crankPhase = 0;
+        uint32_t wheelPulses = 0;
+        uint32_t crankPulses = 0;
+        uint64_t lastCrankUs = 0;
+        uint32_t stopCadenceAfterMs = 0;
+        float lastCadence = 0;
+        const uint32_t wheelStart = bikeData.getData().wheel_rev;
+        const uint16_t crankStart = bikeData.getData().crank_rev;
+        const uint64_t endUs = startUs + scenario.getDurationUs();
+        for (uint64_t now = startUs; now < endUs; now += 1000)
+        {
+            Scenario::Values v = scenario.sample(now);
+            double wheelStep = v.speed / 3.6 / 2.0 / 1000.0; // 每毫秒的圈数（2 m 周长）
+            double crankStep = v.cadence / 60.0 / 1000.0;
+            if (wheelPhase + wheelStep >= 1.0)
+            {
+                uint64_t at = now + (uint64_t)((1.0 - wheelPhase) / wheelStep * 1000.0);
+                wheelPulses += capturePulse(pulses, PulseSource::CHANNEL_WHEEL, at, 10000);
+                wheelPhase -= 1.0;
+            }
+            wheelPhase += wheelStep;
+            if (crankPhase + crankStep >= 1.0)
+            {
+                uint64_t at = now + (uint64_t)((1.0 - crankPhase) / crankStep * 1000.0);
+                crankPulses += capturePulse(pulses, PulseSource::CHANNEL_CRANK, at, 30000);
+                lastCrankUs = at;
+                crankPhase -= 1.0;
+            }
+            crankPhase += crankStep;
+
+            if ((now - startUs) % TICK_US == 0)
+            {
+                bikeData.update(now);
+                float cadence = bikeData.getData().cadence;
+                if (lastCadence > 0 && cadence == 0)
+                    stopCadenceAfterMs = (uint32_t)((now - lastCrankUs) / 1000);
+                lastCadence = cadence;
+            }
+        }
+        bikeData.update(endUs);
+        const BikeData::Data d = bikeData.getData();
+        ok &= d.wheel_rev - wheelStart == wheelPulses && (uint16_t)(d.crank_rev - crankStart) == crankPulses;
+        ok &= d.c_event_time == (uint16_t)((lastCrankUs * 1024 / 1000000) & 0xFFFF);
+        ok &= d.cadence == 0 && d.speed == 0;
+        ok &= pulses.getBounceCount(PulseSource::CHANNEL_WHEEL) == 0 && pulses.getBounceCount(PulseSource::CHANNEL_CRANK) == 0;
+        printf("[BENCH] %-40s 车轮 %u 圈, 曲柄 %u 圈, 停止后 %u ms 踏频归零 %s\n", "脚本场景脉冲序列检查",
+               (unsigned)wheelPulses, (unsigned)crankPulses, (unsigned)stopCadenceAfterMs, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runPulseBench()
+    {
+        bool ok = true;
+        ok &= checkDebounce("脉冲去抖 95 rpm (闭合 40 ms)", 95, 40000);
+        ok &= checkDebounce("脉冲去抖 30 rpm (闭合 200 ms, 释放弹跳)", 30, 200000);
+        ok &= checkQueueAndWrap();
+        ok &= checkCadenceAccuracy();
+        ok &= checkScenario();
+
+        const uint32_t ITERATIONS = 200000;
+        const uint32_t ROUNDS = 5;
+        PulseSource pulses;
+        BikeData bikeData;
+        bikeData.setPulseSource(&pulses);
+        uint64_t now = 1000000;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                            {
+            now += TICK_US;
+            if ((i & 7) == 0)
+                capturePulse(pulses, PulseSource::CHANNEL_CRANK, now - 40000, 30000);
+            if ((i & 3) == 0)
+                capturePulse(pulses, PulseSource::CHANNEL_WHEEL, now - 20000, 10000);
+            doNotOptimize(bikeData.update(now)); });
+        report("BikeData::update (有线传感器)", ns, "update");
+
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t i)
+                     {
+            uint32_t t;
+            pulses.capture(PulseSource::CHANNEL_CRANK, i * 200000u, true);
+            pulses.capture(PulseSource::CHANNEL_CRANK, i * 200000u + 30000u, false);
+            doNotOptimize(pulses.pop(PulseSource::CHANNEL_CRANK, t)); });
+        report("PulseSource::capture 闭合+释放 +pop", ns, "pulse");
+        return ok;
+    }
+}
@@ -0,0 +1,277 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "BikeData.h"
+#include "CSCService.h"
+#include "LoopbackGatt.h"
+#include "Scenario.h"
+#include <math.h>
+
+namespace bench
+{
+    // 脚本场景：解析与错误定位、同一种子可复现、不同采样频率下分段一致，
+    // 中心设备按回绕规则解码 CSC 测量时能跨过 32/16 位计数与事件时间回绕，
+    // 以及采样任务停顿后转数与事件时间仍然一致。
+
+    static const char *ROLLOVER_SCRIPT =
+        "seed 7\n"
+        "wheel 4294967280   # 约 1 秒后回绕\n"
+        "crank 65530\n"
+        "clock 63s\n"
+        "noise 2%\n"
+        "hold 20s 30kmh 90rpm 200w\n"
+        "coast 10s\n"
+        "stop 5s\n"
+        "ramp 5s 25kmh 80rpm 180w\n"
+        "hold 60s\n";
+
+    static bool checkParse()
+    {
+        bool ok = true;
+        Scenario scenario;
+        Scenario::ParseError error;
+
+        ok &= scenario.parse("ramp 60s 25kmh 85rpm 160w\n"
+                             "repeat 3\n"
+                             "  repeat 2\n"
+                             "    ramp 2s 45kmh 120rpm\n"
+                             "    hold 500ms\n"
+                             "  end\n"
+                             "  stop 1m\n"
+                             "end\n",
+                             &error);
+        ok &= scenario.getSegmentCount() == 1 + 3 * (2 * 2 + 1);
+        ok &= scenario.getDurationUs() == 60000000ULL + 3 * (2 * 2500000ULL + 60000000ULL);
+        // 省略的功率沿用上一段，ramp 从上一段的结束值开始
+        const Scenario::Segment &sprint = scenario.getSegment(1);
+        ok &= sprint.to.power == 160 && sprint.from.speed == 25 && sprint.to.cadence == 120;
+        ok &= scenario.getSegment(5).type == Scenario::SEGMENT_STOP;
+
+        struct Bad
+        {
+            const char *script;
+            uint16_t line;
+        };
+        const Bad bad[] = {
+            {"hold 10s\nsprint 5s\n", 2},
+            {"hold 10\n", 1},
+            {"stop 5s 20kmh\n", 1},
+            {"repeat 2\nhold 1s\n", 2},
+            {"# 只有注释\n\n", 2},
+            {"crank 70000\nhold 1s\n", 1},
+            {"hold 1s\nend\n", 2},
+        };
+        for (const Bad &b : bad)
+        {
+            ok &= !scenario.parse(b.script, &error) && error.line == b.line && error.message;
+            ok &= scenario.getSegmentCount() == 0;
+        }
+        printf("[BENCH] %-40s %s\n", "场景脚本解析检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    static bool checkDeterminism()
+    {
+        bool ok = true;
+        Scenario a, b, c;
+        ok &= a.parse(ROLLOVER_SCRIPT) && b.parse(ROLLOVER_SCRIPT);
+        ok &= c.parse("seed 8\nnoise 2%\nhold 20s 30kmh 90rpm 200w\n");
+        a.begin(0);
+        b.begin(0);
+        c.begin(0);
+        bool differs = false;
+        for (uint64_t t = 0; t < 20000000; t += 1000)
+        {
+            Scenario::Values va = a.sample(t), vb = b.sample(t), vc = c.sample(t);
+            ok &= va.speed == vb.speed && va.cadence == vb.cadence && va.power == vb.power;
+            differs |= va.power != vc.power;
+        }
+        ok &= differs;
+
+        // 无噪声时取值只取决于时间，与采样频率无关
+        Scenario slow, fast;
+        const char *script = "ramp 10s 40kmh 100rpm 300w\ncoast 7s\nloop\n";
+        ok &= slow.parse(script) && fast.parse(script);
+        slow.begin(5000);
+        fast.begin(5000);
+        for (uint64_t t = 5000; t < 60000000; t += 1000)
+        {
+            Scenario::Values vf = fast.sample(t);
+            if (t % 50000 == 5000)
+            {
+                Scenario::Values vs = slow.sample(t);
+                ok &= vs.speed == vf.speed && vs.cadence == vf.cadence && vs.power == vf.power;
+            }
+        }
+        ok &= fast.isLooping() && !fast.isFinished(1ULL << 40);
+        printf("[BENCH] %-40s %s\n", "场景可复现检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 中心设备侧的 CSC 解码：按规范对计数与事件时间取模差分
+    struct CscClient
+    {
+        bool first = true;
+        uint32_t wheel = 0;
+        uint16_t wheelTime = 0;
+        uint16_t crank = 0;
+        uint16_t crankTime = 0;
+        uint64_t wheelTotal = 0;
+        uint64_t crankTotal = 0;
+        uint32_t wheelWraps = 0;
+        uint32_t crankWraps = 0;
+        uint32_t timeWraps = 0;
+        float maxCadence = 0;
+        float maxSpeed = 0;
+
+        void receive(const uint8_t *p, size_t len)
+        {
+            if (len != 11 || p[0] != 0x03)
+                return;
+            uint32_t w = p[1] | p[2] << 8 | p[3] << 16 | (uint32_t)p[4] << 24;
+            uint16_t wt = (uint16_t)(p[5] | p[6] << 8);
+            uint16_t c = (uint16_t)(p[7] | p[8] << 8);
+            uint16_t ct = (uint16_t)(p[9] | p[10] << 8);
+            if (!first)
+            {
+                uint32_t dw = w - wheel;
+                uint16_t dwt = (uint16_t)(wt - wheelTime);
+                uint16_t dc = (uint16_t)(c - crank);
+                uint16_t dct = (uint16_t)(ct - crankTime);
+                wheelTotal += dw;
+                crankTotal += dc;
+                wheelWraps += w < wheel;
+                crankWraps += c < crank;
+                timeWraps += wt < wheelTime;
+                if (dwt)
+                    maxSpeed = fmaxf(maxSpeed, dw * 2.0f / (dwt / 1024.0f) * 3.6f);
+                if (dct)
+                    maxCadence = fmaxf(maxCadence, dc * 60.0f / (dct / 1024.0f));
+            }
+            first = false;
+            wheel = w;
+            wheelTime = wt;
+            crank = c;
+            crankTime = ct;
+        }
+    };
+
+    static bool checkRollover()
+    {
+        bool ok = true;
+        Scenario scenario;
+        ok &= scenario.parse(ROLLOVER_SCRIPT);
+
+        host::setMicros(1000000);
+        host::LoopbackServer server;
+        CSCService csc(&server);
+        server.connect(host::LoopbackServer::ClientConfig());
+        BikeData bikeData;
+        bikeData.setScenario(&scenario);
+
+        CscClient client;
+        uint64_t lastNotify = 0;
+        uint64_t nowUs = 1000000;
+        const uint64_t endUs = nowUs + scenario.getDurationUs();
+        const uint64_t TICK_US = 1000; // 1 kHz 采样
+        while (nowUs < endUs)
+        {
+            nowUs += TICK_US;
+            host::setMicros(nowUs);
+            server.advance((int64_t)nowUs);
+            uint8_t events = bikeData.update(nowUs);
+            BikeData::Data d = bikeData.getData();
+            if (events & (BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK))
+                csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+            else
+                csc.flush(nowUs);
+            uint64_t notifies = server.getCallCount(host::LoopbackServer::CALL_NOTIFY);
+            if (notifies != lastNotify)
+            {
+                gatt::Characteristic *ch = csc.getMeasurementChar();
+                client.receive(ch->getData(), ch->getLength());
+                lastNotify = notifies;
+            }
+        }
+
+        // 解码得到的累计量与 BikeData 的实际增量一致，速度与踏频没有回绕造成的异常值
+        BikeData::Data d = bikeData.getData();
+        const Scenario::Start &start = scenario.getStart();
+        uint64_t wheelActual = (uint32_t)(d.wheel_rev - start.wheelRev);
+        uint64_t crankActual = (uint16_t)(d.crank_rev - start.crankRev);
+        ok &= client.wheelWraps == 1 && client.crankWraps == 1 && client.timeWraps >= 1;
+        ok &= client.wheelTotal + 20 >= wheelActual && client.wheelTotal <= wheelActual;
+        ok &= client.crankTotal + 5 >= crankActual && client.crankTotal <= crankActual;
+        ok &= client.maxSpeed < 35 && client.maxCadence < 100;
+        ok &= server.getStats(0).dropped == 0;
+
+        printf("[BENCH] %-40s 车轮 %llu 圈, 曲柄 %llu 圈, 回绕 %u/%u/%u, 最大 %.1f km/h %.0f rpm %s\n",
+               "场景回绕与中心设备解码检查", (unsigned long long)client.wheelTotal,
+               (unsigned long long)client.crankTotal, (unsigned)client.wheelWraps, (unsigned)client.crankWraps,
+               (unsigned)client.timeWraps, client.maxSpeed, client.maxCadence, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    // 匀速骑行中采样停顿 5 秒（任务卡住或回放跳跃）：停顿期间的转数全部计入，
+    // 中心设备按前后两次测量算出的速度与踏频仍等于实际值
+    static bool checkStall()
+    {
+        bool ok = true;
+        Scenario scenario;
+        ok &= scenario.parse("hold 40s 30kmh 90rpm 200w\n");
+        BikeData bikeData;
+        bikeData.setScenario(&scenario);
+
+        const uint64_t TICK_US = 50000;
+        uint64_t nowUs = 1000000;
+        for (int i = 0; i < 200; i++, nowUs += TICK_US)
+            bikeData.update(nowUs);
+        BikeData::Data before = bikeData.getData();
+        nowUs += 5000000;
+        bikeData.update(nowUs);
+        BikeData::Data after = bikeData.getData();
+
+        uint32_t dw = after.wheel_rev - before.wheel_rev;
+        uint16_t dwt = (uint16_t)(after.w_event_time - before.w_event_time);
+        uint16_t dc = (uint16_t)(after.crank_rev - before.crank_rev);
+        uint16_t dct = (uint16_t)(after.c_event_time - before.c_event_time);
+        float speed = dwt ? dw * 2.0f / (dwt / 1024.0f) * 3.6f : 0;
+        float cadence = dct ? dc * 60.0f / (dct / 1024.0f) : 0;
+        ok &= fabsf(speed - 30.0f) < 0.5f && fabsf(cadence - 90.0f) < 1.0f;
+
+        printf("[BENCH] %-40s 停顿 5 s: 车轮 %u 圈 %.1f km/h, 曲柄 %u 圈 %.1f rpm %s\n", "采样停顿后转数检查",
+               (unsigned)dw, speed, (unsigned)dc, cadence, ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runScenarioBench()
+    {
+        bool ok = true;
+        ok &= checkParse();
+        ok &= checkDeterminism();
+        ok &= checkRollover();
+        ok &= checkStall();
+
+        const uint32_t ITERATIONS = 1000000;
+        const uint32_t ROUNDS = 5;
+
+        Scenario scenario;
+        scenario.parse("seed 3\nnoise 5%\nloop\nrepeat 8\nramp 2s 45kmh 120rpm 650w\nhold 20s\n"
+                       "ramp 3s 22kmh 80rpm 140w\nhold 40s\nend\ncoast 15s\nstop 10s\n");
+        uint64_t t = 0;
+        double ns = measure(ITERATIONS, ROUNDS, [&](uint32_t)
+                            {
+            t += 1000;
+            doNotOptimize(scenario.sample(t)); });
+        report("Scenario::sample (1 kHz)", ns, "sample");
+
+        BikeData bikeData;
+        bikeData.setScenario(&scenario);
+        uint64_t nowUs = 1000000;
+        ns = measure(ITERATIONS, ROUNDS, [&](uint32_t)
+                     {
+            nowUs += 1000;
+            doNotOptimize(bikeData.update(nowUs)); });
+        report("BikeData::update (场景, 1 kHz)", ns, "update");
+        return ok;
+    }
+}
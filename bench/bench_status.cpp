@@ -0,0 +1,107 @@
+#include "Bench.h"
+#include "BatteryService.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "DeviceInfoService.h"
+#include "FTMSService.h"
+#include "HostGatt.h"
+
+namespace bench
+{
+    // 服务初始化失败时的错误码：逐个限制后端可创建的特征值数，
+    // 检查返回的错误码与出错的特征值 UUID，以及失败的服务不再发送通知。
+
+    struct StatusCase
+    {
+        const char *name;
+        size_t budget; // 后端还能创建的特征值数
+        StatusCode code;
+        uint16_t uuid;
+    };
+
+    template <typename Service>
+    static bool checkCases(const char *service, const StatusCase *cases, size_t count)
+    {
+        bool ok = true;
+        for (size_t i = 0; i < count; i++)
+        {
+            const StatusCase &c = cases[i];
+            host::GattServer server;
+            server.setCharacteristicBudget(c.budget);
+            Service s(&server);
+            Status status = s.getStatus();
+            if (status.code != c.code || status.uuid != c.uuid)
+            {
+                printf("[BENCH] %s %s: 期望 %u/0x%04X, 实际 %s/0x%04X\n", service, c.name,
+                       (unsigned)c.code, (unsigned)c.uuid, status.name(), (unsigned)status.uuid);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    static bool checkServiceStatus()
+    {
+        static const StatusCase CSC_CASES[] = {
+            {"测量", 0, STATUS_CHARACTERISTIC_FAILED, 0x2A5B},
+            {"特性", 1, STATUS_CHARACTERISTIC_FAILED, 0x2A5C},
+            {"位置", 2, STATUS_CHARACTERISTIC_FAILED, 0x2A5D},
+            {"成功", 3, STATUS_OK, 0},
+        };
+        static const StatusCase CP_CASES[] = {
+            {"测量", 0, STATUS_CHARACTERISTIC_FAILED, 0x2A63},
+            {"特性", 1, STATUS_CHARACTERISTIC_FAILED, 0x2A65},
+            {"位置", 2, STATUS_CHARACTERISTIC_FAILED, 0x2A5D},
+            {"控制点", 3, STATUS_CHARACTERISTIC_FAILED, 0x2A66},
+            {"成功", 4, STATUS_OK, 0},
+        };
+        static const StatusCase FTMS_CASES[] = {
+            {"特性", 0, STATUS_CHARACTERISTIC_FAILED, 0x2ACC},
+            {"室内单车数据", 1, STATUS_CHARACTERISTIC_FAILED, 0x2AD2},
+            {"成功", 2, STATUS_OK, 0},
+        };
+        static const StatusCase BATTERY_CASES[] = {
+            {"电量", 0, STATUS_CHARACTERISTIC_FAILED, 0x2A19},
+            {"成功", 1, STATUS_OK, 0},
+        };
+        static const StatusCase DEVICE_INFO_CASES[] = {
+            {"系统ID", 0, STATUS_CHARACTERISTIC_FAILED, 0x2A23},
+            {"制造商", 6, STATUS_CHARACTERISTIC_FAILED, 0x2A29},
+            {"成功", 7, STATUS_OK, 0},
+        };
+
+        bool ok = checkCases<CSCService>("CSC", CSC_CASES, sizeof(CSC_CASES) / sizeof(CSC_CASES[0]));
+        ok &= checkCases<CPService>("CP", CP_CASES, sizeof(CP_CASES) / sizeof(CP_CASES[0]));
+        ok &= checkCases<FTMSService>("FTMS", FTMS_CASES, sizeof(FTMS_CASES) / sizeof(FTMS_CASES[0]));
+        ok &= checkCases<BatteryService>("电池", BATTERY_CASES, sizeof(BATTERY_CASES) / sizeof(BATTERY_CASES[0]));
+        ok &= checkCases<DeviceInfoService>("设备信息", DEVICE_INFO_CASES,
+                                            sizeof(DEVICE_INFO_CASES) / sizeof(DEVICE_INFO_CASES[0]));
+
+        // 空服务器指针
+        if (CSCService(nullptr).getStatus().code != STATUS_INVALID_ARGUMENT)
+        {
+            printf("[BENCH] CSC 空服务器指针未报告 INVALID_ARGUMENT\n");
+            ok = false;
+        }
+
+        // 初始化失败的服务直接返回，不访问特征值也不发送通知
+        host::GattServer server;
+        server.setCharacteristicBudget(1);
+        CSCService csc(&server);
+        if (csc.updateMeasurement(1, 1024, 1, 1024) || csc.flush(0))
+        {
+            printf("[BENCH] 初始化失败的 CSC 服务仍发送了通知\n");
+            ok = false;
+        }
+
+        printf("[BENCH] %-40s %s\n", "服务初始化错误码检查", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool runStatusBench()
+    {
+        bool ok = true;
+        ok &= checkServiceStatus();
+        return ok;
+    }
+}
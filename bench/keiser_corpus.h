@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Keiser 广播样本集：原始广播数据（AD 结构序列），
+// 混合了 Keiser 实时/回顾数据、旧版固件格式以及健身房里常见的其他厂商广播
+namespace bench
+{
+    struct AdvertRecord
+    {
+        const uint8_t *data;
+        size_t len;
+    };
+
+    // M3i 固件 6.30：含档位，踏频 82.5rpm，功率 187W，档位 14
+    static const uint8_t ADV_KEISER_RT_1[] = {
+        0x02, 0x01, 0x04,
+        0x03, 0x09, 'M', '3',
+        0x14, 0xFF, 0x02, 0x01, 0x06, 0x30, 0x00, 0x07,
+        0x39, 0x03, 0x82, 0x05, 0xBB, 0x00, 0x2A, 0x00, 0x0C, 0x1E, 0x35, 0x80, 0x0E};
+
+    // M3i 固件 6.30：另一台单车，踏频 95.0rpm，功率 256W，档位 18
+    static const uint8_t ADV_KEISER_RT_2[] = {
+        0x02, 0x01, 0x04,
+        0x03, 0x09, 'M', '3',
+        0x14, 0xFF, 0x02, 0x01, 0x06, 0x30, 0x00, 0x15,
+        0xB6, 0x03, 0xC4, 0x05, 0x00, 0x01, 0x61, 0x00, 0x19, 0x02, 0x71, 0x80, 0x12};
+
+    // 旧版固件 6.10：无档位字段
+    static const uint8_t ADV_KEISER_LEGACY[] = {
+        0x02, 0x01, 0x04,
+        0x13, 0xFF, 0x02, 0x01, 0x06, 0x10, 0x00, 0x07,
+        0xE8, 0x02, 0x00, 0x00, 0x96, 0x00, 0x10, 0x00, 0x05, 0x2C, 0x12, 0x00};
+
+    // 回顾模式（dataType != 0）
+    static const uint8_t ADV_KEISER_REVIEW[] = {
+        0x02, 0x01, 0x04,
+        0x14, 0xFF, 0x02, 0x01, 0x06, 0x30, 0x81, 0x07,
+        0x20, 0x03, 0x00, 0x00, 0xA0, 0x00, 0x30, 0x01, 0x2D, 0x00, 0x50, 0x81, 0x0A};
+
+    // Apple iBeacon
+    static const uint8_t ADV_IBEACON[] = {
+        0x02, 0x01, 0x06,
+        0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15,
+        0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48, 0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0,
+        0x00, 0x01, 0x00, 0x02, 0xC5};
+
+    // 心率带：仅含名称与 16 位服务 UUID
+    static const uint8_t ADV_HRM[] = {
+        0x02, 0x01, 0x06,
+        0x03, 0x03, 0x0D, 0x18,
+        0x09, 0x09, 'H', 'R', 'M', '-', 'P', 'r', 'o'};
+
+    // 其他健身设备的厂商数据
+    static const uint8_t ADV_OTHER_MFG[] = {
+        0x02, 0x01, 0x06,
+        0x07, 0xFF, 0x59, 0x00, 0x01, 0x02, 0x03, 0x04,
+        0x05, 0x09, 'F', 'T', 'M', 'S'};
+
+    // 截断的 AD 结构（长度字段越界）
+    static const uint8_t ADV_TRUNCATED[] = {
+        0x02, 0x01, 0x04,
+        0x14, 0xFF, 0x02, 0x01, 0x06, 0x30};
+
+    static const AdvertRecord KEISER_CORPUS[] = {
+        {ADV_KEISER_RT_1, sizeof(ADV_KEISER_RT_1)},
+        {ADV_IBEACON, sizeof(ADV_IBEACON)},
+        {ADV_KEISER_RT_2, sizeof(ADV_KEISER_RT_2)},
+        {ADV_HRM, sizeof(ADV_HRM)},
+        {ADV_KEISER_LEGACY, sizeof(ADV_KEISER_LEGACY)},
+        {ADV_OTHER_MFG, sizeof(ADV_OTHER_MFG)},
+        {ADV_KEISER_REVIEW, sizeof(ADV_KEISER_REVIEW)},
+        {ADV_TRUNCATED, sizeof(ADV_TRUNCATED)},
+    };
+
+    static const size_t KEISER_CORPUS_SIZE = sizeof(KEISER_CORPUS) / sizeof(KEISER_CORPUS[0]);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+#include "KeiserParser.h"
+
+// 通知负载类基准共用的骑行剖面：1 小时 Keiser 骑行（骑 10 分钟、停 2 分钟循环），
+// 20Hz 采样，Keiser 约 3Hz 广播（每 6 个采样一次）
+namespace bench
+{
+    static const uint64_t RIDE_TICK_US = 50000;
+    static const uint32_t RIDE_TICKS = 3600 * 20;
+    static const uint32_t RIDE_ADVERT_EVERY = 6;
+
+    // 每个通知在 1M PHY 上的固定开销：
+    // 前导码(1) + 接入地址(4) + LL 头(2) + CRC(3) + L2CAP 头(4) + ATT 头(3)
+    static const uint32_t AIR_OVERHEAD = 17;
+
+    inline KeiserSample rideSample(uint32_t tick)
+    {
+        KeiserSample s = {};
+        s.versionMajor = 6;
+        s.versionMinor = 0x30;
+        s.equipmentId = 1;
+        s.gear = 12;
+        uint32_t phase = (tick / 20) % 720; // 秒
+        if (phase < 600)
+        {
+            // 踏频与功率缓慢波动
+            s.cadence = (uint16_t)(850 + (tick / 40) % 60);
+            s.power = (uint16_t)(180 + (tick / 100) % 25);
+        }
+        return s;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+// 主机端 Adafruit_NeoPixel 兼容层：只提供声明，供主机端检查 StatusLed.h 能否编译，不链接实现
+#include <stdint.h>
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel
+{
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type);
+
+    void begin();
+    void show();
+    void clear();
+    void setPin(int16_t pin);
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+};
@@ -0,0 +1,65 @@
+#include "Arduino.h"
+#include "esp_timer.h"
+
+HostSerial Serial;
+
+// 虚拟时钟从 1ms 开始，避免 BikeData::update() 把 millis()==0 当作无效时间
+static uint64_t hostMicros = 1000;
+static uint32_t hostRandState = 1;
+
+namespace host
+{
+    void setMicros(uint64_t us) { hostMicros = us; }
+    void advanceMicros(uint64_t us) { hostMicros += us; }
+}
+
+int64_t esp_timer_get_time() { return (int64_t)hostMicros; }
+
+unsigned long millis() { return (unsigned long)(hostMicros / 1000); }
+unsigned long micros() { return (unsigned long)hostMicros; }
+void delay(unsigned long ms) { hostMicros += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+
+void randomSeed(unsigned long seed)
+{
+    hostRandState = seed ? (uint32_t)seed : 1;
+}
+
+long random(long howbig)
+{
+    if (howbig <= 0)
+        return 0;
+    // xorshift32，足够模拟噪声且与平台无关
+    hostRandState ^= hostRandState << 13;
+    hostRandState ^= hostRandState >> 17;
+    hostRandState ^= hostRandState << 5;
+    return (long)(hostRandState % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+size_t HostSerial::print(const char *s)
+{
+    return fputs(s, stdout) < 0 ? 0 : strlen(s);
+}
+
+size_t HostSerial::println(const char *s)
+{
+    size_t n = print(s);
+    fputc('\n', stdout);
+    return n + 1;
+}
+
+size_t HostSerial::printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n < 0 ? 0 : (size_t)n;
+}
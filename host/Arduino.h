@@ -0,0 +1,50 @@
+#pragma once
+// 主机端 Arduino 最小兼容层，仅供 native 环境编译 BikeData 与编码代码使用
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+using std::abs;
+using std::max;
+using std::min;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+// ------------ 虚拟时钟 ------------
+// 主机端时间完全由基准/回放程序推进，保证结果可复现
+namespace host
+{
+    void setMicros(uint64_t us);
+    void advanceMicros(uint64_t us);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// ------------ 随机数 ------------
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+// ------------ 串口 ------------
+class HostSerial
+{
+public:
+    void begin(unsigned long baud) {}
+    int available() { return 0; }
+    size_t print(const char *s);
+    size_t println(const char *s = "");
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HostSerial Serial;
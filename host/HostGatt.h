@@ -0,0 +1,181 @@
+#pragma once
+// 主机端 GATT 后端：setValue 真实拷贝数据，notify 只计数，
+// 可通知的特征值视为有一个已订阅的连接，
+// 便于在主机上运行服务类、基准测试与追踪回放
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "BLEConfig.h"
+#include "GattBackend.h"
+
+namespace host
+{
+    inline bool sameUuid(const gatt::Uuid &a, const gatt::Uuid &b)
+    {
+        if (a.is16() || b.is16())
+            return a.is16() && b.is16() && a.value16 == b.value16;
+        return strcmp(a.value128, b.value128) == 0;
+    }
+
+    class GattCharacteristic final : public gatt::Characteristic
+    {
+    public:
+        static const size_t MAX_VALUE_LEN = 512; // ATT 属性值最大长度
+
+        GattCharacteristic(const gatt::Uuid &uuid, uint8_t properties)
+            : uuid(uuid), properties(properties) {}
+
+        void setValue(const uint8_t *data, size_t len) override
+        {
+            if (len > MAX_VALUE_LEN)
+                len = MAX_VALUE_LEN;
+            if (data && len)
+                memcpy(value, data, len);
+            valueLen = len;
+        }
+        using gatt::Characteristic::setValue;
+
+        bool notify() override
+        {
+            notifyCount++;
+            return true;
+        }
+        bool notify(const uint8_t *data, size_t len, uint16_t connHandle) override
+        {
+            notifyCount++;
+            return true;
+        }
+        bool indicate() override
+        {
+            indicateCount++;
+            lastIndicateConn = gatt::CONN_ALL;
+            return true;
+        }
+        bool indicate(uint16_t connHandle) override
+        {
+            indicateCount++;
+            lastIndicateConn = connHandle;
+            return true;
+        }
+
+        const uint8_t *getData() const override { return value; }
+        size_t getLength() const override { return valueLen; }
+
+        void setWriteHandler(gatt::WriteHandler handler, void *ctx) override
+        {
+            writeHandler = handler;
+            writeCtx = ctx;
+        }
+
+        size_t getSubscriberCount() const override
+        {
+            return (properties & (CHARACTERISTIC_PROPERTY_NOTIFY | CHARACTERISTIC_PROPERTY_INDICATE)) ? 1 : 0;
+        }
+
+        // 模拟中心设备写入
+        void write(uint16_t connHandle, const uint8_t *data, size_t len)
+        {
+            setValue(data, len);
+            if (writeHandler)
+                writeHandler(writeCtx, connHandle, data, len);
+        }
+
+        const gatt::Uuid &getUuid() const { return uuid; }
+        uint8_t getProperties() const { return properties; }
+        uint32_t getNotifyCount() const { return notifyCount; }
+        uint32_t getIndicateCount() const { return indicateCount; }
+        // 最后一次指示的目标连接，发给所有订阅者时为 gatt::CONN_ALL
+        uint16_t getLastIndicateConn() const { return lastIndicateConn; }
+
+    private:
+        gatt::Uuid uuid;
+        uint8_t properties;
+        uint8_t value[MAX_VALUE_LEN] = {0};
+        size_t valueLen = 0;
+        uint32_t notifyCount = 0;
+        uint32_t indicateCount = 0;
+        uint16_t lastIndicateConn = gatt::CONN_ALL;
+        gatt::WriteHandler writeHandler = nullptr;
+        void *writeCtx = nullptr;
+    };
+
+    class GattService final : public gatt::Service
+    {
+    public:
+        GattService(const gatt::Uuid &uuid, size_t *budget) : uuid(uuid), budget(budget) {}
+        ~GattService()
+        {
+            for (auto c : characteristics)
+                delete c;
+        }
+
+        gatt::Characteristic *createCharacteristic(const gatt::Uuid &uuid, uint8_t properties) override
+        {
+            if (*budget == 0)
+                return nullptr;
+            (*budget)--;
+            auto c = new GattCharacteristic(uuid, properties);
+            characteristics.push_back(c);
+            return c;
+        }
+        bool start() override { return true; }
+
+        const gatt::Uuid &getUuid() const { return uuid; }
+
+        GattCharacteristic *findCharacteristic(const gatt::Uuid &target) const
+        {
+            for (auto c : characteristics)
+            {
+                if (sameUuid(c->getUuid(), target))
+                    return c;
+            }
+            return nullptr;
+        }
+
+    private:
+        gatt::Uuid uuid;
+        size_t *budget;
+        std::vector<GattCharacteristic *> characteristics;
+    };
+
+    class GattServer final : public gatt::Server
+    {
+    public:
+        ~GattServer()
+        {
+            for (auto s : services)
+                delete s;
+        }
+
+        gatt::Service *createService(const gatt::Uuid &uuid) override
+        {
+            auto s = new GattService(uuid, &characteristicBudget);
+            services.push_back(s);
+            return s;
+        }
+
+        // 模拟后端的特征值池：再创建 count 个后 createCharacteristic 返回 nullptr
+        void setCharacteristicBudget(size_t count) { characteristicBudget = count; }
+
+        // 按 UUID 查找特征值（多个服务含相同 UUID 时返回最先创建的）
+        GattCharacteristic *findCharacteristic(const gatt::Uuid &target) const
+        {
+            for (auto s : services)
+            {
+                if (GattCharacteristic *c = s->findCharacteristic(target))
+                    return c;
+            }
+            return nullptr;
+        }
+
+    private:
+        std::vector<GattService *> services;
+        size_t characteristicBudget = SIZE_MAX;
+    };
+
+    // 基准与回放读取主机端计数
+    inline GattCharacteristic *native(gatt::Characteristic *characteristic)
+    {
+        return static_cast<GattCharacteristic *>(characteristic);
+    }
+}
@@ -0,0 +1,391 @@
+#include "LoopbackGatt.h"
+#include <string.h>
+#include "BLEConfig.h"
+#include "HostGatt.h"
+#include "esp_timer.h"
+
+namespace host
+{
+    // ------------ 特征值 ------------
+
+    LoopbackCharacteristic::LoopbackCharacteristic(LoopbackServer *owner, uint16_t index,
+                                                   const gatt::Uuid &uuid, uint8_t properties)
+        : owner(owner), index(index), uuid(uuid), properties(properties)
+    {
+    }
+
+    void LoopbackCharacteristic::setValue(const uint8_t *data, size_t len)
+    {
+        if (len > MAX_VALUE_LEN)
+            len = MAX_VALUE_LEN;
+        if (data && len)
+            memcpy(value, data, len);
+        valueLen = len;
+        owner->record(LoopbackServer::CALL_SET_VALUE, this, len, gatt::CONN_ALL);
+    }
+
+    bool LoopbackCharacteristic::notify()
+    {
+        owner->record(LoopbackServer::CALL_NOTIFY, this, valueLen, gatt::CONN_ALL);
+        return owner->send(this, value, valueLen, gatt::CONN_ALL);
+    }
+
+    bool LoopbackCharacteristic::notify(const uint8_t *data, size_t len, uint16_t connHandle)
+    {
+        owner->record(LoopbackServer::CALL_NOTIFY, this, len, connHandle);
+        return owner->send(this, data, len, connHandle);
+    }
+
+    bool LoopbackCharacteristic::indicate()
+    {
+        // 指示与通知共用发送缓冲；确认往返不模拟
+        owner->record(LoopbackServer::CALL_INDICATE, this, valueLen, gatt::CONN_ALL);
+        return owner->send(this, value, valueLen, gatt::CONN_ALL);
+    }
+
+    bool LoopbackCharacteristic::indicate(uint16_t connHandle)
+    {
+        owner->record(LoopbackServer::CALL_INDICATE, this, valueLen, connHandle);
+        return owner->send(this, value, valueLen, connHandle);
+    }
+
+    void LoopbackCharacteristic::setWriteHandler(gatt::WriteHandler handler, void *ctx)
+    {
+        writeHandler = handler;
+        writeCtx = ctx;
+    }
+
+    void LoopbackCharacteristic::setCccd(uint16_t connHandle, uint16_t cccd)
+    {
+        subscribers.update(connHandle, cccd);
+    }
+
+    void LoopbackCharacteristic::write(uint16_t connHandle, const uint8_t *data, size_t len)
+    {
+        if (len > MAX_VALUE_LEN)
+            len = MAX_VALUE_LEN;
+        if (data && len)
+            memcpy(value, data, len);
+        valueLen = len;
+        if (writeHandler)
+            writeHandler(writeCtx, connHandle, data, len);
+    }
+
+    // ------------ 服务 ------------
+
+    gatt::Characteristic *LoopbackService::createCharacteristic(const gatt::Uuid &uuid, uint8_t properties)
+    {
+        return owner->addCharacteristic(uuid, properties);
+    }
+
+    // ------------ 服务器 ------------
+
+    LoopbackServer::LoopbackServer(uint32_t seed) : randomState(seed ? seed : 1)
+    {
+    }
+
+    LoopbackServer::~LoopbackServer()
+    {
+        for (auto c : clients)
+            delete c;
+        for (auto c : characteristics)
+            delete c;
+        for (auto s : services)
+            delete s;
+    }
+
+    gatt::Service *LoopbackServer::createService(const gatt::Uuid &uuid)
+    {
+        auto s = new LoopbackService(this, uuid);
+        services.push_back(s);
+        return s;
+    }
+
+    LoopbackCharacteristic *LoopbackServer::addCharacteristic(const gatt::Uuid &uuid, uint8_t properties)
+    {
+        auto c = new LoopbackCharacteristic(this, (uint16_t)characteristics.size(), uuid, properties);
+        characteristics.push_back(c);
+        bool notifiable = properties & (CHARACTERISTIC_PROPERTY_NOTIFY | CHARACTERISTIC_PROPERTY_INDICATE);
+        for (uint16_t i = 0; i < clients.size(); i++)
+        {
+            ensureSlots(*clients[i]);
+            if (notifiable && clients[i]->connected && clients[i]->config.subscribeAll)
+                c->setCccd(i, SubscriberSet<MAX_CLIENTS>::CCCD_NOTIFY);
+        }
+        return c;
+    }
+
+    void LoopbackServer::ensureSlots(Client &client)
+    {
+        while (client.delivered.size() < characteristics.size())
+        {
+            client.delivered.push_back(0);
+            client.last.emplace_back();
+        }
+    }
+
+    uint16_t LoopbackServer::connect(const ClientConfig &config)
+    {
+        if (clients.size() >= MAX_CLIENTS)
+            return gatt::CONN_ALL;
+        Client *client = new Client();
+        client->config = config;
+        if (client->config.connIntervalUs == 0)
+            client->config.connIntervalUs = 7500; // 规范允许的最小连接间隔
+        client->nextEventUs = esp_timer_get_time() + config.phaseUs;
+        ensureSlots(*client);
+        clients.push_back(client);
+        uint16_t connHandle = (uint16_t)(clients.size() - 1);
+
+        // 中心设备连接后写入 CCCD
+        if (config.subscribeAll)
+        {
+            for (auto c : characteristics)
+            {
+                if (c->getProperties() & (CHARACTERISTIC_PROPERTY_NOTIFY | CHARACTERISTIC_PROPERTY_INDICATE))
+                    c->setCccd(connHandle, SubscriberSet<MAX_CLIENTS>::CCCD_NOTIFY);
+            }
+        }
+        return connHandle;
+    }
+
+    void LoopbackServer::disconnect(uint16_t connHandle)
+    {
+        if (!isConnected(connHandle))
+            return;
+        Client &client = *clients[connHandle];
+        client.connected = false;
+        for (auto c : characteristics)
+            c->setCccd(connHandle, 0);
+        for (const Packet &packet : client.queue)
+            releasePayload(packet.payload);
+        client.queue.clear();
+    }
+
+    void LoopbackServer::subscribe(uint16_t connHandle, const gatt::Uuid &uuid, bool enabled)
+    {
+        if (!isConnected(connHandle))
+            return;
+        for (auto c : characteristics)
+        {
+            if (sameUuid(c->getUuid(), uuid))
+                c->setCccd(connHandle, enabled ? SubscriberSet<MAX_CLIENTS>::CCCD_NOTIFY : 0);
+        }
+    }
+
+    void LoopbackServer::setRecording(bool enabled, size_t limit)
+    {
+        recording = enabled;
+        maxCalls = limit;
+        calls.clear();
+    }
+
+    void LoopbackServer::record(CallType type, const LoopbackCharacteristic *characteristic, size_t len, uint16_t connHandle)
+    {
+        callCount[type]++;
+        if (!recording || calls.size() >= maxCalls)
+            return;
+        calls.push_back({esp_timer_get_time(), characteristic->getIndex(), connHandle, (uint16_t)len, (uint8_t)type});
+    }
+
+    bool LoopbackServer::send(const LoopbackCharacteristic *characteristic, const uint8_t *data, size_t len, uint16_t connHandle)
+    {
+        // 与 NimBLE 一致：发给全部连接时，只要有一个连接成功入队即视为成功
+        const auto &subscribers = characteristic->subscribers;
+        if (connHandle != gatt::CONN_ALL && !subscribers.contains(connHandle))
+            return false;
+        if (subscribers.empty())
+            return false;
+
+        // 负载只拷贝一次，各连接的发送缓冲只放引用
+        uint32_t payload = acquirePayload(data, len);
+        bool any = false;
+        if (connHandle != gatt::CONN_ALL)
+            any = enqueue(*clients[connHandle], characteristic, payload, len);
+        else
+        {
+            for (size_t i = 0; i < subscribers.size(); i++)
+                any |= enqueue(*clients[subscribers[i].connHandle], characteristic, payload, len);
+        }
+        if (payloads[payload].refs == 0)
+            freePayloads.push_back(payload);
+        return any;
+    }
+
+    uint32_t LoopbackServer::acquirePayload(const uint8_t *data, size_t len)
+    {
+        uint32_t index;
+        if (!freePayloads.empty())
+        {
+            index = freePayloads.back();
+            freePayloads.pop_back();
+        }
+        else
+        {
+            index = (uint32_t)payloads.size();
+            payloads.emplace_back();
+        }
+        Payload &payload = payloads[index];
+        if (len > MAX_PAYLOAD)
+            len = MAX_PAYLOAD;
+        payload.refs = 0;
+        payload.len = (uint16_t)len;
+        if (len)
+            memcpy(payload.data, data, len);
+        return index;
+    }
+
+    void LoopbackServer::releasePayload(uint32_t payload)
+    {
+        if (--payloads[payload].refs == 0)
+            freePayloads.push_back(payload);
+    }
+
+    bool LoopbackServer::enqueue(Client &client, const LoopbackCharacteristic *characteristic, uint32_t payload, size_t len)
+    {
+        if (client.queue.size() >= client.config.txQueueSize)
+        {
+            client.stats.dropped++;
+            return false;
+        }
+        size_t limit = client.config.mtu > 3 ? client.config.mtu - 3 : 0;
+        if (limit > MAX_PAYLOAD)
+            limit = MAX_PAYLOAD;
+        if (len > limit)
+        {
+            client.stats.truncated++;
+            len = limit;
+        }
+        client.queue.push_back({esp_timer_get_time(), payload, characteristic->getIndex(), (uint16_t)len});
+        payloads[payload].refs++;
+        client.stats.queued++;
+        return true;
+    }
+
+    void LoopbackServer::advance(int64_t nowUs)
+    {
+        for (auto client : clients)
+        {
+            while (client->connected && client->nextEventUs <= nowUs)
+            {
+                runEvent(*client);
+                client->nextEventUs += client->config.connIntervalUs;
+            }
+        }
+    }
+
+    void LoopbackServer::runEvent(Client &client)
+    {
+        ClientStats &stats = client.stats;
+        uint32_t depth = (uint32_t)client.queue.size();
+        stats.events++;
+        stats.depthSum += depth;
+        if (depth > stats.maxDepth)
+            stats.maxDepth = depth;
+
+        if (client.config.missPermille && nextRandom() % 1000 < client.config.missPermille)
+        {
+            stats.missedEvents++;
+            return;
+        }
+
+        // 调用方晚于事件时刻才 advance() 时，事件之后入队的包留到下一个事件
+        for (uint8_t i = 0; i < client.config.packetsPerEvent && !client.queue.empty(); i++)
+        {
+            const Packet &packet = client.queue.front();
+            if (packet.queuedUs > client.nextEventUs)
+                break;
+            uint32_t latency = (uint32_t)(client.nextEventUs - packet.queuedUs);
+            stats.delivered++;
+            stats.deliveredBytes += packet.len;
+            stats.latencySumUs += latency;
+            if (latency > stats.maxLatencyUs)
+                stats.maxLatencyUs = latency;
+            const uint8_t *data = payloads[packet.payload].data;
+            client.delivered[packet.characteristic]++;
+            client.last[packet.characteristic].assign(data, data + packet.len);
+            releasePayload(packet.payload);
+            client.queue.pop_front();
+        }
+    }
+
+    LoopbackServer::ClientStats LoopbackServer::getTotalStats() const
+    {
+        ClientStats total;
+        for (auto client : clients)
+        {
+            const ClientStats &s = client->stats;
+            total.queued += s.queued;
+            total.delivered += s.delivered;
+            total.deliveredBytes += s.deliveredBytes;
+            total.dropped += s.dropped;
+            total.truncated += s.truncated;
+            total.events += s.events;
+            total.missedEvents += s.missedEvents;
+            total.depthSum += s.depthSum;
+            total.latencySumUs += s.latencySumUs;
+            if (s.maxDepth > total.maxDepth)
+                total.maxDepth = s.maxDepth;
+            if (s.maxLatencyUs > total.maxLatencyUs)
+                total.maxLatencyUs = s.maxLatencyUs;
+        }
+        return total;
+    }
+
+    uint64_t LoopbackServer::getDeliveredCount(uint16_t connHandle, const LoopbackCharacteristic *characteristic) const
+    {
+        return clients[connHandle]->delivered[characteristic->getIndex()];
+    }
+
+    const std::vector<uint8_t> &LoopbackServer::getLastPayload(uint16_t connHandle,
+                                                               const LoopbackCharacteristic *characteristic) const
+    {
+        return clients[connHandle]->last[characteristic->getIndex()];
+    }
+
+    void LoopbackServer::resetStats()
+    {
+        for (auto client : clients)
+        {
+            client->stats = ClientStats();
+            for (auto &count : client->delivered)
+                count = 0;
+        }
+        for (auto &count : callCount)
+            count = 0;
+        calls.clear();
+    }
+
+    LoopbackCharacteristic *LoopbackServer::findCharacteristic(const gatt::Uuid &uuid) const
+    {
+        for (auto c : characteristics)
+        {
+            if (sameUuid(c->getUuid(), uuid))
+                return c;
+        }
+        return nullptr;
+    }
+
+    void LoopbackServer::startAdvertising()
+    {
+        if (tableRegistered)
+            return;
+        tableRegistered = true;
+        registered = characteristics.size();
+    }
+
+    LoopbackCharacteristic *LoopbackServer::discover(const gatt::Uuid &uuid) const
+    {
+        LoopbackCharacteristic *c = findCharacteristic(uuid);
+        return c && c->getIndex() < registered ? c : nullptr;
+    }
+
+    uint32_t LoopbackServer::nextRandom()
+    {
+        // xorshift32：与主机端 random() 相同，但状态独立，不影响 BikeData 的随机序列
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return randomState;
+    }
+}
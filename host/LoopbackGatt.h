@@ -0,0 +1,229 @@
+#pragma once
+// 主机端回环 GATT 传输：服务类照常调用 setValue/notify，这里记录每一次调用，
+// 并模拟 N 个已连接的中心设备：每个特征值按连接记录 CCCD，一次通知的负载只拷贝一份（引用计数），
+// 只向订阅了该特征值的连接的发送缓冲放入引用，每个连接在自己的连接事件上
+// 取走最多 packetsPerEvent 个包；缓冲满时 notify 失败（对应 NimBLE 的 BLE_HS_ENOMEM），
+// 连接事件可按概率丢失（干扰），缓冲中的包推迟到下一个事件。
+// 时间取自主机虚拟时钟并由调用方 advance() 推进，结果可复现。
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <vector>
+#include "GattBackend.h"
+#include "SubscriberSet.h"
+
+namespace host
+{
+    class LoopbackServer;
+
+    static const size_t LOOPBACK_MAX_CLIENTS = 64;
+
+    class LoopbackCharacteristic final : public gatt::Characteristic
+    {
+    public:
+        static const size_t MAX_VALUE_LEN = 512; // ATT 属性值最大长度
+
+        LoopbackCharacteristic(LoopbackServer *owner, uint16_t index, const gatt::Uuid &uuid, uint8_t properties);
+
+        void setValue(const uint8_t *data, size_t len) override;
+        using gatt::Characteristic::setValue;
+        bool notify() override;
+        bool notify(const uint8_t *data, size_t len, uint16_t connHandle) override;
+        bool indicate() override;
+        bool indicate(uint16_t connHandle) override;
+
+        const uint8_t *getData() const override { return value; }
+        size_t getLength() const override { return valueLen; }
+
+        void setWriteHandler(gatt::WriteHandler handler, void *ctx) override;
+
+        size_t getSubscriberCount() const override { return subscribers.size(); }
+
+        // 模拟中心设备写入
+        void write(uint16_t connHandle, const uint8_t *data, size_t len);
+
+        const gatt::Uuid &getUuid() const { return uuid; }
+        uint8_t getProperties() const { return properties; }
+        uint16_t getIndex() const { return index; }
+
+    private:
+        friend class LoopbackServer;
+
+        LoopbackServer *owner;
+        uint16_t index;
+        gatt::Uuid uuid;
+        uint8_t properties;
+        uint8_t value[MAX_VALUE_LEN] = {0};
+        size_t valueLen = 0;
+        gatt::WriteHandler writeHandler = nullptr;
+        void *writeCtx = nullptr;
+        SubscriberSet<LOOPBACK_MAX_CLIENTS> subscribers;
+
+        // 模拟中心设备写入 CCCD
+        void setCccd(uint16_t connHandle, uint16_t cccd);
+    };
+
+    class LoopbackService final : public gatt::Service
+    {
+    public:
+        LoopbackService(LoopbackServer *owner, const gatt::Uuid &uuid) : owner(owner), uuid(uuid) {}
+
+        gatt::Characteristic *createCharacteristic(const gatt::Uuid &uuid, uint8_t properties) override;
+        bool start() override { return true; }
+
+        const gatt::Uuid &getUuid() const { return uuid; }
+
+    private:
+        LoopbackServer *owner;
+        gatt::Uuid uuid;
+    };
+
+    class LoopbackServer final : public gatt::Server
+    {
+    public:
+        static const size_t MAX_PAYLOAD = 244; // DLE 下单包通知的上限 (ATT MTU 247)
+        static const size_t MAX_CLIENTS = LOOPBACK_MAX_CLIENTS;
+
+        struct ClientConfig
+        {
+            uint32_t connIntervalUs = 30000; // 连接间隔
+            uint32_t phaseUs = 0;            // 首个连接事件相对连接建立的偏移
+            uint8_t packetsPerEvent = 4;     // 每个连接事件最多送达的通知数
+            uint16_t txQueueSize = 12;       // 发送缓冲的包数，满时 notify 失败
+            uint16_t mtu = 23;               // ATT MTU，超过 MTU-3 的通知被截断
+            uint16_t missPermille = 0;       // 连接事件丢失的概率 (‰)
+            bool subscribeAll = true;        // 连接时订阅所有可通知的特征值
+        };
+
+        struct ClientStats
+        {
+            uint64_t queued = 0;       // 进入发送缓冲的通知
+            uint64_t delivered = 0;    // 送达的通知
+            uint64_t deliveredBytes = 0;
+            uint64_t dropped = 0;      // 缓冲满被拒绝的通知
+            uint64_t truncated = 0;    // 超过 MTU-3 被截断的通知
+            uint64_t events = 0;       // 连接事件数
+            uint64_t missedEvents = 0; // 丢失的连接事件
+            uint64_t depthSum = 0;     // 每个连接事件开始时的缓冲深度之和
+            uint32_t maxDepth = 0;
+            uint64_t latencySumUs = 0; // 入队到送达
+            uint32_t maxLatencyUs = 0;
+        };
+
+        enum CallType : uint8_t
+        {
+            CALL_SET_VALUE = 0,
+            CALL_NOTIFY,
+            CALL_INDICATE,
+            CALL_TYPE_COUNT
+        };
+
+        // 服务类对后端的一次调用
+        struct Call
+        {
+            int64_t timeUs;
+            uint16_t characteristic; // LoopbackCharacteristic::getIndex()
+            uint16_t connHandle;     // notify/indicate 的目标连接，其余为 gatt::CONN_ALL
+            uint16_t len;
+            uint8_t type; // CallType
+        };
+
+        explicit LoopbackServer(uint32_t seed = 1);
+        ~LoopbackServer();
+
+        LoopbackServer(const LoopbackServer &) = delete;
+        LoopbackServer &operator=(const LoopbackServer &) = delete;
+
+        gatt::Service *createService(const gatt::Uuid &uuid) override;
+
+        // 建立一个连接，返回连接句柄（从 0 开始递增）；超过 MAX_CLIENTS 时返回 gatt::CONN_ALL
+        uint16_t connect(const ClientConfig &config);
+        // 断开：清除该连接的全部订阅并丢弃发送缓冲，句柄不再复用
+        void disconnect(uint16_t connHandle);
+        void subscribe(uint16_t connHandle, const gatt::Uuid &uuid, bool enabled);
+        bool isConnected(uint16_t connHandle) const { return connHandle < clients.size() && clients[connHandle]->connected; }
+
+        // 处理 nowUs 之前（含）到期的全部连接事件
+        void advance(int64_t nowUs);
+
+        // 记录每一次调用（最多 maxCalls 条，超出后只计数）
+        void setRecording(bool enabled, size_t maxCalls = 1 << 20);
+        const std::vector<Call> &getCalls() const { return calls; }
+        uint64_t getCallCount(CallType type) const { return callCount[type]; }
+
+        size_t getClientCount() const { return clients.size(); }
+        // 尚未送达的共享负载数（每次扇出一份，送达或丢弃后释放）
+        size_t getPayloadsInFlight() const { return payloads.size() - freePayloads.size(); }
+        const ClientStats &getStats(uint16_t connHandle) const { return clients[connHandle]->stats; }
+        ClientStats getTotalStats() const;
+        size_t getQueueDepth(uint16_t connHandle) const { return clients[connHandle]->queue.size(); }
+        // 中心设备从该特征值收到的通知数与最后一个负载
+        uint64_t getDeliveredCount(uint16_t connHandle, const LoopbackCharacteristic *characteristic) const;
+        const std::vector<uint8_t> &getLastPayload(uint16_t connHandle, const LoopbackCharacteristic *characteristic) const;
+        void resetStats();
+
+        LoopbackCharacteristic *findCharacteristic(const gatt::Uuid &uuid) const;
+
+        // 开始广播：与 NimBLE 相同，GATT 表在第一次开始广播时注册，
+        // 之后创建的服务直到 GATT 重置都不会被中心设备发现
+        void startAdvertising();
+        // 中心设备的服务发现：只返回已注册的特征值
+        LoopbackCharacteristic *discover(const gatt::Uuid &uuid) const;
+        size_t getRegisteredCount() const { return registered; }
+
+    private:
+        friend class LoopbackCharacteristic;
+        friend class LoopbackService;
+
+        // 一次通知的负载：所有订阅连接的发送缓冲共享同一份
+        struct Payload
+        {
+            uint32_t refs;
+            uint16_t len;
+            uint8_t data[MAX_PAYLOAD];
+        };
+
+        // 发送缓冲中的一项只是对共享负载的引用
+        struct Packet
+        {
+            int64_t queuedUs;
+            uint32_t payload; // payloads 下标
+            uint16_t characteristic;
+            uint16_t len;     // 按该连接的 MTU 截断后的长度
+        };
+
+        struct Client
+        {
+            ClientConfig config;
+            ClientStats stats;
+            int64_t nextEventUs;
+            bool connected = true;
+            std::deque<Packet> queue;
+            std::vector<uint64_t> delivered;       // 按特征值序号
+            std::vector<std::vector<uint8_t>> last; // 按特征值序号
+        };
+
+        std::vector<LoopbackService *> services;
+        std::vector<LoopbackCharacteristic *> characteristics;
+        std::vector<Client *> clients;
+        std::vector<Payload> payloads;
+        std::vector<uint32_t> freePayloads;
+        std::vector<Call> calls;
+        uint64_t callCount[CALL_TYPE_COUNT] = {};
+        bool recording = false;
+        size_t maxCalls = 0;
+        bool tableRegistered = false;
+        size_t registered = 0; // 已注册的特征值数
+        uint32_t randomState;
+
+        LoopbackCharacteristic *addCharacteristic(const gatt::Uuid &uuid, uint8_t properties);
+        void record(CallType type, const LoopbackCharacteristic *characteristic, size_t len, uint16_t connHandle);
+        bool send(const LoopbackCharacteristic *characteristic, const uint8_t *data, size_t len, uint16_t connHandle);
+        bool enqueue(Client &client, const LoopbackCharacteristic *characteristic, uint32_t payload, size_t len);
+        uint32_t acquirePayload(const uint8_t *data, size_t len);
+        void releasePayload(uint32_t payload);
+        void runEvent(Client &client);
+        void ensureSlots(Client &client);
+        uint32_t nextRandom();
+    };
+}
@@ -0,0 +1,5 @@
+#pragma once
+// 主机端 esp_timer 兼容层：时间取自 Arduino.h 中的虚拟时钟
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,7 @@
+#pragma once
+// 主机端 FreeRTOS 兼容层：只提供 StatusLed.h 等头文件用到的类型
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
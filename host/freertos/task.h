@@ -0,0 +1,5 @@
+#pragma once
+// 主机端 FreeRTOS 任务兼容层：只提供类型，主机端不创建任务
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
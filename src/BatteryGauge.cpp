@@ -0,0 +1,99 @@
+#include "BatteryGauge.h"
+
+void BatteryGauge::reset()
+{
+    smoothed = 0;
+    centiPercent = 0;
+    level = 0;
+    frames = 0;
+    changes = 0;
+    invalid = 0;
+}
+
+uint16_t BatteryGauge::trimmedMean(const uint16_t *samples, size_t count)
+{
+    if (count == 0)
+        return 0;
+    if (count > MAX_FRAME)
+        count = MAX_FRAME;
+
+    // 插入排序：每帧最多 MAX_FRAME 个采样，每隔数秒一帧
+    uint16_t sorted[MAX_FRAME];
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t v = samples[i];
+        size_t j = i;
+        while (j > 0 && sorted[j - 1] > v)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    size_t begin = count / 4;
+    size_t end = count - count / 4;
+    uint32_t sum = 0;
+    for (size_t i = begin; i < end; i++)
+        sum += sorted[i];
+    size_t n = end - begin;
+    return (uint16_t)((sum + n / 2) / n);
+}
+
+uint16_t BatteryGauge::toCentiPercent(uint16_t millivolts) const
+{
+    const CurvePoint *curve = config.curve;
+    const size_t n = config.curvePoints;
+    if (n == 0)
+        return 0;
+    if (millivolts <= curve[0].millivolts)
+        return curve[0].centiPercent;
+    if (millivolts >= curve[n - 1].millivolts)
+        return curve[n - 1].centiPercent;
+
+    size_t i = 1;
+    while (curve[i].millivolts < millivolts)
+        i++;
+    const CurvePoint &lo = curve[i - 1];
+    const CurvePoint &hi = curve[i];
+    uint32_t span = hi.millivolts - lo.millivolts;
+    uint32_t offset = millivolts - lo.millivolts;
+    return (uint16_t)(lo.centiPercent + ((hi.centiPercent - lo.centiPercent) * offset + span / 2) / span);
+}
+
+bool BatteryGauge::addFrame(const uint16_t *pinMillivolts, size_t count)
+{
+    if (count == 0 || config.dividerDen == 0)
+        return false;
+
+    uint32_t millivolts = (uint32_t)trimmedMean(pinMillivolts, count) * config.dividerNum / config.dividerDen;
+    if (millivolts < config.minValidMillivolts || millivolts > config.maxValidMillivolts)
+    {
+        invalid++;
+        return false;
+    }
+    uint32_t sample = millivolts << SMOOTH_BITS;
+
+    // 首帧直接作为初值，之后 y += (x - y) / 2^shift
+    if (frames == 0)
+        smoothed = sample;
+    else
+        smoothed = (uint32_t)((int32_t)smoothed + (((int32_t)sample - (int32_t)smoothed) >> config.smoothShift));
+    frames++;
+
+    centiPercent = toCentiPercent(getMillivolts());
+
+    // 上报值为 level 时，只有估计值离开 (level - 0.5% - 下降滞回, level + 0.5% + 上升滞回) 才改变
+    uint8_t next = (uint8_t)((centiPercent + 50) / 100);
+    if (frames > 1)
+    {
+        int32_t distance = (int32_t)centiPercent - (int32_t)level * 100;
+        int32_t fall = 50 + config.hysteresisCenti;
+        int32_t rise = 50 + config.riseHysteresisCenti;
+        if (distance > -fall && distance < rise)
+            return false;
+    }
+    level = next;
+    changes++;
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 电池电量估计（与平台无关）：输入一帧 ADC 采样（已按芯片校准换算为引脚 mV），
+// 依次做帧内截尾平均、分压比还原、帧间指数平滑与电压-电量曲线插值，
+// 电量只在越过带滞回的整数百分比边界时改变。上升的滞回更大：负载下沉的电压在停止骑行后回升，
+// 不应让电量回跳；充电时电压整体抬高，仍能越过。只用整数运算，可在主机上测试；
+// 固件中由 BatteryMonitor 以连续 ADC (DMA) 采集一帧后调用。
+class BatteryGauge
+{
+public:
+    static const size_t MAX_FRAME = 256; // 每帧最多采样数
+
+    // 电压-电量曲线上的一点，按电压升序排列
+    struct CurvePoint
+    {
+        uint16_t millivolts;
+        uint16_t centiPercent; // 0.01% 单位
+    };
+
+    static const size_t MAX_CURVE_POINTS = 16;
+
+    struct Config
+    {
+        uint16_t dividerNum = 2;             // 电池电压 = 引脚电压 * dividerNum / dividerDen
+        uint16_t dividerDen = 1;             // 默认两只等值电阻分压
+        uint8_t smoothShift = 3;             // 帧间平滑系数 1/2^smoothShift，0 表示不平滑
+        uint16_t hysteresisCenti = 50;       // 下降：估计值越过整数边界后再多移动 0.5% 才改变
+        uint16_t riseHysteresisCenti = 400;  // 上升：再多移动 4%
+        uint16_t minValidMillivolts = 2500;  // 超出范围的帧丢弃（未接电池或分压断开时引脚悬空）
+        uint16_t maxValidMillivolts = 4500;
+        size_t curvePoints = 11;
+        CurvePoint curve[MAX_CURVE_POINTS] = {
+            // 单节锂离子电池小电流放电的开路电压曲线
+            {3300, 0},
+            {3500, 500},
+            {3600, 1000},
+            {3680, 2000},
+            {3740, 3000},
+            {3790, 4000},
+            {3840, 5000},
+            {3900, 6000},
+            {3970, 7000},
+            {4060, 8500},
+            {4180, 10000},
+        };
+    };
+
+    BatteryGauge() {}
+    explicit BatteryGauge(const Config &config) : config(config) {}
+
+    void reset();
+
+    // 处理一帧引脚电压 (mV)，返回 true 表示电量百分比改变（首个有效帧总是返回 true）
+    bool addFrame(const uint16_t *pinMillivolts, size_t count);
+
+    bool hasLevel() const { return frames > 0; }
+    uint8_t getLevel() const { return level; }
+    // 平滑后的电池电压 (mV) 与未经滞回的电量 (0.01%)
+    uint16_t getMillivolts() const { return (uint16_t)(smoothed >> SMOOTH_BITS); }
+    uint16_t getCentiPercent() const { return centiPercent; }
+    uint32_t getFrameCount() const { return frames; }
+    uint32_t getChangeCount() const { return changes; }
+    uint32_t getInvalidCount() const { return invalid; }
+
+    const Config &getConfig() const { return config; }
+
+    // 截尾平均：排序后去掉最低与最高各 1/4，对中间一半取平均，去除射频突发等尖峰
+    static uint16_t trimmedMean(const uint16_t *samples, size_t count);
+    // 电池电压 (mV) 到电量 (0.01%)：曲线两端之外截断，之间线性插值
+    uint16_t toCentiPercent(uint16_t millivolts) const;
+
+private:
+    static const uint8_t SMOOTH_BITS = 4; // 平滑状态的定点小数位
+
+    Config config;
+    uint32_t smoothed = 0; // mV << SMOOTH_BITS
+    uint16_t centiPercent = 0;
+    uint8_t level = 0;
+    uint32_t frames = 0;
+    uint32_t changes = 0;
+    uint32_t invalid = 0;
+};
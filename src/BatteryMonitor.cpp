@@ -0,0 +1,278 @@
+#include "BatteryMonitor.h"
+#include <soc/soc_caps.h>
+#include "Log.h"
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <driver/adc.h>
+#endif
+
+// 每个转换结果在 DMA 缓冲中占 SOC_ADC_DIGI_RESULT_BYTES 字节（S3 为 TYPE2 格式）
+static const size_t RESULT_BYTES = SOC_ADC_DIGI_RESULT_BYTES;
+
+bool BatteryMonitor::begin(const Config &cfg)
+{
+    end();
+    config = cfg;
+    if (config.frameSamples == 0 || config.frameSamples > BatteryGauge::MAX_FRAME)
+        config.frameSamples = BatteryGauge::MAX_FRAME;
+    gauge = BatteryGauge(config.gauge);
+    level.store(-1, std::memory_order_relaxed);
+
+    int8_t ch = digitalPinToAnalogChannel(config.pin);
+    if (ch < 0 || ch >= SOC_ADC_CHANNEL_NUM(0))
+    {
+        LOG_ERROR("[ERROR] BatteryMonitor: GPIO%u 不是 ADC1 引脚", (unsigned)config.pin);
+        return false;
+    }
+    channel = (uint8_t)ch;
+    if (!initAdc())
+        return false;
+
+    if (xTaskCreatePinnedToCore(taskEntry, "battery", config.taskStackSize, this,
+                                config.taskPriority, &task, config.taskCore) != pdPASS)
+    {
+        task = nullptr;
+        deinitAdc();
+        LOG_ERROR("[ERROR] BatteryMonitor: 创建监测任务失败");
+        return false;
+    }
+    LOG_INFO("[BAT] GPIO%u, 每 %u ms 采集 %u 点", (unsigned)config.pin, (unsigned)config.periodMs,
+             (unsigned)config.frameSamples);
+    return true;
+}
+
+void BatteryMonitor::end()
+{
+    if (task)
+    {
+        vTaskDelete(task);
+        task = nullptr;
+    }
+    deinitAdc();
+}
+
+bool BatteryMonitor::getLevel(uint8_t &out) const
+{
+    int16_t value = level.load(std::memory_order_relaxed);
+    if (value < 0)
+        return false;
+    out = (uint8_t)value;
+    return true;
+}
+
+void BatteryMonitor::taskEntry(void *arg)
+{
+    static_cast<BatteryMonitor *>(arg)->run();
+}
+
+void BatteryMonitor::run()
+{
+    uint16_t samples[BatteryGauge::MAX_FRAME];
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        size_t count = readFrame(samples, config.frameSamples);
+        bool changed = gauge.addFrame(samples, count);
+        millivolts.store(gauge.getMillivolts(), std::memory_order_relaxed);
+        frames.store(gauge.getFrameCount(), std::memory_order_relaxed);
+        invalid.store(gauge.getInvalidCount(), std::memory_order_relaxed);
+        if (changed)
+        {
+            level.store(gauge.getLevel(), std::memory_order_relaxed);
+            changes.store(gauge.getChangeCount(), std::memory_order_relaxed);
+            if (config.onLevel)
+                config.onLevel(gauge.getLevel());
+        }
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(config.periodMs));
+    }
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+
+bool BatteryMonitor::initAdc()
+{
+    const uint32_t frameBytes = config.frameSamples * RESULT_BYTES;
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = frameBytes * 2;
+    handleConfig.conv_frame_size = frameBytes;
+    esp_err_t err = adc_continuous_new_handle(&handleConfig, &adc);
+    if (err != ESP_OK)
+    {
+        adc = nullptr;
+        LOG_ERROR("[ERROR] BatteryMonitor: 连续 ADC 初始化失败 (%d)", (int)err);
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_11; // 约 0-3.1 V
+    pattern.channel = channel;
+    pattern.unit = ADC_UNIT_1;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    adc_continuous_config_t digi = {};
+    digi.pattern_num = 1;
+    digi.adc_pattern = &pattern;
+    digi.sample_freq_hz = config.sampleFreqHz;
+    digi.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digi.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    err = adc_continuous_config(adc, &digi);
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("[ERROR] BatteryMonitor: 连续 ADC 配置失败 (%d)", (int)err);
+        deinitAdc();
+        return false;
+    }
+
+    // 曲线拟合校准使用 eFuse 中的出厂参数；不可用时按理想线性换算
+    adc_cali_curve_fitting_config_t caliConfig = {};
+    caliConfig.unit_id = ADC_UNIT_1;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    caliConfig.chan = (adc_channel_t)channel;
+#endif
+    caliConfig.atten = ADC_ATTEN_DB_11;
+    caliConfig.bitwidth = ADC_BITWIDTH_DEFAULT;
+    if (adc_cali_create_scheme_curve_fitting(&caliConfig, &cali) != ESP_OK)
+    {
+        cali = nullptr;
+        LOG_WARN("[BAT] 无 ADC 校准数据，电压误差较大");
+    }
+    return true;
+}
+
+void BatteryMonitor::deinitAdc()
+{
+    if (adc)
+    {
+        adc_continuous_deinit(adc);
+        adc = nullptr;
+    }
+    if (cali)
+    {
+        adc_cali_delete_scheme_curve_fitting(cali);
+        cali = nullptr;
+    }
+}
+
+uint16_t BatteryMonitor::toMillivolts(uint32_t raw)
+{
+    int mv = 0;
+    if (cali && adc_cali_raw_to_voltage(cali, (int)raw, &mv) == ESP_OK)
+        return (uint16_t)mv;
+    return (uint16_t)(raw * 3100 / ((1 << SOC_ADC_DIGI_MAX_BITWIDTH) - 1));
+}
+
+size_t BatteryMonitor::readFrame(uint16_t *out, size_t maxSamples)
+{
+    uint8_t buffer[BatteryGauge::MAX_FRAME * RESULT_BYTES];
+    const uint32_t frameBytes = maxSamples * RESULT_BYTES;
+    const uint32_t timeoutMs = 100 + 2000 * maxSamples / config.sampleFreqHz;
+    if (adc_continuous_start(adc) != ESP_OK)
+        return 0;
+
+    // 停止前 DMA 可能已写入下一帧的一部分，下次启动时先读到的是上个周期的残留，丢弃第一帧
+    uint32_t got = 0;
+    size_t count = 0;
+    if (adc_continuous_read(adc, buffer, frameBytes, &got, timeoutMs) == ESP_OK &&
+        adc_continuous_read(adc, buffer, frameBytes, &got, timeoutMs) == ESP_OK)
+    {
+        for (uint32_t i = 0; i + RESULT_BYTES <= got && count < maxSamples; i += RESULT_BYTES)
+        {
+            const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&buffer[i];
+            if (p->type2.channel == channel)
+                out[count++] = toMillivolts(p->type2.data);
+        }
+    }
+    adc_continuous_stop(adc);
+    return count;
+}
+
+#else
+
+bool BatteryMonitor::initAdc()
+{
+    const uint32_t frameBytes = config.frameSamples * RESULT_BYTES;
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = frameBytes * 2;
+    init.conv_num_each_intr = frameBytes;
+    init.adc1_chan_mask = BIT(channel);
+    init.adc2_chan_mask = 0;
+    esp_err_t err = adc_digi_initialize(&init);
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("[ERROR] BatteryMonitor: 连续 ADC 初始化失败 (%d)", (int)err);
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_11; // 约 0-3.1 V
+    pattern.channel = channel;
+    pattern.unit = 0; // ADC1
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    adc_digi_configuration_t digi = {};
+    digi.conv_limit_en = false;
+    digi.conv_limit_num = 250;
+    digi.pattern_num = 1;
+    digi.adc_pattern = &pattern;
+    digi.sample_freq_hz = config.sampleFreqHz;
+    digi.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digi.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    err = adc_digi_controller_configure(&digi);
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("[ERROR] BatteryMonitor: 连续 ADC 配置失败 (%d)", (int)err);
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    // eFuse 中的两点或参考电压校准；都没有时使用默认 1100 mV 参考
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &cali);
+    adcReady = true;
+    return true;
+}
+
+void BatteryMonitor::deinitAdc()
+{
+    if (adcReady)
+    {
+        adc_digi_deinitialize();
+        adcReady = false;
+    }
+}
+
+uint16_t BatteryMonitor::toMillivolts(uint32_t raw)
+{
+    return (uint16_t)esp_adc_cal_raw_to_voltage(raw, &cali);
+}
+
+size_t BatteryMonitor::readFrame(uint16_t *out, size_t maxSamples)
+{
+    uint8_t buffer[BatteryGauge::MAX_FRAME * RESULT_BYTES];
+    const uint32_t frameBytes = maxSamples * RESULT_BYTES;
+    const uint32_t timeoutMs = 100 + 2000 * maxSamples / config.sampleFreqHz;
+    if (adc_digi_start() != ESP_OK)
+        return 0;
+
+    // 停止前 DMA 可能已写入下一帧的一部分，下次启动时先读到的是上个周期的残留，丢弃第一帧
+    uint32_t got = 0;
+    size_t count = 0;
+    if (adc_digi_read_bytes(buffer, frameBytes, &got, timeoutMs) == ESP_OK &&
+        adc_digi_read_bytes(buffer, frameBytes, &got, timeoutMs) == ESP_OK)
+    {
+        for (uint32_t i = 0; i + RESULT_BYTES <= got && count < maxSamples; i += RESULT_BYTES)
+        {
+            const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&buffer[i];
+            if (p->type2.channel == channel)
+                out[count++] = toMillivolts(p->type2.data);
+        }
+    }
+    adc_digi_stop();
+    return count;
+}
+
+#endif
+
+void BatteryMonitor::report()
+{
+    int16_t value = level.load(std::memory_order_relaxed);
+    LOG_INFO("[BAT] level=%d%% voltage=%u mV", (int)value, (unsigned)getMillivolts());
+    LOG_INFO("[BAT] frames=%u invalid=%u changes=%u", (unsigned)frames.load(std::memory_order_relaxed),
+             (unsigned)invalid.load(std::memory_order_relaxed), (unsigned)changes.load(std::memory_order_relaxed));
+}
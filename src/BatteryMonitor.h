@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <esp_idf_version.h>
+#include "BatteryGauge.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_adc/adc_continuous.h>
+#include <esp_adc/adc_cali.h>
+#else
+#include <esp_adc_cal.h>
+#endif
+
+// 电池监测：低优先级任务每隔 periodMs 用连续 ADC 以 DMA 采集一帧分压引脚电压，
+// 交给 BatteryGauge 平滑并换算电量，电量百分比改变时才调用 onLevel（更新电池服务并通知）。
+// 采集期间任务阻塞在 DMA 完成上，不像 analogRead 那样逐次忙等转换；两次采集之间 ADC 停止，
+// 因此每个周期只唤醒一次。分压必须接在 ADC1 的引脚上（S3 的 GPIO1-10），ADC2 与射频共用。
+class BatteryMonitor
+{
+public:
+    static const uint8_t DEFAULT_PIN = 1; // GPIO1 = ADC1 通道 0
+
+    struct Config
+    {
+        uint8_t pin = DEFAULT_PIN;
+        uint32_t periodMs = 10000;     // 采集周期，电池电量变化缓慢
+        uint16_t frameSamples = 64;    // 每帧采样数，不超过 BatteryGauge::MAX_FRAME
+        uint32_t sampleFreqHz = 20000; // 一帧约 3.2 ms
+        BatteryGauge::Config gauge;
+        void (*onLevel)(uint8_t level) = nullptr; // 电量改变时在监测任务中调用
+        UBaseType_t taskPriority = 1;              // 低于采样 (6) 与通知 (5) 任务
+        uint32_t taskStackSize = 4096;             // DMA 读缓冲与采样帧在栈上
+        BaseType_t taskCore = 1;
+    };
+
+    bool begin(const Config &config);
+    void end();
+
+    // 尚无有效测量时返回 false
+    bool getLevel(uint8_t &level) const;
+    uint16_t getMillivolts() const { return millivolts.load(std::memory_order_relaxed); }
+
+    // 输出电压、电量与帧计数（串口命令 'V'）
+    void report();
+
+private:
+    Config config;
+    BatteryGauge gauge;
+    TaskHandle_t task = nullptr;
+    uint8_t channel = 0;
+
+    std::atomic<int16_t> level{-1};
+    std::atomic<uint16_t> millivolts{0};
+    std::atomic<uint32_t> frames{0};
+    std::atomic<uint32_t> invalid{0};
+    std::atomic<uint32_t> changes{0};
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    adc_continuous_handle_t adc = nullptr;
+    adc_cali_handle_t cali = nullptr;
+#else
+    esp_adc_cal_characteristics_t cali;
+    bool adcReady = false;
+#endif
+
+    bool initAdc();
+    void deinitAdc();
+    // 采集一帧并换算为引脚电压 (mV)，返回有效采样数
+    size_t readFrame(uint16_t *pinMillivolts, size_t maxSamples);
+    uint16_t toMillivolts(uint32_t raw);
+
+    static void taskEntry(void *arg);
+    void run();
+};
@@ -1,23 +1,38 @@
 #include "BatteryService.h"
-#include "BLE2902.h"
 
-BatteryService::BatteryService(BLEServer *server)
+BatteryService::BatteryService(gatt::Server *server)
 {
+    status = init(server);
+}
+
+Status BatteryService::init(gatt::Server *server)
+{
+    if (!server)
+        return Status::error(STATUS_INVALID_ARGUMENT);
+
     service = server->createService(BAT_UUID);
+    if (!service)
+        return Status::error(STATUS_SERVICE_FAILED, BAT_UUID);
 
     battLevelChar = service->createCharacteristic(
         BAT_LEVEL_UUID,
-        BLECharacteristic::PROPERTY_READ |
-            BLECharacteristic::PROPERTY_NOTIFY);
+        CHARACTERISTIC_PROPERTY_READ |
+            CHARACTERISTIC_PROPERTY_NOTIFY);
+    if (!battLevelChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, BAT_LEVEL_UUID);
 
     // 设置初始值
     uint8_t level = 100;
     battLevelChar->setValue(&level, 1);
-    battLevelChar->addDescriptor(new BLE2902());
+    if (!service->start())
+        return Status::error(STATUS_START_FAILED, BAT_UUID);
+    return Status::success();
 }
 
 void BatteryService::updateLevel(uint8_t level)
 {
+    if (!status.ok())
+        return;
     battLevelChar->setValue(&level, 1);
     battLevelChar->notify();
 }
\ No newline at end of file
@@ -1,13 +1,20 @@
 #pragma once
 #include "BLEConfig.h"
+#include "Status.h"
 
 class BatteryService
 {
 public:
-    BatteryService(BLEServer *server);
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    BatteryService(gatt::Server *server);
     void updateLevel(uint8_t level);
 
+    Status getStatus() const { return status; }
+
 private:
-    BLEService *service;
-    BLECharacteristic *battLevelChar;
+    gatt::Service *service = nullptr;
+    gatt::Characteristic *battLevelChar = nullptr;
+    Status status;
+
+    Status init(gatt::Server *server);
 };
\ No newline at end of file
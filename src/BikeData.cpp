@@ -5,11 +5,13 @@ BikeData::BikeData()
     // 初始化数据
     data.wheel_rev = 1; // 从1开始，确保有初始值
     data.w_event_time = 0;
+    data.w_event_time_2048 = 0;
     data.crank_rev = 1; // 从1开始，确保有初始值
     data.c_event_time = 0;
     data.power = MIN_POWER;
     data.speed = 0;
     data.cadence = 0;
+    data.energy = 0;
 
     // 初始化当前状态
     current_speed = 15.0;   // 直接从目标速度开始
@@ -39,36 +41,76 @@ float BikeData::constrainValue(float value, float min, float max)
     return value;
 }
 
-uint32_t BikeData::safeAdd(uint32_t a, uint32_t b)
+uint8_t BikeData::update()
 {
-    // 检查溢出
-    if (b > UINT32_MAX - a)
-    {
-        return UINT32_MAX; // 溢出保护
-    }
-    return a + b;
+    return update((uint64_t)esp_timer_get_time());
 }
 
-uint16_t BikeData::safeAdd(uint16_t a, uint16_t b)
+uint8_t BikeData::update(uint64_t now_us)
 {
-    // 检查溢出
-    if (b > UINT16_MAX - a)
+    // 毫秒与微秒取自同一时刻，保证回放时可以精确重现
+    unsigned long current_time = (unsigned long)(now_us / 1000);
+    tick_us = (uint32_t)now_us;
+
+    // 安全检查：防止millis溢出或无效
+    if (current_time == 0)
+    {
+        return 0;
+    }
+
+    // 记录更新前的值，用于生成事件位
+    const uint32_t prev_wheel_rev = data.wheel_rev;
+    const uint16_t prev_crank_rev = data.crank_rev;
+    const int16_t prev_power = data.power;
+    const uint16_t prev_energy = data.energy;
+
+    if (source == SOURCE_KEISER)
+    {
+        updateKeiser(current_time);
+    }
+    else if (source == SOURCE_SCENARIO)
+    {
+        updateScenario(now_us);
+    }
+    else if (source == SOURCE_PULSE)
     {
-        return UINT16_MAX; // 溢出保护
+        updatePulse(now_us);
     }
-    return a + b;
+    else
+    {
+        simulate(current_time);
+    }
+
+    // 上一周期的功率持续到本次更新
+    accumulateEnergy(now_us, prev_power);
+
+    uint8_t events = 0;
+    if (data.wheel_rev != prev_wheel_rev)
+        events |= EVENT_WHEEL;
+    if (data.crank_rev != prev_crank_rev)
+        events |= EVENT_CRANK;
+    if (data.power != prev_power)
+        events |= EVENT_POWER;
+    if (data.energy != prev_energy)
+        events |= EVENT_ENERGY;
+    return events;
 }
 
-void BikeData::update()
+void BikeData::accumulateEnergy(uint64_t now_us, int16_t power)
 {
-    unsigned long current_time = millis();
-
-    // 安全检查：防止millis溢出或无效
-    if (current_time == 0)
+    if (last_energy_us != 0 && now_us > last_energy_us && power > 0)
     {
-        return;
+        energy_wus += (uint64_t)power * (now_us - last_energy_us);
     }
+    last_energy_us = now_us;
+
+    // 1 kJ = 1e9 W·us；CP 字段为 16 位，饱和而不回绕
+    uint64_t kj = energy_wus / 1000000000ULL;
+    data.energy = kj > UINT16_MAX ? UINT16_MAX : (uint16_t)kj;
+}
 
+void BikeData::simulate(unsigned long current_time)
+{
     // 确保至少有一个数据更新
     bool dataUpdated = false;
 
@@ -103,12 +145,6 @@ void BikeData::update()
         updateCadence();
         updatePower();
     }
-
-    // 确保数据永远不为零
-    if (data.wheel_rev == 0)
-        data.wheel_rev = 1;
-    if (data.crank_rev == 0)
-        data.crank_rev = 1;
 }
 
 void BikeData::updateSpeed()
@@ -133,16 +169,21 @@ void BikeData::updateSpeed()
     // 限制速度范围
     current_speed = constrainValue(current_speed, 0.0f, MAX_SPEED);
 
-    // 计算轮转数 - 使用安全计算
-    float wheel_rev_per_second = constrainValue((current_speed * 1000.0) / (3600.0 * WHEEL_CIRCUMFERENCE), 0.0f, 20.0f);
-    uint32_t wheel_rev_increment = (uint32_t)(wheel_rev_per_second * 0.1); // 0.1秒的轮转数
-
-    // 限制增量为合理值，防止异常大的值
-    wheel_rev_increment = min(wheel_rev_increment, (uint32_t)10);
+    advanceWheel();
+}
 
-    // 安全地增加轮转数
-    data.wheel_rev = safeAdd(data.wheel_rev, wheel_rev_increment);
-    data.w_event_time = (uint16_t)(millis() & 0xFFFF);
+void BikeData::advanceWheel()
+{
+    // 计算轮转数 - 按实际经过时间累加，保留不足一圈的部分
+    float wheel_rev_per_second = constrainValue((current_speed * 1000.0) / (3600.0 * WHEEL_CIRCUMFERENCE), 0.0f, 20.0f);
+    // 转速已在上面限幅；增量不再截断：累加器已按整圈推进事件时间，截断会让长时间停顿后
+    // 转数少于事件时间所对应的圈数，中心设备算出错误的速度
+    uint32_t wheel_rev_increment = wheelAccumulator.advance(wheel_rev_per_second, tick_us);
+
+    // 累计圈数按规范回绕（CSC 32 位），事件时间取最后一个整圈的时刻
+    data.wheel_rev += wheel_rev_increment;
+    data.w_event_time = wheelAccumulator.eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
+    data.w_event_time_2048 = wheelAccumulator.eventTime(RevolutionAccumulator::CP_WHEEL_TIME_UNIT);
     data.speed = current_speed;
 }
 
@@ -168,16 +209,20 @@ void BikeData::updateCadence()
     // 限制踏频范围
     current_cadence = constrainValue(current_cadence, 0.0f, MAX_CADENCE);
 
-    // 计算踏频数 - 使用安全计算
-    float crank_rev_per_second = constrainValue(current_cadence / 60.0, 0.0f, 5.0f);
-    uint16_t crank_rev_increment = (uint16_t)(crank_rev_per_second * 0.1); // 0.1秒的踏频数
+    advanceCrank();
+    data.cadence = filterCadence(current_cadence);
+}
 
-    // 限制增量为合理值，防止异常大的值
-    crank_rev_increment = min(crank_rev_increment, (uint16_t)5);
+void BikeData::advanceCrank()
+{
+    // 计算踏频数 - 按实际经过时间累加，保留不足一圈的部分
+    float crank_rev_per_second = constrainValue(current_cadence / 60.0, 0.0f, 5.0f);
+    // 与车轮相同，增量不截断，转数与事件时间保持一致
+    uint32_t crank_rev_increment = crankAccumulator.advance(crank_rev_per_second, tick_us);
 
-    // 安全地增加踏频数
-    data.crank_rev = safeAdd(data.crank_rev, crank_rev_increment);
-    data.c_event_time = (uint16_t)(millis() & 0xFFFF);
+    // 累计圈数按规范回绕（16 位），事件时间取最后一个整圈的时刻
+    data.crank_rev += (uint16_t)crank_rev_increment;
+    data.c_event_time = crankAccumulator.eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
     data.cadence = current_cadence;
 }
 
@@ -205,12 +250,239 @@ void BikeData::updatePower()
     float power = base_power * (0.8 + 0.2 * cadence_factor);
 
     // 添加一些随机波动，但更为保守
-    int16_t rand_factor = random(-50, 50);
+    int16_t rand_factor = drawRandom(-50, 50);
     power *= (1.0 + (rand_factor / 1000.0));
 
     // 限制功率范围
     power = constrainValue(power, MIN_POWER, MAX_POWER);
 
     // 设置功率
-    data.power = (int16_t)power;
-}
\ No newline at end of file
+    data.power = powerFilter.push((int16_t)power);
+}
+
+float BikeData::filterCadence(float cadence)
+{
+    // 未启用时原样返回，不经过 0.1 rpm 量化
+    if (!cadenceFilter.isEnabled())
+        return cadence;
+    return cadenceFilter.push((int16_t)lroundf(cadence * 10.0f)) / 10.0f;
+}
+
+void BikeData::setFilters(const SampleFilter::Config &power, const SampleFilter::Config &cadence)
+{
+    powerFilter.configure(power);
+    cadenceFilter.configure(cadence);
+}
+void BikeData::setSource(Source newSource)
+{
+    source = newSource;
+    last_keiser_sample = 0;
+    keiser_pending = false;
+    powerFilter.reset();
+    cadenceFilter.reset();
+}
+
+void BikeData::setScenario(Scenario *newScenario)
+{
+    setSource(SOURCE_SCENARIO);
+    scenario = newScenario;
+    scenario_started = false;
+}
+
+void BikeData::updateScenario(uint64_t now_us)
+{
+    if (!scenario)
+    {
+        current_speed = 0;
+        current_cadence = 0;
+        data.power = 0;
+        return;
+    }
+    if (!scenario_started)
+    {
+        // 从脚本给出的计数与事件时间开始，便于在短时间内覆盖回绕
+        const Scenario::Start &start = scenario->getStart();
+        scenario->begin(now_us);
+        data.wheel_rev = start.wheelRev;
+        data.crank_rev = start.crankRev;
+        wheelAccumulator.reset(tick_us, start.clockUs);
+        crankAccumulator.reset(tick_us, start.clockUs);
+        scenario_started = true;
+    }
+
+    // 每次调用推进一次，不按 100ms 节流，支持 kHz 采样
+    Scenario::Values v = scenario->sample(now_us);
+    current_speed = constrainValue(v.speed, 0.0f, 150.0f);
+    current_cadence = constrainValue(v.cadence, 0.0f, 250.0f);
+    advanceWheel();
+    advanceCrank();
+    data.cadence = filterCadence(current_cadence);
+    data.power = powerFilter.push((int16_t)constrainValue(v.power, 0.0f, 4000.0f));
+}
+
+void BikeData::setPulseSource(PulseSource *newPulses)
+{
+    setSource(SOURCE_PULSE);
+    pulses = newPulses;
+    wheelPulses.reset();
+    crankPulses.reset();
+}
+
+void BikeData::updatePulse(uint64_t now_us)
+{
+    if (!pulses)
+    {
+        current_speed = 0;
+        current_cadence = 0;
+        data.power = 0;
+        return;
+    }
+
+    // 每个脉冲是一整圈，事件时间直接取中断记录的时刻
+    uint32_t time_us;
+    while (pulses->pop(PulseSource::CHANNEL_WHEEL, time_us))
+    {
+        wheelPulses.addPulse(PulseTracker::extend(now_us, time_us));
+        data.wheel_rev++;
+    }
+    while (pulses->pop(PulseSource::CHANNEL_CRANK, time_us))
+    {
+        crankPulses.addPulse(PulseTracker::extend(now_us, time_us));
+        data.crank_rev++;
+    }
+    data.w_event_time = wheelPulses.eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
+    data.w_event_time_2048 = wheelPulses.eventTime(RevolutionAccumulator::CP_WHEEL_TIME_UNIT);
+    data.c_event_time = crankPulses.eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
+
+    current_speed = constrainValue(wheelPulses.getRate(now_us, PULSE_STOP_US) * WHEEL_CIRCUMFERENCE * 3.6f,
+                                   0.0f, 150.0f);
+    current_cadence = constrainValue(crankPulses.getRate(now_us, PULSE_STOP_US) * 60.0f, 0.0f, 250.0f);
+    data.speed = current_speed;
+    data.cadence = filterCadence(current_cadence);
+    data.power = 0;
+}
+
+void BikeData::setRandomSource(RandomFn fn, void *ctx)
+{
+    random_fn = fn;
+    random_ctx = ctx;
+}
+
+long BikeData::drawRandom(long howsmall, long howbig)
+{
+    if (random_fn)
+        return random_fn(random_ctx, howsmall, howbig);
+    return random(howsmall, howbig);
+}
+
+void BikeData::ingestKeiser(const KeiserSample &sample)
+{
+    // 只接受实时数据，回顾模式的汇总数据不参与转发
+    if (sample.dataType != 0)
+        return;
+
+    current_cadence = constrainValue(sample.cadence / 10.0f, 0.0f, MAX_CADENCE);
+
+    current_speed = constrainValue(KeiserParser::estimateSpeed(sample), 0.0f, MAX_SPEED);
+
+    keiser_power = powerFilter.push((int16_t)min(sample.power, (uint16_t)INT16_MAX));
+    keiser_cadence = filterCadence(current_cadence);
+    keiser_pending = true;
+}
+
+void BikeData::updateKeiser(unsigned long current_time)
+{
+    if (keiser_pending)
+    {
+        last_keiser_sample = current_time;
+        keiser_pending = false;
+    }
+
+    // 广播中断超过超时时间视为停止骑行
+    if (last_keiser_sample == 0 || current_time - last_keiser_sample > KEISER_TIMEOUT_MS)
+    {
+        current_speed = 0;
+        current_cadence = 0;
+        keiser_power = 0;
+        keiser_cadence = 0;
+        powerFilter.reset(); // 恢复广播后不与停止前的数据混合
+        cadenceFilter.reset();
+    }
+
+    // 两次广播之间按最近一次的速度与踏频继续累加转数
+    advanceWheel();
+    advanceCrank();
+    data.cadence = keiser_cadence;
+    data.power = keiser_power;
+}
+
+void BikeData::saveState(trace::ByteWriter &w) const
+{
+    w.u32(data.wheel_rev);
+    w.u16(data.w_event_time);
+    w.u16(data.w_event_time_2048);
+    w.u16(data.crank_rev);
+    w.u16(data.c_event_time);
+    w.u16((uint16_t)data.power);
+    w.f32(data.speed);
+    w.f32(data.cadence);
+    w.u16(data.energy);
+
+    w.f32(current_speed);
+    w.f32(current_cadence);
+    w.f32(target_speed);
+    w.f32(target_cadence);
+    w.u32((uint32_t)last_wheel_update);
+    w.u32((uint32_t)last_crank_update);
+    w.u32((uint32_t)last_power_update);
+
+    w.u8(source);
+    w.u32((uint32_t)last_keiser_sample);
+    w.u16((uint16_t)keiser_power);
+    w.u8(keiser_pending ? 1 : 0);
+    w.f32(keiser_cadence);
+
+    w.u64(energy_wus);
+    w.u64(last_energy_us);
+
+    wheelAccumulator.saveState(w);
+    crankAccumulator.saveState(w);
+    powerFilter.saveState(w);
+    cadenceFilter.saveState(w);
+}
+
+bool BikeData::loadState(trace::ByteReader &r)
+{
+    data.wheel_rev = r.u32();
+    data.w_event_time = r.u16();
+    data.w_event_time_2048 = r.u16();
+    data.crank_rev = r.u16();
+    data.c_event_time = r.u16();
+    data.power = (int16_t)r.u16();
+    data.speed = r.f32();
+    data.cadence = r.f32();
+    data.energy = r.u16();
+
+    current_speed = r.f32();
+    current_cadence = r.f32();
+    target_speed = r.f32();
+    target_cadence = r.f32();
+    last_wheel_update = r.u32();
+    last_crank_update = r.u32();
+    last_power_update = r.u32();
+
+    source = (Source)r.u8();
+    last_keiser_sample = r.u32();
+    keiser_power = (int16_t)r.u16();
+    keiser_pending = r.u8() != 0;
+    keiser_cadence = r.f32();
+
+    energy_wus = r.u64();
+    last_energy_us = r.u64();
+
+    wheelAccumulator.loadState(r);
+    crankAccumulator.loadState(r);
+    powerFilter.loadState(r);
+    cadenceFilter.loadState(r);
+    return r.ok();
+}
@@ -1,6 +1,13 @@
 #pragma once
 #include <stdint.h>
 #include <Arduino.h>
+#include <esp_timer.h>
+#include "RevolutionAccumulator.h"
+#include "KeiserParser.h"
+#include "PulseInput.h"
+#include "SampleFilter.h"
+#include "Scenario.h"
+#include "TraceFormat.h"
 
 class BikeData
 {
@@ -8,18 +15,64 @@ public:
     struct Data
     {
         uint32_t wheel_rev;
-        uint16_t w_event_time;
+        uint16_t w_event_time;      // 最后一圈车轮事件时间 (1/1024 s, CSC)
+        uint16_t w_event_time_2048; // 最后一圈车轮事件时间 (1/2048 s, CP)
         uint16_t crank_rev;
-        uint16_t c_event_time;
+        uint16_t c_event_time;      // 最后一圈曲柄事件时间 (1/1024 s)
         int16_t power;
-        float speed;   // 速度 (km/h)
-        float cadence; // 踏频 (rpm)
+        float speed;     // 速度 (km/h)
+        float cadence;   // 踏频 (rpm)
+        uint16_t energy; // 累计能量 (kJ, CP)
     };
 
+    // update() 返回的事件位：表示本次更新中发生变化的数据
+    static const uint8_t EVENT_WHEEL = 0x01;  // 车轮转数变化
+    static const uint8_t EVENT_CRANK = 0x02;  // 曲柄转数变化
+    static const uint8_t EVENT_POWER = 0x04;  // 功率变化
+    static const uint8_t EVENT_ENERGY = 0x08; // 累计能量增加 1 kJ
+
+    // 数据来源
+    enum Source : uint8_t
+    {
+        SOURCE_SIMULATION = 0, // 模拟骑行
+        SOURCE_KEISER,         // Keiser M 广播
+        SOURCE_SCENARIO,       // 脚本场景（压力与回绕测试）
+        SOURCE_PULSE           // 有线车轮/曲柄传感器的脉冲时间戳
+    };
+
+    // 可替换的随机数来源（用于追踪记录与回放），返回 [howsmall, howbig)
+    typedef long (*RandomFn)(void *ctx, long howsmall, long howbig);
+
     BikeData();
-    void update();
+    uint8_t update();
+    // 以指定时间 (esp_timer 微秒) 更新，回放时使用
+    uint8_t update(uint64_t now_us);
+
+    void setSource(Source newSource);
+    // 切换为脚本场景：下一次 update() 时从脚本的起始计数与事件时间开始运行。
+    // 场景不写入追踪，由脚本与种子复现
+    void setScenario(Scenario *scenario);
+    // 切换为有线传感器：每次 update() 取出队列中的全部脉冲，转数与事件时间来自脉冲时刻。
+    // 没有功率计，功率为 0；脉冲不写入追踪
+    void setPulseSource(PulseSource *pulses);
+    Source getSource() const { return source; }
+
+    // 写入一条 Keiser 广播数据，下一次 update() 生效；需与 update() 在同一线程调用
+    void ingestKeiser(const KeiserSample &sample);
     Data getData() const { return data; }
 
+    void setRandomSource(RandomFn fn, void *ctx);
+
+    // 上报的瞬时功率与踏频在进入编码器前的滤波（转数与事件时间不受影响）。
+    // 模拟数据每次功率/踏频更新、Keiser 每条新广播各处理一个样本；更换配置会清空滤波状态
+    void setFilters(const SampleFilter::Config &power, const SampleFilter::Config &cadence);
+    const SampleFilter &getPowerFilter() const { return powerFilter; }
+    const SampleFilter &getCadenceFilter() const { return cadenceFilter; }
+
+    // 追踪关键帧用的完整状态序列化（固定宽度小端序，与平台无关）
+    void saveState(trace::ByteWriter &w) const;
+    bool loadState(trace::ByteReader &r);
+
 private:
     Data data;
 
@@ -30,6 +83,32 @@ private:
     const float MAX_SPEED = 40.0;          // 最大速度 (km/h)
     const float MAX_CADENCE = 120.0;       // 最大踏频 (rpm)
 
+    // Keiser 参数
+    const unsigned long KEISER_TIMEOUT_MS = 3000; // 广播超时 (ms)
+
+    Source source = SOURCE_SIMULATION;
+    unsigned long last_keiser_sample = 0;
+    int16_t keiser_power = 0;     // 已滤波
+    float keiser_cadence = 0;     // 已滤波，仅用于上报；转数按原始踏频累加
+    bool keiser_pending = false; // 有新广播待 update() 记录时间
+
+    Scenario *scenario = nullptr;
+    bool scenario_started = false;
+
+    // 有线传感器参数与状态
+    const uint64_t PULSE_STOP_US = 3000000; // 超过该时间没有脉冲视为停止
+    PulseSource *pulses = nullptr;
+    PulseTracker wheelPulses;
+    PulseTracker crankPulses;
+
+    RandomFn random_fn = nullptr;
+    void *random_ctx = nullptr;
+    uint32_t tick_us = 0; // 本次 update() 的时间 (us)，速度与踏频累加共用
+
+    // 累计能量：功率对时间的积分 (W·us)，避免逐次换算为 kJ 时丢失余数
+    uint64_t energy_wus = 0;
+    uint64_t last_energy_us = 0;
+
     // 当前状态
     float current_speed = 0.0;   // 当前速度 (km/h)
     float current_cadence = 0.0; // 当前踏频 (rpm)
@@ -41,13 +120,28 @@ private:
     unsigned long last_crank_update = 0;
     unsigned long last_power_update = 0;
 
+    // 上报值滤波：功率单位 W，踏频单位 0.1 rpm
+    SampleFilter powerFilter;
+    SampleFilter cadenceFilter;
+
+    // 转数累加器：保留不足一圈的部分并给出整圈的精确时间
+    RevolutionAccumulator wheelAccumulator;
+    RevolutionAccumulator crankAccumulator;
+
     // 更新函数
+    void simulate(unsigned long current_time);
+    void updateKeiser(unsigned long current_time);
+    void updateScenario(uint64_t now_us);
+    void updatePulse(uint64_t now_us);
     void updateSpeed();
     void updateCadence();
     void updatePower();
+    void advanceWheel();
+    void advanceCrank();
+    void accumulateEnergy(uint64_t now_us, int16_t power);
+    float filterCadence(float cadence);
 
     // 辅助函数
+    long drawRandom(long howsmall, long howbig);
     float constrainValue(float value, float min, float max);
-    uint32_t safeAdd(uint32_t a, uint32_t b);
-    uint16_t safeAdd(uint16_t a, uint16_t b);
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "BikeSelectService.h"
+
+BikeSelectService::BikeSelectService(gatt::Server *server)
+{
+    status = init(server);
+}
+
+Status BikeSelectService::init(gatt::Server *server)
+{
+    if (!server)
+        return Status::error(STATUS_INVALID_ARGUMENT);
+
+    service = server->createService(GATEWAY_SERVICE_UUID);
+    if (!service)
+        return Status::error(STATUS_SERVICE_FAILED, GATEWAY_SERVICE_UUID);
+
+    selectChar = service->createCharacteristic(
+        GATEWAY_BIKE_SELECT_UUID,
+        CHARACTERISTIC_PROPERTY_READ |
+            CHARACTERISTIC_PROPERTY_WRITE);
+    if (!selectChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, GATEWAY_BIKE_SELECT_UUID);
+
+    // 初始值 0：自动分配
+    uint8_t none = 0;
+    selectChar->setValue(&none, 1);
+    if (!service->start())
+        return Status::error(STATUS_START_FAILED, GATEWAY_SERVICE_UUID);
+    return Status::success();
+}
+
+void BikeSelectService::setWriteHandler(gatt::WriteHandler handler, void *ctx)
+{
+    if (!status.ok())
+        return;
+    selectChar->setWriteHandler(handler, ctx);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "BLEConfig.h"
+#include "Status.h"
+
+// 网关的单车选择服务（128 位 UUID）：中心设备写入单车编号绑定自己的会话，0 表示自动分配。
+// 与其他服务一样在开始广播前创建：NimBLE 在开始广播时一次注册 GATT 表，
+// 之后创建的服务直到 GATT 重置（最后一个中心设备断开）才可见
+class BikeSelectService
+{
+public:
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    BikeSelectService(gatt::Server *server);
+
+    // 写入由网关处理；创建服务时还没有网关，写入前未设置处理函数时忽略
+    void setWriteHandler(gatt::WriteHandler handler, void *ctx);
+
+    Status getStatus() const { return status; }
+
+private:
+    gatt::Service *service = nullptr;
+    gatt::Characteristic *selectChar = nullptr;
+    Status status;
+
+    Status init(gatt::Server *server);
+};
@@ -0,0 +1,172 @@
+#include "BikeTable.h"
+#include <string.h>
+
+BikeTable::BikeTable()
+    : activeBits(0), dirtyBits(0), lastAdvanceUs(0), advanced(false)
+{
+    memset(ids, 0, sizeof(ids));
+    memset(lastSeenMs, 0, sizeof(lastSeenMs));
+    memset(speed, 0, sizeof(speed));
+    memset(cadence, 0, sizeof(cadence));
+    memset(power, 0, sizeof(power));
+    memset(wheelRev, 0, sizeof(wheelRev));
+    memset(wEventTime, 0, sizeof(wEventTime));
+    memset(wEventTime2048, 0, sizeof(wEventTime2048));
+    memset(crankRev, 0, sizeof(crankRev));
+    memset(cEventTime, 0, sizeof(cEventTime));
+    memset(energyWus, 0, sizeof(energyWus));
+}
+
+int BikeTable::find(uint8_t bikeId) const
+{
+    for (uint8_t i = 0; i < MAX_BIKES; i++)
+    {
+        if (ids[i] == bikeId && (activeBits & (1u << i)))
+            return i;
+    }
+    return NOT_FOUND;
+}
+
+uint8_t BikeTable::count() const
+{
+    return (uint8_t)__builtin_popcount(activeBits);
+}
+
+int BikeTable::allocate(uint8_t bikeId, uint32_t nowMs)
+{
+    int slot = NOT_FOUND;
+    if (activeBits != 0xFFFFFFFFu)
+    {
+        slot = __builtin_ctz(~activeBits);
+    }
+    else
+    {
+        // 表满：回收空闲最久且超过 EVICT_MS 的槽位
+        uint32_t oldest = 0;
+        for (uint8_t i = 0; i < MAX_BIKES; i++)
+        {
+            uint32_t idle = nowMs - lastSeenMs[i];
+            if (idle > EVICT_MS && idle > oldest)
+            {
+                oldest = idle;
+                slot = i;
+            }
+        }
+        if (slot == NOT_FOUND)
+            return NOT_FOUND;
+    }
+
+    ids[slot] = bikeId;
+    speed[slot] = 0;
+    cadence[slot] = 0;
+    power[slot] = 0;
+    wheelRev[slot] = 1; // 与 BikeData 一致，从1开始
+    wEventTime[slot] = 0;
+    wEventTime2048[slot] = 0;
+    crankRev[slot] = 1;
+    cEventTime[slot] = 0;
+    energyWus[slot] = 0;
+    wheelAcc[slot] = RevolutionAccumulator();
+    crankAcc[slot] = RevolutionAccumulator();
+    activeBits |= 1u << slot;
+    return slot;
+}
+
+int BikeTable::ingest(const KeiserSample &sample, uint32_t nowMs)
+{
+    // 只接受实时数据
+    if (sample.dataType != 0)
+        return NOT_FOUND;
+
+    int slot = find(sample.equipmentId);
+    if (slot == NOT_FOUND)
+        slot = allocate(sample.equipmentId, nowMs);
+    if (slot == NOT_FOUND)
+        return NOT_FOUND;
+
+    cadence[slot] = sample.cadence / 10.0f;
+    speed[slot] = KeiserParser::estimateSpeed(sample);
+    int16_t newPower = sample.power > INT16_MAX ? INT16_MAX : (int16_t)sample.power;
+    if (newPower != power[slot])
+        dirtyBits |= 1u << slot;
+    power[slot] = newPower;
+    lastSeenMs[slot] = nowMs;
+    return slot;
+}
+
+uint32_t BikeTable::advance(uint32_t nowUs, uint32_t nowMs)
+{
+    uint32_t changed = dirtyBits & activeBits;
+    dirtyBits = 0;
+    // 无符号差值可跨越 32 位微秒计数回绕
+    uint32_t dtUs = advanced ? nowUs - lastAdvanceUs : 0;
+    lastAdvanceUs = nowUs;
+    advanced = true;
+    uint32_t bits = activeBits;
+    while (bits)
+    {
+        uint8_t i = __builtin_ctz(bits);
+        bits &= bits - 1;
+
+        // 上一次推进以来按最近功率累计能量
+        if (power[i] > 0)
+        {
+            uint16_t before = toKilojoules(energyWus[i]);
+            energyWus[i] += (uint64_t)power[i] * dtUs;
+            if (toKilojoules(energyWus[i]) != before)
+                changed |= 1u << i;
+        }
+
+        // 广播中断视为停止骑行
+        if (nowMs - lastSeenMs[i] > BIKE_TIMEOUT_MS)
+        {
+            if (power[i] != 0)
+                changed |= 1u << i;
+            speed[i] = 0;
+            cadence[i] = 0;
+            power[i] = 0;
+        }
+
+        float wheelRps = speed[i] * 1000.0f / (3600.0f * WHEEL_CIRCUMFERENCE);
+        uint32_t wheelInc = wheelAcc[i].advance(wheelRps, nowUs);
+        if (wheelInc)
+        {
+            wheelRev[i] += wheelInc;
+            wEventTime[i] = wheelAcc[i].eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
+            wEventTime2048[i] = wheelAcc[i].eventTime(RevolutionAccumulator::CP_WHEEL_TIME_UNIT);
+            changed |= 1u << i;
+        }
+
+        uint32_t crankInc = crankAcc[i].advance(cadence[i] / 60.0f, nowUs);
+        if (crankInc)
+        {
+            crankRev[i] += (uint16_t)crankInc;
+            cEventTime[i] = crankAcc[i].eventTime(RevolutionAccumulator::CSC_TIME_UNIT);
+            changed |= 1u << i;
+        }
+    }
+    return changed;
+}
+
+BikeData::Data BikeTable::get(uint8_t slot) const
+{
+    BikeData::Data d = {};
+    if (slot >= MAX_BIKES)
+        return d;
+    d.wheel_rev = wheelRev[slot];
+    d.w_event_time = wEventTime[slot];
+    d.w_event_time_2048 = wEventTime2048[slot];
+    d.crank_rev = crankRev[slot];
+    d.c_event_time = cEventTime[slot];
+    d.power = power[slot];
+    d.speed = speed[slot];
+    d.cadence = cadence[slot];
+    d.energy = toKilojoules(energyWus[slot]);
+    return d;
+}
+
+uint16_t BikeTable::toKilojoules(uint64_t wus)
+{
+    uint64_t kj = wus / 1000000000ULL;
+    return kj > UINT16_MAX ? UINT16_MAX : (uint16_t)kj;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include "BikeData.h"
+#include "KeiserParser.h"
+#include "RevolutionAccumulator.h"
+
+// 网关模式的多车状态表：
+// 以单车编号为键，字段按列存放 (structure-of-arrays)，
+// 查找只扫描 32 字节的编号列，批量推进时各列顺序访问
+class BikeTable
+{
+public:
+    static const uint8_t MAX_BIKES = 32;
+    static const int NOT_FOUND = -1;
+    static const uint32_t BIKE_TIMEOUT_MS = 3000; // 超时后视为停止骑行
+    static const uint32_t EVICT_MS = 60000;       // 表满时可回收的空闲时间
+
+    BikeTable();
+
+    int find(uint8_t bikeId) const;
+
+    // 写入一条广播数据，返回所在槽位；表满且无可回收槽位时返回 NOT_FOUND
+    int ingest(const KeiserSample &sample, uint32_t nowMs);
+
+    // 推进所有单车的转数累加，返回数据发生变化的槽位位图
+    uint32_t advance(uint32_t nowUs, uint32_t nowMs);
+
+    BikeData::Data get(uint8_t slot) const;
+    uint8_t bikeId(uint8_t slot) const { return ids[slot]; }
+    bool isActive(uint8_t slot) const { return slot < MAX_BIKES && (activeBits & (1u << slot)); }
+    uint32_t getActiveMask() const { return activeBits; }
+    uint8_t count() const;
+
+private:
+    uint32_t activeBits;
+    uint32_t dirtyBits; // 自上次推进以来功率变化的槽位
+    uint32_t lastAdvanceUs;
+    bool advanced; // 已推进过，lastAdvanceUs 有效
+
+    // 热数据列：每次推进都会访问
+    uint8_t ids[MAX_BIKES];
+    uint32_t lastSeenMs[MAX_BIKES];
+    float speed[MAX_BIKES];   // km/h
+    float cadence[MAX_BIKES]; // rpm
+    int16_t power[MAX_BIKES];
+
+    // 输出列
+    uint32_t wheelRev[MAX_BIKES];
+    uint16_t wEventTime[MAX_BIKES];
+    uint16_t wEventTime2048[MAX_BIKES];
+    uint16_t crankRev[MAX_BIKES];
+    uint16_t cEventTime[MAX_BIKES];
+    uint64_t energyWus[MAX_BIKES]; // 累计能量 (W·us)
+
+    RevolutionAccumulator wheelAcc[MAX_BIKES];
+    RevolutionAccumulator crankAcc[MAX_BIKES];
+
+    const float WHEEL_CIRCUMFERENCE = 2.0; // 轮子周长 (m)
+
+    int allocate(uint8_t bikeId, uint32_t nowMs);
+    static uint16_t toKilojoules(uint64_t wus);
+};
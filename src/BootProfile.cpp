@@ -0,0 +1,61 @@
+#include "BootProfile.h"
+#include "Log.h"
+#include <esp_timer.h>
+
+BootProfile::BootProfile()
+{
+    for (uint8_t i = 0; i < PHASE_COUNT; i++)
+        timeUs[i] = -1;
+}
+
+void BootProfile::mark(Phase phase)
+{
+    mark(phase, esp_timer_get_time());
+}
+
+void BootProfile::mark(Phase phase, int64_t nowUs)
+{
+    if (phase < PHASE_COUNT && timeUs[phase] < 0)
+        timeUs[phase] = nowUs;
+}
+
+bool BootProfile::withinBudget() const
+{
+    return has(PHASE_ADVERTISING) && timeUs[PHASE_ADVERTISING] <= (int64_t)ADVERTISING_BUDGET_US;
+}
+
+const char *BootProfile::name(Phase phase)
+{
+    switch (phase)
+    {
+    case PHASE_SETUP:
+        return "setup";
+    case PHASE_LOG_READY:
+        return "log";
+    case PHASE_STACK_READY:
+        return "stack";
+    case PHASE_GATT_READY:
+        return "gatt";
+    case PHASE_ADVERTISING:
+        return "advertising";
+    case PHASE_READY:
+        return "ready";
+    default:
+        return "?";
+    }
+}
+
+void BootProfile::report() const
+{
+    int64_t previous = 0;
+    for (uint8_t i = 0; i < PHASE_COUNT; i++)
+    {
+        if (timeUs[i] < 0)
+            continue;
+        LOG_INFO("[BOOT] %s %u us (+%u)", name((Phase)i), (unsigned)timeUs[i], (unsigned)(timeUs[i] - previous));
+        previous = timeUs[i];
+    }
+    if (has(PHASE_ADVERTISING) && !withinBudget())
+        LOG_WARN("[BOOT] 首个广播 %u us，超出预算 %u us",
+                 (unsigned)timeUs[PHASE_ADVERTISING], (unsigned)ADVERTISING_BUDGET_US);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+// 启动阶段时间戳：记录从应用启动到首个广播、再到全部初始化完成的各阶段耗时。
+// 时间取 esp_timer（从应用启动开始计时，不含 ROM 与二级引导程序的时间）。
+class BootProfile
+{
+public:
+    enum Phase : uint8_t
+    {
+        PHASE_SETUP = 0,   // 进入 setup()
+        PHASE_LOG_READY,   // 串口与日志任务就绪
+        PHASE_STACK_READY, // NimBLEDevice::init 完成
+        PHASE_GATT_READY,  // 全部 GATT 服务创建完成
+        PHASE_ADVERTISING, // 开始广播
+        PHASE_READY,       // 扫描、追踪、调度器等延后的初始化完成
+        PHASE_COUNT
+    };
+
+    static const uint32_t ADVERTISING_BUDGET_US = 300000; // 启动到首个广播的目标
+
+    BootProfile();
+
+    // 只记录每个阶段第一次到达的时间（重新初始化 BLE 不覆盖）
+    void mark(Phase phase);
+    void mark(Phase phase, int64_t nowUs);
+
+    bool has(Phase phase) const { return timeUs[phase] >= 0; }
+    // 未到达的阶段返回 -1
+    int64_t getUs(Phase phase) const { return timeUs[phase]; }
+    bool withinBudget() const;
+
+    static const char *name(Phase phase);
+
+    // 以 LOG_INFO 逐阶段输出时间与增量，超出预算时 LOG_WARN
+    void report() const;
+
+private:
+    int64_t timeUs[PHASE_COUNT];
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 呼吸灯亮度表：编译期按 (exp(sin(2πi/N)) - 1/e) / (e - 1/e) 生成，
+// 运行时只查表，不再调用 exp/sin。
+// 标准库的 exp/sin 不是 constexpr，这里用泰勒级数实现编译期版本（双精度，误差远小于 1/255）。
+namespace breath
+{
+    // 不能命名为 PI：Arduino.h 把 PI 定义为宏，StatusLed.h 先包含 Arduino.h 再包含本文件
+    constexpr double PI_VALUE = 3.14159265358979323846;
+    constexpr double E_VALUE = 2.71828182845904523536;
+
+    // |x| <= π 时 20 项足够收敛
+    constexpr double sin(double x)
+    {
+        while (x > PI_VALUE)
+            x -= 2 * PI_VALUE;
+        while (x < -PI_VALUE)
+            x += 2 * PI_VALUE;
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 20; n++)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // 仅用于 |x| <= 1
+    constexpr double exp(double x)
+    {
+        double term = 1;
+        double sum = 1;
+        for (int n = 1; n < 20; n++)
+        {
+            term *= x / n;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // 一个周期内第 i 个采样点的亮度 (0..1)
+    constexpr double curve(size_t i, size_t n)
+    {
+        return (exp(sin(2 * PI_VALUE * (double)i / (double)n)) - 1 / E_VALUE) / (E_VALUE - 1 / E_VALUE);
+    }
+
+    template <size_t N>
+    struct Table
+    {
+        uint8_t value[N];
+
+        constexpr uint8_t operator[](size_t i) const { return value[i]; }
+        static constexpr size_t size() { return N; }
+    };
+
+    template <size_t N>
+    constexpr Table<N> makeTable()
+    {
+        Table<N> table = {};
+        for (size_t i = 0; i < N; i++)
+            table.value[i] = (uint8_t)(curve(i, N) * 255.0 + 0.5);
+        return table;
+    }
+
+    constexpr size_t TABLE_SIZE = 256;
+    constexpr Table<TABLE_SIZE> TABLE = makeTable<TABLE_SIZE>();
+
+    // 曲线在 1/4 周期处最亮、3/4 周期处熄灭，起点为 (1 - 1/e) / (e - 1/e)
+    static_assert(TABLE[TABLE_SIZE / 4] == 255, "呼吸表峰值错误");
+    static_assert(TABLE[TABLE_SIZE * 3 / 4] == 0, "呼吸表谷值错误");
+    static_assert(TABLE[0] == 69, "呼吸表起点错误");
+}
@@ -1,101 +1,249 @@
 #include "CPService.h"
-#include "BLE2902.h"
-#include <BLEDevice.h>
+#include "Log.h"
 #include <Arduino.h>
-CPService::CPService(BLEServer *server)
+#include <esp_timer.h>
+#include <string.h>
+
+// 按编译期标志位编码：每个组合各自展开为固定偏移写入
+template <uint16_t Flags>
+static size_t encodeAs(const encoder::CpFields &fields, uint8_t *out)
+{
+    auto buf = encoder::CpMeasurement<Flags>::encode(fields);
+    memcpy(out, buf.data(), buf.size());
+    return buf.size();
+}
+
+CPService::CPService(gatt::Server *server, uint32_t features)
+    : features(features)
 {
+    status = init(server);
+}
+
+Status CPService::init(gatt::Server *server)
+{
+    if (!server)
+        return Status::error(STATUS_INVALID_ARGUMENT);
+
     // 创建 CP 服务
     service = server->createService(CP_UUID);
+    if (!service)
+        return Status::error(STATUS_SERVICE_FAILED, CP_UUID);
 
-    // 创建 CP 测量特征值
+    // 创建 CP 测量特征值（CCCD 由后端创建）
     cpMeasurementChar = service->createCharacteristic(
         CP_MEASUREMENT_UUID,
-        BLECharacteristic::PROPERTY_READ |
-            BLECharacteristic::PROPERTY_NOTIFY);
-    cpMeasurementChar->addDescriptor(new BLE2902());
-    cpMeasurementChar->setCallbacks(new BLECharacteristicCallbacks());
+        CHARACTERISTIC_PROPERTY_READ |
+            CHARACTERISTIC_PROPERTY_NOTIFY);
+    if (!cpMeasurementChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, CP_MEASUREMENT_UUID);
     cpMeasurementChar->setValue((uint8_t *)0, 0);
 
     // 创建 CP 特征值
     cpFeatureChar = service->createCharacteristic(
         CP_FEATURE_UUID,
-        BLECharacteristic::PROPERTY_READ);
-    uint32_t features = 0x00; // 基本功率数据
-    cpFeatureChar->setValue((uint8_t *)&features, sizeof(features));
+        CHARACTERISTIC_PROPERTY_READ);
+    if (!cpFeatureChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, CP_FEATURE_UUID);
+    uint8_t featureValue[4];
+    encoder::putU32(featureValue, features);
+    cpFeatureChar->setValue(featureValue, sizeof(featureValue));
 
     // 创建传感器位置特征值
     sensorLocationChar = service->createCharacteristic(
         SENSOR_LOCATION_UUID,
-        BLECharacteristic::PROPERTY_READ);
+        CHARACTERISTIC_PROPERTY_READ);
+    if (!sensorLocationChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, SENSOR_LOCATION_UUID);
     uint8_t location = LOC_REAR_WHEEL;
     sensorLocationChar->setValue((uint8_t *)&location, sizeof(location));
 
+    // 创建 Control Point：写入请求，以指示返回结果
+    controlPointChar = service->createCharacteristic(
+        CP_CONTROL_POINT_UUID,
+        CHARACTERISTIC_PROPERTY_WRITE |
+            CHARACTERISTIC_PROPERTY_INDICATE);
+    if (!controlPointChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, CP_CONTROL_POINT_UUID);
+    controlPointChar->setWriteHandler(onControlPointWrite, this);
+
     // 启动服务
-    service->start();
+    if (!service->start())
+        return Status::error(STATUS_START_FAILED, CP_UUID);
+    return Status::success();
 }
 
-void CPService::updateMeasurement(int16_t power)
+encoder::CpFields CPService::toFields(const BikeData::Data &data)
 {
-    if (!cpMeasurementChar)
-    {
-        Serial.println("[ERROR] CPService: 测量特征值未初始化");
-        return;
-    }
+    encoder::CpFields fields = {};
+    fields.power = data.power;
+    fields.wheelRev = data.wheel_rev;
+    fields.wEventTime = data.w_event_time_2048;
+    fields.crankRev = data.crank_rev;
+    fields.cEventTime = data.c_event_time;
+    fields.energy = data.energy;
+    return fields;
+}
 
-    if (!service || !service->getServer())
+uint16_t CPService::getMeasurementFlags() const
+{
+    uint16_t mask = contentMask.load(std::memory_order_relaxed);
+    uint16_t flags = 0;
+    if ((features & FEATURE_WHEEL_REV) && !(mask & MASK_WHEEL_REV))
+        flags |= encoder::CP_WHEEL_REV;
+    if ((features & FEATURE_CRANK_REV) && !(mask & MASK_CRANK_REV))
+        flags |= encoder::CP_CRANK_REV;
+    if ((features & FEATURE_ACC_ENERGY) && !(mask & MASK_ACC_ENERGY))
+        flags |= encoder::CP_ACC_ENERGY;
+    return flags;
+}
+
+size_t CPService::encode(const encoder::CpFields &fields, uint8_t *out) const
+{
+    using namespace encoder;
+    switch (getMeasurementFlags())
     {
-        Serial.println("[ERROR] CPService: 服务未初始化或服务器无效");
-        return;
+    case CP_WHEEL_REV:
+        return encodeAs<CP_WHEEL_REV>(fields, out);
+    case CP_CRANK_REV:
+        return encodeAs<CP_CRANK_REV>(fields, out);
+    case CP_WHEEL_REV | CP_CRANK_REV:
+        return encodeAs<CP_WHEEL_REV | CP_CRANK_REV>(fields, out);
+    case CP_ACC_ENERGY:
+        return encodeAs<CP_ACC_ENERGY>(fields, out);
+    case CP_WHEEL_REV | CP_ACC_ENERGY:
+        return encodeAs<CP_WHEEL_REV | CP_ACC_ENERGY>(fields, out);
+    case CP_CRANK_REV | CP_ACC_ENERGY:
+        return encodeAs<CP_CRANK_REV | CP_ACC_ENERGY>(fields, out);
+    case CP_WHEEL_REV | CP_CRANK_REV | CP_ACC_ENERGY:
+        return encodeAs<CP_WHEEL_REV | CP_CRANK_REV | CP_ACC_ENERGY>(fields, out);
+    default:
+        return encodeAs<0>(fields, out);
     }
+}
 
-    try
-    {
-        // 分配缓冲区
-        uint8_t data[4] = {0}; // flags (1) + power (2) + reserved (1)
-        size_t dataLen = 0;
+bool CPService::updateMeasurement(const encoder::CpFields &fields)
+{
+    // 初始化失败时由 getStatus() 报告，这里不再逐次打印
+    if (!status.ok())
+        return false;
 
-        // 设置标志位 (0x20 表示瞬时功率测量)
-        data[dataLen++] = 0x20;
+    // 客户端设置了累计车轮转数：从本次起以该值为基准继续累加
+    encoder::CpFields adjusted = fields;
+    if (cumulativePending.exchange(false, std::memory_order_acquire))
+        wheelOffset = cumulativeValue.load(std::memory_order_relaxed) - fields.wheelRev;
+    adjusted.wheelRev = fields.wheelRev + wheelOffset;
 
-        // 添加功率数据
-        memcpy(&data[dataLen], &power, sizeof(power));
-        dataLen += sizeof(power);
+    uint8_t data[MAX_MEASUREMENT_SIZE];
+    size_t len = encode(adjusted, data);
 
-        // 添加保留字节
-        data[dataLen++] = 0;
+    // 特征值始终保持最新（供读取），通知由合并器决定
+    cpMeasurementChar->setValue(data, len);
+    coalescer.submit(data, len);
+    return flush(esp_timer_get_time());
+}
 
-        // 验证数据长度
-        if (dataLen > sizeof(data))
-        {
-            Serial.println("[CP] 数据长度超出缓冲区大小");
-            return;
-        }
+bool CPService::flush(int64_t nowUs)
+{
+    if (!status.ok() || !coalescer.take(nowUs))
+        return false;
+    cpMeasurementChar->notify();
+    return true;
+}
 
-        // 更新特征值
-        cpMeasurementChar->setValue(data, dataLen);
-        cpMeasurementChar->notify();
-    }
-    catch (const std::exception &e)
-    {
-        Serial.printf("[CP] 更新数据时发生异常: %s\n", e.what());
-    }
-    catch (...)
+void CPService::onConnect(uint16_t connHandle)
+{
+    connectionCount++;
+    // 负载由所有连接共享：新连接的中心设备不能收到其他连接设置的屏蔽
+    if (connectionCount > 1 && maskConn != gatt::CONN_ALL)
     {
-        Serial.println("[CP] 更新数据时发生未知异常");
+        LOG_INFO("[CP] 新的中心设备连接，清除连接 %u 的测量屏蔽", (unsigned)maskConn);
+        clearContentMask();
     }
 }
 
-void CPService::onCPMeasurementWrite(BLECharacteristic *pChar)
+void CPService::onDisconnect(uint16_t connHandle)
+{
+    if (connectionCount > 0)
+        connectionCount--;
+    // 规范要求屏蔽只在设置它的连接内有效
+    if (connHandle == maskConn)
+        clearContentMask();
+}
+
+void CPService::clearContentMask()
+{
+    contentMask.store(0, std::memory_order_relaxed);
+    maskConn = gatt::CONN_ALL;
+}
+
+void CPService::onControlPointWrite(void *ctx, uint16_t connHandle, const uint8_t *data, size_t len)
 {
-    // 处理写入请求
+    static_cast<CPService *>(ctx)->handleControlPoint(connHandle, data, len);
 }
 
-void CPService::onCPFeatureWrite(BLECharacteristic *pChar)
+void CPService::handleControlPoint(uint16_t connHandle, const uint8_t *data, size_t len)
 {
-    // 处理特征值写入
+    if (len < 1)
+        return;
+
+    uint8_t opCode = data[0];
+    switch (opCode)
+    {
+    case OP_SET_CUMULATIVE_VALUE:
+        if (!(features & FEATURE_WHEEL_REV))
+        {
+            respond(connHandle, opCode, RESULT_NOT_SUPPORTED);
+        }
+        else if (len != 5)
+        {
+            respond(connHandle, opCode, RESULT_INVALID_PARAMETER);
+        }
+        else
+        {
+            uint32_t value = (uint32_t)data[1] | ((uint32_t)data[2] << 8) |
+                             ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 24);
+            cumulativeValue.store(value, std::memory_order_relaxed);
+            cumulativePending.store(true, std::memory_order_release);
+            respond(connHandle, opCode, RESULT_SUCCESS);
+        }
+        break;
+
+    case OP_MASK_CONTENT:
+        if (!(features & FEATURE_CONTENT_MASKING))
+        {
+            respond(connHandle, opCode, RESULT_NOT_SUPPORTED);
+        }
+        else if (len != 3)
+        {
+            respond(connHandle, opCode, RESULT_INVALID_PARAMETER);
+        }
+        else if (connectionCount > 1)
+        {
+            // 测量负载由所有连接共享，屏蔽会改变其他中心设备收到的内容
+            respond(connHandle, opCode, RESULT_FAILED);
+        }
+        else
+        {
+            // 下一次编码起生效；负载格式改变，不会被合并器当作重复包抑制
+            contentMask.store((uint16_t)(data[1] | (data[2] << 8)), std::memory_order_relaxed);
+            maskConn = connHandle;
+            respond(connHandle, opCode, RESULT_SUCCESS);
+        }
+        break;
+
+    default:
+        respond(connHandle, opCode, RESULT_NOT_SUPPORTED);
+        break;
+    }
 }
 
-void CPService::onSensorLocationWrite(BLECharacteristic *pChar)
+void CPService::respond(uint16_t connHandle, uint8_t opCode, uint8_t result)
 {
-    // 处理传感器位置写入
-}
\ No newline at end of file
+    if (!controlPointChar)
+        return;
+    uint8_t response[3] = {OP_RESPONSE, opCode, result};
+    controlPointChar->setValue(response, sizeof(response));
+    controlPointChar->indicate(connHandle);
+    if (result != RESULT_SUCCESS)
+        LOG_WARN("[CP] Control Point 请求 0x%02X 失败 (0x%02X)", opCode, result);
+}
@@ -1,21 +1,102 @@
 #pragma once
 #include "BLEConfig.h"
-#include <functional>
+#include "BikeData.h"
+#include "MeasurementEncoder.h"
+#include "NotifyCoalescer.h"
+#include "Status.h"
+#include <atomic>
 
+// 骑行功率服务：测量值按特性位携带车轮/曲柄转数与累计能量，
+// 只订阅 CP 的客户端无需再订阅 CSC。Control Point 支持设置累计车轮转数与屏蔽测量字段，
+// 响应只指示给发出请求的连接。测量负载只编码一次并扇出到所有连接，屏蔽因此只在单个中心设备
+// 连接时可用：屏蔽属于设置它的连接，该连接断开或有其他中心设备连接时清除。
 class CPService
 {
 public:
-    CPService(BLEServer *server);
-    void updateMeasurement(int16_t power);
+    // CP Feature 位 (0x2A65)
+    enum Feature : uint32_t
+    {
+        FEATURE_WHEEL_REV = 1 << 2,        // 车轮转数数据
+        FEATURE_CRANK_REV = 1 << 3,        // 曲柄转数数据
+        FEATURE_ACC_ENERGY = 1 << 7,       // 累计能量
+        FEATURE_CONTENT_MASKING = 1 << 10  // 测量内容屏蔽 (bit11 为多个传感器位置，本设备不支持)
+    };
+    static const uint32_t DEFAULT_FEATURES =
+        FEATURE_WHEEL_REV | FEATURE_CRANK_REV | FEATURE_ACC_ENERGY | FEATURE_CONTENT_MASKING;
+
+    // Control Point 操作码 (0x2A66)
+    enum OpCode : uint8_t
+    {
+        OP_SET_CUMULATIVE_VALUE = 0x01, // 参数: uint32 累计车轮转数
+        OP_MASK_CONTENT = 0x0D,         // 参数: uint16 屏蔽位
+        OP_RESPONSE = 0x20
+    };
+
+    // Control Point 响应结果
+    enum Result : uint8_t
+    {
+        RESULT_SUCCESS = 0x01,
+        RESULT_NOT_SUPPORTED = 0x02,
+        RESULT_INVALID_PARAMETER = 0x03,
+        RESULT_FAILED = 0x04
+    };
+
+    // 测量内容屏蔽位（OP_MASK_CONTENT 参数）
+    enum ContentMask : uint16_t
+    {
+        MASK_WHEEL_REV = 1 << 2,
+        MASK_CRANK_REV = 1 << 3,
+        MASK_ACC_ENERGY = 1 << 8
+    };
+
+    static const size_t MAX_MEASUREMENT_SIZE = encoder::CpPowerFull::SIZE;
+
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    CPService(gatt::Server *server, uint32_t features = DEFAULT_FEATURES);
+    // 更新特征值并交给合并器，返回本次是否发出了通知
+    bool updateMeasurement(const encoder::CpFields &fields);
+    // 发送合并窗口到期的负载或保活包
+    bool flush(int64_t nowUs);
+
+    // 按特性位与当前屏蔽位编码，out 至少 MAX_MEASUREMENT_SIZE 字节，返回长度
+    size_t encode(const encoder::CpFields &fields, uint8_t *out) const;
+    // 当前测量负载包含的字段 (encoder::CpFlags)
+    uint16_t getMeasurementFlags() const;
+    static encoder::CpFields toFields(const BikeData::Data &data);
+
+    // 由服务器连接回调调用（BLE 主机任务，与 Control Point 写入同一任务）
+    void onConnect(uint16_t connHandle);
+    void onDisconnect(uint16_t connHandle);
+    void clearContentMask();
+
+    Status getStatus() const { return status; }
+    uint32_t getFeatures() const { return features; }
+    gatt::Characteristic *getMeasurementChar() const { return cpMeasurementChar; }
+    gatt::Characteristic *getControlPointChar() const { return controlPointChar; }
+    NotifyCoalescer &getCoalescer() { return coalescer; }
 
 private:
-    BLEService *service;
-    BLECharacteristic *cpMeasurementChar;
-    BLECharacteristic *cpFeatureChar;
-    BLECharacteristic *sensorLocationChar;
-
-    // 特征值回调函数
-    static void onCPMeasurementWrite(BLECharacteristic *pChar);
-    static void onCPFeatureWrite(BLECharacteristic *pChar);
-    static void onSensorLocationWrite(BLECharacteristic *pChar);
-};
\ No newline at end of file
+    gatt::Service *service = nullptr;
+    gatt::Characteristic *cpMeasurementChar = nullptr;
+    gatt::Characteristic *cpFeatureChar = nullptr;
+    gatt::Characteristic *sensorLocationChar = nullptr;
+    gatt::Characteristic *controlPointChar = nullptr;
+    NotifyCoalescer coalescer;
+    uint32_t features;
+    Status status;
+
+    // Control Point 在 BLE 主机任务中写入，测量在通知任务中编码
+    std::atomic<uint16_t> contentMask{0};
+    std::atomic<uint32_t> cumulativeValue{0};
+    std::atomic<bool> cumulativePending{false};
+    // 仅通知任务访问：累计车轮转数相对 BikeData 的偏移
+    uint32_t wheelOffset = 0;
+    // 仅 BLE 主机任务访问：已连接的中心设备数与设置屏蔽的连接
+    uint8_t connectionCount = 0;
+    uint16_t maskConn = gatt::CONN_ALL;
+
+    Status init(gatt::Server *server);
+    static void onControlPointWrite(void *ctx, uint16_t connHandle, const uint8_t *data, size_t len);
+    void handleControlPoint(uint16_t connHandle, const uint8_t *data, size_t len);
+    void respond(uint16_t connHandle, uint8_t opCode, uint8_t result);
+};
@@ -1,22 +1,30 @@
 #pragma once
 #include "BLEConfig.h"
-#include <functional>
+#include "NotifyCoalescer.h"
+#include "Status.h"
 
 class CSCService
 {
 public:
-    CSCService(BLEServer *server);
-    void updateMeasurement(uint32_t wheelRev, uint16_t wEventTime,
-                           uint32_t crankRev, uint16_t cEventTime);
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    CSCService(gatt::Server *server);
+    // 更新特征值并交给合并器，返回本次是否发出了通知
+    bool updateMeasurement(uint32_t wheelRev, uint16_t wEventTime,
+                           uint16_t crankRev, uint16_t cEventTime);
+    // 发送合并窗口到期的负载或保活包
+    bool flush(int64_t nowUs);
+
+    Status getStatus() const { return status; }
+    gatt::Characteristic *getMeasurementChar() const { return cscMeasurementChar; }
+    NotifyCoalescer &getCoalescer() { return coalescer; }
 
 private:
-    BLEService *service;
-    BLECharacteristic *cscMeasurementChar;
-    BLECharacteristic *cscFeatureChar;
-    BLECharacteristic *sensorLocationChar;
+    gatt::Service *service = nullptr;
+    gatt::Characteristic *cscMeasurementChar = nullptr;
+    gatt::Characteristic *cscFeatureChar = nullptr;
+    gatt::Characteristic *sensorLocationChar = nullptr;
+    NotifyCoalescer coalescer;
+    Status status;
 
-    // 特征值回调函数
-    void onCSCMeasurementWrite(BLECharacteristic *pChar);
-    void onCSCFeatureWrite(BLECharacteristic *pChar);
-    void onSensorLocationWrite(BLECharacteristic *pChar);
+    Status init(gatt::Server *server);
 };
\ No newline at end of file
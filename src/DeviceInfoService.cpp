@@ -1,27 +1,63 @@
 #include "DeviceInfoService.h"
 #include "BLEConfig.h"
 
-DeviceInfoService::DeviceInfoService(BLEServer *server)
+DeviceInfoService::DeviceInfoService(gatt::Server *server)
 {
+    status = init(server);
+}
+
+Status DeviceInfoService::init(gatt::Server *server)
+{
+    if (!server)
+        return Status::error(STATUS_INVALID_ARGUMENT);
+
     service = server->createService(DI_UUID);
+    if (!service)
+        return Status::error(STATUS_SERVICE_FAILED, DI_UUID);
 
-    // 系统ID (64-bit)
+    // 系统ID (64-bit)，按二进制长度写入（首字节为 0，不能当作字符串）
     uint64_t systemId = 0x0000022001100000;
-    createReadOnlyCharacteristic(DI_SYSTEM_ID_UUID, (char *)&systemId);
+    Status result = createReadOnlyCharacteristic(DI_SYSTEM_ID_UUID, (const uint8_t *)&systemId, sizeof(systemId));
+    if (!result.ok())
+        return result;
 
     // 文本型特征
-    createReadOnlyCharacteristic(DI_MODEL_NUMBER_UUID, "Keiser M to GATT");
-    createReadOnlyCharacteristic(DI_SERIAL_NUMBER_UUID, "12345678");
-    createReadOnlyCharacteristic(DI_FIRMWARE_REV_UUID, "0.0.1");
-    createReadOnlyCharacteristic(DI_HARDWARE_REV_UUID, "0.1.1");
-    createReadOnlyCharacteristic(DI_SOFTWARE_REV_UUID, "1.0beta");
-    createReadOnlyCharacteristic(DI_MANUFACTURER_UUID, "t-j");
+    static const struct
+    {
+        gatt::Uuid uuid;
+        const char *value;
+    } TEXT_CHARACTERISTICS[] = {
+        {DI_MODEL_NUMBER_UUID, "Keiser M to GATT"},
+        {DI_SERIAL_NUMBER_UUID, "12345678"},
+        {DI_FIRMWARE_REV_UUID, "0.0.1"},
+        {DI_HARDWARE_REV_UUID, "0.1.1"},
+        {DI_SOFTWARE_REV_UUID, "1.0beta"},
+        {DI_MANUFACTURER_UUID, "t-j"},
+    };
+    for (const auto &c : TEXT_CHARACTERISTICS)
+    {
+        result = createReadOnlyCharacteristic(c.uuid, c.value);
+        if (!result.ok())
+            return result;
+    }
+
+    if (!service->start())
+        return Status::error(STATUS_START_FAILED, DI_UUID);
+    return Status::success();
 }
 
-void DeviceInfoService::createReadOnlyCharacteristic(BLEUUID uuid, const char *value)
+Status DeviceInfoService::createReadOnlyCharacteristic(const gatt::Uuid &uuid, const uint8_t *value, size_t len)
 {
-    BLECharacteristic *charac = service->createCharacteristic(
+    gatt::Characteristic *charac = service->createCharacteristic(
         uuid,
-        BLECharacteristic::PROPERTY_READ);
-    charac->setValue(value);
+        CHARACTERISTIC_PROPERTY_READ);
+    if (!charac)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, uuid);
+    charac->setValue(value, len);
+    return Status::success();
+}
+
+Status DeviceInfoService::createReadOnlyCharacteristic(const gatt::Uuid &uuid, const char *value)
+{
+    return createReadOnlyCharacteristic(uuid, (const uint8_t *)value, strlen(value));
 }
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 #include "BLEConfig.h"
+#include "Status.h"
 
 class DeviceInfoService
 {
 public:
-    DeviceInfoService(BLEServer *server);
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    DeviceInfoService(gatt::Server *server);
+
+    Status getStatus() const { return status; }
 
 private:
-    BLEService *service;
-    void createReadOnlyCharacteristic(BLEUUID uuid, const char *value);
+    gatt::Service *service = nullptr;
+    Status status;
+
+    Status init(gatt::Server *server);
+    Status createReadOnlyCharacteristic(const gatt::Uuid &uuid, const uint8_t *value, size_t len);
+    Status createReadOnlyCharacteristic(const gatt::Uuid &uuid, const char *value);
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "FTMSService.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Fitness Machine Feature 位 (0x2ACC)
+static const uint32_t FTMS_FEATURE_CADENCE = 1 << 1; // 支持踏频
+static const uint32_t FTMS_FEATURE_POWER = 1 << 14;  // 支持功率测量
+
+FTMSService::FTMSService(gatt::Server *server)
+{
+    status = init(server);
+}
+
+Status FTMSService::init(gatt::Server *server)
+{
+    if (!server)
+        return Status::error(STATUS_INVALID_ARGUMENT);
+
+    // 创建 FTMS 服务
+    service = server->createService(FTMS_UUID);
+    if (!service)
+        return Status::error(STATUS_SERVICE_FAILED, FTMS_UUID);
+
+    // 创建 Fitness Machine Feature 特征值：机器特性(4) + 目标设定特性(4)
+    // 不支持目标设定，因此不提供 Control Point
+    featureChar = service->createCharacteristic(
+        FTMS_FEATURE_UUID,
+        CHARACTERISTIC_PROPERTY_READ);
+    if (!featureChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, FTMS_FEATURE_UUID);
+    uint8_t features[8] = {};
+    encoder::putU32(features, FTMS_FEATURE_CADENCE | FTMS_FEATURE_POWER);
+    featureChar->setValue(features, sizeof(features));
+
+    // 创建 Indoor Bike Data 特征值（仅通知，CCCD 由后端创建）
+    indoorBikeDataChar = service->createCharacteristic(
+        INDOOR_BIKE_DATA_UUID,
+        CHARACTERISTIC_PROPERTY_NOTIFY);
+    if (!indoorBikeDataChar)
+        return Status::error(STATUS_CHARACTERISTIC_FAILED, INDOOR_BIKE_DATA_UUID);
+    indoorBikeDataChar->setValue((uint8_t *)0, 0);
+
+    // 启动服务
+    if (!service->start())
+        return Status::error(STATUS_START_FAILED, FTMS_UUID);
+    return Status::success();
+}
+
+encoder::IbdFields FTMSService::toFields(float speed, float cadence, int16_t power)
+{
+    encoder::IbdFields fields = {};
+    float s = speed * 100.0f + 0.5f;
+    float c = cadence * 2.0f + 0.5f;
+    fields.speed = s <= 0.0f ? 0 : (s >= 65535.0f ? 65535 : (uint16_t)s);
+    fields.cadence = c <= 0.0f ? 0 : (c >= 65535.0f ? 65535 : (uint16_t)c);
+    fields.power = power;
+    return fields;
+}
+
+bool FTMSService::updateMeasurement(float speed, float cadence, int16_t power)
+{
+    // 初始化失败时由 getStatus() 报告，这里不再逐次打印
+    if (!status.ok())
+        return false;
+
+    // 速度 + 踏频 + 功率：flags(2) + speed(2) + cadence(2) + power(2)
+    auto data = encoder::IbdSpeedCadencePower::encode(toFields(speed, cadence, power));
+
+    indoorBikeDataChar->setValue(data.data(), data.size());
+    coalescer.submit(data.data(), data.size());
+    return flush(esp_timer_get_time());
+}
+
+bool FTMSService::flush(int64_t nowUs)
+{
+    if (!status.ok() || !coalescer.take(nowUs))
+        return false;
+    indoorBikeDataChar->notify();
+    return true;
+}
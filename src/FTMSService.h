@@ -0,0 +1,34 @@
+#pragma once
+#include "BLEConfig.h"
+#include "MeasurementEncoder.h"
+#include "NotifyCoalescer.h"
+#include "Status.h"
+
+// 健身器材服务 (FTMS, 0x1826)：仅提供 Indoor Bike Data，
+// 一个通知即可带上速度、踏频与功率（CSC + CP 需要两个通知）
+class FTMSService
+{
+public:
+    // 构造失败不抛异常，由 getStatus() 返回错误码
+    FTMSService(gatt::Server *server);
+    // 更新特征值并交给合并器，返回本次是否发出了通知
+    bool updateMeasurement(float speed, float cadence, int16_t power);
+    // 发送合并窗口到期的负载或保活包
+    bool flush(int64_t nowUs);
+
+    // km/h、rpm 转换为规范单位（0.01 km/h、0.5 rpm），四舍五入并限制在字段范围内
+    static encoder::IbdFields toFields(float speed, float cadence, int16_t power);
+
+    Status getStatus() const { return status; }
+    gatt::Characteristic *getMeasurementChar() const { return indoorBikeDataChar; }
+    NotifyCoalescer &getCoalescer() { return coalescer; }
+
+private:
+    gatt::Service *service = nullptr;
+    gatt::Characteristic *featureChar = nullptr;
+    gatt::Characteristic *indoorBikeDataChar = nullptr;
+    NotifyCoalescer coalescer;
+    Status status;
+
+    Status init(gatt::Server *server);
+};
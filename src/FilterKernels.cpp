@@ -0,0 +1,177 @@
+#include "FilterKernels.h"
+#include <math.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <sdkconfig.h>
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3 || defined(__SSE2__) || defined(__ARM_NEON)
+#define DSP_MEDIAN_VECTOR 1
+#else
+#define DSP_MEDIAN_VECTOR 0
+#endif
+
+namespace dsp
+{
+    namespace
+    {
+        // 一行 8 路 int16，16 字节对齐：PIE 的 128 位载入/存储只接受对齐地址
+        struct Row
+        {
+            int16_t lane[VECTOR_LANES];
+        } __attribute__((aligned(16)));
+
+#if CONFIG_IDF_TARGET_ESP32S3
+        // PIE：两行载入 q0/q1，EE.VMIN.S16/EE.VMAX.S16 逐路比较后写回。
+        // 编译器不分配 q 寄存器，不需要声明为破坏
+        inline void compareExchange(Row &a, Row &b)
+        {
+            int16_t *pa = a.lane;
+            int16_t *pb = b.lane;
+            asm volatile("ee.vld.128.ip q0, %0, 0\n\t"
+                         "ee.vld.128.ip q1, %1, 0\n\t"
+                         "ee.vmin.s16 q2, q0, q1\n\t"
+                         "ee.vmax.s16 q3, q0, q1\n\t"
+                         "ee.vst.128.ip q2, %0, 0\n\t"
+                         "ee.vst.128.ip q3, %1, 0\n\t"
+                         : "+r"(pa), "+r"(pb)
+                         :
+                         : "memory");
+        }
+#else
+        // GCC 通用向量：8 x int16，主机上编译为 SSE2 pminsw/pmaxsw 或 NEON smin/smax
+        typedef int16_t Vec __attribute__((vector_size(16)));
+
+        inline void compareExchange(Row &a, Row &b)
+        {
+            Vec x, y;
+            memcpy(&x, a.lane, sizeof(x));
+            memcpy(&y, b.lane, sizeof(y));
+            Vec lo = x < y ? x : y;
+            Vec hi = x < y ? y : x;
+            memcpy(a.lane, &lo, sizeof(lo));
+            memcpy(b.lane, &hi, sizeof(hi));
+        }
+#endif
+
+        // 奇偶换位排序网络：N 轮相邻比较交换后有序，取中间一路。
+        // 窗口按行拷入对齐的暂存区，网络部分在目标与主机上相同，只有 compareExchange 按平台实现
+        template <int N>
+        void medianVectorN(const int16_t *window, int16_t *out, size_t blocks)
+        {
+            Row v[N];
+            for (size_t b = 0; b < blocks; b++)
+            {
+                const int16_t *w = window + b * VECTOR_LANES;
+                for (int k = 0; k < N; k++)
+                    memcpy(v[k].lane, w + k, sizeof(v[k].lane)); // 第 j 路为 window[j + k]
+                for (int round = 0; round < N; round++)
+                {
+                    for (int k = round & 1; k + 1 < N; k += 2)
+                        compareExchange(v[k], v[k + 1]);
+                }
+                memcpy(out + b * VECTOR_LANES, v[N / 2].lane, sizeof(v[N / 2].lane));
+            }
+        }
+
+        inline int16_t saturate(int32_t v)
+        {
+            if (v > INT16_MAX)
+                return INT16_MAX;
+            if (v < INT16_MIN)
+                return INT16_MIN;
+            return (int16_t)v;
+        }
+    }
+
+    void medianScalar(const int16_t *window, int16_t *out, size_t n, uint8_t size)
+    {
+        if (size <= 1)
+        {
+            memmove(out, window, n * sizeof(int16_t));
+            return;
+        }
+        int16_t sorted[MAX_MEDIAN];
+        for (size_t i = 0; i < n; i++)
+        {
+            for (uint8_t k = 0; k < size; k++)
+            {
+                int16_t v = window[i + k];
+                int j = k;
+                while (j > 0 && sorted[j - 1] > v)
+                {
+                    sorted[j] = sorted[j - 1];
+                    j--;
+                }
+                sorted[j] = v;
+            }
+            out[i] = sorted[size / 2];
+        }
+    }
+
+    void medianVector(const int16_t *window, int16_t *out, size_t n, uint8_t size)
+    {
+        size_t blocks = n / VECTOR_LANES;
+        switch (size)
+        {
+        case 3:
+            medianVectorN<3>(window, out, blocks);
+            break;
+        case 5:
+            medianVectorN<5>(window, out, blocks);
+            break;
+        case 7:
+            medianVectorN<7>(window, out, blocks);
+            break;
+        case 9:
+            medianVectorN<9>(window, out, blocks);
+            break;
+        default:
+            blocks = 0;
+            break;
+        }
+        size_t done = blocks * VECTOR_LANES;
+        medianScalar(window + done, out + done, n - done, size);
+    }
+
+    bool medianIsVector()
+    {
+        return DSP_MEDIAN_VECTOR;
+    }
+
+    void median(const int16_t *window, int16_t *out, size_t n, uint8_t size)
+    {
+#if DSP_MEDIAN_VECTOR
+        medianVector(window, out, n, size);
+#else
+        medianScalar(window, out, n, size);
+#endif
+    }
+
+    int32_t ema(const int16_t *in, int16_t *out, size_t n, uint16_t alphaQ15, int32_t state)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            int32_t target = (int32_t)in[i] * 256;
+            state += (int32_t)(((int64_t)(target - state) * alphaQ15) >> 15);
+            out[i] = saturate((state + 128) >> 8);
+        }
+        return state;
+    }
+
+    void kalman(const int16_t *in, int16_t *out, size_t n, float q, float r, float *x, float *p)
+    {
+        float xs = *x;
+        float ps = *p;
+        for (size_t i = 0; i < n; i++)
+        {
+            ps += q;
+            float k = ps / (ps + r);
+            xs += k * ((float)in[i] - xs);
+            ps *= 1.0f - k;
+            out[i] = (int16_t)fminf(fmaxf(floorf(xs + 0.5f), -32768.0f), 32767.0f);
+        }
+        *x = xs;
+        *p = ps;
+    }
+}
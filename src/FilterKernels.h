@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 采样滤波的批处理内核（与平台无关）。样本为 int16（功率 W、踏频 0.1 rpm），
+// 所有内核对同一输入在任何平台上给出逐位相同的输出，主机端基准交叉校验。
+//
+// 中值滤波有两种实现：
+// - medianScalar：逐个窗口插入排序
+// - medianVector：8 路 int16 向量（128 位）上的奇偶换位排序网络，只用逐路 min/max，
+//   一次得到 8 个输出。ESP32-S3 上比较交换为 PIE 的 EE.VMIN.S16/EE.VMAX.S16，
+//   主机上为 GCC 通用向量 (SSE2/NEON)；排序网络与数据搬运两边共用，主机端交叉校验
+// EMA 与 Kalman 是逐样本递推，无法按时间展开为向量，只有标量实现。
+namespace dsp
+{
+    const uint8_t MAX_MEDIAN = 9; // 中值窗口上限（奇数）
+    const size_t VECTOR_LANES = 8;
+
+    // window 含 n + size - 1 个样本：out[i] = median(window[i .. i + size - 1])
+    // size 为 1..MAX_MEDIAN 的奇数
+    void medianScalar(const int16_t *window, int16_t *out, size_t n, uint8_t size);
+    void medianVector(const int16_t *window, int16_t *out, size_t n, uint8_t size);
+
+    // 按平台选择的中值实现：ESP32-S3 (PIE) 与有 128 位整数 SIMD (SSE2/NEON) 的主机用向量版，
+    // 其余平台用标量版
+    void median(const int16_t *window, int16_t *out, size_t n, uint8_t size);
+    bool medianIsVector();
+
+    // 指数滑动平均：state 为 Q8 定点，alphaQ15 为 Q15 平滑系数 (1..32768)，返回新状态
+    int32_t ema(const int16_t *in, int16_t *out, size_t n, uint16_t alphaQ15, int32_t state);
+
+    // 一维 Kalman（随机游走模型）：q 过程噪声方差，r 测量噪声方差，x/p 为状态与估计方差
+    void kalman(const int16_t *in, int16_t *out, size_t n, float q, float r, float *x, float *p);
+}
@@ -0,0 +1,266 @@
+#include "Gateway.h"
+#include "Log.h"
+#include "MeasurementEncoder.h"
+
+bool Gateway::begin(gatt::Server *srv, CSCService *csc, CPService *cp, BikeSelectService *select,
+                    KeiserScanner *keiser, const Config &cfg)
+{
+    if (!srv || !csc || !cp || !select || !keiser)
+    {
+        LOG_ERROR("[ERROR] Gateway: 无效的参数");
+        return false;
+    }
+
+    end();
+
+    server = srv;
+    cscService = csc;
+    cpService = cp;
+    scanner = keiser;
+    config = cfg;
+
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        sessions[i].connId = NO_CONN;
+        sessions[i].slot = -1;
+        sessions[i].bikeId = 0;
+        sessions[i].requestedId = 0;
+        sessions[i].policy = NotifyPolicy();
+        sessions[i].policy.setMinInterval(CHANNEL_CSC, config.minIntervalMs * 1000);
+        sessions[i].policy.setMinInterval(CHANNEL_CP, config.minIntervalMs * 1000);
+    }
+
+    // 单车选择服务已随其他服务在广播前注册，首批连接的中心设备即可发现
+    select->setWriteHandler(onBikeSelectWrite, this);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = timerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "gateway";
+    if (esp_timer_create(&timerArgs, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, (uint64_t)config.producerPeriodMs * 1000) != ESP_OK)
+    {
+        LOG_ERROR("[ERROR] Gateway: 创建定时器失败");
+        end();
+        return false;
+    }
+
+    lastActivityMillis = millis();
+    LOG_INFO("[BLE] 多车网关启动成功");
+    return true;
+}
+
+void Gateway::end()
+{
+    if (timer)
+    {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+        timer = nullptr;
+    }
+}
+
+void Gateway::onConnect(uint16_t connId)
+{
+    portENTER_CRITICAL(&sessionMux);
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        if (sessions[i].connId == NO_CONN)
+        {
+            sessions[i].connId = connId;
+            sessions[i].slot = -1;
+            sessions[i].requestedId = 0;
+            sessions[i].policy = NotifyPolicy();
+            sessions[i].policy.setMinInterval(CHANNEL_CSC, config.minIntervalMs * 1000);
+            sessions[i].policy.setMinInterval(CHANNEL_CP, config.minIntervalMs * 1000);
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&sessionMux);
+}
+
+void Gateway::onDisconnect(uint16_t connId)
+{
+    portENTER_CRITICAL(&sessionMux);
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        if (sessions[i].connId == connId)
+        {
+            sessions[i].connId = NO_CONN;
+            sessions[i].slot = -1;
+        }
+    }
+    portEXIT_CRITICAL(&sessionMux);
+}
+
+bool Gateway::selectBike(uint16_t connId, uint8_t bikeId)
+{
+    bool found = false;
+    portENTER_CRITICAL(&sessionMux);
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        if (sessions[i].connId == connId)
+        {
+            sessions[i].requestedId = bikeId;
+            sessions[i].slot = -1; // 下一个周期重新绑定
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&sessionMux);
+    return found;
+}
+
+uint8_t Gateway::getSessionCount() const
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        if (sessions[i].connId != NO_CONN)
+            n++;
+    }
+    return n;
+}
+
+void Gateway::timerCallback(void *arg)
+{
+    static_cast<Gateway *>(arg)->tick();
+}
+
+void Gateway::onBikeSelectWrite(void *ctx, uint16_t connId, const uint8_t *data, size_t len)
+{
+    // 直接读取写入的数据，不经过 std::string
+    if (len >= 1)
+        static_cast<Gateway *>(ctx)->selectBike(connId, data[0]);
+}
+
+void Gateway::bindSessions()
+{
+    // 调用方需持有 sessionMux
+    uint32_t bound = 0;
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        Session &s = sessions[i];
+        if (s.connId == NO_CONN || s.slot < 0)
+            continue;
+        // 槽位被回收或换成了其他单车时解除绑定
+        if (!table.isActive(s.slot) || table.bikeId(s.slot) != s.bikeId)
+            s.slot = -1;
+        else
+            bound |= 1u << s.slot;
+    }
+
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        Session &s = sessions[i];
+        if (s.connId == NO_CONN || s.slot >= 0)
+            continue;
+
+        int slot = BikeTable::NOT_FOUND;
+        if (s.requestedId != 0)
+        {
+            slot = table.find(s.requestedId);
+        }
+        else
+        {
+            // 自动分配：编号最小的未绑定单车
+            uint32_t free = table.getActiveMask() & ~bound;
+            int bestId = 256;
+            while (free)
+            {
+                uint8_t candidate = __builtin_ctz(free);
+                free &= free - 1;
+                if (table.bikeId(candidate) < bestId)
+                {
+                    bestId = table.bikeId(candidate);
+                    slot = candidate;
+                }
+            }
+        }
+
+        if (slot != BikeTable::NOT_FOUND)
+        {
+            s.slot = (int8_t)slot;
+            s.bikeId = table.bikeId(slot);
+            bound |= 1u << slot;
+        }
+    }
+}
+
+void Gateway::tick()
+{
+    uint32_t nowMs = millis();
+    lastActivityMillis = nowMs;
+
+    KeiserSample samples[KeiserScanner::MAX_PENDING];
+    size_t n = scanner->takePending(samples, KeiserScanner::MAX_PENDING);
+    for (size_t i = 0; i < n; i++)
+    {
+        table.ingest(samples[i], nowMs);
+    }
+
+    uint32_t changed = table.advance(micros(), nowMs);
+
+    // 在锁内确定每个会话要发送的内容，锁外发送
+    struct Pending
+    {
+        uint16_t connId;
+        bool csc;
+        bool cp;
+        BikeData::Data data;
+    } work[MAX_SESSIONS];
+    uint8_t workCount = 0;
+
+    int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&sessionMux);
+    bindSessions();
+    for (uint8_t i = 0; i < MAX_SESSIONS; i++)
+    {
+        Session &s = sessions[i];
+        if (s.connId == NO_CONN || s.slot < 0)
+            continue;
+        if (changed & (1u << s.slot))
+        {
+            s.policy.markPending(CHANNEL_CSC, nowUs);
+            s.policy.markPending(CHANNEL_CP, nowUs);
+        }
+        bool csc = s.policy.take(CHANNEL_CSC, nowUs, nullptr);
+        bool cp = s.policy.take(CHANNEL_CP, nowUs, nullptr);
+        if (csc || cp)
+        {
+            work[workCount].connId = s.connId;
+            work[workCount].csc = csc;
+            work[workCount].cp = cp;
+            work[workCount].data = table.get(s.slot);
+            workCount++;
+        }
+    }
+    portEXIT_CRITICAL(&sessionMux);
+
+    for (uint8_t i = 0; i < workCount; i++)
+    {
+        const BikeData::Data &d = work[i].data;
+        if (work[i].csc)
+        {
+            auto buf = encoder::CscWheelCrank::encode(d.wheel_rev, d.w_event_time,
+                                                      d.crank_rev, d.c_event_time);
+            send(work[i].connId, cscService->getMeasurementChar(), buf.data(), buf.size());
+        }
+        if (work[i].cp)
+        {
+            // 与单车模式相同的 CP 负载格式（按特性位携带转数与能量）
+            uint8_t buf[CPService::MAX_MEASUREMENT_SIZE];
+            size_t len = cpService->encode(CPService::toFields(d), buf);
+            send(work[i].connId, cpService->getMeasurementChar(), buf, len);
+        }
+    }
+}
+
+void Gateway::send(uint16_t connId, gatt::Characteristic *characteristic, const uint8_t *data, size_t len)
+{
+    if (!characteristic)
+        return;
+    // 只发给该会话的连接，而不是广播给所有订阅者
+    if (characteristic->notify(data, len, connId))
+        notifyCount++;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include "BikeSelectService.h"
+#include "BikeTable.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "GattBackend.h"
+#include "KeiserScanner.h"
+#include "NotifyPolicy.h"
+
+// 多车网关：一台设备接收整个教室的 Keiser 广播，
+// 每个连接的中心设备对应一个会话，会话绑定一台单车并独立编码、限速、发送
+class Gateway
+{
+public:
+    static const uint8_t MAX_SESSIONS = 9; // 受控制器最大连接数限制
+    static const uint16_t NO_CONN = 0xFFFF;
+
+    struct Config
+    {
+        uint32_t producerPeriodMs = 50; // 表推进周期
+        uint32_t minIntervalMs = 100;   // 每个会话每个特征值的最小通知间隔
+    };
+
+    // 单车选择服务须已在开始广播前创建（见 BikeSelectService），这里只接管它的写入
+    bool begin(gatt::Server *server, CSCService *csc, CPService *cp, BikeSelectService *select,
+               KeiserScanner *scanner, const Config &config);
+    void end();
+
+    // 由服务器回调调用，connId 为连接句柄
+    void onConnect(uint16_t connId);
+    void onDisconnect(uint16_t connId);
+
+    // 中心设备写入选择特征值时调用，bikeId 为 0 表示自动分配
+    bool selectBike(uint16_t connId, uint8_t bikeId);
+
+    uint8_t getSessionCount() const;
+    uint8_t getBikeCount() const { return table.count(); }
+    uint32_t getNotifyCount() const { return notifyCount; }
+
+    // 定时器最近一次运行的时间，用于看门狗
+    unsigned long getLastActivityMillis() const { return lastActivityMillis; }
+
+private:
+    struct Session
+    {
+        uint16_t connId;
+        int8_t slot;        // 绑定的表槽位，-1 表示未绑定
+        uint8_t bikeId;     // 绑定时的单车编号，用于检测槽位被回收
+        uint8_t requestedId; // 中心设备指定的单车编号，0 表示自动
+        NotifyPolicy policy;
+    };
+
+    enum Channel : uint8_t
+    {
+        CHANNEL_CSC = 0,
+        CHANNEL_CP
+    };
+
+    gatt::Server *server = nullptr;
+    CSCService *cscService = nullptr;
+    CPService *cpService = nullptr;
+    KeiserScanner *scanner = nullptr;
+    Config config;
+
+    BikeTable table;
+    Session sessions[MAX_SESSIONS];
+    portMUX_TYPE sessionMux = portMUX_INITIALIZER_UNLOCKED;
+    esp_timer_handle_t timer = nullptr;
+    uint32_t notifyCount = 0;
+    volatile unsigned long lastActivityMillis = 0;
+
+    static void timerCallback(void *arg);
+    static void onBikeSelectWrite(void *ctx, uint16_t connId, const uint8_t *data, size_t len);
+    void tick();
+    void bindSessions();
+    void send(uint16_t connId, gatt::Characteristic *characteristic, const uint8_t *data, size_t len);
+};
+
+// 每个会话占用一个连接：NimBLE 的连接上限由 platformio.ini 中的 CONFIG_BT_NIMBLE_MAX_CONNECTIONS 设置
+#ifdef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+static_assert(Gateway::MAX_SESSIONS <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS, "MAX_SESSIONS 超过 NimBLE 的连接上限");
+#endif
+static_assert(Gateway::MAX_SESSIONS <= gatt::MAX_CONNECTIONS, "MAX_SESSIONS 超过订阅表容量");
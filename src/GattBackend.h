@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// GATT 后端接口：服务类只依赖这里的最小接口，
+// 固件使用 NimBLE 实现 (NimBleBackend)，主机端使用 host/HostGatt 中的实现。
+// 特征值属性使用 BLEConfig.h 中的 CHARACTERISTIC_PROPERTY_* 位（与规范中的属性位一致）。
+namespace gatt
+{
+    static const uint16_t CONN_ALL = 0xFFFF; // 发给所有已订阅的连接
+    static const size_t MAX_CONNECTIONS = 9;  // 同时连接的中心设备上限（NimBLE 允许的最大值）
+
+    struct Uuid
+    {
+        uint16_t value16;     // 16 位 UUID，128 位时为 0
+        const char *value128; // 128 位 UUID 字符串，16 位时为空
+
+        constexpr Uuid(uint16_t value) : value16(value), value128(nullptr) {}
+        constexpr Uuid(const char *value) : value16(0), value128(value) {}
+        constexpr bool is16() const { return value128 == nullptr; }
+    };
+
+    // 写入回调：connHandle 为写入方的连接，data 仅在回调期间有效
+    typedef void (*WriteHandler)(void *ctx, uint16_t connHandle, const uint8_t *data, size_t len);
+
+    class Characteristic
+    {
+    public:
+        virtual void setValue(const uint8_t *data, size_t len) = 0;
+        void setValue(const char *str) { setValue((const uint8_t *)str, strlen(str)); }
+
+        // 发送当前值给所有已订阅的连接：负载只编码一次，由后端扇出到订阅了通知的连接
+        virtual bool notify() = 0;
+        // 只发给指定连接，不改变特征值（网关按连接发送不同单车的数据）
+        virtual bool notify(const uint8_t *data, size_t len, uint16_t connHandle) = 0;
+        virtual bool indicate() = 0;
+        // 只向指定连接指示当前值（须已订阅指示），用于 Control Point 等只应答请求方的响应
+        virtual bool indicate(uint16_t connHandle) = 0;
+
+        virtual const uint8_t *getData() const = 0;
+        virtual size_t getLength() const = 0;
+
+        virtual void setWriteHandler(WriteHandler handler, void *ctx) = 0;
+
+        // 按连接跟踪的 CCCD：当前订阅了通知或指示的连接数
+        virtual size_t getSubscriberCount() const = 0;
+
+    protected:
+        ~Characteristic() {}
+    };
+
+    class Service
+    {
+    public:
+        virtual Characteristic *createCharacteristic(const Uuid &uuid, uint8_t properties) = 0;
+        // 所有特征值创建完成后调用
+        virtual bool start() = 0;
+
+    protected:
+        ~Service() {}
+    };
+
+    class Server
+    {
+    public:
+        virtual Service *createService(const Uuid &uuid) = 0;
+
+    protected:
+        ~Server() {}
+    };
+}
@@ -0,0 +1,83 @@
+#include "KeiserParser.h"
+
+namespace
+{
+    inline uint16_t readU16(const uint8_t *p)
+    {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+}
+
+namespace KeiserParser
+{
+    bool findManufacturerData(const uint8_t *adv, size_t len,
+                              const uint8_t **payload, size_t *payloadLen)
+    {
+        if (!adv || !payload || !payloadLen)
+            return false;
+
+        size_t pos = 0;
+        while (pos < len)
+        {
+            uint8_t fieldLen = adv[pos];
+            if (fieldLen == 0)
+                break; // 剩余为填充
+            if (pos + 1 + fieldLen > len)
+                return false; // 截断的 AD 结构
+
+            const uint8_t *field = &adv[pos + 1];
+            if (field[0] == AD_TYPE_MANUFACTURER && fieldLen >= 3 &&
+                readU16(&field[1]) == COMPANY_ID)
+            {
+                *payload = &field[3];
+                *payloadLen = fieldLen - 3;
+                return true;
+            }
+            pos += 1 + fieldLen;
+        }
+        return false;
+    }
+
+    bool parsePayload(const uint8_t *payload, size_t len, KeiserSample &out)
+    {
+        if (!payload || len < MIN_PAYLOAD_LEN)
+            return false;
+
+        out.versionMajor = payload[0];
+        out.versionMinor = payload[1];
+        out.dataType = payload[2];
+        out.equipmentId = payload[3];
+        out.cadence = readU16(&payload[4]);
+        out.heartRate = readU16(&payload[6]);
+        out.power = readU16(&payload[8]);
+        out.calories = readU16(&payload[10]);
+        out.minutes = payload[12];
+        out.seconds = payload[13];
+
+        // 里程最高位为单位标志
+        uint16_t rawDistance = readU16(&payload[14]);
+        out.metric = (rawDistance & 0x8000) != 0;
+        out.distance = rawDistance & 0x7FFF;
+
+        out.gear = (out.versionMinor >= MIN_GEAR_VERSION && len > MIN_PAYLOAD_LEN) ? payload[16] : 0;
+        return true;
+    }
+
+    bool parseAdvertisement(const uint8_t *adv, size_t len, KeiserSample &out)
+    {
+        const uint8_t *payload;
+        size_t payloadLen;
+        if (!findManufacturerData(adv, len, &payload, &payloadLen))
+            return false;
+        return parsePayload(payload, payloadLen, out);
+    }
+
+    float estimateSpeed(const KeiserSample &sample)
+    {
+        uint8_t gear = sample.gear ? sample.gear : DEFAULT_GEAR;
+        if (gear > GEARS)
+            gear = GEARS;
+        float development = DEV_MIN + (DEV_MAX - DEV_MIN) * (gear - 1) / (GEARS - 1);
+        return (sample.cadence / 10.0f) * development * 60.0f / 1000.0f;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Keiser M 系列广播数据
+struct KeiserSample
+{
+    uint8_t versionMajor;
+    uint8_t versionMinor;
+    uint8_t dataType;     // 0 = 实时数据，其余为回顾模式
+    uint8_t equipmentId;  // 单车编号
+    uint16_t cadence;     // 踏频 (0.1 rpm)
+    uint16_t heartRate;   // 心率 (0.1 bpm)
+    uint16_t power;       // 功率 (W)
+    uint16_t calories;    // 卡路里 (kcal)
+    uint8_t minutes;      // 骑行时长 - 分
+    uint8_t seconds;      // 骑行时长 - 秒
+    uint16_t distance;    // 里程 (0.1 km 或 0.1 mi)
+    bool metric;          // 里程单位是否为公制
+    uint8_t gear;         // 档位 (1-24)，旧版固件为 0
+};
+
+// Keiser 广播解析器：直接在广播缓冲区上按偏移读取，
+// 不拷贝、不分配，可安全地在 BLE 主机回调中调用
+namespace KeiserParser
+{
+    const uint16_t COMPANY_ID = 0x0102;      // Keiser 厂商 ID
+    const uint8_t AD_TYPE_MANUFACTURER = 0xFF;
+    const size_t MIN_PAYLOAD_LEN = 16;       // 厂商 ID 之后不含档位的最短长度
+    const uint8_t MIN_GEAR_VERSION = 0x21;   // 含档位字段的最低次版本号
+
+    // 在原始广播数据 (AD 结构序列) 中查找 Keiser 厂商数据，
+    // payload 指向厂商 ID 之后的第一个字节
+    bool findManufacturerData(const uint8_t *adv, size_t len,
+                              const uint8_t **payload, size_t *payloadLen);
+
+    // 解析厂商 ID 之后的负载
+    bool parsePayload(const uint8_t *payload, size_t len, KeiserSample &out);
+
+    // 组合：查找并解析
+    bool parseAdvertisement(const uint8_t *adv, size_t len, KeiserSample &out);
+
+    // Keiser 不广播速度，按档位对应的每圈前进距离由踏频推算 (km/h)
+    const uint8_t GEARS = 24;         // 档位数
+    const uint8_t DEFAULT_GEAR = 12;  // 旧版固件无档位时的默认档位
+    const float DEV_MIN = 2.5f;       // 1 档每圈前进距离 (m)
+    const float DEV_MAX = 9.5f;       // 24 档每圈前进距离 (m)
+
+    float estimateSpeed(const KeiserSample &sample);
+}
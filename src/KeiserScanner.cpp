@@ -0,0 +1,162 @@
+#include "KeiserScanner.h"
+#include "Log.h"
+#if defined(CONFIG_NIMBLE_CPP_IDF)
+#include "host/ble_hs.h"
+#else
+#include "nimble/nimble/host/include/host/ble_hs.h"
+#endif
+
+bool KeiserScanner::begin(uint8_t equipmentId)
+{
+    targetId = equipmentId;
+    intervalMs = 50;
+    windowMs = 30;
+    if (!startScan())
+    {
+        LOG_ERROR("[ERROR] KeiserScanner: 启动扫描失败");
+        return false;
+    }
+
+    LOG_INFO("[BLE] Keiser 扫描已启动");
+    return true;
+}
+
+bool KeiserScanner::beginGateway()
+{
+    gatewayMode = true;
+    return begin(ANY_EQUIPMENT);
+}
+
+void KeiserScanner::end()
+{
+    scanning = false;
+    ble_gap_disc_cancel();
+}
+
+void KeiserScanner::setDutyCycle(uint16_t newIntervalMs, uint16_t newWindowMs)
+{
+    if (!scanning)
+        return;
+    intervalMs = newIntervalMs;
+    windowMs = newWindowMs < newIntervalMs ? newWindowMs : newIntervalMs;
+    // 扫描参数只能在启动时设置：先取消再以新参数启动
+    ble_gap_disc_cancel();
+    if (!startScan())
+        LOG_ERROR("[ERROR] KeiserScanner: 调整扫描参数失败");
+}
+
+// 被动扫描，关闭重复过滤以收到每一条广播；
+// 扫描窗口小于间隔，给连接事件留出射频时间
+bool KeiserScanner::startScan()
+{
+    uint8_t ownAddrType;
+    if (ble_hs_id_infer_auto(0, &ownAddrType) != 0)
+        return false;
+
+    ble_gap_disc_params params = {};
+    params.itvl = (uint16_t)(intervalMs * 1000 / 625); // 0.625 ms 单位
+    params.window = (uint16_t)(windowMs * 1000 / 625);
+    params.filter_policy = BLE_HCI_SCAN_FILT_NO_WL;
+    params.limited = 0;
+    params.passive = 1;
+    params.filter_duplicates = 0;
+
+    int rc = ble_gap_disc(ownAddrType, BLE_HS_FOREVER, &params, gapEvent, this);
+    scanning = rc == 0 || rc == BLE_HS_EALREADY;
+    return scanning;
+}
+
+bool KeiserScanner::takeLatest(KeiserSample &out)
+{
+    bool updated = false;
+    portENTER_CRITICAL(&mux);
+    if (hasSample)
+    {
+        out = latest;
+        hasSample = false;
+        updated = true;
+    }
+    portEXIT_CRITICAL(&mux);
+    return updated;
+}
+
+size_t KeiserScanner::takePending(KeiserSample *out, size_t maxCount)
+{
+    portENTER_CRITICAL(&mux);
+    size_t n = pendingCount < maxCount ? pendingCount : maxCount;
+    memcpy(out, pending, n * sizeof(KeiserSample));
+    pendingCount = 0;
+    portEXIT_CRITICAL(&mux);
+    return n;
+}
+
+// 在 NimBLE 主机任务中调用；广播数据只在回调期间有效，就地解析不做拷贝
+int KeiserScanner::gapEvent(struct ble_gap_event *event, void *arg)
+{
+    KeiserScanner *self = static_cast<KeiserScanner *>(arg);
+    switch (event->type)
+    {
+    case BLE_GAP_EVENT_DISC:
+        self->onAdvertisement(event->disc.data, event->disc.length_data);
+        break;
+
+    case BLE_GAP_EVENT_DISC_COMPLETE:
+        // 持续扫描被连接等事件打断后重新开始；end() 或调整参数时的取消不会产生此事件
+        if (self->scanning)
+            self->startScan();
+        break;
+
+    default:
+        break;
+    }
+    return 0;
+}
+
+void KeiserScanner::onAdvertisement(const uint8_t *adv, size_t len)
+{
+    advertCount++;
+
+    KeiserSample sample;
+    if (!KeiserParser::parseAdvertisement(adv, len, sample))
+        return;
+
+    if (gatewayMode)
+    {
+        matchCount++;
+        queueGatewaySample(sample);
+        return;
+    }
+
+    if (targetId == ANY_EQUIPMENT)
+        targetId = sample.equipmentId;
+    if (sample.equipmentId != targetId)
+        return;
+
+    matchCount++;
+    portENTER_CRITICAL(&mux);
+    latest = sample;
+    hasSample = true;
+    portEXIT_CRITICAL(&mux);
+}
+
+void KeiserScanner::queueGatewaySample(const KeiserSample &sample)
+{
+    // 同一台单车在一个周期内只保留最新一条
+    portENTER_CRITICAL(&mux);
+    uint8_t i = 0;
+    while (i < pendingCount && pending[i].equipmentId != sample.equipmentId)
+        i++;
+    if (i < pendingCount)
+    {
+        pending[i] = sample;
+    }
+    else if (pendingCount < MAX_PENDING)
+    {
+        pending[pendingCount++] = sample;
+    }
+    else
+    {
+        droppedCount++;
+    }
+    portEXIT_CRITICAL(&mux);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include <freertos/FreeRTOS.h>
+#include "KeiserParser.h"
+
+// Keiser M 广播被动扫描：
+// 不经过 NimBLEScan（它为每条广播在堆上创建 NimBLEAdvertisedDevice 并把负载拷贝进 std::vector），
+// 直接用 ble_gap_disc 注册 GAP 事件回调，在主机任务中就地解析 event->disc.data，
+// 每条广播没有堆分配与拷贝，只把最新一条匹配结果放入邮箱
+class KeiserScanner
+{
+public:
+    static const uint8_t ANY_EQUIPMENT = 0; // 锁定第一个收到的单车
+
+    static const uint8_t MAX_PENDING = 32;   // 网关模式下每个周期最多缓存的单车数
+
+    bool begin(uint8_t equipmentId = ANY_EQUIPMENT);
+    // 网关模式：接收所有单车的广播
+    bool beginGateway();
+    void end();
+    // 调整扫描间隔与窗口 (ms) 并重新开始扫描；电源管理在空闲时降低占空比
+    void setDutyCycle(uint16_t intervalMs, uint16_t windowMs);
+
+    // 取出最新一条数据（若自上次读取后有更新），供数据生产者调用
+    bool takeLatest(KeiserSample &out);
+
+    // 网关模式：取出自上次读取后每台单车的最新数据，返回条数
+    size_t takePending(KeiserSample *out, size_t maxCount);
+
+    uint8_t getEquipmentId() const { return targetId; }
+    uint32_t getAdvertCount() const { return advertCount; }
+    uint32_t getMatchCount() const { return matchCount; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+
+private:
+    static int gapEvent(struct ble_gap_event *event, void *arg);
+    bool startScan();
+    void onAdvertisement(const uint8_t *adv, size_t len);
+    void queueGatewaySample(const KeiserSample &sample);
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    uint16_t intervalMs = 50;
+    uint16_t windowMs = 30;
+    volatile bool scanning = false;
+    KeiserSample latest = {};
+    bool hasSample = false;
+    bool gatewayMode = false;
+    KeiserSample pending[MAX_PENDING];
+    uint8_t pendingCount = 0;
+    volatile uint32_t droppedCount = 0;
+    volatile uint8_t targetId = ANY_EQUIPMENT;
+    volatile uint32_t advertCount = 0;
+    volatile uint32_t matchCount = 0;
+};
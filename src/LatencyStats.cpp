@@ -0,0 +1,47 @@
+#include "LatencyStats.h"
+#include <string.h>
+
+LatencyStats::LatencyStats()
+{
+    reset();
+}
+
+void LatencyStats::reset()
+{
+    memset(buckets, 0, sizeof(buckets));
+    total = 0;
+    maxLatency = 0;
+}
+
+void LatencyStats::record(uint32_t latencyUs)
+{
+    uint32_t index = latencyUs / BUCKET_US;
+    if (index >= BUCKETS)
+        index = BUCKETS - 1;
+    buckets[index]++;
+    total++;
+    if (latencyUs > maxLatency)
+        maxLatency = latencyUs;
+}
+
+uint32_t LatencyStats::percentileUs(uint8_t p) const
+{
+    if (total == 0)
+        return 0;
+    if (p > 100)
+        p = 100;
+
+    // 向上取整，保证 p99 至少覆盖 99% 的样本
+    uint64_t target = ((uint64_t)total * p + 99) / 100;
+    if (target == 0)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= target)
+            return (i + 1) * BUCKET_US;
+    }
+    return BUCKETS * BUCKET_US;
+}
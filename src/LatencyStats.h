@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+// 事件到通知的延迟统计：固定桶宽直方图，O(1) 记录，无堆分配
+class LatencyStats
+{
+public:
+    static const uint32_t BUCKET_US = 128; // 桶宽 (us)
+    static const uint32_t BUCKETS = 512;   // 覆盖 0 ~ 65.5ms，超出部分计入最后一个桶
+
+    LatencyStats();
+    void record(uint32_t latencyUs);
+    void reset();
+
+    uint32_t count() const { return total; }
+    uint32_t maxUs() const { return maxLatency; }
+    // 返回第 p 百分位 (0-100) 所在桶的上界 (us)
+    uint32_t percentileUs(uint8_t p) const;
+
+private:
+    uint32_t buckets[BUCKETS];
+    uint32_t total;
+    uint32_t maxLatency;
+};
@@ -0,0 +1,49 @@
+#include "LedPattern.h"
+
+static const LedPattern::Color RED = {255, 0, 0};
+static const LedPattern::Color AMBER = {255, 128, 0};
+static const LedPattern::Color WHITE = {255, 255, 255};
+
+LedPattern::State LedPattern::stateFor(bool connected, bool ingesting, bool error)
+{
+    if (error)
+        return STATE_ERROR;
+    if (!connected)
+        return STATE_ADVERTISING;
+    return ingesting ? STATE_STREAMING : STATE_WAITING_DATA;
+}
+
+LedPattern::Color LedPattern::render(State state, uint32_t nowMs) const
+{
+    switch (state)
+    {
+    case STATE_ADVERTISING:
+        if (config.blinkPeriodMs && nowMs % config.blinkPeriodMs < config.blinkOnMs)
+            return scale(RED, config.blinkLevel);
+        return Color{0, 0, 0};
+    case STATE_WAITING_DATA:
+        return scale(AMBER, breathLevel(nowMs));
+    case STATE_STREAMING:
+        return scale(WHITE, breathLevel(nowMs));
+    case STATE_ERROR:
+    default:
+        return scale(RED, config.blinkLevel);
+    }
+}
+
+LedPattern::Color LedPattern::scale(Color color, uint8_t level)
+{
+    // 与 Adafruit_NeoPixel::setBrightness 相同的缩放方式
+    return Color{(uint8_t)((color.r * (level + 1)) >> 8),
+                 (uint8_t)((color.g * (level + 1)) >> 8),
+                 (uint8_t)((color.b * (level + 1)) >> 8)};
+}
+
+uint8_t LedPattern::breathLevel(uint32_t nowMs) const
+{
+    if (!config.breathPeriodMs)
+        return config.breathLevel;
+    uint32_t phase = nowMs % config.breathPeriodMs;
+    size_t index = (size_t)((uint64_t)phase * breath::TABLE_SIZE / config.breathPeriodMs);
+    return (uint8_t)((breath::TABLE[index] * config.breathLevel + 127) / 255);
+}
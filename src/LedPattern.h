@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include "BreathTable.h"
+
+// 状态灯图案：由 BLE 连接与数据输入状态决定颜色与节奏，
+// render() 只做查表与整数运算，可在主机上测试，也可在任意周期调用。
+class LedPattern
+{
+public:
+    enum State : uint8_t
+    {
+        STATE_ADVERTISING = 0, // 未连接：红色闪烁
+        STATE_WAITING_DATA,    // 已连接但没有数据输入：琥珀色呼吸
+        STATE_STREAMING,       // 已连接且有数据输入：白色呼吸
+        STATE_ERROR            // 即将重启：红色常亮
+    };
+
+    struct Color
+    {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+
+        bool operator==(const Color &other) const { return r == other.r && g == other.g && b == other.b; }
+        bool operator!=(const Color &other) const { return !(*this == other); }
+    };
+
+    struct Config
+    {
+        uint32_t blinkPeriodMs = 1000;  // 未连接时的闪烁周期
+        uint32_t blinkOnMs = 500;       // 每个周期点亮的时长
+        uint8_t blinkLevel = 16;        // 闪烁亮度 (0..255)
+        uint32_t breathPeriodMs = 6000; // 呼吸周期（与原 exp(sin(t/3000·π)) 曲线一致）
+        uint8_t breathLevel = 32;       // 呼吸峰值亮度
+    };
+
+    LedPattern() {}
+    explicit LedPattern(const Config &config) : config(config) {}
+
+    static State stateFor(bool connected, bool ingesting, bool error);
+
+    // 返回 nowMs 时刻的颜色（已按亮度缩放）
+    Color render(State state, uint32_t nowMs) const;
+
+    const Config &getConfig() const { return config; }
+
+private:
+    Config config;
+
+    static Color scale(Color color, uint8_t level);
+    uint8_t breathLevel(uint32_t nowMs) const;
+};
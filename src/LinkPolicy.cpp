@@ -0,0 +1,201 @@
+#include "LinkPolicy.h"
+
+// 时间比较按差值的符号，跨越 millis() 回绕
+static bool reached(uint32_t nowMs, uint32_t atMs)
+{
+    return (int32_t)(nowMs - atMs) >= 0;
+}
+
+void LinkPolicy::begin(uint32_t nowMs)
+{
+    activity = ACTIVITY_ACTIVE;
+    lastActivityMs = nowMs;
+    linkCount = 0;
+}
+
+bool LinkPolicy::onConnect(uint32_t nowMs, uint16_t connHandle, uint16_t interval, uint16_t latency,
+                           uint16_t timeout, Request &request)
+{
+    if (findLink(connHandle) || linkCount == MAX_LINKS)
+        return false;
+
+    Link &link = links[linkCount++];
+    link = {};
+    link.connHandle = connHandle;
+    link.interval = interval;
+    link.latency = latency;
+    link.timeout = timeout;
+    link.txPhy = PHY_1M;
+    link.rxPhy = PHY_1M;
+    link.mtu = 23;
+    link.nextRequestMs = nowMs + config.paramsDelayMs;
+
+    // 新连接按活动处理：服务发现与首批通知使用短间隔
+    lastActivityMs = nowMs;
+    if (activity != ACTIVITY_ACTIVE)
+    {
+        activity = ACTIVITY_ACTIVE;
+        resetAttempts(nowMs);
+        link.nextRequestMs = nowMs + config.paramsDelayMs;
+    }
+
+    request.connHandle = connHandle;
+    request.actions = 0;
+    request.params = getParams();
+    if (config.phy2M)
+        request.actions |= ACTION_PHY;
+    if (config.dataLenOctets)
+        request.actions |= ACTION_DATA_LEN;
+    return true;
+}
+
+void LinkPolicy::onDisconnect(uint16_t connHandle)
+{
+    Link *link = findLink(connHandle);
+    if (link)
+        *link = links[--linkCount];
+}
+
+void LinkPolicy::onParamsUpdated(uint16_t connHandle, uint16_t interval, uint16_t latency, uint16_t timeout)
+{
+    Link *link = findLink(connHandle);
+    if (!link)
+        return;
+    link->interval = interval;
+    link->latency = latency;
+    link->timeout = timeout;
+    link->updates++;
+}
+
+void LinkPolicy::onPhyUpdated(uint16_t connHandle, uint8_t txPhy, uint8_t rxPhy)
+{
+    Link *link = findLink(connHandle);
+    if (!link)
+        return;
+    link->txPhy = txPhy;
+    link->rxPhy = rxPhy;
+}
+
+void LinkPolicy::onMtuChanged(uint16_t connHandle, uint16_t mtu)
+{
+    Link *link = findLink(connHandle);
+    if (link)
+        link->mtu = mtu;
+}
+
+bool LinkPolicy::update(uint32_t nowMs, bool riding)
+{
+    Activity next = activity;
+    if (riding)
+    {
+        next = ACTIVITY_ACTIVE;
+        lastActivityMs = nowMs;
+    }
+    else if (activity == ACTIVITY_ACTIVE && config.idleAfterMs && nowMs - lastActivityMs >= config.idleAfterMs)
+    {
+        next = ACTIVITY_IDLE;
+    }
+
+    if (next == activity)
+        return false;
+    activity = next;
+    resetAttempts(nowMs);
+    return true;
+}
+
+size_t LinkPolicy::poll(uint32_t nowMs, Request *requests, size_t maxRequests)
+{
+    const ConnParams &params = getParams();
+    size_t count = 0;
+    for (size_t i = 0; i < linkCount && count < maxRequests; i++)
+    {
+        Link &link = links[i];
+        if (accepts(params, link.interval) || link.attempts >= config.maxAttempts ||
+            !reached(nowMs, link.nextRequestMs))
+            continue;
+        link.attempts++;
+        link.requests++;
+        link.nextRequestMs = nowMs + config.retryMs;
+        requests[count++] = {link.connHandle, ACTION_PARAMS, params};
+    }
+    return count;
+}
+
+const LinkPolicy::Link *LinkPolicy::find(uint16_t connHandle) const
+{
+    for (size_t i = 0; i < linkCount; i++)
+    {
+        if (links[i].connHandle == connHandle)
+            return &links[i];
+    }
+    return nullptr;
+}
+
+LinkPolicy::Link *LinkPolicy::findLink(uint16_t connHandle)
+{
+    return const_cast<Link *>(find(connHandle));
+}
+
+void LinkPolicy::resetAttempts(uint32_t nowMs)
+{
+    for (size_t i = 0; i < linkCount; i++)
+    {
+        links[i].attempts = 0;
+        links[i].nextRequestMs = nowMs;
+    }
+}
+
+uint32_t LinkPolicy::airTimeUs(Phy phy, size_t llPayloadLen)
+{
+    // 接入地址 4 + 头部 2 + CRC 3 字节；前导码 1M 为 1 字节，2M 为 2 字节
+    switch (phy)
+    {
+    case PHY_2M:
+        return (uint32_t)(2 + 4 + 2 + llPayloadLen + 3) * 4;
+    case PHY_CODED:
+        // S=8：前导码 80 µs、接入地址 256 µs、CI 16 µs、TERM1 24 µs，头部到 CRC 每字节 64 µs，TERM2 24 µs
+        return 80 + 256 + 16 + 24 + (uint32_t)(2 + llPayloadLen + 3) * 64 + 24;
+    default:
+        return (uint32_t)(1 + 4 + 2 + llPayloadLen + 3) * 8;
+    }
+}
+
+uint32_t LinkPolicy::notifyAirTimeUs(Phy phy, size_t valueLen, size_t llPayloadMax)
+{
+    size_t remaining = 4 + 3 + valueLen;
+    uint32_t us = 0;
+    while (remaining > llPayloadMax)
+    {
+        us += airTimeUs(phy, llPayloadMax);
+        remaining -= llPayloadMax;
+    }
+    return us + airTimeUs(phy, remaining);
+}
+
+const char *LinkPolicy::activityName(Activity a)
+{
+    switch (a)
+    {
+    case ACTIVITY_ACTIVE:
+        return "active";
+    case ACTIVITY_IDLE:
+        return "idle";
+    default:
+        return "?";
+    }
+}
+
+const char *LinkPolicy::phyName(uint8_t phy)
+{
+    switch (phy)
+    {
+    case PHY_1M:
+        return "1M";
+    case PHY_2M:
+        return "2M";
+    case PHY_CODED:
+        return "coded";
+    default:
+        return "?";
+    }
+}
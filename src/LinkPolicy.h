@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "GattBackend.h"
+
+// 链路策略（与平台无关）：按连接记录协议栈实际给出的连接参数、PHY 与 MTU，
+// 决定何时请求 2M PHY、数据长度扩展 (DLE) 与连接参数。只做整数比较，可在主机上测试；
+// 固件中由 LinkTuner 在 BLE 回调与主循环中调用，并执行返回的请求。
+//
+//   ACTIVE  有踏频或 idleAfterMs 内有新连接：短连接间隔，通知延迟低
+//   IDLE    idleAfterMs 内没有踏频：长连接间隔加从机延迟，减少连接事件
+// 连接参数由中心设备决定：给出的间隔落在请求范围内即视为满足，否则按 retryMs 重试，
+// 每次活动状态切换后最多请求 maxAttempts 次，不与坚持自己参数的中心设备反复协商。
+class LinkPolicy
+{
+public:
+    static const size_t MAX_LINKS = gatt::MAX_CONNECTIONS;
+
+    enum Activity : uint8_t
+    {
+        ACTIVITY_ACTIVE = 0,
+        ACTIVITY_IDLE,
+        ACTIVITY_COUNT
+    };
+
+    // PHY 取值与 HCI 一致
+    enum Phy : uint8_t
+    {
+        PHY_1M = 1,
+        PHY_2M = 2,
+        PHY_CODED = 3
+    };
+
+    enum Action : uint8_t
+    {
+        ACTION_PHY = 0x01,      // 请求 2M PHY
+        ACTION_DATA_LEN = 0x02, // 请求数据长度扩展
+        ACTION_PARAMS = 0x04    // 请求连接参数
+    };
+
+    struct ConnParams
+    {
+        uint16_t minInterval; // 1.25 ms 单位
+        uint16_t maxInterval;
+        uint16_t latency;     // 从机延迟（可跳过的连接事件数）
+        uint16_t timeout;     // 监督超时 (10 ms 单位)
+    };
+
+    struct Config
+    {
+        uint32_t idleAfterMs = 30000;   // 无踏频多久后改用长间隔；0 表示始终 ACTIVE
+        uint32_t paramsDelayMs = 1000;  // 连接后首次请求连接参数的延迟，留给中心设备完成服务发现
+        uint32_t retryMs = 5000;        // 中心设备未接受时的重试间隔
+        uint8_t maxAttempts = 3;        // 每次活动状态切换后最多请求次数
+        bool phy2M = true;              // 连接后请求 2M PHY
+        uint16_t dataLenOctets = 251;   // 请求的 LL 负载长度，0 表示不请求
+        ConnParams params[ACTIVITY_COUNT] = {
+            {12, 24, 0, 400}, // ACTIVE: 15-30 ms，超时 4 s
+            {80, 160, 4, 600}, // IDLE: 100-200 ms，从机延迟 4，超时 6 s
+        };
+    };
+
+    // 一个连接：协议栈最近一次给出的参数与本策略的请求记录
+    struct Link
+    {
+        uint16_t connHandle;
+        uint16_t interval; // 1.25 ms 单位
+        uint16_t latency;
+        uint16_t timeout;  // 10 ms 单位
+        uint8_t txPhy;
+        uint8_t rxPhy;
+        uint16_t mtu;
+        uint8_t attempts;       // 当前活动状态下已请求连接参数的次数
+        uint32_t nextRequestMs; // 最早的下一次请求时间
+        uint32_t requests;      // 累计连接参数请求
+        uint32_t updates;       // 累计收到的连接参数更新
+    };
+
+    struct Request
+    {
+        uint16_t connHandle;
+        uint8_t actions; // Action 位
+        ConnParams params;
+    };
+
+    LinkPolicy() {}
+    explicit LinkPolicy(const Config &config) : config(config) {}
+
+    void begin(uint32_t nowMs);
+
+    // 连接建立：记录初始参数，返回 true 时 request 中为需要立即执行的 PHY 与数据长度请求。
+    // 新连接视为一次活动；表满时不跟踪该连接并返回 false
+    bool onConnect(uint32_t nowMs, uint16_t connHandle, uint16_t interval, uint16_t latency, uint16_t timeout,
+                   Request &request);
+    void onDisconnect(uint16_t connHandle);
+    void onParamsUpdated(uint16_t connHandle, uint16_t interval, uint16_t latency, uint16_t timeout);
+    void onPhyUpdated(uint16_t connHandle, uint8_t txPhy, uint8_t rxPhy);
+    void onMtuChanged(uint16_t connHandle, uint16_t mtu);
+
+    // 更新活动状态，返回 true 表示切换（所有连接的请求次数清零并立即按新参数请求）
+    bool update(uint32_t nowMs, bool riding);
+
+    // 取出到期的连接参数请求，返回写入 requests 的个数
+    size_t poll(uint32_t nowMs, Request *requests, size_t maxRequests);
+
+    Activity getActivity() const { return activity; }
+    const ConnParams &getParams() const { return config.params[activity]; }
+    const ConnParams &getParams(Activity a) const { return config.params[a]; }
+    const Config &getConfig() const { return config; }
+
+    size_t getLinkCount() const { return linkCount; }
+    const Link &getLink(size_t i) const { return links[i]; }
+    const Link *find(uint16_t connHandle) const;
+
+    // 给出的间隔是否落在请求范围内
+    static bool accepts(const ConnParams &params, uint16_t interval)
+    {
+        return interval >= params.minInterval && interval <= params.maxInterval;
+    }
+
+    // 未加密的 LL 数据包空口时间 (µs)：前导码、接入地址、头部、负载与 CRC
+    static uint32_t airTimeUs(Phy phy, size_t llPayloadLen);
+    // 一次通知（L2CAP 4 字节 + ATT 3 字节 + 特征值）的空口时间，超过 llPayloadMax 时按多个 LL 分片计
+    static uint32_t notifyAirTimeUs(Phy phy, size_t valueLen, size_t llPayloadMax);
+
+    static const char *activityName(Activity a);
+    static const char *phyName(uint8_t phy);
+
+private:
+    Config config;
+    Activity activity = ACTIVITY_ACTIVE;
+    uint32_t lastActivityMs = 0;
+    Link links[MAX_LINKS];
+    size_t linkCount = 0;
+
+    Link *findLink(uint16_t connHandle);
+    void resetAttempts(uint32_t nowMs);
+};
@@ -0,0 +1,130 @@
+#include "LinkTuner.h"
+#include "Log.h"
+
+void LinkTuner::begin(NimBLEServer *s, const Config &config)
+{
+    server = s;
+    portENTER_CRITICAL(&mux);
+    policy = LinkPolicy(config.policy);
+    policy.begin(millis());
+    portEXIT_CRITICAL(&mux);
+
+    // 之后建立的连接默认优先 2M PHY；中心设备不支持时保持 1M
+    if (config.policy.phy2M)
+        NimBLEDevice::setDefaultPhy(BLE_GAP_LE_PHY_1M_MASK | BLE_GAP_LE_PHY_2M_MASK,
+                                    BLE_GAP_LE_PHY_1M_MASK | BLE_GAP_LE_PHY_2M_MASK);
+}
+
+void LinkTuner::onConnect(NimBLEConnInfo &connInfo)
+{
+    LinkPolicy::Request request;
+    portENTER_CRITICAL(&mux);
+    bool tracked = policy.onConnect(millis(), connInfo.getConnHandle(), connInfo.getConnInterval(),
+                                    connInfo.getConnLatency(), connInfo.getConnTimeout(), request);
+    portEXIT_CRITICAL(&mux);
+
+    if (tracked)
+        execute(request);
+    else
+        LOG_WARN("[LINK] handle=%u 连接表已满，不做链路调优", (unsigned)connInfo.getConnHandle());
+}
+
+void LinkTuner::onDisconnect(uint16_t connHandle)
+{
+    portENTER_CRITICAL(&mux);
+    policy.onDisconnect(connHandle);
+    portEXIT_CRITICAL(&mux);
+}
+
+void LinkTuner::onConnParamsUpdate(NimBLEConnInfo &connInfo)
+{
+    portENTER_CRITICAL(&mux);
+    policy.onParamsUpdated(connInfo.getConnHandle(), connInfo.getConnInterval(), connInfo.getConnLatency(),
+                           connInfo.getConnTimeout());
+    portEXIT_CRITICAL(&mux);
+
+    LOG_INFO("[LINK] handle=%u interval=%u us latency=%u timeout=%u ms", (unsigned)connInfo.getConnHandle(),
+             (unsigned)connInfo.getConnInterval() * 1250, (unsigned)connInfo.getConnLatency(),
+             (unsigned)connInfo.getConnTimeout() * 10);
+}
+
+void LinkTuner::onPhyUpdate(NimBLEConnInfo &connInfo, uint8_t txPhy, uint8_t rxPhy)
+{
+    portENTER_CRITICAL(&mux);
+    policy.onPhyUpdated(connInfo.getConnHandle(), txPhy, rxPhy);
+    portEXIT_CRITICAL(&mux);
+
+    LOG_INFO("[LINK] handle=%u phy tx=%s rx=%s", (unsigned)connInfo.getConnHandle(), LinkPolicy::phyName(txPhy),
+             LinkPolicy::phyName(rxPhy));
+}
+
+void LinkTuner::onMtuChange(uint16_t mtu, NimBLEConnInfo &connInfo)
+{
+    portENTER_CRITICAL(&mux);
+    policy.onMtuChanged(connInfo.getConnHandle(), mtu);
+    portEXIT_CRITICAL(&mux);
+
+    LOG_INFO("[LINK] handle=%u mtu=%u", (unsigned)connInfo.getConnHandle(), (unsigned)mtu);
+}
+
+void LinkTuner::poll()
+{
+    LinkPolicy::Request requests[LinkPolicy::MAX_LINKS];
+    portENTER_CRITICAL(&mux);
+    bool changed = policy.update(millis(), riding.load(std::memory_order_relaxed));
+    LinkPolicy::Activity activity = policy.getActivity();
+    size_t count = policy.poll(millis(), requests, LinkPolicy::MAX_LINKS);
+    portEXIT_CRITICAL(&mux);
+
+    if (changed)
+        LOG_INFO("[LINK] 活动状态 %s", LinkPolicy::activityName(activity));
+    for (size_t i = 0; i < count; i++)
+        execute(requests[i]);
+}
+
+void LinkTuner::execute(const LinkPolicy::Request &request)
+{
+    if (!server)
+        return;
+    const uint16_t conn = request.connHandle;
+    if (request.actions & LinkPolicy::ACTION_PHY)
+    {
+        if (!server->updatePhy(conn, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, 0))
+            LOG_WARN("[LINK] handle=%u 请求 2M PHY 失败", (unsigned)conn);
+    }
+    if (request.actions & LinkPolicy::ACTION_DATA_LEN)
+    {
+        uint16_t octets = policy.getConfig().dataLenOctets;
+        server->setDataLen(conn, octets);
+        LOG_INFO("[LINK] handle=%u 请求数据长度 %u", (unsigned)conn, (unsigned)octets);
+    }
+    if (request.actions & LinkPolicy::ACTION_PARAMS)
+    {
+        const LinkPolicy::ConnParams &p = request.params;
+        server->updateConnParams(conn, p.minInterval, p.maxInterval, p.latency, p.timeout);
+        LOG_INFO("[LINK] handle=%u 请求间隔 %u-%u us latency=%u", (unsigned)conn, (unsigned)p.minInterval * 1250,
+                 (unsigned)p.maxInterval * 1250, (unsigned)p.latency);
+    }
+}
+
+void LinkTuner::report()
+{
+    LinkPolicy::Link links[LinkPolicy::MAX_LINKS];
+    portENTER_CRITICAL(&mux);
+    LinkPolicy::Activity activity = policy.getActivity();
+    size_t count = policy.getLinkCount();
+    for (size_t i = 0; i < count; i++)
+        links[i] = policy.getLink(i);
+    portEXIT_CRITICAL(&mux);
+
+    LOG_INFO("[LINK] activity=%s links=%u", LinkPolicy::activityName(activity), (unsigned)count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const LinkPolicy::Link &l = links[i];
+        LOG_INFO("[LINK] handle=%u interval=%u us latency=%u phy=%s/%s mtu=%u", (unsigned)l.connHandle,
+                 (unsigned)l.interval * 1250, (unsigned)l.latency, LinkPolicy::phyName(l.txPhy),
+                 LinkPolicy::phyName(l.rxPhy), (unsigned)l.mtu);
+        LOG_INFO("[LINK] handle=%u requests=%u updates=%u", (unsigned)l.connHandle, (unsigned)l.requests,
+                 (unsigned)l.updates);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include <atomic>
+#include "LinkPolicy.h"
+
+// 链路调优：连接后请求 2M PHY 与数据长度扩展，按踏频请求短/长连接间隔，
+// 并记录每个连接实际给出的参数。决策在 LinkPolicy 中，这里只执行 NimBLE 调用并输出日志。
+//
+// 连接事件回调在 BLE 主机任务中运行，poll() 在主循环中运行，两者通过 mux 访问 policy；
+// NimBLE 请求在临界区外发出。数据长度的协商结果 NimBLE-Arduino 不上报，只记录请求。
+class LinkTuner
+{
+public:
+    struct Config
+    {
+        LinkPolicy::Config policy;
+    };
+
+    void begin(NimBLEServer *server, const Config &config);
+
+    // BLE 主机任务的服务器回调中调用
+    void onConnect(NimBLEConnInfo &connInfo);
+    void onDisconnect(uint16_t connHandle);
+    void onConnParamsUpdate(NimBLEConnInfo &connInfo);
+    void onPhyUpdate(NimBLEConnInfo &connInfo, uint8_t txPhy, uint8_t rxPhy);
+    void onMtuChange(uint16_t mtu, NimBLEConnInfo &connInfo);
+
+    // 由采样任务每次采样调用，只写原子标志
+    void setRiding(bool value) { riding.store(value, std::memory_order_relaxed); }
+
+    // 主循环中周期调用：更新活动状态并发出到期的连接参数请求
+    void poll();
+
+    // 输出每个连接当前的参数（串口命令 'L'）
+    void report();
+
+private:
+    NimBLEServer *server = nullptr;
+    LinkPolicy policy;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<bool> riding{false};
+
+    void execute(const LinkPolicy::Request &request);
+};
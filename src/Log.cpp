@@ -0,0 +1,100 @@
+#include "Log.h"
+#include <esp_timer.h>
+
+namespace logging
+{
+    Ring &ring()
+    {
+        static Ring instance;
+        return instance;
+    }
+
+    uint32_t timestamp()
+    {
+        return (uint32_t)esp_timer_get_time();
+    }
+
+    FrameEncoder::FrameEncoder() : formatCount(0)
+    {
+        memset(formats, 0, sizeof(formats));
+        memset(sent, 0, sizeof(sent));
+    }
+
+    int FrameEncoder::lookup(const char *fmt)
+    {
+        for (size_t i = 0; i < formatCount; i++)
+        {
+            if (formats[i] == fmt)
+                return (int)i;
+        }
+        if (formatCount >= MAX_FORMATS)
+            return -1;
+        formats[formatCount] = fmt;
+        sent[formatCount] = false;
+        return (int)formatCount++;
+    }
+
+    void FrameEncoder::newEpoch()
+    {
+        memset(sent, 0, sizeof(sent));
+    }
+
+    size_t FrameEncoder::frame(uint8_t type, const uint8_t *payload, size_t len, uint8_t *out)
+    {
+        out[0] = logfmt::SYNC0;
+        out[1] = logfmt::SYNC1;
+        out[2] = type;
+        out[3] = (uint8_t)len;
+        uint8_t checksum = type ^ (uint8_t)len;
+        for (size_t i = 0; i < len; i++)
+        {
+            out[4 + i] = payload[i];
+            checksum ^= payload[i];
+        }
+        out[4 + len] = checksum;
+        return len + logfmt::FRAME_OVERHEAD;
+    }
+
+    size_t FrameEncoder::encode(const Record &record, uint8_t *out)
+    {
+        uint8_t payload[logfmt::MAX_PAYLOAD];
+        size_t n = 0;
+
+        // 格式表已满时把格式字符串当作参数发出（编号 0xFF）
+        int id = lookup(record.fmt);
+        if (id >= 0 && !sent[id])
+        {
+            payload[0] = (uint8_t)id;
+            size_t len = strnlen(record.fmt, logfmt::MAX_PAYLOAD - 1);
+            memcpy(&payload[1], record.fmt, len);
+            n = frame(logfmt::FRAME_FORMAT, payload, 1 + len, out);
+            sent[id] = true;
+        }
+
+        size_t len = 0;
+        payload[len++] = id >= 0 ? (uint8_t)id : 0xFF;
+        payload[len++] = record.level;
+        payload[len++] = (uint8_t)(record.timeUs & 0xFF);
+        payload[len++] = (uint8_t)((record.timeUs >> 8) & 0xFF);
+        payload[len++] = (uint8_t)((record.timeUs >> 16) & 0xFF);
+        payload[len++] = (uint8_t)(record.timeUs >> 24);
+        if (id < 0)
+        {
+            size_t fmtLen = strnlen(record.fmt, logfmt::MAX_STR);
+            payload[len++] = logfmt::ARG_STR;
+            payload[len++] = (uint8_t)fmtLen;
+            memcpy(&payload[len], record.fmt, fmtLen);
+            len += fmtLen;
+        }
+        memcpy(&payload[len], record.args, record.argLen);
+        len += record.argLen;
+        return n + frame(logfmt::FRAME_RECORD, payload, len, out + n);
+    }
+
+    size_t FrameEncoder::encodeDropped(uint32_t count, uint8_t *out)
+    {
+        uint8_t payload[4] = {(uint8_t)(count & 0xFF), (uint8_t)((count >> 8) & 0xFF),
+                              (uint8_t)((count >> 16) & 0xFF), (uint8_t)(count >> 24)};
+        return frame(logfmt::FRAME_DROPPED, payload, sizeof(payload), out);
+    }
+}
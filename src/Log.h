@@ -0,0 +1,206 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+#include "LogFormat.h"
+#include "MpmcRing.h"
+
+// ------------ 异步二进制日志 ------------
+// LOG_* 只把格式字符串指针、时间戳与编码后的参数写入无锁队列，不格式化、不访问串口；
+// 低优先级的 LogDrain 任务把记录编码成帧写到 UART，主机端 tools/log_decode 还原为文本。
+// 低于 LOG_LEVEL 的调用在预处理阶段被移除，参数也不会求值。
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_VERBOSE 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+namespace logging
+{
+    const size_t MAX_ARG_BYTES = 48;
+    const size_t RING_SIZE = 64;
+
+    struct Record
+    {
+        const char *fmt; // 字符串字面量，生命周期为整个程序
+        uint32_t timeUs; // esp_timer 低 32 位
+        uint8_t level;   // logfmt::Level，参数被截断时置 LEVEL_TRUNCATED
+        uint8_t argLen;
+        uint8_t args[MAX_ARG_BYTES];
+    };
+
+    typedef MpmcRing<Record, RING_SIZE> Ring;
+
+    Ring &ring();
+    uint32_t timestamp();
+
+    class ArgWriter
+    {
+    public:
+        explicit ArgWriter(Record &r) : record(r) {}
+
+        void varint(uint8_t tag, uint64_t v)
+        {
+            uint8_t buf[11];
+            size_t n = 0;
+            buf[n++] = tag;
+            do
+            {
+                uint8_t b = v & 0x7F;
+                v >>= 7;
+                buf[n++] = v ? (b | 0x80) : b;
+            } while (v);
+            append(buf, n);
+        }
+
+        void f32(float v)
+        {
+            uint8_t buf[5];
+            buf[0] = logfmt::ARG_FLOAT;
+            memcpy(&buf[1], &v, 4);
+            append(buf, sizeof(buf));
+        }
+
+        void str(const char *s)
+        {
+            uint8_t buf[2 + logfmt::MAX_STR];
+            size_t len = s ? strnlen(s, logfmt::MAX_STR) : 0;
+            buf[0] = logfmt::ARG_STR;
+            buf[1] = (uint8_t)len;
+            if (len)
+                memcpy(&buf[2], s, len);
+            append(buf, 2 + len);
+        }
+
+    private:
+        Record &record;
+
+        // 单个参数写不下时整体丢弃，之后的参数也不再写入
+        void append(const uint8_t *p, size_t n)
+        {
+            if (record.level & logfmt::LEVEL_TRUNCATED)
+                return;
+            if (record.argLen + n > MAX_ARG_BYTES)
+            {
+                record.level |= logfmt::LEVEL_TRUNCATED;
+                return;
+            }
+            memcpy(&record.args[record.argLen], p, n);
+            record.argLen += n;
+        }
+    };
+
+    template <typename T>
+    inline void putArg(ArgWriter &w, T value)
+    {
+        if constexpr (std::is_same<T, const char *>::value || std::is_same<T, char *>::value)
+            w.str(value);
+        else if constexpr (std::is_floating_point<T>::value)
+            w.f32((float)value);
+        else if constexpr (std::is_enum<T>::value)
+            putArg(w, (typename std::underlying_type<T>::type)value);
+        else if constexpr (std::is_same<T, bool>::value)
+            w.varint(logfmt::ARG_UINT, value ? 1 : 0);
+        else if constexpr (std::is_signed<T>::value)
+            w.varint(logfmt::ARG_INT, logfmt::zigzag((int64_t)value));
+        else
+        {
+            static_assert(std::is_unsigned<T>::value, "不支持的日志参数类型");
+            w.varint(logfmt::ARG_UINT, (uint64_t)value);
+        }
+    }
+
+    template <typename... Args>
+    inline void write(uint8_t level, const char *fmt, Args... args)
+    {
+        Record r;
+        r.fmt = fmt;
+        r.timeUs = timestamp();
+        r.level = level;
+        r.argLen = 0;
+        ArgWriter w(r);
+        (putArg(w, args), ...);
+        ring().push(r); // 队列满时丢弃，由 LogDrain 报告丢弃数
+    }
+
+    // 只用于编译期检查格式字符串与参数类型，从不调用
+    inline void checkFormat(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+    inline void checkFormat(const char *fmt, ...) {}
+}
+
+// fmt 必须是字符串字面量（"" fmt 在编译期拼接）
+#define LOG_AT(level, fmt, ...)                                   \
+    do                                                            \
+    {                                                             \
+        if (false)                                                \
+            logging::checkFormat("" fmt, ##__VA_ARGS__);          \
+        logging::write(level, "" fmt, ##__VA_ARGS__);             \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_AT(logfmt::LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) LOG_AT(logfmt::LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) LOG_AT(logfmt::LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_AT(logfmt::LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(fmt, ...) LOG_AT(logfmt::LEVEL_VERBOSE, fmt, ##__VA_ARGS__)
+#else
+#define LOG_VERBOSE(fmt, ...) ((void)0)
+#endif
+
+namespace logging
+{
+    // 把记录编码为串口帧（仅由 LogDrain 单线程调用）：
+    // 格式字符串在本周期首次出现时先发定义帧，之后记录只带 1 字节编号
+    class FrameEncoder
+    {
+    public:
+        static const size_t MAX_FORMATS = 128;
+        // 一条记录最多产生的字节数：定义帧 + 记录帧
+        static const size_t MAX_OUTPUT = 2 * (logfmt::FRAME_OVERHEAD + logfmt::MAX_PAYLOAD);
+
+        FrameEncoder();
+
+        // 编码一条记录，返回写入 out 的字节数（out 至少 MAX_OUTPUT 字节）
+        size_t encode(const Record &record, uint8_t *out);
+        size_t encodeDropped(uint32_t count, uint8_t *out);
+
+        // 开始新周期：所有格式在下次使用时重发定义，中途接入的解码器也能还原
+        void newEpoch();
+
+        size_t getFormatCount() const { return formatCount; }
+
+    private:
+        const char *formats[MAX_FORMATS];
+        bool sent[MAX_FORMATS];
+        size_t formatCount;
+
+        int lookup(const char *fmt);
+        static size_t frame(uint8_t type, const uint8_t *payload, size_t len, uint8_t *out);
+    };
+}
@@ -0,0 +1,90 @@
+#include "LogDrain.h"
+
+bool LogDrain::begin(const Config &cfg)
+{
+    end();
+    config = cfg;
+    encoder.newEpoch();
+    if (xTaskCreatePinnedToCore(taskEntry, "log", config.taskStackSize, this,
+                                config.taskPriority, &task, config.taskCore) != pdPASS)
+    {
+        task = nullptr;
+        Serial.println("[ERROR] LogDrain: 创建日志任务失败");
+        return false;
+    }
+    return true;
+}
+
+void LogDrain::end()
+{
+    if (task)
+    {
+        vTaskDelete(task);
+        task = nullptr;
+    }
+}
+
+bool LogDrain::flush(uint32_t timeoutMs)
+{
+    unsigned long start = millis();
+    while (logging::ring().size() > 0 || busy)
+    {
+        if (!task || millis() - start > timeoutMs)
+            return false;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    Serial.flush();
+    return true;
+}
+
+void LogDrain::taskEntry(void *arg)
+{
+    static_cast<LogDrain *>(arg)->run();
+}
+
+void LogDrain::run()
+{
+    unsigned long epochStart = millis();
+    for (;;)
+    {
+        drainOnce();
+        if (millis() - epochStart > config.epochMs)
+        {
+            encoder.newEpoch();
+            epochStart = millis();
+        }
+        vTaskDelay(pdMS_TO_TICKS(config.periodMs));
+    }
+}
+
+void LogDrain::drainOnce()
+{
+    // 攒满一批再写串口，减少 UART 驱动调用次数
+    static uint8_t buf[1024];
+    size_t n = 0;
+    logging::Record record;
+
+    busy = true;
+    uint32_t dropped = getDroppedCount();
+    if (dropped != reportedDropped)
+    {
+        n += encoder.encodeDropped(dropped, buf + n);
+        reportedDropped = dropped;
+    }
+    while (logging::ring().pop(record))
+    {
+        n += encoder.encode(record, buf + n);
+        if (n > sizeof(buf) - logging::FrameEncoder::MAX_OUTPUT)
+        {
+            Serial.write(buf, n);
+            bytesWritten += n;
+            n = 0;
+        }
+    }
+    if (n)
+    {
+        Serial.write(buf, n);
+        bytesWritten += n;
+    }
+    busy = false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Log.h"
+
+// 日志输出任务：以最低的应用优先级把队列中的日志编码成帧写到串口。
+// 串口阻塞只会推迟本任务，不会影响采样与通知任务。
+class LogDrain
+{
+public:
+    struct Config
+    {
+        uint32_t periodMs = 20;       // 队列为空时的休眠间隔
+        uint32_t epochMs = 10000;     // 格式定义重发周期
+        UBaseType_t taskPriority = 1; // 低于采样 (6) 与通知 (5) 任务
+        uint32_t taskStackSize = 3072;
+        BaseType_t taskCore = 1; // 不与 BLE 主机争用核心 0
+    };
+
+    bool begin(const Config &config);
+    void end();
+
+    // 等待队列写空（重启前调用），超时返回 false
+    bool flush(uint32_t timeoutMs);
+
+    uint32_t getDroppedCount() const { return logging::ring().getOverflowCount(); }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    Config config;
+    TaskHandle_t task = nullptr;
+    logging::FrameEncoder encoder;
+    uint32_t reportedDropped = 0;
+    volatile uint32_t bytesWritten = 0;
+    volatile bool busy = false;
+
+    static void taskEntry(void *arg);
+    void run();
+    void drainOnce();
+};
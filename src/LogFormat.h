@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 二进制日志的串口帧格式（固件与主机端解码器共用）：
+//   sync0(0xA5) sync1(0x5A) type(1) len(1) payload[len] checksum(1)
+// checksum 为 type、len 与 payload 的异或。帧之外的字节（启动信息、协议栈日志、追踪导出）
+// 原样作为文本输出。
+//
+// FRAME_FORMAT:  id(1) text...                      格式字符串定义，首次使用及每个周期重发
+// FRAME_RECORD:  id(1) level(1) time_us(4) args...  一条日志
+// FRAME_DROPPED: count(4)                           队列满丢弃的日志总数
+// 参数按顺序编码：tag(1) 后接值。整数为 LEB128 变长（有符号数先 zigzag），浮点为 f32。
+namespace logfmt
+{
+    const uint8_t SYNC0 = 0xA5;
+    const uint8_t SYNC1 = 0x5A;
+    const size_t FRAME_OVERHEAD = 5;
+    const size_t MAX_PAYLOAD = 255;
+
+    enum FrameType : uint8_t
+    {
+        FRAME_FORMAT = 0x01,
+        FRAME_RECORD = 0x02,
+        FRAME_DROPPED = 0x03
+    };
+
+    enum Level : uint8_t
+    {
+        LEVEL_NONE = 0,
+        LEVEL_ERROR = 1,
+        LEVEL_WARN = 2,
+        LEVEL_INFO = 3,
+        LEVEL_DEBUG = 4,
+        LEVEL_VERBOSE = 5
+    };
+
+    // 参数写不下时在 level 上置位，解码器据此标记截断
+    const uint8_t LEVEL_TRUNCATED = 0x80;
+
+    enum ArgTag : uint8_t
+    {
+        ARG_INT = 0x01,   // zigzag + LEB128
+        ARG_UINT = 0x02,  // LEB128
+        ARG_FLOAT = 0x03, // f32 小端
+        ARG_STR = 0x04    // len(1) + 字节（最长 MAX_STR）
+    };
+
+    const size_t MAX_STR = 24;
+
+    inline uint64_t zigzag(int64_t v)
+    {
+        return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t v)
+    {
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    inline char levelLetter(uint8_t level)
+    {
+        static const char LETTERS[] = "-EWIDV";
+        level &= ~LEVEL_TRUNCATED;
+        return level <= LEVEL_VERBOSE ? LETTERS[level] : '?';
+    }
+}
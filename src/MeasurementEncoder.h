@@ -0,0 +1,222 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+// ------------ 测量数据编码器 ------------
+// 按标志位在编译期特化：负载长度为 constexpr，缓冲区为 std::array，
+// 每个变体都展开为固定偏移的直接写入，没有运行时分支和堆分配。
+// 所有多字节字段均为小端序（GATT 规范要求）。
+namespace encoder
+{
+    // CSC 测量标志位 (0x2A5B)
+    enum CscFlags : uint8_t
+    {
+        CSC_WHEEL_REV = 0x01, // 车轮转数数据
+        CSC_CRANK_REV = 0x02  // 曲柄转数数据
+    };
+
+    // CP 测量标志位 (0x2A63)
+    enum CpFlags : uint16_t
+    {
+        CP_WHEEL_REV = 0x0010,  // 车轮转数数据
+        CP_CRANK_REV = 0x0020,  // 曲柄转数数据
+        CP_ACC_ENERGY = 0x0800  // 累计能量
+    };
+
+    constexpr void putU8(uint8_t *p, uint8_t v)
+    {
+        p[0] = v;
+    }
+
+    constexpr void putU16(uint8_t *p, uint16_t v)
+    {
+        p[0] = (uint8_t)(v & 0xFF);
+        p[1] = (uint8_t)(v >> 8);
+    }
+
+    constexpr void putU32(uint8_t *p, uint32_t v)
+    {
+        p[0] = (uint8_t)(v & 0xFF);
+        p[1] = (uint8_t)((v >> 8) & 0xFF);
+        p[2] = (uint8_t)((v >> 16) & 0xFF);
+        p[3] = (uint8_t)(v >> 24);
+    }
+
+    // CSC 测量: flags(1) [wheel_rev(4) w_time(2)] [crank_rev(2) c_time(2)]
+    // 事件时间单位为 1/1024 秒
+    template <uint8_t Flags>
+    struct CscMeasurement
+    {
+        static_assert((Flags & ~(CSC_WHEEL_REV | CSC_CRANK_REV)) == 0, "未知的 CSC 标志位");
+
+        static constexpr bool HAS_WHEEL = (Flags & CSC_WHEEL_REV) != 0;
+        static constexpr bool HAS_CRANK = (Flags & CSC_CRANK_REV) != 0;
+
+        static constexpr size_t WHEEL_OFFSET = 1;
+        static constexpr size_t CRANK_OFFSET = WHEEL_OFFSET + (HAS_WHEEL ? 6 : 0);
+        static constexpr size_t SIZE = CRANK_OFFSET + (HAS_CRANK ? 4 : 0);
+
+        using Buffer = std::array<uint8_t, SIZE>;
+
+        static constexpr Buffer encode(uint32_t wheelRev, uint16_t wEventTime,
+                                       uint16_t crankRev, uint16_t cEventTime)
+        {
+            Buffer buf{};
+            putU8(&buf[0], Flags);
+            if constexpr (HAS_WHEEL)
+            {
+                putU32(&buf[WHEEL_OFFSET], wheelRev);
+                putU16(&buf[WHEEL_OFFSET + 4], wEventTime);
+            }
+            if constexpr (HAS_CRANK)
+            {
+                putU16(&buf[CRANK_OFFSET], crankRev);
+                putU16(&buf[CRANK_OFFSET + 2], cEventTime);
+            }
+            return buf;
+        }
+    };
+
+    // CP 测量所需的全部字段，未启用的字段编码时被忽略
+    struct CpFields
+    {
+        int16_t power;         // 瞬时功率 (W)
+        uint32_t wheelRev;     // 累计车轮转数
+        uint16_t wEventTime;   // 车轮事件时间 (1/2048 秒)
+        uint16_t crankRev;     // 累计曲柄转数
+        uint16_t cEventTime;   // 曲柄事件时间 (1/1024 秒)
+        uint16_t energy;       // 累计能量 (kJ)
+    };
+
+    // CP 测量: flags(2) power(2) [wheel_rev(4) w_time(2)] [crank_rev(2) c_time(2)] [energy(2)]
+    template <uint16_t Flags>
+    struct CpMeasurement
+    {
+        static_assert((Flags & ~(CP_WHEEL_REV | CP_CRANK_REV | CP_ACC_ENERGY)) == 0, "不支持的 CP 标志位");
+
+        static constexpr bool HAS_WHEEL = (Flags & CP_WHEEL_REV) != 0;
+        static constexpr bool HAS_CRANK = (Flags & CP_CRANK_REV) != 0;
+        static constexpr bool HAS_ENERGY = (Flags & CP_ACC_ENERGY) != 0;
+
+        static constexpr size_t WHEEL_OFFSET = 4;
+        static constexpr size_t CRANK_OFFSET = WHEEL_OFFSET + (HAS_WHEEL ? 6 : 0);
+        static constexpr size_t ENERGY_OFFSET = CRANK_OFFSET + (HAS_CRANK ? 4 : 0);
+        static constexpr size_t SIZE = ENERGY_OFFSET + (HAS_ENERGY ? 2 : 0);
+
+        using Buffer = std::array<uint8_t, SIZE>;
+
+        static constexpr Buffer encode(const CpFields &f)
+        {
+            Buffer buf{};
+            putU16(&buf[0], Flags);
+            putU16(&buf[2], (uint16_t)f.power);
+            if constexpr (HAS_WHEEL)
+            {
+                putU32(&buf[WHEEL_OFFSET], f.wheelRev);
+                putU16(&buf[WHEEL_OFFSET + 4], f.wEventTime);
+            }
+            if constexpr (HAS_CRANK)
+            {
+                putU16(&buf[CRANK_OFFSET], f.crankRev);
+                putU16(&buf[CRANK_OFFSET + 2], f.cEventTime);
+            }
+            if constexpr (HAS_ENERGY)
+            {
+                putU16(&buf[ENERGY_OFFSET], f.energy);
+            }
+            return buf;
+        }
+    };
+
+    // FTMS Indoor Bike Data 标志位 (0x2AD2)
+    // 注意 bit0 为 "More Data"：为 0 时才包含瞬时速度
+    enum IbdFlags : uint16_t
+    {
+        IBD_MORE_DATA = 0x0001,    // 置位时不含瞬时速度
+        IBD_INST_CADENCE = 0x0004, // 瞬时踏频
+        IBD_INST_POWER = 0x0040    // 瞬时功率
+    };
+
+    // Indoor Bike Data 所需字段，均为规范单位
+    struct IbdFields
+    {
+        uint16_t speed;   // 瞬时速度 (0.01 km/h)
+        uint16_t cadence; // 瞬时踏频 (0.5 rpm)
+        int16_t power;    // 瞬时功率 (W)
+    };
+
+    // Indoor Bike Data: flags(2) [speed(2)] [cadence(2)] [power(2)]
+    // 字段按规范顺序排列，未列出的可选字段（平均值、距离等）不支持
+    template <uint16_t Flags>
+    struct IndoorBikeData
+    {
+        static_assert((Flags & ~(IBD_MORE_DATA | IBD_INST_CADENCE | IBD_INST_POWER)) == 0, "不支持的 FTMS 标志位");
+
+        static constexpr bool HAS_SPEED = (Flags & IBD_MORE_DATA) == 0;
+        static constexpr bool HAS_CADENCE = (Flags & IBD_INST_CADENCE) != 0;
+        static constexpr bool HAS_POWER = (Flags & IBD_INST_POWER) != 0;
+
+        static constexpr size_t SPEED_OFFSET = 2;
+        static constexpr size_t CADENCE_OFFSET = SPEED_OFFSET + (HAS_SPEED ? 2 : 0);
+        static constexpr size_t POWER_OFFSET = CADENCE_OFFSET + (HAS_CADENCE ? 2 : 0);
+        static constexpr size_t SIZE = POWER_OFFSET + (HAS_POWER ? 2 : 0);
+
+        using Buffer = std::array<uint8_t, SIZE>;
+
+        static constexpr Buffer encode(const IbdFields &f)
+        {
+            Buffer buf{};
+            putU16(&buf[0], Flags);
+            if constexpr (HAS_SPEED)
+            {
+                putU16(&buf[SPEED_OFFSET], f.speed);
+            }
+            if constexpr (HAS_CADENCE)
+            {
+                putU16(&buf[CADENCE_OFFSET], f.cadence);
+            }
+            if constexpr (HAS_POWER)
+            {
+                putU16(&buf[POWER_OFFSET], (uint16_t)f.power);
+            }
+            return buf;
+        }
+    };
+
+    // 常用变体
+    using CscWheel = CscMeasurement<CSC_WHEEL_REV>;
+    using CscCrank = CscMeasurement<CSC_CRANK_REV>;
+    using CscWheelCrank = CscMeasurement<CSC_WHEEL_REV | CSC_CRANK_REV>;
+
+    using CpPower = CpMeasurement<0>;
+    using CpPowerCrank = CpMeasurement<CP_CRANK_REV>;
+    using CpPowerWheelCrank = CpMeasurement<CP_WHEEL_REV | CP_CRANK_REV>;
+    using CpPowerFull = CpMeasurement<CP_WHEEL_REV | CP_CRANK_REV | CP_ACC_ENERGY>;
+
+    using IbdSpeedCadencePower = IndoorBikeData<IBD_INST_CADENCE | IBD_INST_POWER>;
+
+    // 编译期自检：长度与字节布局
+    static_assert(CscWheel::SIZE == 7, "CSC 车轮负载长度错误");
+    static_assert(CscCrank::SIZE == 5, "CSC 曲柄负载长度错误");
+    static_assert(CscWheelCrank::SIZE == 11, "CSC 完整负载长度错误");
+    static_assert(CpPower::SIZE == 4, "CP 功率负载长度错误");
+    static_assert(CpPowerFull::SIZE == 16, "CP 完整负载长度错误");
+    static_assert(IbdSpeedCadencePower::SIZE == 8, "FTMS 负载长度错误");
+    static_assert(IndoorBikeData<IBD_MORE_DATA | IBD_INST_POWER>::SIZE == 4, "FTMS 无速度负载长度错误");
+
+    static_assert(CscWheelCrank::encode(0x04030201, 0x0605, 0x0807, 0x0A09)[0] == 0x03, "");
+    static_assert(CscWheelCrank::encode(0x04030201, 0x0605, 0x0807, 0x0A09)[4] == 0x04, "");
+    static_assert(CscWheelCrank::encode(0x04030201, 0x0605, 0x0807, 0x0A09)[7] == 0x07, "");
+    static_assert(CscWheelCrank::encode(0x04030201, 0x0605, 0x0807, 0x0A09)[10] == 0x0A, "");
+    static_assert(CscCrank::encode(0, 0, 0x0201, 0x0403)[1] == 0x01, "");
+    static_assert(CpPower::encode({-2, 0, 0, 0, 0, 0})[2] == 0xFE, "");
+    static_assert(CpPowerFull::encode({0, 0, 0, 0, 0, 0x1234})[14] == 0x34, "");
+    static_assert(CpPowerFull::encode({0, 0, 0, 0, 0, 0})[1] == 0x08, "");
+    static_assert(IbdSpeedCadencePower::encode({2550, 181, -1})[0] == 0x44, "");
+    static_assert(IbdSpeedCadencePower::encode({2550, 181, -1})[2] == 0xF6, "");
+    static_assert(IbdSpeedCadencePower::encode({2550, 181, -1})[3] == 0x09, "");
+    static_assert(IbdSpeedCadencePower::encode({2550, 181, -1})[4] == 0xB5, "");
+    static_assert(IbdSpeedCadencePower::encode({2550, 181, -1})[7] == 0xFF, "");
+    static_assert(IndoorBikeData<IBD_MORE_DATA | IBD_INST_POWER>::encode({0, 0, 0x0102})[2] == 0x02, "");
+}
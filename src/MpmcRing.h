@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// 多生产者/多消费者有界无锁队列（每个槽位带序号）：
+// 生产者之间只竞争一次 CAS，不使用临界区，任何任务都可以写入；队列满时立即返回 false。
+// 容量必须为 2 的幂。
+template <typename T, size_t Capacity>
+class MpmcRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量必须为 2 的幂");
+
+public:
+    static const size_t CAPACITY = Capacity;
+
+    MpmcRing() : enqueuePos(0), overflows(0), dequeuePos(0)
+    {
+        for (uint32_t i = 0; i < Capacity; i++)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // 队列已满时返回 false 并计入溢出
+    bool push(const T &item)
+    {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells[pos & (Capacity - 1)];
+            uint32_t seq = cell->seq.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = item;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列为空（或下一个槽位仍在写入中）时返回 false
+    bool pop(T &out)
+    {
+        uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells[pos & (Capacity - 1)];
+            uint32_t seq = cell->seq.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - (pos + 1));
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = cell->data;
+        cell->seq.store(pos + Capacity, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return enqueuePos.load(std::memory_order_acquire) - dequeuePos.load(std::memory_order_acquire);
+    }
+
+    uint32_t getOverflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<uint32_t> seq;
+        T data;
+    };
+
+    Cell cells[Capacity];
+    // 生产者与消费者的位置分开放置，避免同一缓存行在两个核心间来回失效
+    alignas(32) std::atomic<uint32_t> enqueuePos;
+    std::atomic<uint32_t> overflows;
+    alignas(32) std::atomic<uint32_t> dequeuePos;
+};
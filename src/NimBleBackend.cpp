@@ -0,0 +1,156 @@
+#include "NimBleBackend.h"
+#include "Log.h"
+#include "BLEConfig.h"
+#include <Arduino.h>
+
+NimBleCharacteristic::NimBleCharacteristic(NimBLECharacteristic *characteristic)
+    : characteristic(characteristic), cacheLen(0), writeHandler(nullptr), writeCtx(nullptr)
+{
+    // 订阅跟踪需要回调，与是否有写入处理无关
+    characteristic->setCallbacks(this);
+}
+
+void NimBleCharacteristic::setValue(const uint8_t *data, size_t len)
+{
+    characteristic->setValue(data, len);
+    cacheLen = len < MAX_CACHED ? len : MAX_CACHED;
+    if (cacheLen)
+        memcpy(cache, data, cacheLen);
+}
+
+bool NimBleCharacteristic::notify()
+{
+    return send(Subscribers::CCCD_NOTIFY);
+}
+
+bool NimBleCharacteristic::notify(const uint8_t *data, size_t len, uint16_t connHandle)
+{
+    return characteristic->notify(data, len, connHandle == gatt::CONN_ALL ? BLE_HS_CONN_HANDLE_NONE : connHandle);
+}
+
+bool NimBleCharacteristic::indicate()
+{
+    return send(Subscribers::CCCD_INDICATE);
+}
+
+bool NimBleCharacteristic::indicate(uint16_t connHandle)
+{
+    portENTER_CRITICAL(&mux);
+    bool subscribed = subscribers.contains(connHandle, Subscribers::CCCD_INDICATE);
+    portEXIT_CRITICAL(&mux);
+    return subscribed && characteristic->indicate(connHandle);
+}
+
+bool NimBleCharacteristic::send(uint16_t cccdMask)
+{
+    // 特征值已由 setValue() 写入一次，这里只按连接发送；与 NimBLE 一致，任一连接成功即返回 true
+    Subscribers::Entry targets[gatt::MAX_CONNECTIONS];
+    size_t count = 0;
+    portENTER_CRITICAL(&mux);
+    for (size_t i = 0; i < subscribers.size(); i++)
+    {
+        if (subscribers[i].cccd & cccdMask)
+            targets[count++] = subscribers[i];
+    }
+    portEXIT_CRITICAL(&mux);
+
+    bool any = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (cccdMask == Subscribers::CCCD_NOTIFY)
+            any |= characteristic->notify(targets[i].connHandle);
+        else
+            any |= characteristic->indicate(targets[i].connHandle);
+    }
+    return any;
+}
+
+void NimBleCharacteristic::setWriteHandler(gatt::WriteHandler handler, void *ctx)
+{
+    writeHandler = handler;
+    writeCtx = ctx;
+}
+
+void NimBleCharacteristic::removeConnection(uint16_t connHandle)
+{
+    portENTER_CRITICAL(&mux);
+    subscribers.remove(connHandle);
+    portEXIT_CRITICAL(&mux);
+}
+
+void NimBleCharacteristic::onSubscribe(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo, uint16_t subValue)
+{
+    portENTER_CRITICAL(&mux);
+    subscribers.update(connInfo.getConnHandle(), subValue);
+    portEXIT_CRITICAL(&mux);
+}
+
+void NimBleCharacteristic::onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo)
+{
+    if (!writeHandler)
+        return;
+    NimBLEAttValue value = pCharacteristic->getValue();
+    writeHandler(writeCtx, connInfo.getConnHandle(), value.data(), value.size());
+}
+
+gatt::Characteristic *NimBleService::createCharacteristic(const gatt::Uuid &uuid, uint8_t properties)
+{
+    uint32_t nimProperties = 0;
+    if (properties & CHARACTERISTIC_PROPERTY_READ)
+        nimProperties |= NIMBLE_PROPERTY::READ;
+    if (properties & CHARACTERISTIC_PROPERTY_WRITE)
+        nimProperties |= NIMBLE_PROPERTY::WRITE;
+    if (properties & CHARACTERISTIC_PROPERTY_NOTIFY)
+        nimProperties |= NIMBLE_PROPERTY::NOTIFY;
+    if (properties & CHARACTERISTIC_PROPERTY_INDICATE)
+        nimProperties |= NIMBLE_PROPERTY::INDICATE;
+
+    NimBLECharacteristic *native = service->createCharacteristic(NimBleServer::toNative(uuid), nimProperties);
+    if (!native)
+        return nullptr;
+    NimBleCharacteristic *characteristic = owner->characteristics.create(native);
+    if (!characteristic)
+        LOG_ERROR("[ERROR] NimBleBackend: 特征值池已满");
+    return characteristic;
+}
+
+bool NimBleService::start()
+{
+    // NimBLE 在开始广播时统一注册 GATT 表，这里无需额外操作
+    return service != nullptr;
+}
+
+gatt::Service *NimBleServer::createService(const gatt::Uuid &uuid)
+{
+    NimBLEService *native = server->createService(toNative(uuid));
+    if (!native)
+        return nullptr;
+    NimBleService *service = services.create(this, native);
+    if (!service)
+        LOG_ERROR("[ERROR] NimBleBackend: 服务池已满");
+    return service;
+}
+
+void NimBleServer::reset()
+{
+    // 先移除协议栈中的服务（连同其特征值），再析构包装对象
+    for (size_t i = 0; i < services.size(); i++)
+    {
+        server->removeService(services.at(i)->getNative(), true);
+    }
+    characteristics.clear();
+    services.clear();
+}
+
+void NimBleServer::removeConnection(uint16_t connHandle)
+{
+    for (size_t i = 0; i < characteristics.size(); i++)
+        characteristics.at(i)->removeConnection(connHandle);
+}
+
+NimBLEUUID NimBleServer::toNative(const gatt::Uuid &uuid)
+{
+    if (uuid.is16())
+        return NimBLEUUID(uuid.value16);
+    return NimBLEUUID(uuid.value128);
+}
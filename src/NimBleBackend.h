@@ -0,0 +1,112 @@
+#pragma once
+#include <NimBLEDevice.h>
+#include "GattBackend.h"
+#include "StaticPool.h"
+#include "SubscriberSet.h"
+
+// GATT 后端的 NimBLE 实现：
+// 只链接 NimBLE 主机协议栈，不再拉入 Bluedroid；CCCD (0x2902) 由 NimBLE 为
+// 带 NOTIFY/INDICATE 属性的特征值自动创建，服务类不再单独分配描述符。
+// 订阅按连接记录在 SubscriberSet 中：notify() 只遍历订阅了通知的连接，无人订阅时不进入协议栈
+class NimBleCharacteristic : public gatt::Characteristic, public NimBLECharacteristicCallbacks
+{
+public:
+    // 缓存最近一次写入的值，getData() 不必经过 NimBLEAttValue 拷贝
+    static const size_t MAX_CACHED = 32;
+
+    explicit NimBleCharacteristic(NimBLECharacteristic *characteristic);
+
+    void setValue(const uint8_t *data, size_t len) override;
+    using gatt::Characteristic::setValue;
+    bool notify() override;
+    bool notify(const uint8_t *data, size_t len, uint16_t connHandle) override;
+    bool indicate() override;
+    bool indicate(uint16_t connHandle) override;
+
+    const uint8_t *getData() const override { return cache; }
+    size_t getLength() const override { return cacheLen; }
+
+    void setWriteHandler(gatt::WriteHandler handler, void *ctx) override;
+
+    size_t getSubscriberCount() const override { return subscribers.size(); }
+
+    // 连接断开时清除其订阅（NimBLE 不保证为断开的连接回调 onSubscribe）
+    void removeConnection(uint16_t connHandle);
+
+    NimBLECharacteristic *getNative() const { return characteristic; }
+
+    // NimBLECharacteristicCallbacks
+    void onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override;
+    void onSubscribe(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo, uint16_t subValue) override;
+
+private:
+    typedef SubscriberSet<gatt::MAX_CONNECTIONS> Subscribers;
+
+    NimBLECharacteristic *characteristic;
+    uint8_t cache[MAX_CACHED];
+    size_t cacheLen;
+    gatt::WriteHandler writeHandler;
+    void *writeCtx;
+
+    // 主机任务写入订阅表，通知任务遍历：在临界区内拷贝快照后再逐个发送
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    Subscribers subscribers;
+
+    bool send(uint16_t cccdMask);
+};
+
+class NimBleServer;
+
+class NimBleService : public gatt::Service
+{
+public:
+    NimBleService(NimBleServer *owner, NimBLEService *service) : owner(owner), service(service) {}
+
+    gatt::Characteristic *createCharacteristic(const gatt::Uuid &uuid, uint8_t properties) override;
+    bool start() override;
+
+    NimBLEService *getNative() const { return service; }
+
+private:
+    NimBleServer *owner;
+    NimBLEService *service;
+};
+
+// 包装对象全部放在按编译期上限定长的静态池中；
+// reset() 移除已创建的 NimBLE 服务并清空池，重新初始化时复用同一块存储
+class NimBleServer : public gatt::Server
+{
+public:
+    static const size_t MAX_SERVICES = 8;
+    static const size_t MAX_CHARACTERISTICS = 24;
+
+    explicit NimBleServer(NimBLEServer *server) : server(server) {}
+
+    gatt::Service *createService(const gatt::Uuid &uuid) override;
+    void reset();
+
+    // 由服务器断开回调调用：清除该连接在所有特征值上的订阅
+    void removeConnection(uint16_t connHandle);
+
+    NimBLEServer *getNative() const { return server; }
+    size_t getServiceCount() const { return services.size(); }
+    size_t getCharacteristicCount() const { return characteristics.size(); }
+    uint32_t getPoolFailureCount() const
+    {
+        return services.getFailureCount() + characteristics.getFailureCount();
+    }
+    static constexpr size_t poolBytes()
+    {
+        return StaticPool<NimBleService, MAX_SERVICES>::bytes() +
+               StaticPool<NimBleCharacteristic, MAX_CHARACTERISTICS>::bytes();
+    }
+
+    static NimBLEUUID toNative(const gatt::Uuid &uuid);
+
+private:
+    friend class NimBleService;
+
+    NimBLEServer *server;
+    StaticPool<NimBleService, MAX_SERVICES> services;
+    StaticPool<NimBleCharacteristic, MAX_CHARACTERISTICS> characteristics;
+};
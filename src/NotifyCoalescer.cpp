@@ -0,0 +1,81 @@
+#include "NotifyCoalescer.h"
+#include <string.h>
+
+NotifyCoalescer::NotifyCoalescer()
+    : windowUs(DEFAULT_WINDOW_US), keepAliveUs(DEFAULT_KEEPALIVE_US),
+      sent(0), suppressed(0), merged(0), keepAlives(0)
+{
+    reset();
+}
+
+void NotifyCoalescer::reset()
+{
+    lastSentLen = 0;
+    candidateLen = 0;
+    pending = false;
+    everSent = false;
+    lastSentUs = 0;
+}
+
+void NotifyCoalescer::submit(const uint8_t *data, size_t len)
+{
+    if (len > MAX_PAYLOAD)
+        len = MAX_PAYLOAD;
+
+    bool sameAsSent = everSent && len == lastSentLen && memcmp(data, lastSent, len) == 0;
+    if (sameAsSent)
+    {
+        // 值又回到了已发出的内容，尚未发出的中间值也不必再发
+        suppressed++;
+        pending = false;
+        return;
+    }
+
+    if (pending)
+        merged++;
+    memcpy(candidate, data, len);
+    candidateLen = (uint8_t)len;
+    pending = true;
+}
+
+bool NotifyCoalescer::take(int64_t nowUs)
+{
+    int64_t elapsed = nowUs - lastSentUs;
+
+    if (pending && (!everSent || elapsed >= (int64_t)windowUs))
+    {
+        memcpy(lastSent, candidate, candidateLen);
+        lastSentLen = candidateLen;
+        pending = false;
+        everSent = true;
+        lastSentUs = nowUs;
+        sent++;
+        return true;
+    }
+
+    if (!pending && everSent && keepAliveUs > 0 && elapsed >= (int64_t)keepAliveUs)
+    {
+        lastSentUs = nowUs;
+        sent++;
+        keepAlives++;
+        return true;
+    }
+
+    return false;
+}
+
+int64_t NotifyCoalescer::nextWakeUs(int64_t nowUs) const
+{
+    if (!everSent)
+        return pending ? 0 : -1;
+
+    int64_t due;
+    if (pending)
+        due = lastSentUs + (int64_t)windowUs;
+    else if (keepAliveUs > 0)
+        due = lastSentUs + (int64_t)keepAliveUs;
+    else
+        return -1;
+
+    return due > nowUs ? due - nowUs : 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 单个特征值的通知合并器（与平台无关）：
+// - 负载与上次发出的完全相同时不发送
+// - 一个合并窗口（取连接间隔）内的多次更新只发最后一次，即每个连接事件最多一次通知
+// - 长时间无变化时按保活间隔重发上一包，避免中心设备判定传感器掉线
+class NotifyCoalescer
+{
+public:
+    static const size_t MAX_PAYLOAD = 20; // 默认 ATT MTU 下单包通知的上限
+
+    static const uint32_t DEFAULT_WINDOW_US = 30000;     // 未知连接间隔时的合并窗口
+    static const uint32_t DEFAULT_KEEPALIVE_US = 1000000; // 0 表示不发送保活
+
+    NotifyCoalescer();
+
+    void setWindow(uint32_t windowUs) { this->windowUs = windowUs; }
+    void setKeepAlive(uint32_t keepAliveUs) { this->keepAliveUs = keepAliveUs; }
+    uint32_t getWindow() const { return windowUs; }
+
+    // 提交最新负载；与上次发出的相同时计入抑制，覆盖尚未发出的负载时计入合并
+    void submit(const uint8_t *data, size_t len);
+
+    // 若现在应当发送（有变化且窗口已过，或保活到期）则记为已发送并返回 true
+    bool take(int64_t nowUs);
+
+    // 距离下一次可能发送的时间 (us)：-1 表示无需唤醒
+    int64_t nextWakeUs(int64_t nowUs) const;
+
+    bool isPending() const { return pending; }
+
+    // 断开连接后重置，下次连接的第一包立即发出
+    void reset();
+
+    uint32_t getSentCount() const { return sent; }
+    uint32_t getSuppressedCount() const { return suppressed; }
+    uint32_t getMergedCount() const { return merged; }
+    uint32_t getKeepAliveCount() const { return keepAlives; }
+
+private:
+    uint32_t windowUs;
+    uint32_t keepAliveUs;
+
+    uint8_t lastSent[MAX_PAYLOAD];
+    uint8_t lastSentLen;
+    uint8_t candidate[MAX_PAYLOAD];
+    uint8_t candidateLen;
+    bool pending;
+    bool everSent;
+    int64_t lastSentUs;
+
+    uint32_t sent;
+    uint32_t suppressed;
+    uint32_t merged;
+    uint32_t keepAlives;
+};
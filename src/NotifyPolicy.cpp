@@ -0,0 +1,77 @@
+#include "NotifyPolicy.h"
+
+NotifyPolicy::NotifyPolicy()
+{
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++)
+    {
+        channels[i].minIntervalUs = 0;
+        channels[i].pending = false;
+        channels[i].everSent = false;
+        channels[i].pendingSinceUs = 0;
+        channels[i].lastSentUs = 0;
+    }
+}
+
+void NotifyPolicy::setMinInterval(uint8_t channel, uint32_t intervalUs)
+{
+    if (channel >= MAX_CHANNELS)
+        return;
+    channels[channel].minIntervalUs = intervalUs;
+}
+
+void NotifyPolicy::markPending(uint8_t channel, int64_t eventUs)
+{
+    if (channel >= MAX_CHANNELS)
+        return;
+    Channel &ch = channels[channel];
+    if (!ch.pending)
+    {
+        ch.pending = true;
+        ch.pendingSinceUs = eventUs;
+    }
+}
+
+bool NotifyPolicy::take(uint8_t channel, int64_t nowUs, int64_t *eventUs)
+{
+    if (channel >= MAX_CHANNELS)
+        return false;
+    Channel &ch = channels[channel];
+    if (!ch.pending)
+        return false;
+    if (ch.everSent && nowUs - ch.lastSentUs < (int64_t)ch.minIntervalUs)
+        return false;
+
+    if (eventUs)
+        *eventUs = ch.pendingSinceUs;
+    ch.pending = false;
+    ch.everSent = true;
+    ch.lastSentUs = nowUs;
+    return true;
+}
+
+int64_t NotifyPolicy::nextWakeUs(int64_t nowUs) const
+{
+    int64_t wait = -1;
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++)
+    {
+        const Channel &ch = channels[i];
+        if (!ch.pending)
+            continue;
+
+        int64_t remaining = 0;
+        if (ch.everSent)
+        {
+            remaining = ch.lastSentUs + (int64_t)ch.minIntervalUs - nowUs;
+            if (remaining < 0)
+                remaining = 0;
+        }
+        if (wait < 0 || remaining < wait)
+            wait = remaining;
+    }
+    return wait;
+}
+
+bool NotifyPolicy::isPending(uint8_t channel) const
+{
+    return channel < MAX_CHANNELS && channels[channel].pending;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+// 通知调度策略（与平台无关）：
+// 每个特征值一个通道，记录最早未发送事件的时间，并按各自的最小间隔限速
+class NotifyPolicy
+{
+public:
+    static const uint8_t MAX_CHANNELS = 4;
+
+    NotifyPolicy();
+
+    // 设置通道的最小通知间隔 (us)，0 表示不限速
+    void setMinInterval(uint8_t channel, uint32_t intervalUs);
+
+    // 标记通道有新数据，保留最早的事件时间用于延迟统计
+    void markPending(uint8_t channel, int64_t eventUs);
+
+    // 若通道有待发数据且已过限速间隔，则清除待发标记并返回 true
+    bool take(uint8_t channel, int64_t nowUs, int64_t *eventUs);
+
+    // 距离下一个通道可发送还需等待的时间 (us)：-1 表示无待发数据，0 表示立即可发
+    int64_t nextWakeUs(int64_t nowUs) const;
+
+    bool isPending(uint8_t channel) const;
+
+private:
+    struct Channel
+    {
+        uint32_t minIntervalUs;
+        bool pending;
+        bool everSent;
+        int64_t pendingSinceUs;
+        int64_t lastSentUs;
+    };
+
+    Channel channels[MAX_CHANNELS];
+};
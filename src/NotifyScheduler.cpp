@@ -0,0 +1,288 @@
+#include "NotifyScheduler.h"
+#include "Log.h"
+
+NotifyScheduler::NotifyScheduler()
+{
+    pending = {};
+    current = {};
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+    {
+        awaitingSend[i] = false;
+        submitEventUs[i] = 0;
+        submitTick[i] = 0;
+    }
+}
+
+bool NotifyScheduler::begin(BikeData *data, CSCService *csc, CPService *cp, FTMSService *ftms, const Config &cfg)
+{
+    if (!data || !csc || !cp || !ftms)
+    {
+        LOG_ERROR("[ERROR] NotifyScheduler: 无效的参数");
+        return false;
+    }
+
+    end();
+
+    bikeData = data;
+    cscService = csc;
+    cpService = cp;
+    ftmsService = ftms;
+    config = cfg;
+
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+    {
+        policy.setMinInterval(i, config.minIntervalMs[i] * 1000);
+    }
+    ring.reset();
+    pending = {};
+    current = {};
+    current.data = bikeData->getData();
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+    {
+        awaitingSend[i] = false;
+        submitEventUs[i] = 0;
+        submitTick[i] = 0;
+    }
+    sampleCount = 0;
+    producerPeriodMs = config.producerPeriodMs;
+    lastActivityMillis = millis();
+
+    if (xTaskCreatePinnedToCore(taskEntry, "notify", config.taskStackSize, this,
+                                config.taskPriority, &notifyTask, config.taskCore) != pdPASS)
+    {
+        LOG_ERROR("[ERROR] NotifyScheduler: 创建通知任务失败");
+        notifyTask = nullptr;
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(producerEntry, "producer", config.producerStackSize, this,
+                                config.producerPriority, &producerTask, config.producerCore) != pdPASS)
+    {
+        LOG_ERROR("[ERROR] NotifyScheduler: 创建采样任务失败");
+        producerTask = nullptr;
+        end();
+        return false;
+    }
+
+    LOG_INFO("[BLE] 通知调度器启动成功 (采样核心 %d, 通知核心 %d)",
+             (int)config.producerCore, (int)config.taskCore);
+    return true;
+}
+
+void NotifyScheduler::end()
+{
+    if (producerTask)
+    {
+        vTaskDelete(producerTask);
+        producerTask = nullptr;
+    }
+    if (notifyTask)
+    {
+        vTaskDelete(notifyTask);
+        notifyTask = nullptr;
+    }
+}
+
+void NotifyScheduler::producerEntry(void *arg)
+{
+    NotifyScheduler *self = static_cast<NotifyScheduler *>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        TickType_t period = pdMS_TO_TICKS(self->producerPeriodMs);
+        if (period == 0)
+            period = 1;
+        // 与 vTaskDelayUntil 相同的固定相位；setProducerPeriod() 的通知提前结束等待
+        TickType_t elapsed = xTaskGetTickCount() - lastWake;
+        if (elapsed < period && ulTaskNotifyTake(pdTRUE, period - elapsed))
+            lastWake = xTaskGetTickCount();
+        else
+            lastWake += period;
+        self->produce();
+    }
+}
+
+void NotifyScheduler::setProducerPeriod(uint32_t periodMs)
+{
+    uint32_t previous = producerPeriodMs;
+    if (periodMs == previous)
+        return;
+    producerPeriodMs = periodMs;
+    TaskHandle_t task = producerTask;
+    if (periodMs < previous && task)
+        xTaskNotifyGive(task);
+}
+
+void NotifyScheduler::produce()
+{
+    // 只有采样任务写入 BikeData 与 pending
+    int64_t nowUs = esp_timer_get_time();
+    if (config.trace)
+        config.trace->beginTick(*bikeData, nowUs);
+    if (config.pollSource)
+        config.pollSource(bikeData);
+    uint8_t events = bikeData->update((uint64_t)nowUs);
+    if (config.trace)
+        config.trace->endTick();
+    sampleCount = sampleCount + 1;
+
+    if (!events && !pending.events)
+        return;
+
+    // 每个通道只记录最早的未送出事件时间
+    if ((events & CSC_EVENTS) && !(pending.events & CSC_EVENTS))
+        pending.eventUs[CHANNEL_CSC] = nowUs;
+    if ((events & CP_EVENTS) && !(pending.events & CP_EVENTS))
+        pending.eventUs[CHANNEL_CP] = nowUs;
+    if (!pending.events)
+        pending.eventUs[CHANNEL_FTMS] = nowUs;
+    pending.events |= events;
+    pending.data = bikeData->getData();
+    pending.tick = config.trace ? config.trace->currentTick() : 0;
+
+    // 队列满时保留事件，随下一个快照送出（转数是累计值，跳过中间快照不丢信息）
+    if (ring.push(pending))
+    {
+        pending.events = 0;
+        xTaskNotifyGive(notifyTask);
+    }
+}
+
+void NotifyScheduler::resetLatency()
+{
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+    {
+        latency[i].reset();
+    }
+}
+
+void NotifyScheduler::taskEntry(void *arg)
+{
+    static_cast<NotifyScheduler *>(arg)->run();
+}
+
+void NotifyScheduler::run()
+{
+    uint32_t waitMs = config.heartbeatMs;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+        lastActivityMillis = millis();
+
+        drain();
+
+        int64_t nowUs = esp_timer_get_time();
+        int64_t eventUs = 0;
+        const BikeData::Data &data = current.data;
+
+        // 有新事件时提交最新数据；否则只让合并器处理到期的合并窗口与保活
+        bool sent;
+        if (policy.take(CHANNEL_CSC, nowUs, &eventUs))
+        {
+            noteSubmit(CHANNEL_CSC, eventUs);
+            sent = cscService->updateMeasurement(data.wheel_rev, data.w_event_time,
+                                                 data.crank_rev, data.c_event_time);
+        }
+        else
+        {
+            sent = cscService->flush(nowUs);
+        }
+        if (sent)
+            noteSent(CHANNEL_CSC, trace::CH_CSC, cscService->getMeasurementChar());
+        else if (!cscService->getCoalescer().isPending())
+            awaitingSend[CHANNEL_CSC] = false; // 负载未变化，被抑制
+
+        if (policy.take(CHANNEL_CP, nowUs, &eventUs))
+        {
+            noteSubmit(CHANNEL_CP, eventUs);
+            sent = cpService->updateMeasurement(CPService::toFields(data));
+        }
+        else
+        {
+            sent = cpService->flush(nowUs);
+        }
+        if (sent)
+            noteSent(CHANNEL_CP, trace::CH_CP, cpService->getMeasurementChar());
+        else if (!cpService->getCoalescer().isPending())
+            awaitingSend[CHANNEL_CP] = false;
+
+        if (policy.take(CHANNEL_FTMS, nowUs, &eventUs))
+        {
+            noteSubmit(CHANNEL_FTMS, eventUs);
+            sent = ftmsService->updateMeasurement(data.speed, data.cadence, data.power);
+        }
+        else
+        {
+            sent = ftmsService->flush(nowUs);
+        }
+        if (sent)
+            noteSent(CHANNEL_FTMS, trace::CH_FTMS, ftmsService->getMeasurementChar());
+        else if (!ftmsService->getCoalescer().isPending())
+            awaitingSend[CHANNEL_FTMS] = false;
+
+        // 被限速的通道或合并窗口、保活到期时再唤醒，其余情况等待下一个事件
+        nowUs = esp_timer_get_time();
+        int64_t wakeUs = earliestWake(policy.nextWakeUs(nowUs), cscService->getCoalescer().nextWakeUs(nowUs));
+        wakeUs = earliestWake(wakeUs, cpService->getCoalescer().nextWakeUs(nowUs));
+        wakeUs = earliestWake(wakeUs, ftmsService->getCoalescer().nextWakeUs(nowUs));
+        if (wakeUs < 0)
+            waitMs = config.heartbeatMs;
+        else
+            waitMs = (uint32_t)((wakeUs + 999) / 1000);
+        if (waitMs == 0)
+            waitMs = 1;
+    }
+}
+
+void NotifyScheduler::drain()
+{
+    // 取出全部快照：事件并入限速策略，数据只保留最新一份
+    Sample sample;
+    while (ring.pop(sample))
+    {
+        if (sample.events & CSC_EVENTS)
+            policy.markPending(CHANNEL_CSC, sample.eventUs[CHANNEL_CSC]);
+        if (sample.events & CP_EVENTS)
+            policy.markPending(CHANNEL_CP, sample.eventUs[CHANNEL_CP]);
+        if (sample.events)
+            policy.markPending(CHANNEL_FTMS, sample.eventUs[CHANNEL_FTMS]);
+        current = sample;
+    }
+}
+
+void NotifyScheduler::noteSubmit(Channel channel, int64_t eventUs)
+{
+    // 合并中的负载保留最早的事件时间
+    if (!awaitingSend[channel])
+        submitEventUs[channel] = eventUs;
+    awaitingSend[channel] = true;
+    submitTick[channel] = current.tick;
+}
+
+void NotifyScheduler::noteSent(Channel channel, uint8_t traceChannel, gatt::Characteristic *characteristic)
+{
+    // 保活包没有对应的事件，不计入延迟
+    if (awaitingSend[channel])
+    {
+        latency[channel].record((uint32_t)(esp_timer_get_time() - submitEventUs[channel]));
+        awaitingSend[channel] = false;
+    }
+    recordPayload(traceChannel, submitTick[channel], characteristic);
+}
+
+int64_t NotifyScheduler::earliestWake(int64_t a, int64_t b)
+{
+    if (a < 0)
+        return b;
+    if (b < 0)
+        return a;
+    return a < b ? a : b;
+}
+
+void NotifyScheduler::recordPayload(uint8_t channel, uint32_t tick, gatt::Characteristic *characteristic)
+{
+    if (!config.trace || !characteristic)
+        return;
+    config.trace->recordPayload(channel, tick, characteristic->getData(), characteristic->getLength());
+}
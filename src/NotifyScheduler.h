@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "FTMSService.h"
+#include "LatencyStats.h"
+#include "NotifyPolicy.h"
+#include "SpscRing.h"
+#include "TraceRecorder.h"
+
+// 事件驱动的通知调度器：
+// 采样任务（核心 1）周期调用 bikeData.update()，把带事件的快照写入无锁 SPSC 环形队列并唤醒
+// 通知任务（核心 0，与 BLE 主机同核），通知任务按各特征值的限速立即发送。
+// 两侧之间没有临界区：拥塞时 notify 变慢不会推迟采样，采样也不会阻塞发送。
+class NotifyScheduler
+{
+public:
+    enum Channel : uint8_t
+    {
+        CHANNEL_CSC = 0,
+        CHANNEL_CP,
+        CHANNEL_FTMS, // 速度、踏频、功率任一变化都会触发
+        CHANNEL_COUNT
+    };
+
+    // 采样任务交给通知任务的快照
+    struct Sample
+    {
+        BikeData::Data data;
+        int64_t eventUs[CHANNEL_COUNT]; // 各通道最早的未送出事件时间
+        uint32_t tick;                  // 追踪 tick 序号
+        uint8_t events;                 // BikeData::EVENT_*（含因队列满而延后的事件）
+    };
+
+    static const size_t RING_SIZE = 16;
+
+    // 触发各通道的事件：CP 测量携带转数与累计能量，任一变化都需要发送
+    static const uint8_t CSC_EVENTS = BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK;
+    static const uint8_t CP_EVENTS = BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK |
+                                     BikeData::EVENT_POWER | BikeData::EVENT_ENERGY;
+
+    struct Config
+    {
+        // 新的一圈要到下一次采样才被发现，采样周期决定一圈到通知的延迟上限；
+        // CSC 只在转数变化时发送，限速不超过采样周期即不再增加延迟。CP/FTMS 携带每次采样都可能变化的功率，
+        // 限速 50 ms 使通知频率不超过旧版轮询 (bench_latency)
+        uint32_t producerPeriodMs = 25;                          // 采样周期
+        uint32_t minIntervalMs[CHANNEL_COUNT] = {25, 50, 50};    // 各特征值最小通知间隔
+        uint32_t heartbeatMs = 1000;                             // 无事件时任务的最长休眠时间
+        void (*pollSource)(BikeData *) = nullptr;                // 每次采样前调用，用于写入外部数据
+        TraceRecorder *trace = nullptr;                          // 非空时记录输入与输出负载
+        UBaseType_t taskPriority = 5;                            // 通知任务
+        uint32_t taskStackSize = 4096;
+        BaseType_t taskCore = 0;                                 // 与 BLE 主机同核
+        UBaseType_t producerPriority = 6;
+        uint32_t producerStackSize = 4096;
+        BaseType_t producerCore = 1;
+    };
+
+    NotifyScheduler();
+
+    bool begin(BikeData *bikeData, CSCService *csc, CPService *cp, FTMSService *ftms, const Config &config);
+    void end();
+
+    const LatencyStats &getLatency(Channel channel) const { return latency[channel]; }
+    void resetLatency();
+
+    // 通知任务最近一次运行的时间，用于看门狗
+    unsigned long getLastActivityMillis() const { return lastActivityMillis; }
+
+    // 队列统计：溢出的快照数（其事件并入下一个快照）、最高水位、产生的快照总数
+    uint32_t getOverflowCount() const { return ring.getOverflowCount(); }
+    uint32_t getHighWater() const { return ring.getHighWater(); }
+    uint32_t getSampleCount() const { return sampleCount; }
+
+    // 运行中调整采样周期（电源管理在空闲时放慢采样）；缩短周期时立即唤醒采样任务并以当前时刻为新的相位
+    void setProducerPeriod(uint32_t periodMs);
+
+private:
+    BikeData *bikeData = nullptr;
+    CSCService *cscService = nullptr;
+    CPService *cpService = nullptr;
+    FTMSService *ftmsService = nullptr;
+    Config config;
+
+    TaskHandle_t producerTask = nullptr;
+    TaskHandle_t notifyTask = nullptr;
+
+    SpscRing<Sample, RING_SIZE> ring;
+
+    // 仅采样任务访问：队列满时未送出的事件及其最早时间
+    Sample pending;
+    volatile uint32_t sampleCount = 0;
+    volatile uint32_t producerPeriodMs = 25;
+
+    // 仅通知任务访问：最近取出的快照，被限速的通道到期时发送它
+    Sample current;
+    // 已提交给合并器、尚未发出的负载的事件时间与追踪 tick
+    bool awaitingSend[CHANNEL_COUNT];
+    int64_t submitEventUs[CHANNEL_COUNT];
+    uint32_t submitTick[CHANNEL_COUNT];
+
+    NotifyPolicy policy;
+    LatencyStats latency[CHANNEL_COUNT];
+    volatile unsigned long lastActivityMillis = 0;
+
+    static void producerEntry(void *arg);
+    static void taskEntry(void *arg);
+    void produce();
+    void run();
+    void drain();
+    void noteSubmit(Channel channel, int64_t eventUs);
+    void noteSent(Channel channel, uint8_t traceChannel, gatt::Characteristic *characteristic);
+    static int64_t earliestWake(int64_t a, int64_t b);
+    void recordPayload(uint8_t channel, uint32_t tick, gatt::Characteristic *characteristic);
+};
@@ -0,0 +1,162 @@
+#include "PowerManager.h"
+#include <NimBLEDevice.h>
+#include <esp_idf_version.h>
+#include <sdkconfig.h>
+#include "Log.h"
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+bool PowerManager::begin(const Config &cfg)
+{
+    end();
+    config = cfg;
+    policy = PowerPolicy(config.policy);
+    policy.begin(millis());
+    advMinUnits = 0;
+    advMaxUnits = 0;
+
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    LOG_INFO("[PWR] 电源管理: 动态调频 + 自动浅睡眠");
+#elif CONFIG_PM_ENABLE
+    LOG_WARN("[PWR] 电源管理: 动态调频，未启用 tickless idle，无自动浅睡眠");
+#else
+    LOG_WARN("[PWR] 电源管理: 框架未启用 CONFIG_PM_ENABLE，仅静态切换 CPU 频率");
+#endif
+
+    // 启动时按 ADVERTISING 配置应用一次，之后只在状态切换时应用
+    apply(policy.getProfile());
+
+    if (xTaskCreatePinnedToCore(taskEntry, "power", config.taskStackSize, this,
+                                config.taskPriority, &task, config.taskCore) != pdPASS)
+    {
+        task = nullptr;
+        LOG_ERROR("[ERROR] PowerManager: 创建电源任务失败");
+        return false;
+    }
+    return true;
+}
+
+void PowerManager::end()
+{
+    if (task)
+    {
+        vTaskDelete(task);
+        task = nullptr;
+    }
+}
+
+void PowerManager::setConnected(bool value)
+{
+    connected.store(value, std::memory_order_relaxed);
+    TaskHandle_t t = task;
+    if (t)
+        xTaskNotifyGive(t);
+}
+
+void PowerManager::setRiding(bool value)
+{
+    bool was = riding.exchange(value, std::memory_order_relaxed);
+    TaskHandle_t t = task;
+    if (value && !was && t)
+        xTaskNotifyGive(t);
+}
+
+void PowerManager::taskEntry(void *arg)
+{
+    static_cast<PowerManager *>(arg)->run();
+}
+
+void PowerManager::run()
+{
+    for (;;)
+    {
+        // 连接与踏频恢复通过通知立即唤醒；超时只用于进入空闲的计时
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(pollPeriodMs.load(std::memory_order_relaxed)));
+
+        portENTER_CRITICAL(&mux);
+        bool changed = policy.update(millis(), connected.load(std::memory_order_relaxed),
+                                     riding.load(std::memory_order_relaxed));
+        PowerPolicy::Profile profile = policy.getProfile();
+        portEXIT_CRITICAL(&mux);
+
+        if (changed)
+            apply(profile);
+    }
+}
+
+void PowerManager::apply(const PowerPolicy::Profile &profile)
+{
+    PowerPolicy::State s = policy.getState();
+    // 先升频再通知其他任务加快节奏；降频时顺序无关紧要
+    applyCpu(profile);
+    applyAdvertising(profile);
+    if (config.onChange)
+        config.onChange(profile);
+    pollPeriodMs.store(profile.pollPeriodMs, std::memory_order_relaxed);
+    state.store(s, std::memory_order_relaxed);
+
+    LOG_INFO("[PWR] %s: CPU %u-%u MHz sleep=%u adv=%u-%u",
+             PowerPolicy::stateName(s), (unsigned)profile.cpuMinMHz, (unsigned)profile.cpuMaxMHz,
+             (unsigned)profile.lightSleep, (unsigned)profile.advMinUnits, (unsigned)profile.advMaxUnits);
+}
+
+void PowerManager::applyCpu(const PowerPolicy::Profile &profile)
+{
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_pm_config_t pm = {};
+#else
+    esp_pm_config_esp32s3_t pm = {};
+#endif
+    pm.max_freq_mhz = profile.cpuMaxMHz;
+    pm.min_freq_mhz = profile.cpuMinMHz;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pm.light_sleep_enable = profile.lightSleep;
+#endif
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK)
+        LOG_WARN("[PWR] esp_pm_configure 失败 (%d)", (int)err);
+#else
+    // 没有 DFS 时取下限作为固定频率；射频要求 APB 80 MHz，CPU 不能低于 80 MHz
+    uint32_t mhz = profile.cpuMinMHz < 80 ? 80 : profile.cpuMinMHz;
+    if (getCpuFrequencyMhz() != mhz && !setCpuFrequencyMhz(mhz))
+        LOG_WARN("[PWR] 设置 CPU 频率 %u MHz 失败", (unsigned)mhz);
+#endif
+}
+
+void PowerManager::applyAdvertising(const PowerPolicy::Profile &profile)
+{
+    if (profile.advMinUnits == advMinUnits && profile.advMaxUnits == advMaxUnits)
+        return;
+    NimBLEAdvertising *advertising = NimBLEDevice::getAdvertising();
+    if (!advertising)
+        return;
+    advertising->setMinInterval(profile.advMinUnits);
+    advertising->setMaxInterval(profile.advMaxUnits);
+    advMinUnits = profile.advMinUnits;
+    advMaxUnits = profile.advMaxUnits;
+
+    // 新间隔在启动广播时生效：正在广播时重启；已连接时在断开后重新广播时生效
+    if (advertising->isAdvertising())
+    {
+        advertising->stop();
+        advertising->start();
+    }
+}
+
+void PowerManager::report()
+{
+    uint32_t nowMs = millis();
+    uint32_t seconds[PowerPolicy::STATE_COUNT];
+    portENTER_CRITICAL(&mux);
+    for (uint8_t i = 0; i < PowerPolicy::STATE_COUNT; i++)
+        seconds[i] = policy.getTimeInState((PowerPolicy::State)i, nowMs) / 1000;
+    uint32_t transitions = policy.getTransitionCount();
+    portEXIT_CRITICAL(&mux);
+
+    LOG_INFO("[PWR] state=%s cpu=%u MHz transitions=%u", PowerPolicy::stateName(getState()),
+             (unsigned)getCpuFrequencyMhz(), (unsigned)transitions);
+    LOG_INFO("[PWR] connected=%us advertising=%us idle=%us", (unsigned)seconds[PowerPolicy::STATE_CONNECTED],
+             (unsigned)seconds[PowerPolicy::STATE_ADVERTISING], (unsigned)seconds[PowerPolicy::STATE_IDLE]);
+}
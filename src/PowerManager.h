@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "PowerPolicy.h"
+
+// 电源管理：低优先级任务按 PowerPolicy 切换功耗状态，并应用 CPU 频率、自动浅睡眠与广播间隔。
+// BLE 回调与采样任务只写原子标志并唤醒任务，不调用 esp_pm 或广播 API，
+// 因此中心设备连接或踏频恢复后在一次任务调度内（远小于一个连接间隔）回到全速。
+//
+// 动态调频与自动浅睡眠需要框架启用 CONFIG_PM_ENABLE 与 CONFIG_FREERTOS_USE_TICKLESS_IDLE，
+// 浅睡眠期间保持 BLE 连接还需要控制器的调制解调器睡眠 (CONFIG_BT_CTRL_MODEM_SLEEP)；
+// 未启用时退化为静态切换 CPU 频率（开启射频时不低于 80 MHz），广播退避不受影响。
+class PowerManager
+{
+public:
+    struct Config
+    {
+        PowerPolicy::Config policy;
+        void (*onChange)(const PowerPolicy::Profile &) = nullptr; // 状态切换后在电源任务中调用，应用扫描、采样等
+        UBaseType_t taskPriority = 4;                             // 低于采样 (6) 与通知 (5) 任务
+        uint32_t taskStackSize = 3072;
+        BaseType_t taskCore = 0; // 广播 API 与 BLE 主机同核
+    };
+
+    bool begin(const Config &config);
+    void end();
+
+    // 可在任意任务或回调中调用
+    void setConnected(bool connected);
+    // 由采样任务每次采样调用，只在踏频从无到有时唤醒电源任务
+    void setRiding(bool riding);
+
+    PowerPolicy::State getState() const { return state.load(std::memory_order_relaxed); }
+    uint32_t getPollPeriodMs() const { return pollPeriodMs.load(std::memory_order_relaxed); }
+
+    // 输出当前状态、各状态累计时间与切换次数（串口命令 'P'）
+    void report();
+
+private:
+    Config config;
+    PowerPolicy policy;
+    TaskHandle_t task = nullptr;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; // 保护 policy：电源任务更新，report() 读取
+
+    std::atomic<bool> connected{false};
+    std::atomic<bool> riding{false};
+    std::atomic<PowerPolicy::State> state{PowerPolicy::STATE_ADVERTISING};
+    std::atomic<uint32_t> pollPeriodMs{100};
+
+    // 仅电源任务访问：已应用的广播间隔，未变化时不重启广播
+    uint16_t advMinUnits = 0;
+    uint16_t advMaxUnits = 0;
+
+    static void taskEntry(void *arg);
+    void run();
+    void apply(const PowerPolicy::Profile &profile);
+    void applyCpu(const PowerPolicy::Profile &profile);
+    void applyAdvertising(const PowerPolicy::Profile &profile);
+};
@@ -0,0 +1,67 @@
+#include "PowerPolicy.h"
+
+void PowerPolicy::begin(uint32_t nowMs)
+{
+    state = STATE_ADVERTISING;
+    stateSinceMs = nowMs;
+    lastActivityMs = nowMs;
+    for (uint32_t &t : timeInState)
+        t = 0;
+    transitionCount = 0;
+}
+
+bool PowerPolicy::update(uint32_t nowMs, bool connected, bool riding)
+{
+    State next = state;
+    if (connected)
+    {
+        next = STATE_CONNECTED;
+        lastActivityMs = nowMs;
+    }
+    else if (riding || state == STATE_CONNECTED)
+    {
+        // 断开后重新计时快速广播，骑行中保持可被发现
+        next = STATE_ADVERTISING;
+        lastActivityMs = nowMs;
+    }
+    else if (state == STATE_ADVERTISING && nowMs - lastActivityMs >= config.idleAfterMs)
+    {
+        next = STATE_IDLE;
+    }
+
+    if (next == state)
+        return false;
+    enter(next, nowMs);
+    return true;
+}
+
+void PowerPolicy::enter(State next, uint32_t nowMs)
+{
+    timeInState[state] += nowMs - stateSinceMs;
+    state = next;
+    stateSinceMs = nowMs;
+    transitionCount++;
+}
+
+uint32_t PowerPolicy::getTimeInState(State s, uint32_t nowMs) const
+{
+    uint32_t t = timeInState[s];
+    if (s == state)
+        t += nowMs - stateSinceMs;
+    return t;
+}
+
+const char *PowerPolicy::stateName(State s)
+{
+    switch (s)
+    {
+    case STATE_CONNECTED:
+        return "connected";
+    case STATE_ADVERTISING:
+        return "advertising";
+    case STATE_IDLE:
+        return "idle";
+    default:
+        return "?";
+    }
+}
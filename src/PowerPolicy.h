@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+
+// 电源策略（与平台无关）：由连接与踏频决定功耗状态，每个状态对应一组 CPU 频率、浅睡眠、
+// 广播间隔、扫描占空比与各任务周期。update() 只做整数比较，可在主机上测试；
+// 固件中由 PowerManager 把切换后的配置应用到 esp_pm、NimBLE 与各任务。
+//
+//   CONNECTED    有中心设备连接：全速（240 MHz，与开发板默认频率相同，转数通知延迟按此测得）
+//   ADVERTISING  未连接，刚启动/断开或仍在骑行：全速并快速广播，便于中心设备发现
+//   IDLE         未连接且 idleAfterMs 内没有踏频：动态调频 + 自动浅睡眠，广播退避，降低扫描与采样频率
+// 连接立即回到 CONNECTED，踏频恢复立即回到 ADVERTISING，都在同一次 update() 中完成。
+class PowerPolicy
+{
+public:
+    enum State : uint8_t
+    {
+        STATE_CONNECTED = 0,
+        STATE_ADVERTISING,
+        STATE_IDLE,
+        STATE_COUNT
+    };
+
+    struct Profile
+    {
+        uint16_t cpuMaxMHz;
+        uint16_t cpuMinMHz;      // 小于 cpuMaxMHz 时允许动态调频
+        bool lightSleep;         // 空闲时自动浅睡眠
+        uint16_t advMinUnits;    // 广播间隔 (0.625 ms 单位)
+        uint16_t advMaxUnits;
+        uint16_t scanIntervalMs; // Keiser 扫描间隔与窗口
+        uint16_t scanWindowMs;
+        uint16_t samplePeriodMs; // 采样任务周期
+        uint16_t pollPeriodMs;   // 主循环与电源任务的后台检查周期
+        uint16_t ledPeriodMs;    // 状态灯刷新周期
+    };
+
+    struct Config
+    {
+        uint32_t idleAfterMs = 30000; // 未连接且无踏频多久后进入空闲（快速广播的时长）
+        Profile profiles[STATE_COUNT] = {
+            // CPU max/min, 浅睡眠, 广播 min/max, 扫描间隔/窗口, 采样, 后台, 状态灯
+            {240, 240, false, 32, 48, 50, 30, 25, 100, 20},          // CONNECTED: 25 ms 采样限制转数通知延迟
+            {240, 240, false, 32, 48, 50, 30, 50, 100, 20},          // ADVERTISING: 20-30 ms
+            {160, 40, true, 1636, 2056, 400, 40, 250, 1000, 250},    // IDLE: 1022.5-1285 ms
+        };
+    };
+
+    PowerPolicy() {}
+    explicit PowerPolicy(const Config &config) : config(config) {}
+
+    void begin(uint32_t nowMs);
+
+    // 返回 true 表示状态改变，调用方应用 getProfile()
+    bool update(uint32_t nowMs, bool connected, bool riding);
+
+    State getState() const { return state; }
+    const Profile &getProfile() const { return config.profiles[state]; }
+    const Profile &getProfile(State s) const { return config.profiles[s]; }
+    const Config &getConfig() const { return config; }
+
+    // 各状态的累计时间（含当前状态已持续的时间），与电流计读数对照可得各状态的平均电流
+    uint32_t getTimeInState(State s, uint32_t nowMs) const;
+    uint32_t getTransitionCount() const { return transitionCount; }
+
+    static const char *stateName(State s);
+
+private:
+    Config config;
+    State state = STATE_ADVERTISING;
+    uint32_t stateSinceMs = 0;
+    uint32_t lastActivityMs = 0; // 最近一次连接、断开或踏频
+    uint32_t timeInState[STATE_COUNT] = {};
+    uint32_t transitionCount = 0;
+
+    void enter(State next, uint32_t nowMs);
+};
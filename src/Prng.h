@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+
+// 可设定种子的快速伪随机数发生器 (xoshiro128**)：只用 32 位移位、旋转与乘法，
+// 在 ESP32-S3 与主机上给出相同序列，周期 2^128 - 1
+class Prng
+{
+public:
+    explicit Prng(uint32_t seed = 1) { setSeed(seed); }
+
+    void setSeed(uint32_t seed)
+    {
+        // splitmix32 展开种子，任何种子（含 0）都得到非零状态
+        for (uint32_t &word : s)
+        {
+            seed += 0x9E3779B9u;
+            uint32_t z = seed;
+            z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+            z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+            word = z ^ (z >> 16);
+        }
+    }
+
+    uint32_t next()
+    {
+        uint32_t result = rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    // [0, 1) 的单精度浮点数（取高 24 位）
+    float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // [-1, 1) 均匀分布
+    float nextSigned() { return nextFloat() * 2.0f - 1.0f; }
+
+private:
+    uint32_t s[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
@@ -0,0 +1,40 @@
+#include "PulseInput.h"
+
+PulseSource::PulseSource()
+{
+    channels[CHANNEL_WHEEL].debouncer.setLockout(30000);
+    channels[CHANNEL_CRANK].debouncer.setLockout(150000);
+    channels[CHANNEL_WHEEL].debouncer.setQuiet(5000);
+    channels[CHANNEL_CRANK].debouncer.setQuiet(5000);
+}
+
+void PulseTracker::reset()
+{
+    revolutions = 0;
+    lastUs = 0;
+    intervalUs = 0;
+    started = false;
+}
+
+void PulseTracker::addPulse(uint64_t timeUs)
+{
+    if (started && timeUs > lastUs)
+    {
+        uint64_t interval = timeUs - lastUs;
+        intervalUs = interval > UINT32_MAX ? UINT32_MAX : (uint32_t)interval;
+    }
+    started = true;
+    lastUs = timeUs;
+    revolutions++;
+}
+
+float PulseTracker::getRate(uint64_t nowUs, uint64_t stopUs) const
+{
+    if (!started || intervalUs == 0)
+        return 0.0f;
+    uint64_t waited = nowUs > lastUs ? nowUs - lastUs : 0;
+    if (waited > stopUs)
+        return 0.0f;
+    uint64_t period = waited > intervalUs ? waited : intervalUs;
+    return 1000000.0f / (float)period;
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "SpscRing.h"
+
+// 有线车轮/曲柄传感器（干簧管）的脉冲输入（与平台无关）。
+// 生产者（固件中为 GPIO 中断，主机上为合成脉冲序列）对每个边沿调用 capture()：
+// 去抖后把微秒时间戳放入该通道的无锁队列；消费者 (BikeData) 在采样时取出，
+// 由 PulseTracker 累计转数并给出最后一圈的精确时刻与转速，事件时间不受采样周期量化。
+
+// 去抖：中断在两个方向的边沿触发并带上触发后读到的电平（true 为触点闭合）。
+// 闭合与释放时触点都会弹跳；释放发生在磁铁离开时，低踏频下远在锁定时间之后，
+// 只靠锁定时间会把释放弹跳中的闭合边沿计为额外的一圈。因此只有线路在断开状态下
+// 保持 quietUs 没有任何边沿之后的闭合才算一圈；弹跳期间的边沿不满足静默条件，都被拒绝。
+// 锁定时间仍然保留，作为同一次闭合内的第二道保护
+class PulseDebouncer
+{
+public:
+    explicit PulseDebouncer(uint32_t lockoutUs = 0, uint32_t quietUs = 0) : lockoutUs(lockoutUs), quietUs(quietUs) {}
+
+    void setLockout(uint32_t us) { lockoutUs = us; }
+    uint32_t getLockout() const { return lockoutUs; }
+    void setQuiet(uint32_t us) { quietUs = us; }
+    uint32_t getQuiet() const { return quietUs; }
+
+    // 开始采集前设置线路的当前电平
+    void setLevel(bool closed) { closedLevel = closed; }
+
+    // closed 为边沿之后读到的电平。时间戳为 32 位微秒，按差值比较，允许回绕。在中断中调用，强制内联
+    __attribute__((always_inline)) bool accept(uint32_t nowUs, bool closed)
+    {
+        bool quiet = !edgeSeen || nowUs - lastEdgeUs >= quietUs;
+        bool wasClosed = closedLevel;
+        edgeSeen = true;
+        lastEdgeUs = nowUs;
+        closedLevel = closed;
+        if (!quiet)
+        {
+            rejected++;
+            return false;
+        }
+        // 静默之后的第一个边沿离开稳定电平：原来断开才是闭合（不依赖这次读到的电平，触点可能已弹开）
+        if (wasClosed)
+            return false;
+        if (started && nowUs - lastUs < lockoutUs)
+        {
+            rejected++;
+            return false;
+        }
+        started = true;
+        lastUs = nowUs;
+        return true;
+    }
+
+    void reset()
+    {
+        started = false;
+        edgeSeen = false;
+        rejected = 0;
+    }
+
+    uint32_t getRejectedCount() const { return rejected; }
+
+private:
+    uint32_t lockoutUs;
+    uint32_t quietUs;
+    uint32_t lastUs = 0;     // 最后一次接受的闭合
+    uint32_t lastEdgeUs = 0; // 最后一个边沿（任意方向）
+    bool started = false;
+    bool edgeSeen = false;
+    bool closedLevel = false;
+    uint32_t rejected = 0;
+};
+
+class PulseSource
+{
+public:
+    enum Channel : uint8_t
+    {
+        CHANNEL_WHEEL = 0,
+        CHANNEL_CRANK,
+        CHANNEL_COUNT
+    };
+
+    static const size_t RING_SIZE = 32; // 按最高转速计，足够覆盖数秒未被取出的脉冲
+
+    // 默认锁定时间：车轮 30 ms（约 33 圈/秒），曲柄 150 ms（400 rpm）；静默时间均为 5 ms
+    PulseSource();
+
+    void setLockout(Channel channel, uint32_t us) { channels[channel].debouncer.setLockout(us); }
+    void setQuiet(Channel channel, uint32_t us) { channels[channel].debouncer.setQuiet(us); }
+    void setLevel(Channel channel, bool closed) { channels[channel].debouncer.setLevel(closed); }
+
+    // 生产者侧：每个边沿（两个方向）调用一次，closed 为边沿之后的电平。
+    // 每个通道只能有一个生产者（一个中断或一个线程）。不是新的一圈或队列满时返回 false；
+    // 在 IRAM 中断中调用，强制内联
+    __attribute__((always_inline)) bool capture(Channel channel, uint32_t nowUs, bool closed)
+    {
+        ChannelState &c = channels[channel];
+        return c.debouncer.accept(nowUs, closed) && c.ring.push(nowUs);
+    }
+
+    // 消费者侧
+    bool pop(Channel channel, uint32_t &timeUs) { return channels[channel].ring.pop(timeUs); }
+
+    uint32_t getBounceCount(Channel channel) const { return channels[channel].debouncer.getRejectedCount(); }
+    uint32_t getOverflowCount(Channel channel) const { return channels[channel].ring.getOverflowCount(); }
+
+private:
+    struct ChannelState
+    {
+        PulseDebouncer debouncer;
+        SpscRing<uint32_t, RING_SIZE> ring;
+    };
+
+    ChannelState channels[CHANNEL_COUNT];
+};
+
+// 单个通道的消费端：累计转数，记录最后一圈的时刻 (64 位微秒) 与相邻两圈的间隔
+class PulseTracker
+{
+public:
+    void reset();
+
+    // 记录一个脉冲（时间须单调）
+    void addPulse(uint64_t timeUs);
+
+    // 转速 (圈/秒)：取最近一圈的间隔；距上一圈已超过该间隔时按已等待的时间衰减，
+    // 超过 stopUs 没有脉冲视为停止
+    float getRate(uint64_t nowUs, uint64_t stopUs) const;
+
+    uint32_t getRevolutions() const { return revolutions; }
+    uint64_t getLastEventUs() const { return lastUs; }
+    uint32_t getLastIntervalUs() const { return intervalUs; }
+
+    // 最后一圈的事件时间，单位为 1/unitHz 秒，按 16 位回绕（与 RevolutionAccumulator 一致）
+    uint16_t eventTime(uint32_t unitHz) const { return (uint16_t)((lastUs * unitHz / 1000000) & 0xFFFF); }
+
+    // 把中断记录的 32 位时间戳扩展到采样时刻 nowUs 所在的 64 位时间轴（相差不超过约 35 分钟）
+    static uint64_t extend(uint64_t nowUs, uint32_t timeUs)
+    {
+        int32_t ago = (int32_t)((uint32_t)nowUs - timeUs);
+        return nowUs - (int64_t)ago;
+    }
+
+private:
+    uint32_t revolutions = 0;
+    uint64_t lastUs = 0;
+    uint32_t intervalUs = 0; // 0 表示还没有两圈
+    bool started = false;
+};
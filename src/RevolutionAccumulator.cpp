@@ -0,0 +1,73 @@
+#include "RevolutionAccumulator.h"
+
+RevolutionAccumulator::RevolutionAccumulator()
+    : started(false), lastNowUs(0), totalUs(0), lastRevUs(0), fraction(0)
+{
+}
+
+void RevolutionAccumulator::reset(uint32_t nowUs, uint64_t elapsedUs)
+{
+    started = true;
+    lastNowUs = nowUs;
+    totalUs = elapsedUs;
+    lastRevUs = elapsedUs;
+    fraction = 0;
+}
+
+uint32_t RevolutionAccumulator::advance(float revPerSecond, uint32_t nowUs)
+{
+    if (!started)
+    {
+        reset(nowUs);
+        return 0;
+    }
+
+    // 无符号相减，micros() 回绕后仍然正确
+    uint32_t dtUs = nowUs - lastNowUs;
+    lastNowUs = nowUs;
+    totalUs += dtUs;
+
+    if (dtUs == 0 || !(revPerSecond > 0.0f))
+        return 0;
+
+    // 本周期转过的圈数 (Q16)
+    // 使用单精度避免 S3 上的软件双精度运算
+    uint64_t increment = (uint64_t)(revPerSecond * (float)dtUs * ((float)FRACTION_ONE / 1000000.0f));
+    if (increment == 0)
+        return 0;
+
+    uint64_t sum = (uint64_t)fraction + increment;
+    uint32_t whole = (uint32_t)(sum >> 16);
+    fraction = (uint32_t)(sum & (FRACTION_ONE - 1));
+
+    if (whole > 0)
+    {
+        // 周期内转速视为恒定，当前剩余的 fraction 对应最后一个整圈之后经过的时间
+        uint64_t sinceRevUs = (uint64_t)fraction * dtUs / increment;
+        lastRevUs = totalUs - sinceRevUs;
+    }
+    return whole;
+}
+
+uint16_t RevolutionAccumulator::eventTime(uint32_t unitHz) const
+{
+    return (uint16_t)((lastRevUs * unitHz / 1000000) & 0xFFFF);
+}
+
+void RevolutionAccumulator::saveState(trace::ByteWriter &w) const
+{
+    w.u8(started ? 1 : 0);
+    w.u32(lastNowUs);
+    w.u64(totalUs);
+    w.u64(lastRevUs);
+    w.u32(fraction);
+}
+
+void RevolutionAccumulator::loadState(trace::ByteReader &r)
+{
+    started = r.u8() != 0;
+    lastNowUs = r.u32();
+    totalUs = r.u64();
+    lastRevUs = r.u64();
+    fraction = r.u32();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include "TraceFormat.h"
+
+// 转数累加器：
+// 以 Q16 定点数跨周期累计不足一圈的转数，避免低转速时计数永远不前进；
+// 同时按线性插值计算最后一个整圈发生的精确时刻，并换算为 GATT 要求的时间单位。
+class RevolutionAccumulator
+{
+public:
+    static const uint32_t CSC_TIME_UNIT = 1024;      // CSC 事件时间单位：1/1024 秒
+    static const uint32_t CP_WHEEL_TIME_UNIT = 2048; // CP 车轮事件时间单位：1/2048 秒
+
+    RevolutionAccumulator();
+
+    // 以 revPerSecond 的转速推进到 nowUs（micros() 时间戳，允许回绕），
+    // 返回本次新增的整圈数
+    uint32_t advance(float revPerSecond, uint32_t nowUs);
+
+    // elapsedUs 为事件时间的起点，用于让 16 位事件时间尽快回绕
+    void reset(uint32_t nowUs, uint64_t elapsedUs = 0);
+
+    // 最后一个整圈的事件时间，单位为 1/unitHz 秒，按 16 位回绕
+    uint16_t eventTime(uint32_t unitHz) const;
+
+    uint64_t lastEventUs() const { return lastRevUs; }
+    uint64_t elapsedUs() const { return totalUs; }
+
+    // 追踪关键帧用的状态序列化
+    void saveState(trace::ByteWriter &w) const;
+    void loadState(trace::ByteReader &r);
+
+private:
+    static const uint32_t FRACTION_ONE = 1u << 16;
+
+    bool started;
+    uint32_t lastNowUs;
+    uint64_t totalUs;   // 自 reset 起的累计时间 (us)
+    uint64_t lastRevUs; // 最后一个整圈发生的时刻 (us)
+    uint32_t fraction;  // 不足一圈的部分 (Q16)
+};
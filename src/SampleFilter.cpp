@@ -0,0 +1,136 @@
+#include "SampleFilter.h"
+#include <math.h>
+#include <string.h>
+
+SampleFilter::SampleFilter()
+{
+    configure(Config());
+}
+
+SampleFilter::SampleFilter(const Config &config)
+{
+    configure(config);
+}
+
+void SampleFilter::configure(const Config &cfg)
+{
+    config = cfg;
+    if (config.medianSize < 1)
+        config.medianSize = 1;
+    if (config.medianSize > dsp::MAX_MEDIAN)
+        config.medianSize = dsp::MAX_MEDIAN;
+    if ((config.medianSize & 1) == 0)
+        config.medianSize++; // 偶数窗口取下一个奇数
+    if (config.smoother > SMOOTH_KALMAN)
+        config.smoother = SMOOTH_NONE;
+    if (!(config.emaAlpha > 0.0f) || config.emaAlpha > 1.0f)
+        config.emaAlpha = 1.0f;
+    if (!(config.kalmanQ > 0.0f))
+        config.kalmanQ = 1.0f;
+    if (!(config.kalmanR > 0.0f))
+        config.kalmanR = 1.0f;
+
+    long alpha = lroundf(config.emaAlpha * 32768.0f);
+    alphaQ15 = (uint16_t)(alpha < 1 ? 1 : alpha > 32768 ? 32768 : alpha);
+    reset();
+}
+
+void SampleFilter::reset()
+{
+    primed = false;
+    memset(history, 0, sizeof(history));
+    emaState = 0;
+    kalmanX = 0;
+    kalmanP = 0;
+}
+
+void SampleFilter::prime(int16_t sample)
+{
+    // 第一个样本填满中值窗口并作为平滑器初值，避免从 0 开始爬升
+    for (size_t i = 0; i < sizeof(history) / sizeof(history[0]); i++)
+        history[i] = sample;
+    emaState = (int32_t)sample * 256;
+    kalmanX = sample;
+    kalmanP = config.kalmanR;
+    primed = true;
+}
+
+void SampleFilter::process(const int16_t *in, int16_t *out, size_t n)
+{
+    if (!isEnabled())
+    {
+        if (out != in)
+            memmove(out, in, n * sizeof(int16_t));
+        return;
+    }
+    if (n == 0)
+        return;
+    if (!primed)
+        prime(in[0]);
+
+    const size_t keep = config.medianSize - 1;
+    int16_t window[dsp::MAX_MEDIAN - 1 + CHUNK];
+    int16_t filtered[CHUNK];
+    for (size_t done = 0; done < n; done += CHUNK)
+    {
+        size_t count = n - done < CHUNK ? n - done : CHUNK;
+
+        // 窗口 = 上一批末尾的原始样本 + 本批样本
+        memcpy(window, history, keep * sizeof(int16_t));
+        memcpy(window + keep, in + done, count * sizeof(int16_t));
+        memcpy(history, window + count, keep * sizeof(int16_t));
+        dsp::median(window, filtered, count, config.medianSize);
+
+        switch (config.smoother)
+        {
+        case SMOOTH_EMA:
+            emaState = dsp::ema(filtered, out + done, count, alphaQ15, emaState);
+            break;
+        case SMOOTH_KALMAN:
+            dsp::kalman(filtered, out + done, count, config.kalmanQ, config.kalmanR, &kalmanX, &kalmanP);
+            break;
+        default:
+            memcpy(out + done, filtered, count * sizeof(int16_t));
+            break;
+        }
+    }
+}
+
+int16_t SampleFilter::push(int16_t sample)
+{
+    int16_t out;
+    process(&sample, &out, 1);
+    return out;
+}
+
+void SampleFilter::saveState(trace::ByteWriter &w) const
+{
+    w.u8(config.medianSize);
+    w.u8(config.smoother);
+    w.f32(config.emaAlpha);
+    w.f32(config.kalmanQ);
+    w.f32(config.kalmanR);
+    w.u8(primed ? 1 : 0);
+    for (size_t i = 0; i + 1 < config.medianSize; i++)
+        w.u16((uint16_t)history[i]);
+    w.u32((uint32_t)emaState);
+    w.f32(kalmanX);
+    w.f32(kalmanP);
+}
+
+void SampleFilter::loadState(trace::ByteReader &r)
+{
+    Config cfg;
+    cfg.medianSize = r.u8();
+    cfg.smoother = (Smoother)r.u8();
+    cfg.emaAlpha = r.f32();
+    cfg.kalmanQ = r.f32();
+    cfg.kalmanR = r.f32();
+    configure(cfg);
+    primed = r.u8() != 0;
+    for (size_t i = 0; i + 1 < config.medianSize; i++)
+        history[i] = (int16_t)r.u16();
+    emaState = (int32_t)r.u32();
+    kalmanX = r.f32();
+    kalmanP = r.f32();
+}
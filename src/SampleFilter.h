@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "FilterKernels.h"
+#include "TraceFormat.h"
+
+// 单通道采样滤波：可选的中值（去除尖峰）后接 EMA 或一维 Kalman 平滑。
+// 默认配置不做任何处理，输出等于输入。状态可序列化进追踪关键帧，回放结果与固件一致。
+class SampleFilter
+{
+public:
+    enum Smoother : uint8_t
+    {
+        SMOOTH_NONE = 0,
+        SMOOTH_EMA,
+        SMOOTH_KALMAN
+    };
+
+    struct Config
+    {
+        uint8_t medianSize = 1;        // 1 表示不做中值，否则为 3..9 的奇数
+        Smoother smoother = SMOOTH_NONE;
+        float emaAlpha = 0.25f;        // EMA 新样本权重 (0, 1]
+        float kalmanQ = 4.0f;          // 过程噪声方差（真实值每个采样的变化）
+        float kalmanR = 100.0f;        // 测量噪声方差
+    };
+
+    SampleFilter();
+    explicit SampleFilter(const Config &config);
+
+    // 更换配置并清空状态；非法参数按最接近的合法值处理
+    void configure(const Config &config);
+    const Config &getConfig() const { return config; }
+    bool isEnabled() const { return config.medianSize > 1 || config.smoother != SMOOTH_NONE; }
+
+    // 批量处理（in 与 out 可以是同一缓冲区）
+    void process(const int16_t *in, int16_t *out, size_t n);
+    int16_t push(int16_t sample);
+
+    // 数据源中断后调用，下一个样本重新开始
+    void reset();
+
+    void saveState(trace::ByteWriter &w) const;
+    void loadState(trace::ByteReader &r);
+
+private:
+    static const size_t CHUNK = 64;
+
+    Config config;
+    uint16_t alphaQ15 = 32768;
+    bool primed = false;
+    int16_t history[dsp::MAX_MEDIAN - 1]; // 最近 medianSize - 1 个原始样本
+    int32_t emaState = 0;                 // Q8
+    float kalmanX = 0;
+    float kalmanP = 0;
+
+    void prime(int16_t sample);
+};
@@ -0,0 +1,375 @@
+#include "Scenario.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    const size_t MAX_TOKENS = 8;
+    const size_t MAX_TOKEN_LEN = 31;
+
+    struct Token
+    {
+        const char *text;
+        size_t len;
+    };
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    bool equals(const Token &t, const char *word)
+    {
+        return strlen(word) == t.len && strncmp(t.text, word, t.len) == 0;
+    }
+
+    // 拆分 [begin, end) 中的一行，# 之后忽略；超过 MAX_TOKENS 时返回 MAX_TOKENS + 1
+    size_t tokenize(const char *begin, const char *end, Token *tokens)
+    {
+        size_t count = 0;
+        const char *p = begin;
+        while (p < end && *p != '#')
+        {
+            if (isSpace(*p))
+            {
+                p++;
+                continue;
+            }
+            const char *start = p;
+            while (p < end && !isSpace(*p) && *p != '#')
+                p++;
+            if (count == MAX_TOKENS)
+                return MAX_TOKENS + 1;
+            tokens[count++] = {start, (size_t)(p - start)};
+        }
+        return count;
+    }
+
+    // 数字 + 单位后缀，例如 "30s"、"25.5kmh"、"3%"
+    bool parseNumber(const Token &t, double *value, const char **suffix)
+    {
+        if (t.len == 0 || t.len > MAX_TOKEN_LEN)
+            return false;
+        char buf[MAX_TOKEN_LEN + 1];
+        memcpy(buf, t.text, t.len);
+        buf[t.len] = '\0';
+        char *endPtr = nullptr;
+        *value = strtod(buf, &endPtr);
+        if (endPtr == buf || !(*value >= 0))
+            return false;
+        *suffix = t.text + (endPtr - buf);
+        return true;
+    }
+
+    bool suffixIs(const Token &t, const char *suffix, const char *unit)
+    {
+        size_t len = (size_t)(t.text + t.len - suffix);
+        return strlen(unit) == len && strncmp(suffix, unit, len) == 0;
+    }
+
+    bool parseDuration(const Token &t, uint32_t *us)
+    {
+        double v;
+        const char *suffix;
+        if (!parseNumber(t, &v, &suffix))
+            return false;
+        if (suffixIs(t, suffix, "ms"))
+            v *= 1e3;
+        else if (suffixIs(t, suffix, "s"))
+            v *= 1e6;
+        else if (suffixIs(t, suffix, "m"))
+            v *= 60e6;
+        else
+            return false;
+        if (v < 1 || v > 4.0e9)
+            return false;
+        *us = (uint32_t)(v + 0.5);
+        return true;
+    }
+
+    bool parseInteger(const Token &t, uint32_t max, uint32_t *out)
+    {
+        double v;
+        const char *suffix;
+        if (!parseNumber(t, &v, &suffix) || suffix != t.text + t.len || v > max || v != (double)(uint32_t)v)
+            return false;
+        *out = (uint32_t)v;
+        return true;
+    }
+}
+
+Scenario::Scenario()
+{
+    clear();
+    begin(0);
+}
+
+void Scenario::clear()
+{
+    segmentCount = 0;
+    durationUs = 0;
+    start = Start();
+    seed = 1;
+    noise = 0;
+    looping = false;
+}
+
+bool Scenario::parse(const char *script, ParseError *error)
+{
+    clear();
+    if (error)
+        *error = {0, nullptr};
+
+    size_t repeatStart[MAX_REPEAT_DEPTH];
+    uint32_t repeatCount[MAX_REPEAT_DEPTH];
+    uint8_t depth = 0;
+    Values last = {0, 0, 0}; // 省略的数值沿用上一段的目标值
+
+    const char *message = nullptr;
+    uint16_t line = 0;
+    const char *p = script ? script : "";
+    while (*p && !message)
+    {
+        line++;
+        const char *lineEnd = strchr(p, '\n');
+        if (!lineEnd)
+            lineEnd = p + strlen(p);
+
+        Token tokens[MAX_TOKENS];
+        size_t count = tokenize(p, lineEnd, tokens);
+        p = *lineEnd ? lineEnd + 1 : lineEnd;
+        if (count == 0)
+            continue;
+        if (count > MAX_TOKENS)
+        {
+            message = "参数过多";
+            break;
+        }
+
+        const Token &cmd = tokens[0];
+        uint32_t value;
+        if (equals(cmd, "seed"))
+        {
+            if (count != 2 || !parseInteger(tokens[1], UINT32_MAX, &seed))
+                message = "seed 需要一个整数";
+        }
+        else if (equals(cmd, "noise"))
+        {
+            double v;
+            const char *suffix;
+            if (count != 2 || !parseNumber(tokens[1], &v, &suffix) || !suffixIs(tokens[1], suffix, "%") || v > 100)
+                message = "noise 需要 0-100%";
+            else
+                noise = (float)(v / 100.0);
+        }
+        else if (equals(cmd, "wheel"))
+        {
+            if (count != 2 || !parseInteger(tokens[1], UINT32_MAX, &start.wheelRev))
+                message = "wheel 需要 32 位整数";
+        }
+        else if (equals(cmd, "crank"))
+        {
+            if (count != 2 || !parseInteger(tokens[1], UINT16_MAX, &value))
+                message = "crank 需要 16 位整数";
+            else
+                start.crankRev = (uint16_t)value;
+        }
+        else if (equals(cmd, "clock"))
+        {
+            uint32_t us;
+            if (count != 2 || !parseDuration(tokens[1], &us))
+                message = "clock 需要时长";
+            else
+                start.clockUs = us;
+        }
+        else if (equals(cmd, "loop"))
+        {
+            looping = true;
+        }
+        else if (equals(cmd, "repeat"))
+        {
+            if (count != 2 || !parseInteger(tokens[1], 1000, &value) || value == 0)
+                message = "repeat 需要 1-1000";
+            else if (depth == MAX_REPEAT_DEPTH)
+                message = "repeat 嵌套过深";
+            else
+            {
+                repeatStart[depth] = segmentCount;
+                repeatCount[depth] = value;
+                depth++;
+            }
+        }
+        else if (equals(cmd, "end"))
+        {
+            if (depth == 0)
+            {
+                message = "end 没有对应的 repeat";
+                break;
+            }
+            depth--;
+            size_t body = segmentCount - repeatStart[depth];
+            for (uint32_t r = 1; r < repeatCount[depth] && !message; r++)
+            {
+                if (segmentCount + body > MAX_SEGMENTS)
+                    message = "分段过多";
+                else
+                {
+                    memcpy(&segments[segmentCount], &segments[repeatStart[depth]], body * sizeof(Segment));
+                    segmentCount += body;
+                }
+            }
+        }
+        else
+        {
+            Segment segment;
+            if (equals(cmd, "hold"))
+                segment.type = SEGMENT_HOLD;
+            else if (equals(cmd, "ramp"))
+                segment.type = SEGMENT_RAMP;
+            else if (equals(cmd, "coast"))
+                segment.type = SEGMENT_COAST;
+            else if (equals(cmd, "stop"))
+                segment.type = SEGMENT_STOP;
+            else
+            {
+                message = "未知指令";
+                break;
+            }
+            if (count < 2 || !parseDuration(tokens[1], &segment.durationUs))
+            {
+                message = "分段需要时长 (ms/s/m)";
+                break;
+            }
+
+            Values to = segment.type == SEGMENT_HOLD || segment.type == SEGMENT_RAMP ? last : Values{0, 0, 0};
+            for (size_t i = 2; i < count && !message; i++)
+            {
+                double v;
+                const char *suffix;
+                if (!parseNumber(tokens[i], &v, &suffix))
+                    message = "数值格式错误";
+                else if (suffixIs(tokens[i], suffix, "kmh") && segment.type != SEGMENT_STOP)
+                    to.speed = (float)v;
+                else if (suffixIs(tokens[i], suffix, "rpm") && segment.type <= SEGMENT_RAMP)
+                    to.cadence = (float)v;
+                else if ((suffixIs(tokens[i], suffix, "w") || suffixIs(tokens[i], suffix, "W")) &&
+                         segment.type <= SEGMENT_RAMP)
+                    to.power = (float)v;
+                else
+                    message = "该分段不支持此数值";
+            }
+            if (message)
+                break;
+            if (segmentCount == MAX_SEGMENTS)
+            {
+                message = "分段过多";
+                break;
+            }
+            segment.to = to;
+            if (segment.type <= SEGMENT_RAMP)
+                last = to;
+            segments[segmentCount++] = segment;
+        }
+    }
+    if (!message && depth != 0)
+        message = "repeat 缺少 end";
+    if (!message && segmentCount == 0)
+        message = "没有分段";
+
+    if (message)
+    {
+        if (error)
+            *error = {line, message};
+        clear();
+        begin(0);
+        return false;
+    }
+
+    // 展开后按顺序确定每段的起始值
+    Values previous = {0, 0, 0};
+    for (size_t i = 0; i < segmentCount; i++)
+    {
+        Segment &s = segments[i];
+        switch (s.type)
+        {
+        case SEGMENT_HOLD:
+            s.from = s.to;
+            break;
+        case SEGMENT_RAMP:
+            s.from = previous;
+            break;
+        case SEGMENT_COAST:
+            s.from = {previous.speed, 0, 0};
+            break;
+        default:
+            s.from = s.to;
+            break;
+        }
+        previous = s.to;
+        durationUs += s.durationUs;
+    }
+    begin(0);
+    return true;
+}
+
+void Scenario::begin(uint64_t nowUs)
+{
+    prng.setSeed(seed);
+    beginUs = nowUs;
+    segmentStartUs = 0;
+    current = 0;
+}
+
+bool Scenario::isFinished(uint64_t nowUs) const
+{
+    return !looping && nowUs - beginUs >= durationUs;
+}
+
+Scenario::Values Scenario::evaluate(const Segment &segment, uint64_t offsetUs) const
+{
+    if (segment.type == SEGMENT_HOLD || segment.type == SEGMENT_STOP)
+        return segment.to;
+    float f = (float)offsetUs / (float)segment.durationUs;
+    Values v;
+    v.speed = segment.from.speed + (segment.to.speed - segment.from.speed) * f;
+    v.cadence = segment.from.cadence + (segment.to.cadence - segment.from.cadence) * f;
+    v.power = segment.from.power + (segment.to.power - segment.from.power) * f;
+    return v;
+}
+
+Scenario::Values Scenario::sample(uint64_t nowUs)
+{
+    Values v = {0, 0, 0};
+    if (durationUs == 0 || nowUs < beginUs)
+        return v;
+
+    uint64_t elapsed = nowUs - beginUs;
+    if (looping)
+    {
+        elapsed %= durationUs;
+        if (elapsed < segmentStartUs)
+        {
+            current = 0; // 新一轮
+            segmentStartUs = 0;
+        }
+    }
+    // 时间单调前进，只需从当前分段向后查找
+    while (current < segmentCount && elapsed >= segmentStartUs + segments[current].durationUs)
+    {
+        segmentStartUs += segments[current].durationUs;
+        current++;
+    }
+    if (current >= segmentCount)
+        return v; // 脚本结束
+
+    v = evaluate(segments[current], elapsed - segmentStartUs);
+    if (noise > 0)
+    {
+        // 每次采样固定取两个随机数，序列只与采样次数有关
+        float powerNoise = prng.nextSigned();
+        float cadenceNoise = prng.nextSigned();
+        v.power *= 1.0f + noise * powerNoise;
+        v.cadence *= 1.0f + noise * cadenceNoise;
+    }
+    return v;
+}
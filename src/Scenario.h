@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Prng.h"
+
+// 脚本化骑行场景（与平台无关）：按时间给出速度、踏频与功率，作为 BikeData 的数据来源。
+// 同一脚本与种子在任何平台、任何采样频率下给出相同的分段与噪声序列，用于压力与回归测试。
+//
+// 脚本每行一条，# 之后为注释：
+//   seed 42            噪声随机数种子
+//   noise 3%           功率与踏频的相对噪声（均匀分布）
+//   wheel 4294967000   车轮累计圈数初值（测试 32 位回绕）
+//   crank 65500        曲柄累计圈数初值（测试 16 位回绕）
+//   clock 63s          事件时间初值（1/1024 s 的 16 位事件时间每 64 秒回绕一次）
+//   loop               脚本结束后从头循环，否则结束后保持停止
+//   hold 30s 25kmh 90rpm 200w   保持；省略的数值沿用上一段
+//   ramp 10s 40kmh 110rpm 400w  从上一段的结束值线性过渡
+//   coast 10s [0kmh]   滑行：不踩踏板、无功率，速度线性降到给定值（默认 0）
+//   stop 5s            完全停止
+//   repeat 4 ... end   重复其中的分段（可嵌套 4 层）
+// 时长单位 ms/s/m，数值单位 kmh/rpm/w。
+class Scenario
+{
+public:
+    static const size_t MAX_SEGMENTS = 64;
+    static const uint8_t MAX_REPEAT_DEPTH = 4;
+
+    enum SegmentType : uint8_t
+    {
+        SEGMENT_HOLD = 0,
+        SEGMENT_RAMP,
+        SEGMENT_COAST,
+        SEGMENT_STOP
+    };
+
+    struct Values
+    {
+        float speed;   // km/h
+        float cadence; // rpm
+        float power;   // W
+    };
+
+    struct Segment
+    {
+        SegmentType type;
+        uint32_t durationUs;
+        Values from; // 起始值（由上一段的结束值确定）
+        Values to;
+    };
+
+    struct Start
+    {
+        uint32_t wheelRev = 1;
+        uint16_t crankRev = 1;
+        uint64_t clockUs = 0;
+    };
+
+    struct ParseError
+    {
+        uint16_t line;       // 从 1 开始
+        const char *message; // 静态字符串
+    };
+
+    Scenario();
+
+    // 解析失败时保持空场景并在 error 中给出行号与原因
+    bool parse(const char *script, ParseError *error = nullptr);
+
+    // 从 nowUs 开始运行，随机数按种子重新开始
+    void begin(uint64_t nowUs);
+    // nowUs 时刻的取值（含噪声）；时间需单调不减
+    Values sample(uint64_t nowUs);
+    bool isFinished(uint64_t nowUs) const;
+
+    size_t getSegmentCount() const { return segmentCount; }
+    const Segment &getSegment(size_t i) const { return segments[i]; }
+    uint64_t getDurationUs() const { return durationUs; }
+    const Start &getStart() const { return start; }
+    uint32_t getSeed() const { return seed; }
+    bool isLooping() const { return looping; }
+
+private:
+    Segment segments[MAX_SEGMENTS];
+    size_t segmentCount;
+    uint64_t durationUs;
+    Start start;
+    uint32_t seed;
+    float noise; // 相对噪声幅度
+    bool looping;
+
+    // 运行状态
+    Prng prng;
+    uint64_t beginUs;
+    uint64_t segmentStartUs; // 当前分段在本轮中的起始偏移
+    size_t current;
+
+    void clear();
+    Values evaluate(const Segment &segment, uint64_t offsetUs) const;
+};
@@ -0,0 +1,79 @@
+#include "SensorInput.h"
+#include <esp_timer.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
+#include "Log.h"
+
+bool SensorInput::begin(PulseSource *source, const Config &cfg)
+{
+    end();
+    if (!source || (cfg.wheelPin < 0 && cfg.crankPin < 0))
+    {
+        LOG_ERROR("[ERROR] SensorInput: 未配置传感器引脚");
+        return false;
+    }
+    pulses = source;
+    config = cfg;
+    pulses->setLockout(PulseSource::CHANNEL_WHEEL, config.wheelLockoutUs);
+    pulses->setLockout(PulseSource::CHANNEL_CRANK, config.crankLockoutUs);
+    pulses->setQuiet(PulseSource::CHANNEL_WHEEL, config.quietUs);
+    pulses->setQuiet(PulseSource::CHANNEL_CRANK, config.quietUs);
+
+    // 先设置上拉并记录当前电平，再挂接中断
+    if (config.wheelPin >= 0)
+    {
+        pinMode(config.wheelPin, INPUT_PULLUP);
+        pulses->setLevel(PulseSource::CHANNEL_WHEEL, isClosed(config.wheelPin));
+        attachInterruptArg(digitalPinToInterrupt(config.wheelPin), onWheel, this, CHANGE);
+    }
+    if (config.crankPin >= 0)
+    {
+        pinMode(config.crankPin, INPUT_PULLUP);
+        pulses->setLevel(PulseSource::CHANNEL_CRANK, isClosed(config.crankPin));
+        attachInterruptArg(digitalPinToInterrupt(config.crankPin), onCrank, this, CHANGE);
+    }
+    LOG_INFO("[SENSOR] 车轮 GPIO%d, 曲柄 GPIO%d", (int)config.wheelPin, (int)config.crankPin);
+    return true;
+}
+
+void SensorInput::end()
+{
+    if (!pulses)
+        return;
+    if (config.wheelPin >= 0)
+        detachInterrupt(digitalPinToInterrupt(config.wheelPin));
+    if (config.crankPin >= 0)
+        detachInterrupt(digitalPinToInterrupt(config.crankPin));
+    pulses = nullptr;
+}
+
+// 直接读输入寄存器：内联函数，在 IRAM 中断中可用；低电平为触点闭合
+bool IRAM_ATTR SensorInput::isClosed(int8_t pin)
+{
+    return gpio_ll_get_level(&GPIO, (gpio_num_t)pin) == 0;
+}
+
+// 每个通道只有这一个生产者；时间戳取 64 位 esp_timer 的低 32 位，由消费端扩展
+void IRAM_ATTR SensorInput::onWheel(void *arg)
+{
+    SensorInput *self = static_cast<SensorInput *>(arg);
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    self->pulses->capture(PulseSource::CHANNEL_WHEEL, nowUs, isClosed(self->config.wheelPin));
+}
+
+void IRAM_ATTR SensorInput::onCrank(void *arg)
+{
+    SensorInput *self = static_cast<SensorInput *>(arg);
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    self->pulses->capture(PulseSource::CHANNEL_CRANK, nowUs, isClosed(self->config.crankPin));
+}
+
+void SensorInput::report() const
+{
+    if (!pulses)
+        return;
+    LOG_INFO("[SENSOR] wheel bounce=%u overflow=%u", (unsigned)pulses->getBounceCount(PulseSource::CHANNEL_WHEEL),
+             (unsigned)pulses->getOverflowCount(PulseSource::CHANNEL_WHEEL));
+    LOG_INFO("[SENSOR] crank bounce=%u overflow=%u", (unsigned)pulses->getBounceCount(PulseSource::CHANNEL_CRANK),
+             (unsigned)pulses->getOverflowCount(PulseSource::CHANNEL_CRANK));
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include "PulseInput.h"
+
+// 有线干簧管输入：传感器一端接 GPIO、一端接地，使用内部上拉，磁铁经过时触点闭合（低电平）。
+// 两个方向的边沿都触发中断，中断中读取 esp_timer 微秒时间戳与引脚电平，
+// 由 PulseDebouncer 滤除闭合与释放两处的触点弹跳后放入 PulseSource 的无锁队列，
+// 中断内不做其他处理；转数、事件时间与转速由采样任务中的 BikeData 计算。
+class SensorInput
+{
+public:
+    struct Config
+    {
+        int8_t wheelPin = -1;             // -1 表示不接
+        int8_t crankPin = -1;
+        uint32_t wheelLockoutUs = 30000;  // 去抖锁定时间：车轮最高约 33 圈/秒
+        uint32_t crankLockoutUs = 150000; // 曲柄最高 400 rpm
+        uint32_t quietUs = 5000;          // 闭合前线路须保持断开且没有边沿的时间，长于触点弹跳
+    };
+
+    bool begin(PulseSource *pulses, const Config &config);
+    void end();
+
+    // 输出两个通道的弹跳与溢出计数（串口命令 'S'）
+    void report() const;
+
+private:
+    PulseSource *pulses = nullptr;
+    Config config;
+
+    static bool IRAM_ATTR isClosed(int8_t pin);
+    static void IRAM_ATTR onWheel(void *arg);
+    static void IRAM_ATTR onCrank(void *arg);
+};
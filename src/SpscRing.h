@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// 单生产者/单消费者无锁环形队列：push 与 pop 均为无等待 (wait-free)，
+// 不使用临界区，两端可以运行在不同核心上。
+// 容量必须为 2 的幂；head 只由生产者写，tail 只由消费者写。
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量必须为 2 的幂");
+
+public:
+    static const size_t CAPACITY = Capacity;
+
+    SpscRing() : head(0), overflows(0), highWater(0), tail(0) {}
+
+    // 生产者侧：队列已满时返回 false 并计入溢出。
+    // 强制内联：也在 IRAM 中断里调用，flash 操作期间不能跳转到 flash 中的函数
+    __attribute__((always_inline)) bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= Capacity)
+        {
+            overflows.store(overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+
+        uint32_t depth = h + 1 - t;
+        if (depth > highWater.load(std::memory_order_relaxed))
+            highWater.store(depth, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 消费者侧：队列为空时返回 false
+    bool pop(T &out)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (h == t)
+            return false;
+        out = slots[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅在两端都停止时调用
+    void reset()
+    {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        overflows.store(0, std::memory_order_relaxed);
+        highWater.store(0, std::memory_order_relaxed);
+    }
+
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t getOverflowCount() const { return overflows.load(std::memory_order_relaxed); }
+    uint32_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+
+private:
+    T slots[Capacity];
+    // 生产者与消费者各自写入的字段分开放置，避免同一缓存行在两个核心间来回失效
+    alignas(32) std::atomic<uint32_t> head;
+    std::atomic<uint32_t> overflows;
+    std::atomic<uint32_t> highWater;
+    alignas(32) std::atomic<uint32_t> tail;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+// 编译期定长的对象池：存储在静态区，create() 原位构造，clear() 逆序析构后整体复用。
+// 用于 BLE 初始化期间创建的长生命周期对象，重复初始化时不再向堆申请新内存。
+template <typename T, size_t Capacity>
+class StaticPool
+{
+public:
+    static const size_t CAPACITY = Capacity;
+
+    StaticPool() : count(0), failures(0) {}
+    ~StaticPool() { clear(); }
+
+    StaticPool(const StaticPool &) = delete;
+    StaticPool &operator=(const StaticPool &) = delete;
+
+    // 池满时返回 nullptr 并计入失败次数
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        if (count >= Capacity)
+        {
+            failures++;
+            return nullptr;
+        }
+        T *obj = new (&slots[count]) T(std::forward<Args>(args)...);
+        count++;
+        return obj;
+    }
+
+    void clear()
+    {
+        while (count > 0)
+        {
+            count--;
+            reinterpret_cast<T *>(&slots[count])->~T();
+        }
+    }
+
+    size_t size() const { return count; }
+    T *at(size_t index) { return index < count ? reinterpret_cast<T *>(&slots[index]) : nullptr; }
+    uint32_t getFailureCount() const { return failures; }
+    static constexpr size_t bytes() { return sizeof(Slot) * Capacity; }
+
+private:
+    struct Slot
+    {
+        alignas(T) uint8_t data[sizeof(T)];
+    };
+
+    Slot slots[Capacity];
+    size_t count;
+    uint32_t failures;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include "GattBackend.h"
+
+// 服务层的结构化错误：初始化失败时返回错误码与出错的属性，不抛异常、不打印，
+// 由调用方决定如何报告（固件以 -fno-exceptions 构建）
+enum StatusCode : uint8_t
+{
+    STATUS_OK = 0,
+    STATUS_INVALID_ARGUMENT,      // 空指针等无效参数
+    STATUS_SERVICE_FAILED,        // 后端创建服务失败
+    STATUS_CHARACTERISTIC_FAILED, // 后端创建特征值失败（含静态池耗尽）
+    STATUS_START_FAILED,          // 启动服务失败
+    STATUS_POOL_EXHAUSTED,        // 服务对象池已满
+    STATUS_STACK_FAILED,          // BLE 协议栈或服务器初始化失败
+    STATUS_ADVERTISING_FAILED     // 获取或启动广播失败
+};
+
+struct Status
+{
+    StatusCode code;
+    uint16_t uuid; // 出错的服务或特征值的 16 位 UUID，128 位或无关时为 0
+
+    constexpr Status() : code(STATUS_OK), uuid(0) {}
+    constexpr Status(StatusCode code, uint16_t uuid) : code(code), uuid(uuid) {}
+
+    constexpr bool ok() const { return code == STATUS_OK; }
+
+    static constexpr Status success() { return Status(); }
+    static constexpr Status error(StatusCode code) { return Status(code, 0); }
+    static constexpr Status error(StatusCode code, const gatt::Uuid &uuid)
+    {
+        return Status(code, uuid.is16() ? uuid.value16 : 0);
+    }
+
+    const char *name() const
+    {
+        switch (code)
+        {
+        case STATUS_OK:
+            return "OK";
+        case STATUS_INVALID_ARGUMENT:
+            return "INVALID_ARGUMENT";
+        case STATUS_SERVICE_FAILED:
+            return "SERVICE_FAILED";
+        case STATUS_CHARACTERISTIC_FAILED:
+            return "CHARACTERISTIC_FAILED";
+        case STATUS_START_FAILED:
+            return "START_FAILED";
+        case STATUS_POOL_EXHAUSTED:
+            return "POOL_EXHAUSTED";
+        case STATUS_STACK_FAILED:
+            return "STACK_FAILED";
+        case STATUS_ADVERTISING_FAILED:
+            return "ADVERTISING_FAILED";
+        }
+        return "UNKNOWN";
+    }
+};
@@ -0,0 +1,70 @@
+#include "StatusLed.h"
+#include "Log.h"
+
+StatusLed::StatusLed() : pixels(1, DEFAULT_PIN, NEO_GRB + NEO_KHZ800)
+{
+}
+
+bool StatusLed::begin(const Config &cfg)
+{
+    end();
+    config = cfg;
+    pattern = LedPattern(config.pattern);
+    periodMs.store(config.periodMs, std::memory_order_relaxed);
+
+    // Adafruit_NeoPixel 在 ESP32 上通过 RMT 外设发送，一次写 1 颗灯约 30us
+    pixels.setPin(config.pin);
+    pixels.begin();
+    pixels.clear();
+    pixels.show();
+    shown = {0, 0, 0};
+
+    if (xTaskCreatePinnedToCore(taskEntry, "led", config.taskStackSize, this,
+                                config.taskPriority, &task, config.taskCore) != pdPASS)
+    {
+        task = nullptr;
+        LOG_ERROR("[ERROR] StatusLed: 创建 LED 任务失败");
+        return false;
+    }
+    return true;
+}
+
+void StatusLed::end()
+{
+    if (task)
+    {
+        vTaskDelete(task);
+        task = nullptr;
+    }
+}
+
+LedPattern::State StatusLed::getState() const
+{
+    return LedPattern::stateFor(connected.load(std::memory_order_relaxed),
+                                ingesting.load(std::memory_order_relaxed),
+                                error.load(std::memory_order_relaxed));
+}
+
+void StatusLed::taskEntry(void *arg)
+{
+    static_cast<StatusLed *>(arg)->run();
+}
+
+void StatusLed::run()
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        TickType_t period = pdMS_TO_TICKS(periodMs.load(std::memory_order_relaxed));
+        vTaskDelayUntil(&lastWake, period > 0 ? period : 1);
+
+        // 颜色不变时（闪烁的熄灭段、呼吸的平台段）不写 RMT
+        LedPattern::Color color = pattern.render(getState(), millis());
+        if (color == shown)
+            continue;
+        pixels.setPixelColor(0, color.r, color.g, color.b);
+        pixels.show();
+        shown = color;
+        showCount = showCount + 1;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "LedPattern.h"
+
+// 板载 WS2812 状态灯：最低应用优先级的任务按固定周期查表计算颜色，
+// 颜色变化时才通过 RMT 写出。BLE 回调与主循环只写原子标志，从不等待 LED。
+class StatusLed
+{
+public:
+    static const uint8_t DEFAULT_PIN = 48; // ESP32-S3-DevKitC-1 板载 WS2812
+
+    struct Config
+    {
+        uint8_t pin = DEFAULT_PIN;
+        uint32_t periodMs = 20; // 刷新周期，呼吸渐变约 50 帧/秒
+        LedPattern::Config pattern;
+        UBaseType_t taskPriority = 1; // 低于采样 (6) 与通知 (5) 任务
+        uint32_t taskStackSize = 2048;
+        BaseType_t taskCore = 1; // 不与 BLE 主机争用核心 0
+    };
+
+    StatusLed();
+
+    bool begin(const Config &config);
+    void end();
+
+    // 可在任意任务或回调中调用
+    void setConnected(bool connected) { this->connected.store(connected, std::memory_order_relaxed); }
+    void setIngesting(bool ingesting) { this->ingesting.store(ingesting, std::memory_order_relaxed); }
+    void setError(bool error) { this->error.store(error, std::memory_order_relaxed); }
+    // 调整刷新周期（空闲时降低唤醒次数），下一帧生效
+    void setPeriod(uint32_t periodMs) { this->periodMs.store(periodMs, std::memory_order_relaxed); }
+
+    LedPattern::State getState() const;
+    uint32_t getShowCount() const { return showCount; }
+
+private:
+    Config config;
+    LedPattern pattern;
+    Adafruit_NeoPixel pixels;
+    TaskHandle_t task = nullptr;
+
+    std::atomic<bool> connected{false};
+    std::atomic<bool> ingesting{false};
+    std::atomic<bool> error{false};
+    std::atomic<uint32_t> periodMs{20};
+
+    // 仅 LED 任务访问
+    LedPattern::Color shown = {0, 0, 0};
+    volatile uint32_t showCount = 0;
+
+    static void taskEntry(void *arg);
+    void run();
+};
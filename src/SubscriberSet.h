@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 单个特征值的订阅表（与平台无关）：按连接记录 CCCD 的通知/指示位。
+// 订阅者紧凑存放在定长数组中，遍历只访问已订阅的连接，与已连接但未订阅的中心设备数量无关。
+template <size_t Capacity>
+class SubscriberSet
+{
+public:
+    static const size_t CAPACITY = Capacity;
+
+    // CCCD 的取值（规范定义）
+    static const uint16_t CCCD_NOTIFY = 0x0001;
+    static const uint16_t CCCD_INDICATE = 0x0002;
+
+    struct Entry
+    {
+        uint16_t connHandle;
+        uint16_t cccd;
+    };
+
+    // 写入 CCCD：0 表示取消订阅。返回 true 表示该连接由未订阅变为订阅；表满时忽略并返回 false
+    bool update(uint16_t connHandle, uint16_t cccd)
+    {
+        size_t i = find(connHandle);
+        if (i < count)
+        {
+            if (cccd)
+                entries[i].cccd = cccd;
+            else
+                entries[i] = entries[--count];
+            return false;
+        }
+        if (!cccd || count == Capacity)
+            return false;
+        entries[count++] = {connHandle, cccd};
+        return true;
+    }
+
+    void remove(uint16_t connHandle) { update(connHandle, 0); }
+    void clear() { count = 0; }
+
+    bool contains(uint16_t connHandle, uint16_t mask = CCCD_NOTIFY | CCCD_INDICATE) const
+    {
+        size_t i = find(connHandle);
+        return i < count && (entries[i].cccd & mask);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Entry &operator[](size_t i) const { return entries[i]; }
+
+private:
+    Entry entries[Capacity];
+    size_t count = 0;
+
+    size_t find(uint16_t connHandle) const
+    {
+        size_t i = 0;
+        while (i < count && entries[i].connHandle != connHandle)
+            i++;
+        return i;
+    }
+};
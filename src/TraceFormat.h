@@ -0,0 +1,168 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ------------ 二进制追踪格式 ------------
+// 追踪缓冲区由固定大小的块组成，环形覆盖时整块丢弃。
+// 每块以块头（含格式版本）+ 关键帧开始，之后是增量编码的记录：
+//   关键帧  : 绝对时间、tick 序号、BikeData 完整状态
+//   TICK    : 与上一 tick 的时间差 (varint)、本 tick 写入的广播、随机数
+//   PAYLOAD : 通道、对应 tick 的回溯量、与上一包按字节异或的变化掩码和变化字节
+namespace trace
+{
+    const uint16_t BLOCK_MAGIC = 0x4254; // "TB"
+    const size_t BLOCK_SIZE = 1024;
+    const size_t BLOCK_HEADER_SIZE = 7;  // magic(2) + seq(4) + version(1)
+
+    // 格式版本：关键帧布局（BikeData::saveState 及其成员的状态）每次变化都要加一，
+    // 回放工具拒绝未知版本，而不是按错误的布局解析。
+    // 1: 初版  2: 增加累计能量  3: 增加滤波器配置与状态
+    // 没有版本字节的旧追踪在该位置是 REC_KEYFRAME (0x01)，同样作为未知版本被拒绝
+    const uint8_t FORMAT_VERSION = 3;
+
+    enum RecordType : uint8_t
+    {
+        REC_END = 0x00, // 块内剩余为填充
+        REC_KEYFRAME = 0x01,
+        REC_TICK = 0x02,
+        REC_PAYLOAD = 0x03
+    };
+
+    enum Channel : uint8_t
+    {
+        CH_CSC = 0,
+        CH_CP,
+        CH_FTMS,
+        CH_COUNT
+    };
+
+    const size_t MAX_PAYLOAD = 32;
+    const uint8_t MAX_TICK_KEISER = 4;
+    const uint8_t MAX_TICK_RANDOM = 8;
+
+    class ByteWriter
+    {
+    public:
+        ByteWriter(uint8_t *buf, size_t cap) : buf(buf), cap(cap), pos(0), overflow(false) {}
+
+        void u8(uint8_t v)
+        {
+            if (pos < cap)
+                buf[pos++] = v;
+            else
+                overflow = true;
+        }
+        void u16(uint16_t v)
+        {
+            u8((uint8_t)v);
+            u8((uint8_t)(v >> 8));
+        }
+        void u32(uint32_t v)
+        {
+            u16((uint16_t)v);
+            u16((uint16_t)(v >> 16));
+        }
+        void u64(uint64_t v)
+        {
+            u32((uint32_t)v);
+            u32((uint32_t)(v >> 32));
+        }
+        void f32(float v)
+        {
+            uint32_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            u32(bits);
+        }
+        void varint(uint64_t v)
+        {
+            while (v >= 0x80)
+            {
+                u8((uint8_t)(v | 0x80));
+                v >>= 7;
+            }
+            u8((uint8_t)v);
+        }
+        void svarint(int64_t v)
+        {
+            varint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); // zigzag
+        }
+        void bytes(const uint8_t *p, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                u8(p[i]);
+        }
+
+        size_t size() const { return pos; }
+        bool ok() const { return !overflow; }
+
+    private:
+        uint8_t *buf;
+        size_t cap;
+        size_t pos;
+        bool overflow;
+    };
+
+    class ByteReader
+    {
+    public:
+        ByteReader(const uint8_t *buf, size_t len) : buf(buf), len(len), pos(0), underflow(false) {}
+
+        uint8_t u8()
+        {
+            if (pos < len)
+                return buf[pos++];
+            underflow = true;
+            return 0;
+        }
+        uint16_t u16()
+        {
+            uint16_t lo = u8();
+            return (uint16_t)(lo | (u8() << 8));
+        }
+        uint32_t u32()
+        {
+            uint32_t lo = u16();
+            return lo | ((uint32_t)u16() << 16);
+        }
+        uint64_t u64()
+        {
+            uint64_t lo = u32();
+            return lo | ((uint64_t)u32() << 32);
+        }
+        float f32()
+        {
+            uint32_t bits = u32();
+            float v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+        uint64_t varint()
+        {
+            uint64_t v = 0;
+            for (uint8_t shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = u8();
+                v |= (uint64_t)(b & 0x7F) << shift;
+                if (!(b & 0x80) || underflow)
+                    break;
+            }
+            return v;
+        }
+        int64_t svarint()
+        {
+            uint64_t v = varint();
+            return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+        }
+
+        size_t position() const { return pos; }
+        size_t remaining() const { return pos < len ? len - pos : 0; }
+        bool ok() const { return !underflow; }
+
+    private:
+        const uint8_t *buf;
+        size_t len;
+        size_t pos;
+        bool underflow;
+    };
+}
@@ -0,0 +1,245 @@
+#include "TraceRecorder.h"
+#include <Arduino.h>
+
+using namespace trace;
+
+TraceRecorder::TraceRecorder()
+    : storage(nullptr), blockCount(0), enabled(false), head(0), used(0),
+      blockSeq(0), tickSeq(0), lastTickUs(0), dropped(0), records(0), forceBlock(false),
+      tickUs(0), tickKeiserCount(0), tickRandomCount(0)
+{
+    memset(lastPayloadLen, 0, sizeof(lastPayloadLen));
+}
+
+void TraceRecorder::lock()
+{
+#ifdef ARDUINO
+    portENTER_CRITICAL(&mux);
+#endif
+}
+
+void TraceRecorder::unlock()
+{
+#ifdef ARDUINO
+    portEXIT_CRITICAL(&mux);
+#endif
+}
+
+bool TraceRecorder::begin(uint8_t *buffer, size_t size)
+{
+    if (!buffer || size < BLOCK_SIZE)
+        return false;
+
+    storage = buffer;
+    blockCount = size / BLOCK_SIZE;
+    head = 0;
+    used = 0;
+    blockSeq = 0;
+    tickSeq = 0;
+    dropped = 0;
+    records = 0;
+    forceBlock = false;
+    memset(storage, 0, blockCount * BLOCK_SIZE);
+    enabled = true;
+    return true;
+}
+
+void TraceRecorder::setEnabled(bool enable)
+{
+    lock();
+    // 暂停期间的 tick 没有记录，恢复后从新的关键帧开始
+    if (enable && !enabled)
+        forceBlock = true;
+    enabled = enable;
+    unlock();
+}
+
+void TraceRecorder::startBlock(const BikeData &bikeData, uint64_t nowUs)
+{
+    // 调用方需持有锁
+    if (blockSeq > 0)
+        head = (head + 1) % blockCount;
+    uint8_t *block = &storage[head * BLOCK_SIZE];
+    memset(block, 0, BLOCK_SIZE);
+
+    ByteWriter w(block, BLOCK_SIZE);
+    w.u16(BLOCK_MAGIC);
+    w.u32(blockSeq++);
+    w.u8(FORMAT_VERSION);
+
+    // 关键帧：解码可以从任意块开始
+    w.u8(REC_KEYFRAME);
+    w.u64(nowUs);
+    w.u32(tickSeq);
+    bikeData.saveState(w);
+
+    used = w.size();
+    lastTickUs = nowUs;
+    memset(lastPayloadLen, 0, sizeof(lastPayloadLen));
+}
+
+bool TraceRecorder::append(const uint8_t *record, size_t len, size_t reserve)
+{
+    // 调用方需持有锁
+    if (used + len + reserve > BLOCK_SIZE)
+    {
+        dropped++;
+        return false;
+    }
+    memcpy(&storage[head * BLOCK_SIZE + used], record, len);
+    used += len;
+    records++;
+    return true;
+}
+
+void TraceRecorder::beginTick(const BikeData &bikeData, uint64_t nowUs)
+{
+    if (!isEnabled())
+        return;
+
+    tickUs = nowUs;
+    tickKeiserCount = 0;
+    tickRandomCount = 0;
+
+    // 只在生产者侧开新块，保证关键帧中的状态与 tick 边界一致
+    lock();
+    if (blockSeq == 0 || forceBlock || used + TICK_RESERVE > BLOCK_SIZE)
+    {
+        startBlock(bikeData, nowUs);
+        forceBlock = false;
+    }
+    unlock();
+}
+
+void TraceRecorder::noteKeiser(const KeiserSample &sample)
+{
+    if (!isEnabled())
+        return;
+    if (tickKeiserCount < MAX_TICK_KEISER)
+        tickKeiser[tickKeiserCount++] = sample;
+}
+
+void TraceRecorder::noteRandom(long value)
+{
+    if (!isEnabled())
+        return;
+    if (tickRandomCount < MAX_TICK_RANDOM)
+        tickRandom[tickRandomCount++] = value;
+}
+
+void TraceRecorder::endTick()
+{
+    if (!isEnabled())
+        return;
+
+    uint8_t record[128];
+    ByteWriter w(record, sizeof(record));
+    w.u8(REC_TICK);
+
+    lock();
+    w.varint(tickUs - lastTickUs);
+    w.u8(tickKeiserCount);
+    for (uint8_t i = 0; i < tickKeiserCount; i++)
+    {
+        const KeiserSample &s = tickKeiser[i];
+        w.u8(s.versionMajor);
+        w.u8(s.versionMinor);
+        w.u8(s.dataType);
+        w.u8(s.equipmentId);
+        w.varint(s.cadence);
+        w.varint(s.heartRate);
+        w.varint(s.power);
+        w.varint(s.calories);
+        w.u8(s.minutes);
+        w.u8(s.seconds);
+        w.varint(s.distance | (s.metric ? 0x8000 : 0));
+        w.u8(s.gear);
+    }
+    w.u8(tickRandomCount);
+    for (uint8_t i = 0; i < tickRandomCount; i++)
+    {
+        w.svarint(tickRandom[i]);
+    }
+
+    if (w.ok() && append(record, w.size(), 0))
+    {
+        lastTickUs = tickUs;
+    }
+    else
+    {
+        if (!w.ok())
+            dropped++;
+        forceBlock = true;
+    }
+    // 无论是否写入都推进序号，回放端借助下一个关键帧重新同步
+    tickSeq++;
+    unlock();
+}
+
+void TraceRecorder::recordPayload(uint8_t channel, uint32_t tick, const uint8_t *data, size_t len)
+{
+    if (!isEnabled() || channel >= CH_COUNT || len > MAX_PAYLOAD)
+        return;
+
+    uint8_t record[8 + MAX_PAYLOAD / 8 + MAX_PAYLOAD];
+    ByteWriter w(record, sizeof(record));
+
+    lock();
+    w.u8(REC_PAYLOAD);
+    w.u8(channel);
+    w.varint(tickSeq - tick);
+    w.u8((uint8_t)len);
+
+    // 与上一包按字节比较：掩码每位表示对应字节是否变化
+    const uint8_t *prev = lastPayload[channel];
+    size_t prevLen = lastPayloadLen[channel];
+    for (size_t base = 0; base < len; base += 8)
+    {
+        uint8_t mask = 0;
+        for (size_t i = base; i < len && i < base + 8; i++)
+        {
+            if (i >= prevLen || data[i] != prev[i])
+                mask |= 1 << (i - base);
+        }
+        w.u8(mask);
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (i >= prevLen || data[i] != prev[i])
+            w.u8(data[i]);
+    }
+
+    if (w.ok() && append(record, w.size(), 0))
+    {
+        memcpy(lastPayload[channel], data, len);
+        lastPayloadLen[channel] = (uint8_t)len;
+    }
+    unlock();
+}
+
+size_t TraceRecorder::getBlockCount() const
+{
+    return blockSeq < blockCount ? blockSeq : blockCount;
+}
+
+bool TraceRecorder::copyBlock(size_t index, uint8_t *out)
+{
+    bool ok = false;
+    lock();
+    if (index < getBlockCount())
+    {
+        // 环形未写满时从 0 开始，写满后最旧的块紧跟在 head 之后
+        size_t oldest = blockSeq < blockCount ? 0 : (head + 1) % blockCount;
+        memcpy(out, &storage[((oldest + index) % blockCount) * BLOCK_SIZE], BLOCK_SIZE);
+        ok = true;
+    }
+    unlock();
+    return ok;
+}
+
+long TraceRecorder::recordingRandom(void *ctx, long howsmall, long howbig)
+{
+    long value = random(howsmall, howbig);
+    static_cast<TraceRecorder *>(ctx)->noteRandom(value);
+    return value;
+}
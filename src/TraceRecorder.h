@@ -0,0 +1,85 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "BikeData.h"
+#include "KeiserParser.h"
+#include "TraceFormat.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#endif
+
+// 追踪记录器：把 BikeData 的输入（时间、随机数、广播）与编码后的 CSC/CP 负载
+// 增量编码写入块环形缓冲区。生产者每个 tick 调用 beginTick/endTick，
+// 通知任务调用 recordPayload；两侧可以在不同任务中运行。
+class TraceRecorder
+{
+public:
+    TraceRecorder();
+
+    // buffer 由调用方提供（固件中优先放在 PSRAM），大小按块向下取整
+    bool begin(uint8_t *buffer, size_t size);
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled && blockCount > 0; }
+
+    // ------------ 生产者侧 ------------
+    // 在 update() 之前调用：必要时开新块并写入包含当前状态的关键帧
+    void beginTick(const BikeData &bikeData, uint64_t nowUs);
+    void noteKeiser(const KeiserSample &sample);
+    void noteRandom(long value);
+    // 在 update() 之后调用：把本 tick 作为一条记录写入
+    void endTick();
+    uint32_t currentTick() const { return tickSeq; }
+
+    // ------------ 通知任务侧 ------------
+    // tick 为生成该负载的数据快照所属的 tick 序号
+    void recordPayload(uint8_t channel, uint32_t tick, const uint8_t *data, size_t len);
+
+    // ------------ 导出 ------------
+    // 按从旧到新的顺序在锁内拷贝一个块（BLOCK_SIZE 字节），可在记录进行中调用；
+    // 导出过程中若有块被覆盖，解码端按块序号排序并借助关键帧重新同步
+    size_t getBlockCount() const;
+    bool copyBlock(size_t index, uint8_t *out);
+
+    uint32_t getDroppedCount() const { return dropped; }
+    uint32_t getRecordCount() const { return records; }
+
+    // BikeData 随机数钩子：调用 random() 并记录结果
+    static long recordingRandom(void *ctx, long howsmall, long howbig);
+
+private:
+    static const size_t TICK_RESERVE = 256; // 开新块的阈值：保证本 tick 与并发的负载记录写得下
+
+    uint8_t *storage;
+    size_t blockCount;
+    bool enabled;
+
+    size_t head;       // 当前写入块
+    size_t used;       // 当前块已用字节
+    uint32_t blockSeq; // 已开始的块总数
+    uint32_t tickSeq;
+    uint64_t lastTickUs;
+    uint32_t dropped;
+    uint32_t records;
+    bool forceBlock; // tick 写入失败后，下一个 tick 必须开新块重新同步
+
+    // 本 tick 的暂存
+    uint64_t tickUs;
+    KeiserSample tickKeiser[trace::MAX_TICK_KEISER];
+    uint8_t tickKeiserCount;
+    long tickRandom[trace::MAX_TICK_RANDOM];
+    uint8_t tickRandomCount;
+
+    // 各通道上一包负载，用于异或增量（每块重置）
+    uint8_t lastPayload[trace::CH_COUNT][trace::MAX_PAYLOAD];
+    uint8_t lastPayloadLen[trace::CH_COUNT];
+
+#ifdef ARDUINO
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+    void lock();
+    void unlock();
+
+    void startBlock(const BikeData &bikeData, uint64_t nowUs);
+    bool append(const uint8_t *record, size_t len, size_t reserve);
+};
@@ -1,163 +1,503 @@
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLEServer.h>
+#include <NimBLEDevice.h>
 #include "BikeData.h"
+#include "BootProfile.h"
+#include "BatteryMonitor.h"
 #include "BatteryService.h"
+#include "BikeSelectService.h"
 #include "CSCService.h"
 #include "CPService.h"
 #include "DeviceInfoService.h"
-
-// LED 引脚定义
-#define LED_PIN 2
-
-// 调试标志
-#define DEBUG_MEMORY true
-#define DEBUG_BLE true
-
-// 全局变量，用于标记是否发生异常
-volatile bool hadException = false;
+#include "FTMSService.h"
+#include "NotifyScheduler.h"
+#include "KeiserScanner.h"
+#include "LinkTuner.h"
+#include "Log.h"
+#include "LogDrain.h"
+#include "Gateway.h"
+#include "NimBleBackend.h"
+#include "PowerManager.h"
+#include "SensorInput.h"
+#include "StaticPool.h"
+#include "Status.h"
+#include "StatusLed.h"
+#include "TraceRecorder.h"
+#include <esp_heap_caps.h>
+
+// 状态灯：超过该时间没有新的输入数据时显示为等待数据
+#define INGEST_TIMEOUT_MS 3000
+
+// 日志级别由 platformio.ini 中的 LOG_LEVEL 决定，低于该级别的日志在编译期移除
+
+// Keiser 桥接：true 时转发 Keiser M 广播，false 时使用模拟数据
+#define KEISER_BRIDGE true
+#define KEISER_EQUIPMENT_ID KeiserScanner::ANY_EQUIPMENT
+
+// 追踪记录：记录数据管线的输入与输出，串口发送 'T' 导出
+#define TRACE_ENABLED true
+#define TRACE_PSRAM_SIZE (1024 * 1024) // PSRAM 中约可记录 30 分钟（连接时 25 ms 采样）
+#define TRACE_SRAM_SIZE (16 * 1024)    // 无 PSRAM 时的回退大小
+
+// 通知合并：无变化时的保活间隔；合并窗口在连接后取连接间隔
+#define NOTIFY_KEEPALIVE_MS 1000
+
+// 压力测试：true 时以脚本场景（格式见 Scenario.h）代替 Keiser 与模拟数据，覆盖冲刺、滑行、停车与计数回绕
+#define SCENARIO_ENABLED false
+#define SCENARIO_SCRIPT \
+    "seed 1\n"         \
+    "noise 3%\n"       \
+    "wheel 4294960000\n" \
+    "crank 65000\n"    \
+    "loop\n"           \
+    "ramp 30s 25kmh 85rpm 160w\n" \
+    "ramp 3s 45kmh 120rpm 650w\n" \
+    "hold 15s\n"       \
+    "coast 20s\n"      \
+    "stop 10s\n"
+
+// 有线传感器：true 时以直接接在 GPIO 上的干簧管代替 Keiser 与模拟数据（脚本场景优先），
+// 脉冲在中断中按微秒打时间戳，事件时间不受采样周期量化；没有功率计，功率为 0
+#define WIRED_SENSORS false
+#define WHEEL_SENSOR_PIN 4
+#define CRANK_SENSOR_PIN 5
+
+// 上报功率与踏频的滤波：中值窗口去除单点尖峰，再做平滑；窗口 1 且 SMOOTH_NONE 时原样转发
+#define POWER_FILTER_MEDIAN 3
+#define POWER_FILTER_SMOOTHER SampleFilter::SMOOTH_KALMAN
+#define CADENCE_FILTER_MEDIAN 3
+#define CADENCE_FILTER_SMOOTHER SampleFilter::SMOOTH_EMA
+
+// 快速启动：不再等待串口监视器连接，先开始广播，状态灯、扫描、追踪与调度器在广播之后启动
+#define FAST_BOOT true
+
+// 电源管理：未连接且无踏频一段时间后降频、自动浅睡眠并退避广播，连接或踏频恢复后立即回到全速
+#define POWER_SAVE true
+#define POWER_IDLE_AFTER_MS 30000
+
+// 电池监测：每 10 秒以连续 ADC (DMA) 采集一帧分压电压，电量百分比改变时才更新电池服务并通知。
+// 分压接在 ADC1 引脚上（两只等值电阻，电池电压的一半）；未接电池时读数超出有效范围，电量保持不变
+#define BATTERY_MONITOR true
+#define BATTERY_ADC_PIN 1
+
+// 链路调优：连接后请求 2M PHY 与数据长度扩展，骑行时请求 15-30 ms 连接间隔，
+// 无踏频 LINK_IDLE_AFTER_MS 后请求 100-200 ms 间隔加从机延迟（网关模式始终使用短间隔）
+#define LINK_TUNING true
+#define LINK_IDLE_AFTER_MS POWER_IDLE_AFTER_MS
+
+// 多车网关：true 时接收所有 Keiser 单车，每个连接的中心设备各自绑定一台单车
+#define GATEWAY_MODE false
+
+// 单车模式下同时连接的中心设备数（手表、手机 App 与骑行软件）：每个样本只编码一次，
+// 由后端按各连接的 CCCD 扇出；未满时连接后继续广播
+#define MAX_CENTRALS 3
+#ifdef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+static_assert(MAX_CENTRALS <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS, "MAX_CENTRALS 超过 NimBLE 的连接上限");
+#endif
+static_assert(MAX_CENTRALS <= gatt::MAX_CONNECTIONS, "MAX_CENTRALS 超过订阅表容量");
 
 // 计时器变量，用于监测系统是否卡住
 unsigned long lastActiveTime = 0;
 const unsigned long WATCHDOG_TIMEOUT = 10000; // 10秒超时
 
 BikeData bikeData;
-BLEServer *pServer = nullptr;
+NimBLEServer *pServer = nullptr;
+NimBleServer *pGattServer = nullptr;
 BatteryService *pBatteryService = nullptr;
 CSCService *pCSCService = nullptr;
 CPService *pCPService = nullptr;
+FTMSService *pFTMSService = nullptr;
 DeviceInfoService *pDeviceInfoService = nullptr;
+BikeSelectService *pBikeSelectService = nullptr;
+NotifyScheduler notifyScheduler;
+KeiserScanner keiserScanner;
+Gateway gateway;
+TraceRecorder traceRecorder;
+LogDrain logDrain;
+StatusLed statusLed;
+BootProfile bootProfile;
+PowerManager powerManager;
+LinkTuner linkTuner;
+BatteryMonitor batteryMonitor;
+PulseSource pulseSource;
+SensorInput sensorInput;
+
+// 采样前把最新的 Keiser 广播写入 BikeData，并把踏频交给电源管理与链路调优（在采样任务中运行）
+void pollSource(BikeData *data)
+{
+    KeiserSample sample;
+    if (data->getSource() == BikeData::SOURCE_KEISER && keiserScanner.takeLatest(sample))
+    {
+        traceRecorder.noteKeiser(sample);
+        data->ingestKeiser(sample);
+    }
+    bool riding = data->getData().cadence > 0;
+    powerManager.setRiding(riding);
+    linkTuner.setRiding(riding);
+}
+
+NotifyScheduler::Config schedulerConfig()
+{
+    NotifyScheduler::Config config;
+    config.pollSource = pollSource;
+    if (traceRecorder.isEnabled())
+        config.trace = &traceRecorder;
+    return config;
+}
 
-// 连接状态回调
-class ServerCallbacks : public BLEServerCallbacks
+// 分配追踪缓冲区（优先 PSRAM）并接管 BikeData 的随机数来源
+void setupTrace()
 {
-    void onConnect(BLEServer *pServer)
+    size_t size = TRACE_PSRAM_SIZE;
+    uint8_t *buffer = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!buffer)
     {
-        digitalWrite(LED_PIN, HIGH);
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 设备已连接");
+        size = TRACE_SRAM_SIZE;
+        buffer = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
     }
-    void onDisconnect(BLEServer *pServer)
+    if (!buffer || !traceRecorder.begin(buffer, size))
     {
-        digitalWrite(LED_PIN, LOW);
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 设备已断开");
-        if (pServer)
-        {
-            pServer->startAdvertising();
-            if (DEBUG_BLE)
-                Serial.println("[BLE] 重新开始广播");
-        }
+        LOG_ERROR("[ERROR] 追踪缓冲区分配失败");
+        return;
     }
-};
+    bikeData.setRandomSource(TraceRecorder::recordingRandom, &traceRecorder);
+    LOG_INFO("[TRACE] 缓冲区 %u 字节", (unsigned)size);
+}
 
-bool setupBLE()
+// 以十六进制文本导出追踪块，主机端 trace_replay 可直接读取此输出
+void dumpTrace()
 {
-    try
+    static uint8_t block[trace::BLOCK_SIZE];
+    size_t blocks = traceRecorder.getBlockCount();
+    Serial.printf("[TRACE] BEGIN blocks=%u block_size=%u\n", (unsigned)blocks, (unsigned)trace::BLOCK_SIZE);
+    for (size_t b = 0; b < blocks; b++)
     {
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 初始化BLE设备...");
-        BLEDevice::init("Indoor Bike");
-
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 创建BLE服务器...");
-        pServer = BLEDevice::createServer();
-        if (!pServer)
+        if (!traceRecorder.copyBlock(b, block))
+            break;
+        for (size_t i = 0; i < trace::BLOCK_SIZE; i += 32)
         {
-            Serial.println("[ERROR] 创建BLE服务器失败");
-            return false;
+            char line[65];
+            for (size_t j = 0; j < 32; j++)
+                snprintf(&line[j * 2], 3, "%02X", block[i + j]);
+            Serial.println(line);
         }
+    }
+    Serial.printf("[TRACE] END dropped=%u\n", (unsigned)traceRecorder.getDroppedCount());
+}
 
-        pServer->setCallbacks(new ServerCallbacks());
-
-        // 创建所有服务实例
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 创建服务实例...");
+// 合并窗口取所有连接中最短的连接间隔 (1.25ms 单位)：最快的连接每个连接事件最多一次通知。
+// 回调中协议栈的连接表可能尚未更新，因此显式加入新连接的间隔并排除正在断开的连接
+void updateCoalescerWindow(NimBLEServer *server, uint32_t extraUs, uint16_t excludeHandle)
+{
+    uint32_t windowUs = extraUs;
+    for (uint16_t handle : server->getPeerDevices())
+    {
+        if (handle == excludeHandle)
+            continue;
+        uint32_t us = (uint32_t)server->getPeerInfoByHandle(handle).getConnInterval() * 1250;
+        if (us > 0 && (windowUs == 0 || us < windowUs))
+            windowUs = us;
+    }
+    if (windowUs == 0 || !pCSCService || !pCPService || !pFTMSService)
+        return;
+    pCSCService->getCoalescer().setWindow(windowUs);
+    pCPService->getCoalescer().setWindow(windowUs);
+    pFTMSService->getCoalescer().setWindow(windowUs);
+    LOG_INFO("[BLE] 合并窗口 %u us", (unsigned)windowUs);
+}
 
-        if (DEBUG_MEMORY)
-        {
-            Serial.printf("[MEM] Free heap before services: %d\n", ESP.getFreeHeap());
-        }
+// 连接状态回调（均在 BLE 主机任务中运行）
+class ServerCallbacks : public NimBLEServerCallbacks
+{
+    uint8_t centralCount = 0;
 
-        pBatteryService = new BatteryService(pServer);
-        if (!pBatteryService)
+    void onConnect(NimBLEServer *pServer, NimBLEConnInfo &connInfo) override
+    {
+        centralCount++;
+        statusLed.setConnected(true);
+        powerManager.setConnected(true);
+        LOG_INFO("[BLE] 设备已连接 (handle=%u, %u 个连接, 间隔 %u us)", (unsigned)connInfo.getConnHandle(),
+                 (unsigned)centralCount, (unsigned)connInfo.getConnInterval() * 1250);
+        updateCoalescerWindow(pServer, (uint32_t)connInfo.getConnInterval() * 1250, BLE_HS_CONN_HANDLE_NONE);
+        if (LINK_TUNING)
+            linkTuner.onConnect(connInfo);
+        if (pCPService)
+            pCPService->onConnect(connInfo.getConnHandle());
+
+        if (GATEWAY_MODE)
         {
-            Serial.println("[ERROR] 创建电池服务失败");
-            return false;
+            gateway.onConnect(connInfo.getConnHandle());
+            // 网关需要继续广播以接受更多中心设备
+            if (gateway.getSessionCount() < Gateway::MAX_SESSIONS)
+                pServer->startAdvertising();
         }
-
-        pCSCService = new CSCService(pServer);
-        if (!pCSCService)
+        else if (centralCount < MAX_CENTRALS)
         {
-            Serial.println("[ERROR] 创建CSC服务失败");
-            return false;
+            pServer->startAdvertising();
         }
+    }
 
-        pCPService = new CPService(pServer);
-        if (!pCPService)
+    void onDisconnect(NimBLEServer *pServer, NimBLEConnInfo &connInfo, int reason) override
+    {
+        uint16_t handle = connInfo.getConnHandle();
+        if (centralCount > 0)
+            centralCount--;
+        if (pGattServer)
+            pGattServer->removeConnection(handle);
+        linkTuner.onDisconnect(handle);
+        if (pCPService)
+            pCPService->onDisconnect(handle);
+        if (GATEWAY_MODE)
+            gateway.onDisconnect(handle);
+
+        // 仍有其他中心设备连接时保持已连接状态
+        bool anyConnected = GATEWAY_MODE ? gateway.getSessionCount() > 0 : centralCount > 0;
+        statusLed.setConnected(anyConnected);
+        powerManager.setConnected(anyConnected);
+        if (anyConnected)
         {
-            Serial.println("[ERROR] 创建CP服务失败");
-            return false;
+            updateCoalescerWindow(pServer, 0, handle);
         }
-
-        pDeviceInfoService = new DeviceInfoService(pServer);
-        if (!pDeviceInfoService)
+        else
         {
-            Serial.println("[ERROR] 创建设备信息服务失败");
-            return false;
+            // 下次连接的第一包立即发出
+            if (pCSCService)
+                pCSCService->getCoalescer().reset();
+            if (pCPService)
+                pCPService->getCoalescer().reset();
+            if (pFTMSService)
+                pFTMSService->getCoalescer().reset();
         }
-
-        if (DEBUG_MEMORY)
+        LOG_INFO("[BLE] 设备已断开 (handle=%u, reason=0x%02X, 剩余 %u)", (unsigned)handle, reason,
+                 (unsigned)centralCount);
+        if (pServer)
         {
-            Serial.printf("[MEM] Free heap after services: %d\n", ESP.getFreeHeap());
+            pServer->startAdvertising();
+            LOG_INFO("[BLE] 重新开始广播");
         }
+    }
 
-        // 启动服务
-        if (DEBUG_BLE)
-            Serial.println("[BLE] 启动广播...");
-        auto advertising = pServer->getAdvertising();
-        if (!advertising)
-        {
-            Serial.println("[ERROR] 获取广播对象失败");
-            return false;
-        }
+    // 中心设备接受或自行更新连接参数：合并窗口跟随新的间隔
+    void onConnParamsUpdate(NimBLEConnInfo &connInfo) override
+    {
+        linkTuner.onConnParamsUpdate(connInfo);
+        updateCoalescerWindow(pServer, (uint32_t)connInfo.getConnInterval() * 1250, BLE_HS_CONN_HANDLE_NONE);
+    }
 
-        advertising->addServiceUUID(BAT_UUID);
-        advertising->addServiceUUID(CSC_UUID);
-        advertising->addServiceUUID(CP_UUID);
-        advertising->setAppearance(0x0480); // Cycling appearance
-        advertising->start();
+    void onPhyUpdate(NimBLEConnInfo &connInfo, uint8_t txPhy, uint8_t rxPhy) override
+    {
+        linkTuner.onPhyUpdate(connInfo, txPhy, rxPhy);
+    }
 
-        if (DEBUG_BLE)
-            Serial.println("[BLE] BLE服务已启动");
-        return true;
+    void onMTUChange(uint16_t MTU, NimBLEConnInfo &connInfo) override
+    {
+        linkTuner.onMtuChange(MTU, connInfo);
     }
-    catch (const std::exception &e)
+};
+
+// GATT 相关对象的静态存储：大小在编译期确定，重新初始化时析构后原位重建，不再泄漏到堆上
+StaticPool<ServerCallbacks, 1> serverCallbacksPool;
+StaticPool<NimBleServer, 1> gattServerPool;
+StaticPool<BatteryService, 1> batteryServicePool;
+StaticPool<CSCService, 1> cscServicePool;
+StaticPool<CPService, 1> cpServicePool;
+StaticPool<FTMSService, 1> ftmsServicePool;
+StaticPool<DeviceInfoService, 1> deviceInfoServicePool;
+StaticPool<BikeSelectService, 1> bikeSelectServicePool;
+
+// 释放上一次初始化创建的服务（调用方需先停止通知调度器）
+void releaseServices()
+{
+    pBatteryService = nullptr;
+    pCSCService = nullptr;
+    pCPService = nullptr;
+    pFTMSService = nullptr;
+    pDeviceInfoService = nullptr;
+    pBikeSelectService = nullptr;
+    bikeSelectServicePool.clear();
+    deviceInfoServicePool.clear();
+    ftmsServicePool.clear();
+    cpServicePool.clear();
+    cscServicePool.clear();
+    batteryServicePool.clear();
+    if (pGattServer)
+        pGattServer->reset();
+}
+
+// 重启前先把队列中的日志写出串口，再等待 delayMs
+void restartSystem(uint32_t delayMs)
+{
+    statusLed.setError(true);
+    logDrain.flush(delayMs);
+    delay(delayMs);
+    ESP.restart();
+}
+
+// 电源状态切换后调整扫描占空比、采样与状态灯节奏（在电源任务中运行）
+void applyPowerProfile(const PowerPolicy::Profile &profile)
+{
+    notifyScheduler.setProducerPeriod(profile.samplePeriodMs);
+    statusLed.setPeriod(profile.ledPeriodMs);
+    if (bikeData.getSource() == BikeData::SOURCE_KEISER)
+        keiserScanner.setDutyCycle(profile.scanIntervalMs, profile.scanWindowMs);
+}
+
+// 电量改变时更新电池服务并通知（在电池监测任务中运行）
+void reportBatteryLevel(uint8_t level)
+{
+    BatteryService *service = pBatteryService;
+    if (service)
+        service->updateLevel(level);
+}
+
+// 当前空闲堆、最大可分配块与历史最低空闲堆：最大块远小于空闲总量说明碎片化
+void printHeapStats(const char *label)
+{
+    LOG_INFO("[MEM] %s: free=%u largest=%u min_ever=%u", label,
+             (unsigned)ESP.getFreeHeap(),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+             (unsigned)ESP.getMinFreeHeap());
+}
+
+// 周期报告按通道分行输出，单条日志的参数不超过 logging::MAX_ARG_BYTES
+void logLatency(const char *name, const LatencyStats &stats)
+{
+    LOG_INFO("[LAT] %s n=%u p50=%uus p99=%uus", name,
+             (unsigned)stats.count(), (unsigned)stats.percentileUs(50), (unsigned)stats.percentileUs(99));
+}
+
+void logCoalescer(const char *name, const NotifyCoalescer &notify)
+{
+    LOG_INFO("[NOTIFY] %s sent=%u suppressed=%u merged=%u keepalive=%u", name,
+             (unsigned)notify.getSentCount(), (unsigned)notify.getSuppressedCount(),
+             (unsigned)notify.getMergedCount(), (unsigned)notify.getKeepAliveCount());
+}
+
+// 网关模式下没有单车的踏频输入，始终使用短连接间隔
+LinkTuner::Config linkTunerConfig()
+{
+    LinkTuner::Config config;
+    config.policy.idleAfterMs = GATEWAY_MODE ? 0 : LINK_IDLE_AFTER_MS;
+    return config;
+}
+
+// 在静态池中构造服务：池满或服务初始化失败时返回对应的错误码
+template <typename T, size_t N, typename... Args>
+Status createService(StaticPool<T, N> &pool, T *&service, const gatt::Uuid &uuid, Args &&...args)
+{
+    service = pool.create(std::forward<Args>(args)...);
+    if (!service)
+        return Status::error(STATUS_POOL_EXHAUSTED, uuid);
+    Status status = service->getStatus();
+    if (!status.ok())
+        service = nullptr;
+    return status;
+}
+
+Status setupBLE()
+{
+    LOG_DEBUG("[BLE] 初始化BLE设备...");
+    if (!NimBLEDevice::init("Indoor Bike"))
+        return Status::error(STATUS_STACK_FAILED);
+    bootProfile.mark(BootProfile::PHASE_STACK_READY);
+
+    if (!FAST_BOOT)
+        printHeapStats("after stack init");
+
+    LOG_DEBUG("[BLE] 创建BLE服务器...");
+    pServer = NimBLEDevice::createServer();
+    if (!pServer)
+        return Status::error(STATUS_STACK_FAILED);
+
+    // 回调与后端只创建一次；回调对象在静态池中，不能交给 NimBLE 删除
+    if (serverCallbacksPool.size() == 0)
     {
-        Serial.printf("[ERROR] BLE设置失败: %s\n", e.what());
-        return false;
+        pServer->setCallbacks(serverCallbacksPool.create(), false);
+        // 在开始广播前启动，首个连接即可协商 PHY 与连接参数
+        if (LINK_TUNING)
+            linkTuner.begin(pServer, linkTunerConfig());
     }
-    catch (...)
+    if (!pGattServer)
+        pGattServer = gattServerPool.create(pServer);
+    releaseServices();
+
+    // 创建所有服务实例
+    LOG_DEBUG("[BLE] 创建服务实例...");
+
+    if (!FAST_BOOT)
+        printHeapStats("before services");
+
+    // 设备信息与电池服务不在测量数据的路径上，但 GATT 表在开始广播时一次注册，
+    // 之后再添加服务需要重置 GATT 并发送 Service Changed，因此仍在广播前创建（只是内存中的属性表，
+    // 服务顺序也保持不变，已缓存句柄的中心设备不受影响）
+    Status status = createService(batteryServicePool, pBatteryService, BAT_UUID, pGattServer);
+    if (!status.ok())
+        return status;
+    status = createService(cscServicePool, pCSCService, CSC_UUID, pGattServer);
+    if (!status.ok())
+        return status;
+    status = createService(cpServicePool, pCPService, CP_UUID, pGattServer);
+    if (!status.ok())
+        return status;
+    status = createService(ftmsServicePool, pFTMSService, FTMS_UUID, pGattServer);
+    if (!status.ok())
+        return status;
+
+    pCSCService->getCoalescer().setKeepAlive(NOTIFY_KEEPALIVE_MS * 1000);
+    pCPService->getCoalescer().setKeepAlive(NOTIFY_KEEPALIVE_MS * 1000);
+    pFTMSService->getCoalescer().setKeepAlive(NOTIFY_KEEPALIVE_MS * 1000);
+
+    status = createService(deviceInfoServicePool, pDeviceInfoService, DI_UUID, pGattServer);
+    if (!status.ok())
+        return status;
+    // 网关的单车选择服务同样须在广播前创建，否则首批连接的中心设备看不到它
+    if (GATEWAY_MODE)
     {
-        Serial.println("[ERROR] BLE设置失败: 未知错误");
-        return false;
+        status = createService(bikeSelectServicePool, pBikeSelectService, GATEWAY_SERVICE_UUID, pGattServer);
+        if (!status.ok())
+            return status;
     }
+    bootProfile.mark(BootProfile::PHASE_GATT_READY);
+
+    // 启动服务
+    LOG_DEBUG("[BLE] 启动广播...");
+    NimBLEAdvertising *advertising = NimBLEDevice::getAdvertising();
+    if (!advertising)
+        return Status::error(STATUS_ADVERTISING_FAILED);
+
+    advertising->addServiceUUID(NimBleServer::toNative(BAT_UUID));
+    advertising->addServiceUUID(NimBleServer::toNative(CSC_UUID));
+    advertising->addServiceUUID(NimBleServer::toNative(CP_UUID));
+    advertising->addServiceUUID(NimBleServer::toNative(FTMS_UUID));
+    // FTMS 服务数据：flags(1) = 可用，机器类型(2) = 室内单车 (bit5)
+    const uint8_t ftmsServiceData[3] = {0x01, 0x20, 0x00};
+    advertising->setServiceData(NimBleServer::toNative(FTMS_UUID), ftmsServiceData, sizeof(ftmsServiceData));
+    advertising->setAppearance(0x0480); // Cycling appearance
+    if (!advertising->start())
+        return Status::error(STATUS_ADVERTISING_FAILED);
+    bootProfile.mark(BootProfile::PHASE_ADVERTISING);
+
+    printHeapStats("after services");
+    LOG_INFO("[MEM] GATT pool: services=%u/%u chars=%u/%u failures=%u static=%u",
+             (unsigned)pGattServer->getServiceCount(), (unsigned)NimBleServer::MAX_SERVICES,
+             (unsigned)pGattServer->getCharacteristicCount(), (unsigned)NimBleServer::MAX_CHARACTERISTICS,
+             (unsigned)pGattServer->getPoolFailureCount(), (unsigned)NimBleServer::poolBytes());
+
+    LOG_DEBUG("[BLE] BLE服务已启动");
+    return Status::success();
 }
 
 void setup()
 {
+    bootProfile.mark(BootProfile::PHASE_SETUP);
     Serial.begin(115200);
-    delay(1000);
+    if (!FAST_BOOT)
+        delay(1000); // 等待串口监视器连接
+    logDrain.begin(LogDrain::Config());
+    bootProfile.mark(BootProfile::PHASE_LOG_READY);
 
-    Serial.println("\n[INIT] 系统启动...");
-    if (DEBUG_MEMORY)
-    {
-        Serial.printf("[MEM] Initial free heap: %d\n", ESP.getFreeHeap());
-    }
-
-    pinMode(LED_PIN, OUTPUT);
-    digitalWrite(LED_PIN, LOW);
+    LOG_INFO("[INIT] 系统启动...");
+    if (!FAST_BOOT)
+        printHeapStats("initial");
 
     // 初始化看门狗计时器
     lastActiveTime = millis();
@@ -166,78 +506,250 @@ void setup()
     randomSeed(millis());
 
     // 设置BLE
-    if (!setupBLE())
+    Status status = setupBLE();
+    if (!status.ok())
+    {
+        LOG_ERROR("[ERROR] BLE初始化失败: %s (UUID 0x%04X)，系统重启", status.name(), (unsigned)status.uuid);
+        restartSystem(3000);
+    }
+
+    // 以下初始化不影响首个广播
+    statusLed.begin(StatusLed::Config());
+    LOG_INFO("[MEM] Image size: %u", (unsigned)ESP.getSketchSize());
+
+    if (GATEWAY_MODE)
+    {
+        // 网关模式：接收所有单车，由网关按连接分发
+        if (!keiserScanner.beginGateway() ||
+            !gateway.begin(pGattServer, pCSCService, pCPService, pBikeSelectService, &keiserScanner,
+                           Gateway::Config()))
+        {
+            LOG_ERROR("[ERROR] 网关启动失败，系统重启");
+            restartSystem(3000);
+        }
+        bootProfile.mark(BootProfile::PHASE_READY);
+        bootProfile.report();
+        LOG_INFO("[INIT] 初始化完成 (网关模式)");
+        return;
+    }
+
+    static Scenario scenario;
+    Scenario::ParseError scenarioError;
+    if (SCENARIO_ENABLED)
+    {
+        if (scenario.parse(SCENARIO_SCRIPT, &scenarioError))
+        {
+            bikeData.setScenario(&scenario);
+            LOG_INFO("[INIT] 场景数据: %u 段, %u 秒", (unsigned)scenario.getSegmentCount(),
+                     (unsigned)(scenario.getDurationUs() / 1000000));
+        }
+        else
+        {
+            LOG_ERROR("[ERROR] 场景脚本第 %u 行: %s", (unsigned)scenarioError.line, scenarioError.message);
+        }
+    }
+
+    // 有线传感器：中断在 BLE 之后挂接，不影响首个广播
+    if (WIRED_SENSORS && bikeData.getSource() == BikeData::SOURCE_SIMULATION)
+    {
+        SensorInput::Config sensorConfig;
+        sensorConfig.wheelPin = WHEEL_SENSOR_PIN;
+        sensorConfig.crankPin = CRANK_SENSOR_PIN;
+        if (sensorInput.begin(&pulseSource, sensorConfig))
+            bikeData.setPulseSource(&pulseSource);
+        else
+            LOG_ERROR("[ERROR] 有线传感器启动失败");
+    }
+
+    // 启动 Keiser 广播扫描
+    if (KEISER_BRIDGE && bikeData.getSource() == BikeData::SOURCE_SIMULATION)
+    {
+        bikeData.setSource(BikeData::SOURCE_KEISER);
+        if (!keiserScanner.begin(KEISER_EQUIPMENT_ID))
+        {
+            LOG_ERROR("[ERROR] Keiser 扫描启动失败，改用模拟数据");
+            bikeData.setSource(BikeData::SOURCE_SIMULATION);
+        }
+    }
+
+    // 追踪启动前设置，关键帧中记录的是最终的滤波配置
+    SampleFilter::Config powerFilter;
+    powerFilter.medianSize = POWER_FILTER_MEDIAN;
+    powerFilter.smoother = POWER_FILTER_SMOOTHER;
+    SampleFilter::Config cadenceFilter;
+    cadenceFilter.medianSize = CADENCE_FILTER_MEDIAN;
+    cadenceFilter.smoother = CADENCE_FILTER_SMOOTHER;
+    bikeData.setFilters(powerFilter, cadenceFilter);
+
+    if (TRACE_ENABLED)
+        setupTrace();
+
+    // 启动事件驱动的通知调度器
+    if (!notifyScheduler.begin(&bikeData, pCSCService, pCPService, pFTMSService, schedulerConfig()))
     {
-        Serial.println("[ERROR] BLE初始化失败，系统重启");
-        delay(3000);
-        ESP.restart();
+        LOG_ERROR("[ERROR] 通知调度器启动失败，系统重启");
+        restartSystem(3000);
     }
 
-    Serial.println("[INIT] 初始化完成");
+    // 网关模式由多个中心设备共用，通常有外部供电，不启用
+    if (POWER_SAVE)
+    {
+        PowerManager::Config powerConfig;
+        powerConfig.policy.idleAfterMs = POWER_IDLE_AFTER_MS;
+        powerConfig.onChange = applyPowerProfile;
+        if (!powerManager.begin(powerConfig))
+            LOG_ERROR("[ERROR] 电源管理启动失败，保持全速运行");
+    }
+
+    if (BATTERY_MONITOR)
+    {
+        BatteryMonitor::Config batteryConfig;
+        batteryConfig.pin = BATTERY_ADC_PIN;
+        batteryConfig.onLevel = reportBatteryLevel;
+        if (!batteryMonitor.begin(batteryConfig))
+            LOG_ERROR("[ERROR] 电池监测启动失败");
+    }
+
+    bootProfile.mark(BootProfile::PHASE_READY);
+    bootProfile.report();
+    LOG_INFO("[INIT] 初始化完成");
+}
+
+// 最近是否有新的输入数据：单车模式看匹配的 Keiser 广播，网关看全部广播，模拟数据始终有输入
+bool isIngesting(unsigned long now)
+{
+    static uint32_t lastCount = 0;
+    static unsigned long lastChange = 0;
+    if (!GATEWAY_MODE && bikeData.getSource() != BikeData::SOURCE_KEISER)
+        return true;
+    uint32_t count = GATEWAY_MODE ? keiserScanner.getAdvertCount() : keiserScanner.getMatchCount();
+    if (count != lastCount)
+    {
+        lastCount = count;
+        lastChange = now;
+        return true;
+    }
+    return lastChange != 0 && now - lastChange < INGEST_TIMEOUT_MS;
 }
 
 void loop()
 {
     static uint32_t lastHeapCheck = 0;
+    static uint32_t lastLatencyReport = 0;
     unsigned long currentTime = millis();
 
+    // 状态灯只读取标志，由 LED 任务异步刷新
+    statusLed.setIngesting(isIngesting(currentTime));
+
     // 定期检查堆内存
-    if (DEBUG_MEMORY && (currentTime - lastHeapCheck > 5000))
+    if (LOG_LEVEL >= LOG_LEVEL_INFO && (currentTime - lastHeapCheck > 5000))
     {
-        Serial.printf("[MEM] Free heap: %d\n", ESP.getFreeHeap());
+        printHeapStats("heap");
         lastHeapCheck = currentTime;
     }
 
-    // 更新数据
-    bikeData.update();
-    auto data = bikeData.getData();
-
-    // 更新传感器数据
-    try
+    if (GATEWAY_MODE)
     {
-        // 检查必要的指针
-        if (!pServer || !pCSCService || !pCPService)
+        if (LOG_LEVEL >= LOG_LEVEL_INFO && (currentTime - lastLatencyReport > 5000))
         {
-            Serial.println("[ERROR] 检测到无效的服务指针，重新初始化...");
-            if (!setupBLE())
-            {
-                Serial.println("[ERROR] 重新初始化失败，系统重启");
-                delay(1000);
-                ESP.restart();
-            }
-            return;
+            LOG_INFO("[GW] bikes=%u sessions=%u notifies=%u adverts=%u dropped=%u",
+                     (unsigned)gateway.getBikeCount(), (unsigned)gateway.getSessionCount(),
+                     (unsigned)gateway.getNotifyCount(), (unsigned)keiserScanner.getAdvertCount(),
+                     (unsigned)keiserScanner.getDroppedCount());
+            lastLatencyReport = currentTime;
         }
+        if (LINK_TUNING)
+            linkTuner.poll();
+        delay(100);
+        if (millis() - gateway.getLastActivityMillis() > WATCHDOG_TIMEOUT)
+        {
+            LOG_ERROR("[ERROR] 网关卡住检测到，准备重启...");
+            restartSystem(1000);
+        }
+        return;
+    }
 
-        // 更新CSC服务
-        pCSCService->updateMeasurement(
-            data.wheel_rev,
-            data.w_event_time,
-            data.crank_rev,
-            data.c_event_time);
-
-        // 更新CP服务
-        pCPService->updateMeasurement(data.power);
+    if (LINK_TUNING)
+        linkTuner.poll();
 
-        // 数据更新成功，重置看门狗计时器
-        lastActiveTime = currentTime;
+    // 串口命令：'T' 导出追踪，'B' 输出启动阶段耗时，'P' 输出各电源状态的累计时间，'L' 输出各连接的链路参数，
+    // 'V' 输出电池电压与电量，'S' 输出有线传感器的弹跳与溢出计数
+    if (Serial.available())
+    {
+        int command = Serial.read();
+        if (TRACE_ENABLED && command == 'T')
+            dumpTrace();
+        else if (command == 'B')
+            bootProfile.report();
+        else if (command == 'P')
+            powerManager.report();
+        else if (command == 'L')
+            linkTuner.report();
+        else if (command == 'V')
+            batteryMonitor.report();
+        else if (command == 'S')
+            sensorInput.report();
     }
-    catch (const std::exception &e)
+
+    // 定期输出事件到通知的延迟 (p50/p99)
+    if (LOG_LEVEL >= LOG_LEVEL_INFO && (currentTime - lastLatencyReport > 5000))
     {
-        Serial.printf("[ERROR] 更新传感器数据失败: %s\n", e.what());
+        logLatency("CSC", notifyScheduler.getLatency(NotifyScheduler::CHANNEL_CSC));
+        logLatency("CP", notifyScheduler.getLatency(NotifyScheduler::CHANNEL_CP));
+        logLatency("FTMS", notifyScheduler.getLatency(NotifyScheduler::CHANNEL_FTMS));
+        if (pCSCService && pCPService && pFTMSService)
+        {
+            logCoalescer("CSC", pCSCService->getCoalescer());
+            logCoalescer("CP", pCPService->getCoalescer());
+            logCoalescer("FTMS", pFTMSService->getCoalescer());
+        }
+        LOG_INFO("[RING] samples=%u overflow=%u high_water=%u/%u",
+                 (unsigned)notifyScheduler.getSampleCount(), (unsigned)notifyScheduler.getOverflowCount(),
+                 (unsigned)notifyScheduler.getHighWater(), (unsigned)NotifyScheduler::RING_SIZE);
+        if (bikeData.getSource() == BikeData::SOURCE_KEISER)
+        {
+            LOG_INFO("[KEISER] bike=%u adverts=%u matched=%u",
+                     (unsigned)keiserScanner.getEquipmentId(),
+                     (unsigned)keiserScanner.getAdvertCount(),
+                     (unsigned)keiserScanner.getMatchCount());
+        }
+        LOG_INFO("[LOG] dropped=%u bytes=%u",
+                 (unsigned)logDrain.getDroppedCount(), (unsigned)logDrain.getBytesWritten());
+        lastLatencyReport = currentTime;
     }
-    catch (...)
+
+    // 检查必要的指针
+    if (!pServer || !pCSCService || !pCPService || !pFTMSService)
     {
-        Serial.println("[ERROR] 更新传感器数据时发生未知错误");
+        LOG_ERROR("[ERROR] 检测到无效的服务指针，重新初始化...");
+        notifyScheduler.end();
+        Status status = setupBLE();
+        if (!status.ok())
+        {
+            LOG_ERROR("[ERROR] 重新初始化失败: %s (UUID 0x%04X)，系统重启", status.name(), (unsigned)status.uuid);
+            restartSystem(1000);
+        }
+        // 新的电池服务从初始值开始，写回已测得的电量
+        uint8_t batteryLevel;
+        if (batteryMonitor.getLevel(batteryLevel))
+            reportBatteryLevel(batteryLevel);
+        if (!notifyScheduler.begin(&bikeData, pCSCService, pCPService, pFTMSService, schedulerConfig()))
+        {
+            LOG_ERROR("[ERROR] 重新初始化失败，系统重启");
+            restartSystem(1000);
+        }
+        return;
     }
 
-    // 添加短暂延时以防止过于频繁的更新
-    delay(50);
+    // 数据采集与通知均由调度器驱动，这里只做低频的后台检查（空闲时放慢）
+    delay(powerManager.getPollPeriodMs());
 
-    // 看门狗检查
+    // 看门狗检查：通知任务至少每个心跳周期运行一次
+    lastActiveTime = notifyScheduler.getLastActivityMillis();
+    currentTime = millis();
     if (currentTime - lastActiveTime > WATCHDOG_TIMEOUT)
     {
-        Serial.println("[ERROR] 系统卡住检测到，准备重启...");
-        delay(1000);
-        ESP.restart();
+        LOG_ERROR("[ERROR] 系统卡住检测到，准备重启...");
+        restartSystem(1000);
     }
 }
\ No newline at end of file
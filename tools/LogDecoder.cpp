@@ -0,0 +1,352 @@
+#include "LogDecoder.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+LogDecoder::LogDecoder(LineFn onLine, void *ctx) : onLine(onLine), ctx(ctx) {}
+
+void LogDecoder::emit(const std::string &line)
+{
+    if (onLine)
+        onLine(ctx, line);
+}
+
+void LogDecoder::textByte(uint8_t b)
+{
+    if (b == '\n')
+    {
+        emit(text);
+        text.clear();
+    }
+    else if (b != '\r')
+    {
+        text.push_back((char)b);
+    }
+}
+
+void LogDecoder::finish()
+{
+    if (!text.empty())
+    {
+        emit(text);
+        text.clear();
+    }
+}
+
+void LogDecoder::feed(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t b = data[i];
+        switch (state)
+        {
+        case STATE_TEXT:
+            if (b == logfmt::SYNC0)
+                state = STATE_SYNC1;
+            else
+                textByte(b);
+            break;
+
+        case STATE_SYNC1:
+            if (b == logfmt::SYNC1)
+            {
+                state = STATE_TYPE;
+            }
+            else
+            {
+                // 不是帧头：0xA5 属于文本
+                textByte(logfmt::SYNC0);
+                state = STATE_TEXT;
+                i--;
+            }
+            break;
+
+        case STATE_TYPE:
+            frameType = b;
+            state = STATE_LEN;
+            break;
+
+        case STATE_LEN:
+            frameLen = b;
+            payloadPos = 0;
+            state = frameLen ? STATE_PAYLOAD : STATE_CHECKSUM;
+            break;
+
+        case STATE_PAYLOAD:
+            payload[payloadPos++] = b;
+            if (payloadPos == frameLen)
+                state = STATE_CHECKSUM;
+            break;
+
+        case STATE_CHECKSUM:
+        {
+            uint8_t checksum = frameType ^ frameLen;
+            for (size_t j = 0; j < frameLen; j++)
+                checksum ^= payload[j];
+            if (checksum == b)
+                handleFrame();
+            else
+                checksumErrors++;
+            state = STATE_TEXT;
+            break;
+        }
+        }
+    }
+}
+
+void LogDecoder::handleFrame()
+{
+    frames++;
+    switch (frameType)
+    {
+    case logfmt::FRAME_FORMAT:
+        if (frameLen >= 1)
+        {
+            formats[payload[0]].assign((const char *)&payload[1], frameLen - 1);
+            known[payload[0]] = true;
+        }
+        break;
+
+    case logfmt::FRAME_RECORD:
+    {
+        if (frameLen < 6 || textOnly)
+            break;
+        uint8_t id = payload[0];
+        uint8_t level = payload[1];
+        uint32_t timeUs = (uint32_t)payload[2] | ((uint32_t)payload[3] << 8) |
+                          ((uint32_t)payload[4] << 16) | ((uint32_t)payload[5] << 24);
+
+        // 32 位微秒时间约 71 分钟回绕一次
+        if (haveTime && timeUs < lastTimeUs)
+            timeHigh += 1ULL << 32;
+        lastTimeUs = timeUs;
+        haveTime = true;
+        double seconds = (double)(timeHigh + timeUs) / 1e6;
+
+        std::string body;
+        if (known[id])
+        {
+            body = format(formats[id], &payload[6], frameLen - 6);
+        }
+        else
+        {
+            // 格式定义尚未收到（中途接入或格式表已满），只输出参数
+            unknownFormats++;
+            body = "<格式 #" + std::to_string(id) + "> " + format("", &payload[6], frameLen - 6);
+        }
+        if (level & logfmt::LEVEL_TRUNCATED)
+            body += " <参数截断>";
+
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "[%11.6f] %c ", seconds, logfmt::levelLetter(level));
+        emit(prefix + body);
+        break;
+    }
+
+    case logfmt::FRAME_DROPPED:
+        if (frameLen == 4)
+        {
+            uint32_t count = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) |
+                             ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+            if (count > dropped && !textOnly)
+                emit("[LOG] 丢弃 " + std::to_string(count - dropped) + " 条日志");
+            dropped = count;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+namespace
+{
+    struct Arg
+    {
+        uint8_t tag;
+        uint64_t u;
+        int64_t i;
+        float f;
+        std::string s;
+    };
+
+    bool readArg(const uint8_t *args, size_t len, size_t &pos, Arg &arg)
+    {
+        if (pos >= len)
+            return false;
+        arg.tag = args[pos++];
+        switch (arg.tag)
+        {
+        case logfmt::ARG_INT:
+        case logfmt::ARG_UINT:
+        {
+            uint64_t v = 0;
+            int shift = 0;
+            while (pos < len)
+            {
+                uint8_t b = args[pos++];
+                v |= (uint64_t)(b & 0x7F) << shift;
+                shift += 7;
+                if (!(b & 0x80))
+                    break;
+            }
+            arg.u = v;
+            arg.i = arg.tag == logfmt::ARG_INT ? logfmt::unzigzag(v) : (int64_t)v;
+            if (arg.tag == logfmt::ARG_INT)
+                arg.u = (uint64_t)arg.i;
+            arg.f = (float)arg.i;
+            return true;
+        }
+        case logfmt::ARG_FLOAT:
+            if (pos + 4 > len)
+                return false;
+            memcpy(&arg.f, &args[pos], 4);
+            pos += 4;
+            arg.i = (int64_t)arg.f;
+            arg.u = (uint64_t)arg.i;
+            return true;
+        case logfmt::ARG_STR:
+        {
+            if (pos >= len)
+                return false;
+            size_t n = args[pos++];
+            if (pos + n > len)
+                return false;
+            arg.s.assign((const char *)&args[pos], n);
+            pos += n;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    std::string argText(const Arg &arg)
+    {
+        char buf[64];
+        switch (arg.tag)
+        {
+        case logfmt::ARG_INT:
+            snprintf(buf, sizeof(buf), "%lld", (long long)arg.i);
+            return buf;
+        case logfmt::ARG_UINT:
+            snprintf(buf, sizeof(buf), "%llu", (unsigned long long)arg.u);
+            return buf;
+        case logfmt::ARG_FLOAT:
+            snprintf(buf, sizeof(buf), "%g", arg.f);
+            return buf;
+        default:
+            return arg.s;
+        }
+    }
+}
+
+std::string LogDecoder::format(const std::string &fmt, const uint8_t *args, size_t len)
+{
+    std::string out;
+    size_t pos = 0;
+    size_t i = 0;
+    while (i < fmt.size())
+    {
+        char c = fmt[i];
+        if (c != '%')
+        {
+            out.push_back(c);
+            i++;
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '%')
+        {
+            out.push_back('%');
+            i += 2;
+            continue;
+        }
+
+        // 解析 %[flags][width][.precision][length]conv，去掉长度修饰后按参数类型格式化
+        std::string spec = "%";
+        i++;
+        while (i < fmt.size() && strchr("-+ #0", fmt[i]))
+            spec.push_back(fmt[i++]);
+        while (i < fmt.size() && (isdigit((unsigned char)fmt[i]) || fmt[i] == '.'))
+            spec.push_back(fmt[i++]);
+        while (i < fmt.size() && strchr("hlLzjt", fmt[i]))
+            i++;
+        if (i >= fmt.size())
+            break;
+        char conv = fmt[i++];
+
+        Arg arg;
+        if (!readArg(args, len, pos, arg))
+        {
+            out += "<?>";
+            continue;
+        }
+
+        char buf[96];
+        switch (conv)
+        {
+        case 'd':
+        case 'i':
+            snprintf(buf, sizeof(buf), (spec + "lld").c_str(), (long long)arg.i);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(), (unsigned long long)arg.u);
+            break;
+        case 'c':
+            snprintf(buf, sizeof(buf), (spec + "c").c_str(), (int)arg.i);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            snprintf(buf, sizeof(buf), (spec + conv).c_str(), (double)arg.f);
+            break;
+        case 's':
+            snprintf(buf, sizeof(buf), (spec + "s").c_str(), arg.s.c_str());
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%s", argText(arg).c_str());
+            break;
+        }
+        out += buf;
+    }
+
+    // 多出的参数（无格式或格式表已满时）依次附在末尾
+    Arg arg;
+    bool first = fmt.empty();
+    while (readArg(args, len, pos, arg))
+    {
+        if (!first)
+            out.push_back(' ');
+        out += argText(arg);
+        first = false;
+    }
+    return out;
+}
+
+std::vector<uint8_t> LogDecoder::stripFrames(const uint8_t *data, size_t len)
+{
+    struct Collector
+    {
+        std::vector<uint8_t> out;
+        static void onLine(void *ctx, const std::string &line)
+        {
+            Collector *c = static_cast<Collector *>(ctx);
+            c->out.insert(c->out.end(), line.begin(), line.end());
+            c->out.push_back('\n');
+        }
+    };
+
+    // 只保留文本：日志帧解析后丢弃
+    Collector collector;
+    LogDecoder decoder(Collector::onLine, &collector);
+    decoder.textOnly = true;
+    decoder.feed(data, len);
+    decoder.finish();
+    return collector.out;
+}
@@ -0,0 +1,69 @@
+#pragma once
+// 二进制日志解码（主机端）：从串口字节流中拆出日志帧还原为文本，
+// 帧之外的字节按行原样输出
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "LogFormat.h"
+
+class LogDecoder
+{
+public:
+    typedef void (*LineFn)(void *ctx, const std::string &line);
+
+    LogDecoder(LineFn onLine, void *ctx);
+
+    void feed(const uint8_t *data, size_t len);
+    // 输出尚未以换行结束的文本
+    void finish();
+
+    // 按 printf 格式还原参数；参数不足时以 <?> 占位
+    static std::string format(const std::string &fmt, const uint8_t *args, size_t len);
+
+    // 去掉字节流中的日志帧，只保留文本（供追踪导出等文本解析使用）
+    static std::vector<uint8_t> stripFrames(const uint8_t *data, size_t len);
+
+    uint32_t getFrameCount() const { return frames; }
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+    uint32_t getUnknownFormats() const { return unknownFormats; }
+    uint32_t getDroppedCount() const { return dropped; }
+
+private:
+    enum State
+    {
+        STATE_TEXT,
+        STATE_SYNC1,
+        STATE_TYPE,
+        STATE_LEN,
+        STATE_PAYLOAD,
+        STATE_CHECKSUM
+    };
+
+    LineFn onLine;
+    void *ctx;
+    bool textOnly = false; // 丢弃日志帧，只输出文本
+
+    State state = STATE_TEXT;
+    uint8_t frameType = 0;
+    uint8_t frameLen = 0;
+    uint8_t payload[logfmt::MAX_PAYLOAD];
+    size_t payloadPos = 0;
+    std::string text;
+
+    std::string formats[256];
+    bool known[256] = {};
+
+    uint32_t lastTimeUs = 0;
+    uint64_t timeHigh = 0;
+    bool haveTime = false;
+
+    uint32_t frames = 0;
+    uint32_t checksumErrors = 0;
+    uint32_t unknownFormats = 0;
+    uint32_t dropped = 0;
+
+    void textByte(uint8_t b);
+    void handleFrame();
+    void emit(const std::string &line);
+};
@@ -0,0 +1,220 @@
+// GATT 负载发生器（主机端）：
+//   gatt_load [--clients N] [--seconds S] [--interval MS] [--miss ‰] [--rate HZ] [--queue N]
+//             [--scenario <脚本>] [--sweep]
+// 在回环 GATT 后端上运行 CSC/CP/FTMS 服务与模拟骑行（或脚本场景，见 tools/scenarios/），N 个中心设备同时订阅，
+// 报告通知速率、送达/丢弃、发送缓冲深度、入队到送达的延迟以及每次采样构造负载的开销。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "FTMSService.h"
+#include "LoopbackGatt.h"
+#include "Scenario.h"
+
+namespace
+{
+    struct Options
+    {
+        uint32_t clients = 1;
+        uint32_t seconds = 600;
+        uint32_t intervalMs = 30;  // 连接间隔，同时作为合并窗口
+        uint32_t missPermille = 0; // 连接事件丢失概率
+        uint32_t rateHz = 20;      // 采样频率（固件 BikeData 为 50ms 一次）
+        uint32_t queue = 12;       // 每个连接的发送缓冲
+        const char *scenarioPath = nullptr;
+        bool sweep = false;
+    };
+
+    struct Result
+    {
+        host::LoopbackServer::ClientStats total;
+        uint64_t notifyCalls = 0;
+        uint64_t samples = 0;
+        double buildNs = 0; // 采样到 notify 返回的主机耗时
+        double wallUs = 0;
+    };
+
+    Scenario scenario;
+
+    Result run(const Options &opt, uint32_t clients)
+    {
+        Result result;
+        const int64_t startUs = 1000000;
+        const uint32_t tickUs = 1000000 / (opt.rateHz ? opt.rateHz : 1);
+        host::setMicros(startUs);
+
+        host::LoopbackServer server(clients);
+        CSCService csc(&server);
+        CPService cp(&server);
+        FTMSService ftms(&server);
+
+        uint32_t intervalUs = opt.intervalMs * 1000;
+        csc.getCoalescer().setWindow(intervalUs);
+        cp.getCoalescer().setWindow(intervalUs);
+        ftms.getCoalescer().setWindow(intervalUs);
+
+        // 各连接的连接事件错开，避免全部落在同一时刻
+        for (uint32_t i = 0; i < clients; i++)
+        {
+            host::LoopbackServer::ClientConfig config;
+            config.connIntervalUs = intervalUs;
+            config.phaseUs = (uint32_t)((uint64_t)intervalUs * i / clients);
+            config.txQueueSize = (uint16_t)opt.queue;
+            config.missPermille = (uint16_t)opt.missPermille;
+            server.connect(config);
+        }
+
+        BikeData bikeData;
+        if (opt.scenarioPath)
+            bikeData.setScenario(&scenario);
+        int64_t nowUs = startUs;
+        uint64_t ticks = (uint64_t)opt.seconds * 1000000 / tickUs;
+        double buildNs = 0;
+
+        auto wallStart = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ticks; i++)
+        {
+            nowUs += tickUs;
+            host::setMicros(nowUs);
+            server.advance(nowUs);
+
+            auto start = std::chrono::steady_clock::now();
+            uint8_t events = bikeData.update(nowUs);
+            BikeData::Data d = bikeData.getData();
+            if (events & (BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK))
+                csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+            else
+                csc.flush(nowUs);
+            if (events)
+            {
+                cp.updateMeasurement(CPService::toFields(d));
+                ftms.updateMeasurement(d.speed, d.cadence, d.power);
+            }
+            else
+            {
+                cp.flush(nowUs);
+                ftms.flush(nowUs);
+            }
+            buildNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        result.wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+
+        result.total = server.getTotalStats();
+        result.notifyCalls = server.getCallCount(host::LoopbackServer::CALL_NOTIFY);
+        result.samples = ticks;
+        result.buildNs = ticks ? buildNs / ticks : 0;
+        return result;
+    }
+
+    void printResult(const Options &opt, uint32_t clients, const Result &r)
+    {
+        const host::LoopbackServer::ClientStats &s = r.total;
+        double seconds = opt.seconds ? (double)opt.seconds : 1.0;
+        double avgDepth = s.events ? (double)s.depthSum / s.events : 0.0;
+        double avgLatencyMs = s.delivered ? (double)s.latencySumUs / s.delivered / 1000.0 : 0.0;
+        double simulatedUs = (double)r.samples * (1000000.0 / (opt.rateHz ? opt.rateHz : 1));
+        printf("[LOAD] %3u 客户端: notify %7.1f/s, 送达 %8.1f/s (%6.0f B/s), 丢弃 %llu, "
+               "缓冲 平均 %.2f 最大 %u, 延迟 平均 %.1f 最大 %.1f ms, 构造 %.0f ns/采样, %.0fx 实时\n",
+               (unsigned)clients, r.notifyCalls / seconds, s.delivered / seconds, s.deliveredBytes / seconds,
+               (unsigned long long)s.dropped, avgDepth, (unsigned)s.maxDepth, avgLatencyMs,
+               s.maxLatencyUs / 1000.0, r.buildNs, r.wallUs > 0 ? simulatedUs / r.wallUs : 0.0);
+        if (s.missedEvents || s.truncated)
+            printf("[LOAD]      丢失连接事件 %llu/%llu, 截断 %llu\n", (unsigned long long)s.missedEvents,
+                   (unsigned long long)s.events, (unsigned long long)s.truncated);
+    }
+
+    bool parseArgs(int argc, char **argv, Options &opt)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char *arg = argv[i];
+            if (strcmp(arg, "--sweep") == 0)
+            {
+                opt.sweep = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+                return false;
+            if (strcmp(arg, "--scenario") == 0)
+            {
+                opt.scenarioPath = argv[++i];
+                continue;
+            }
+            uint32_t value = (uint32_t)strtoul(argv[++i], nullptr, 10);
+            if (strcmp(arg, "--clients") == 0)
+                opt.clients = value;
+            else if (strcmp(arg, "--seconds") == 0)
+                opt.seconds = value;
+            else if (strcmp(arg, "--interval") == 0)
+                opt.intervalMs = value;
+            else if (strcmp(arg, "--miss") == 0)
+                opt.missPermille = value;
+            else if (strcmp(arg, "--rate") == 0)
+                opt.rateHz = value;
+            else if (strcmp(arg, "--queue") == 0)
+                opt.queue = value;
+            else
+                return false;
+        }
+        return opt.clients > 0 && opt.clients <= host::LoopbackServer::MAX_CLIENTS &&
+               opt.intervalMs >= 7 && opt.rateHz > 0 && opt.missPermille <= 1000;
+    }
+
+    bool loadScenario(const char *path)
+    {
+        FILE *f = fopen(path, "rb");
+        if (!f)
+        {
+            printf("[ERROR] 无法读取场景 %s\n", path);
+            return false;
+        }
+        std::vector<char> text;
+        char buf[1024];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            text.insert(text.end(), buf, buf + n);
+        fclose(f);
+        text.push_back('\0');
+
+        Scenario::ParseError error;
+        if (!scenario.parse(text.data(), &error))
+        {
+            printf("[ERROR] %s:%u: %s\n", path, (unsigned)error.line, error.message);
+            return false;
+        }
+        printf("[LOAD] 场景 %s: %u 段, %.1f s%s, 种子 %u\n", path, (unsigned)scenario.getSegmentCount(),
+               scenario.getDurationUs() / 1e6, scenario.isLooping() ? " (循环)" : "", (unsigned)scenario.getSeed());
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        printf("用法: %s [--clients N] [--seconds S] [--interval MS] [--miss ‰] [--rate HZ] [--queue N]"
+               " [--scenario <脚本>] [--sweep]\n",
+               argv[0]);
+        return 2;
+    }
+    if (opt.scenarioPath && !loadScenario(opt.scenarioPath))
+        return 2;
+
+    printf("[LOAD] 模拟 %u 秒, 采样 %u Hz, 连接间隔 %u ms, 发送缓冲 %u, 连接事件丢失 %u‰\n",
+           (unsigned)opt.seconds, (unsigned)opt.rateHz, (unsigned)opt.intervalMs, (unsigned)opt.queue,
+           (unsigned)opt.missPermille);
+
+    if (!opt.sweep)
+    {
+        printResult(opt, opt.clients, run(opt, opt.clients));
+        return 0;
+    }
+    for (uint32_t clients = 1; clients <= 32; clients *= 2)
+        printResult(opt, clients, run(opt, clients));
+    return 0;
+}
@@ -0,0 +1,47 @@
+// 二进制日志解码工具（主机端）：
+//   log_decode <capture>   解码串口原始捕获（如 pio device monitor --raw 的输出）
+//   log_decode -           从标准输入读取，可直接接在串口读取命令之后
+// 日志帧还原为 "[秒] 级别 文本"，其余字节按行原样输出
+#include <stdio.h>
+#include <string.h>
+#include "LogDecoder.h"
+
+namespace
+{
+    void printLine(void *ctx, const std::string &line)
+    {
+        fputs(line.c_str(), stdout);
+        fputc('\n', stdout);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "用法: %s <capture>|-\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (!f)
+    {
+        fprintf(stderr, "[ERROR] 无法读取 %s\n", argv[1]);
+        return 1;
+    }
+
+    LogDecoder decoder(printLine, nullptr);
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        decoder.feed(buf, n);
+    decoder.finish();
+    if (f != stdin)
+        fclose(f);
+
+    fprintf(stderr, "[LOG] 帧 %u, 校验错误 %u, 未知格式 %u, 设备端丢弃 %u\n",
+            (unsigned)decoder.getFrameCount(), (unsigned)decoder.getChecksumErrors(),
+            (unsigned)decoder.getUnknownFormats(), (unsigned)decoder.getDroppedCount());
+    return 0;
+}
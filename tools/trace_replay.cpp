@@ -0,0 +1,513 @@
+// 追踪回放工具（主机端）：
+//   trace_replay <trace>              回放追踪并逐字节比对 CSC/CP 负载
+//   trace_replay --record <out> [秒]  在主机上模拟骑行并生成追踪（用于自检与回归基线）
+// <trace> 可以是原始二进制块，也可以是固件串口 'T' 命令输出的文本日志（可含二进制日志帧）
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "BikeData.h"
+#include "CSCService.h"
+#include "CPService.h"
+#include "FTMSService.h"
+#include "HostGatt.h"
+#include "LogDecoder.h"
+#include "TraceFormat.h"
+#include "TraceRecorder.h"
+
+using namespace trace;
+
+namespace
+{
+    const size_t HISTORY = 16;       // 可回溯的 tick 数
+    const size_t MAX_REPORTED = 10;  // 最多打印的差异条数
+
+    struct Block
+    {
+        uint32_t seq;
+        const uint8_t *data;
+    };
+
+    // ------------ 读取 ------------
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    // 从串口日志中提取 [TRACE] BEGIN 与 END 之间的十六进制行
+    bool parseTextDump(const std::vector<uint8_t> &text, std::vector<uint8_t> &out)
+    {
+        const char *begin = "[TRACE] BEGIN";
+        auto it = std::search(text.begin(), text.end(), begin, begin + strlen(begin));
+        if (it == text.end())
+            return false;
+
+        bool inLine = false;
+        bool skipLine = true; // BEGIN 行本身
+        int high = -1;
+        std::vector<uint8_t> line;
+        for (; it != text.end(); ++it)
+        {
+            char c = (char)*it;
+            if (c == '\n' || c == '\r')
+            {
+                if (!skipLine && inLine && high < 0)
+                    out.insert(out.end(), line.begin(), line.end());
+                line.clear();
+                inLine = false;
+                skipLine = false;
+                high = -1;
+                continue;
+            }
+            if (skipLine)
+                continue;
+            if (c == '[')
+            {
+                // END 行或其他日志
+                if (std::distance(it, text.end()) >= 11 && memcmp(&*it, "[TRACE] END", 11) == 0)
+                    break;
+                skipLine = true;
+                continue;
+            }
+            int v = hexValue(c);
+            if (v < 0)
+            {
+                skipLine = true; // 混入的其他输出
+                line.clear();
+                continue;
+            }
+            inLine = true;
+            if (high < 0)
+            {
+                high = v;
+            }
+            else
+            {
+                line.push_back((uint8_t)(high << 4 | v));
+                high = -1;
+            }
+        }
+        return !out.empty();
+    }
+
+    bool loadTrace(const char *path, std::vector<uint8_t> &out)
+    {
+        FILE *f = fopen(path, "rb");
+        if (!f)
+            return false;
+        std::vector<uint8_t> raw;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            raw.insert(raw.end(), buf, buf + n);
+        fclose(f);
+
+        if (raw.size() >= 2 && raw[0] == (BLOCK_MAGIC & 0xFF) && raw[1] == (BLOCK_MAGIC >> 8))
+        {
+            out.swap(raw);
+            return true;
+        }
+        // 串口捕获中可能夹有二进制日志帧，先去掉再解析文本
+        std::vector<uint8_t> text = LogDecoder::stripFrames(raw.data(), raw.size());
+        return parseTextDump(text, out);
+    }
+
+    // ------------ 回放 ------------
+
+    struct ReplayRandom
+    {
+        long values[MAX_TICK_RANDOM];
+        uint8_t count;
+        uint8_t next;
+        bool exhausted;
+    };
+
+    long replayRandom(void *ctx, long howsmall, long howbig)
+    {
+        ReplayRandom *r = static_cast<ReplayRandom *>(ctx);
+        if (r->next >= r->count)
+        {
+            r->exhausted = true;
+            return howsmall;
+        }
+        return r->values[r->next++];
+    }
+
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t payloads = 0;
+        uint64_t matched = 0;
+        uint64_t mismatched = 0;
+        uint64_t unverifiable = 0;
+        uint64_t stateDivergence = 0;
+        uint64_t randomDivergence = 0;
+        uint64_t gaps = 0;
+        uint64_t firstUs = 0;
+        uint64_t lastUs = 0;
+    };
+
+    void printHex(const char *label, const uint8_t *p, size_t n)
+    {
+        printf("    %s", label);
+        for (size_t i = 0; i < n; i++)
+            printf(" %02X", p[i]);
+        printf("\n");
+    }
+
+    const char *channelName(uint8_t channel)
+    {
+        switch (channel)
+        {
+        case CH_CSC:
+            return "CSC";
+        case CH_CP:
+            return "CP";
+        default:
+            return "FTMS";
+        }
+    }
+
+    class Replayer
+    {
+    public:
+        Replayer() : csc(&server), cp(&server), ftms(&server)
+        {
+            bikeData.setRandomSource(replayRandom, &random);
+        }
+
+        bool run(std::vector<Block> &blocks, Stats &stats)
+        {
+            std::sort(blocks.begin(), blocks.end(),
+                      [](const Block &a, const Block &b)
+                      { return a.seq < b.seq; });
+
+            bool first = true;
+            uint32_t expectedSeq = 0;
+            for (const Block &b : blocks)
+            {
+                if (!first && b.seq == expectedSeq - 1)
+                    continue; // 导出时重复的块
+                bool contiguous = !first && b.seq == expectedSeq;
+                if (!first && !contiguous)
+                    stats.gaps++;
+                replayBlock(b, contiguous, stats);
+                expectedSeq = b.seq + 1;
+                first = false;
+            }
+            return true;
+        }
+
+    private:
+        host::GattServer server;
+        CSCService csc;
+        CPService cp;
+        FTMSService ftms;
+        BikeData bikeData;
+        ReplayRandom random = {};
+
+        uint64_t nowUs = 0;
+        uint64_t tick = 0;
+        uint64_t historyStart = 0; // 可验证的最早 tick（关键帧处）
+        BikeData::Data history[HISTORY];
+        uint8_t prevPayload[CH_COUNT][MAX_PAYLOAD];
+        uint8_t prevLen[CH_COUNT];
+
+        void replayBlock(const Block &b, bool contiguous, Stats &stats)
+        {
+            ByteReader r(b.data + BLOCK_HEADER_SIZE, BLOCK_SIZE - BLOCK_HEADER_SIZE);
+            if (r.u8() != REC_KEYFRAME)
+                return;
+
+            uint64_t keyUs = r.u64();
+            uint32_t keyTick = r.u32();
+            size_t stateStart = BLOCK_HEADER_SIZE + r.position();
+
+            if (contiguous && keyTick == (uint32_t)tick)
+            {
+                // 连续块：比较回放得到的状态与记录的关键帧
+                uint8_t replayed[256];
+                ByteWriter w(replayed, sizeof(replayed));
+                bikeData.saveState(w);
+                if (memcmp(replayed, b.data + stateStart, w.size()) != 0)
+                {
+                    stats.stateDivergence++;
+                    if (stats.stateDivergence <= MAX_REPORTED)
+                        printf("[REPLAY] 块 %u 关键帧状态与回放结果不一致\n", (unsigned)b.seq);
+                }
+            }
+            else
+            {
+                historyStart = keyTick;
+            }
+
+            // 以关键帧状态为准继续回放
+            bikeData.loadState(r);
+            nowUs = keyUs;
+            tick = keyTick;
+            if (stats.ticks == 0)
+                stats.firstUs = keyUs;
+            history[tick % HISTORY] = bikeData.getData();
+            memset(prevLen, 0, sizeof(prevLen));
+
+            while (r.remaining() > 0 && r.ok())
+            {
+                uint8_t type = r.u8();
+                if (type == REC_TICK)
+                    replayTick(r, stats);
+                else if (type == REC_PAYLOAD)
+                    replayPayload(r, b.seq, stats);
+                else
+                    break; // REC_END 或损坏
+            }
+        }
+
+        void replayTick(ByteReader &r, Stats &stats)
+        {
+            uint64_t dt = r.varint();
+            nowUs += dt;
+            stats.lastUs = nowUs;
+
+            uint8_t keiserCount = r.u8();
+            for (uint8_t i = 0; i < keiserCount; i++)
+            {
+                KeiserSample s = {};
+                s.versionMajor = r.u8();
+                s.versionMinor = r.u8();
+                s.dataType = r.u8();
+                s.equipmentId = r.u8();
+                s.cadence = (uint16_t)r.varint();
+                s.heartRate = (uint16_t)r.varint();
+                s.power = (uint16_t)r.varint();
+                s.calories = (uint16_t)r.varint();
+                s.minutes = r.u8();
+                s.seconds = r.u8();
+                uint16_t distance = (uint16_t)r.varint();
+                s.metric = (distance & 0x8000) != 0;
+                s.distance = distance & 0x7FFF;
+                s.gear = r.u8();
+                bikeData.ingestKeiser(s);
+            }
+
+            random.count = r.u8();
+            random.next = 0;
+            random.exhausted = false;
+            for (uint8_t i = 0; i < random.count && i < MAX_TICK_RANDOM; i++)
+                random.values[i] = (long)r.svarint();
+
+            host::setMicros(nowUs);
+            bikeData.update(nowUs);
+            if (random.exhausted || random.next != random.count)
+                stats.randomDivergence++;
+
+            tick++;
+            history[tick % HISTORY] = bikeData.getData();
+            stats.ticks++;
+        }
+
+        void replayPayload(ByteReader &r, uint32_t blockSeq, Stats &stats)
+        {
+            uint8_t channel = r.u8();
+            uint64_t back = r.varint();
+            uint8_t len = r.u8();
+            if (channel >= CH_COUNT || len > MAX_PAYLOAD)
+            {
+                r.u8(); // 触发退出
+                return;
+            }
+
+            // 还原负载：掩码中置位的字节来自记录，其余沿用上一包
+            uint8_t masks[(MAX_PAYLOAD + 7) / 8];
+            for (size_t i = 0; i < (size_t)(len + 7) / 8; i++)
+                masks[i] = r.u8();
+            uint8_t recorded[MAX_PAYLOAD];
+            for (size_t i = 0; i < len; i++)
+            {
+                if (masks[i / 8] & (1 << (i % 8)))
+                    recorded[i] = r.u8();
+                else
+                    recorded[i] = i < prevLen[channel] ? prevPayload[channel][i] : 0;
+            }
+            memcpy(prevPayload[channel], recorded, len);
+            prevLen[channel] = len;
+            stats.payloads++;
+
+            if (back > tick || tick - back < historyStart || back >= HISTORY)
+            {
+                stats.unverifiable++;
+                return;
+            }
+
+            // 用同一份服务代码重新编码并比对
+            const BikeData::Data &d = history[(tick - back) % HISTORY];
+            gatt::Characteristic *ch;
+            if (channel == CH_CSC)
+            {
+                csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+                ch = csc.getMeasurementChar();
+            }
+            else if (channel == CH_CP)
+            {
+                cp.updateMeasurement(CPService::toFields(d));
+                ch = cp.getMeasurementChar();
+            }
+            else
+            {
+                ftms.updateMeasurement(d.speed, d.cadence, d.power);
+                ch = ftms.getMeasurementChar();
+            }
+
+            if (ch->getLength() == len && memcmp(ch->getData(), recorded, len) == 0)
+            {
+                stats.matched++;
+                return;
+            }
+
+            stats.mismatched++;
+            if (stats.mismatched <= MAX_REPORTED)
+            {
+                printf("[REPLAY] 块 %u tick %llu %s 负载不一致\n", (unsigned)blockSeq,
+                       (unsigned long long)(tick - back), channelName(channel));
+                printHex("记录:", recorded, len);
+                printHex("回放:", ch->getData(), ch->getLength());
+            }
+        }
+    };
+
+    // ------------ 主机端录制 ------------
+
+    int record(const char *path, uint32_t seconds)
+    {
+        const uint32_t TICK_US = 50000;
+        size_t size = 4 * 1024 * 1024;
+        std::vector<uint8_t> buffer(size);
+
+        TraceRecorder recorder;
+        recorder.begin(buffer.data(), size);
+
+        host::GattServer server;
+        CSCService csc(&server);
+        CPService cp(&server);
+        FTMSService ftms(&server);
+        BikeData bikeData;
+        bikeData.setRandomSource(TraceRecorder::recordingRandom, &recorder);
+
+        uint64_t nowUs = 1000000;
+        uint64_t ticks = (uint64_t)seconds * 1000000 / TICK_US;
+        for (uint64_t i = 0; i < ticks; i++)
+        {
+            nowUs += TICK_US;
+            host::setMicros(nowUs);
+            recorder.beginTick(bikeData, nowUs);
+            uint8_t events = bikeData.update(nowUs);
+            recorder.endTick();
+
+            BikeData::Data d = bikeData.getData();
+            uint32_t tick = recorder.currentTick();
+            if (events & (BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK))
+            {
+                csc.updateMeasurement(d.wheel_rev, d.w_event_time, d.crank_rev, d.c_event_time);
+                gatt::Characteristic *ch = csc.getMeasurementChar();
+                recorder.recordPayload(CH_CSC, tick, ch->getData(), ch->getLength());
+            }
+            if (events & (BikeData::EVENT_WHEEL | BikeData::EVENT_CRANK | BikeData::EVENT_POWER | BikeData::EVENT_ENERGY))
+            {
+                cp.updateMeasurement(CPService::toFields(d));
+                gatt::Characteristic *ch = cp.getMeasurementChar();
+                recorder.recordPayload(CH_CP, tick, ch->getData(), ch->getLength());
+            }
+            if (events)
+            {
+                ftms.updateMeasurement(d.speed, d.cadence, d.power);
+                gatt::Characteristic *ch = ftms.getMeasurementChar();
+                recorder.recordPayload(CH_FTMS, tick, ch->getData(), ch->getLength());
+            }
+        }
+
+        FILE *f = fopen(path, "wb");
+        if (!f)
+        {
+            printf("[ERROR] 无法写入 %s\n", path);
+            return 1;
+        }
+        uint8_t block[BLOCK_SIZE];
+        size_t blocks = recorder.getBlockCount();
+        for (size_t b = 0; b < blocks; b++)
+        {
+            if (recorder.copyBlock(b, block))
+                fwrite(block, 1, BLOCK_SIZE, f);
+        }
+        fclose(f);
+        printf("[TRACE] 录制 %u 秒, %llu ticks, %u 条记录, %u 块, 丢弃 %u\n", (unsigned)seconds,
+               (unsigned long long)ticks, (unsigned)recorder.getRecordCount(), (unsigned)blocks,
+               (unsigned)recorder.getDroppedCount());
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "--record") == 0)
+    {
+        uint32_t seconds = argc >= 4 ? (uint32_t)atoi(argv[3]) : 3600;
+        return record(argv[2], seconds);
+    }
+    if (argc != 2)
+    {
+        printf("用法: %s <trace> | --record <out> [秒]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!loadTrace(argv[1], data))
+    {
+        printf("[ERROR] 无法读取追踪 %s\n", argv[1]);
+        return 2;
+    }
+
+    std::vector<Block> blocks;
+    for (size_t off = 0; off + BLOCK_SIZE <= data.size(); off += BLOCK_SIZE)
+    {
+        ByteReader r(&data[off], BLOCK_SIZE);
+        if (r.u16() != BLOCK_MAGIC)
+            continue;
+        uint32_t seq = r.u32();
+        uint8_t version = r.u8();
+        if (version != FORMAT_VERSION)
+        {
+            // 关键帧布局不同，按当前布局解析只会得到错误的状态与大量不一致
+            printf("[ERROR] 追踪格式版本 %u 不受支持（本工具为版本 %u），请用对应版本的工具回放\n",
+                   (unsigned)version, (unsigned)FORMAT_VERSION);
+            return 2;
+        }
+        blocks.push_back({seq, &data[off]});
+    }
+
+    Stats stats;
+    auto start = std::chrono::steady_clock::now();
+    Replayer replayer;
+    replayer.run(blocks, stats);
+    double wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[REPLAY] 块 %u (缺口 %llu), tick %llu, 负载 %llu: 一致 %llu, 不一致 %llu, 无法验证 %llu\n",
+           (unsigned)blocks.size(), (unsigned long long)stats.gaps, (unsigned long long)stats.ticks,
+           (unsigned long long)stats.payloads, (unsigned long long)stats.matched,
+           (unsigned long long)stats.mismatched, (unsigned long long)stats.unverifiable);
+    printf("[REPLAY] 状态偏离 %llu, 随机数偏离 %llu\n",
+           (unsigned long long)stats.stateDivergence, (unsigned long long)stats.randomDivergence);
+    double simulatedUs = (double)(stats.lastUs - stats.firstUs);
+    printf("[REPLAY] 模拟时长 %.1f s, 耗时 %.3f s, %.0fx 实时\n", simulatedUs / 1e6, wallUs / 1e6,
+           wallUs > 0 ? simulatedUs / wallUs : 0.0);
+
+    bool clean = stats.mismatched == 0 && stats.stateDivergence == 0 && stats.randomDivergence == 0;
+    return clean ? 0 : 1;
+}